@@ -0,0 +1,799 @@
+/****************************************************************************
+ * drivers/net/netdev_offload.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <assert.h>
+#include <errno.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/param.h>
+
+#include <nuttx/mm/iob.h>
+#include <nuttx/net/ethernet.h>
+#include <nuttx/net/ip.h>
+#include <nuttx/net/netdev.h>
+#include <nuttx/net/netdev_lowerhalf.h>
+#include <nuttx/net/tcp.h>
+
+#include "netdev_offload.h"
+
+#if defined(CONFIG_NETDEV_GSO) || defined(CONFIG_NETDEV_GRO)
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* The longest IP and TCP headers, both with the maximum options */
+
+#define OFFLOAD_HDRMAX    (60 + 60)
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* The IP and TCP headers of a packet, all in its first I/O buffer */
+
+struct offload_hdr_s
+{
+  FAR uint8_t          *l3;     /* The IPv4 or IPv6 header */
+  FAR struct tcp_hdr_s *tcp;    /* The TCP header */
+  uint16_t              iplen;  /* Length of the IP header */
+  uint16_t              hdrlen; /* Length of the IP and TCP headers */
+  int                   type;   /* NETDEV_F_TSO4 or NETDEV_F_TSO6 */
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static inline uint16_t offload_get16(FAR const uint8_t *p)
+{
+  return ((uint16_t)p[0] << 8) | p[1];
+}
+
+static inline void offload_put16(FAR uint8_t *p, uint16_t val)
+{
+  p[0] = val >> 8;
+  p[1] = val & 0xff;
+}
+
+static inline uint32_t offload_get32(FAR const uint8_t *p)
+{
+  return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) |
+         ((uint32_t)p[2] << 8) | p[3];
+}
+
+static inline void offload_put32(FAR uint8_t *p, uint32_t val)
+{
+  p[0] = val >> 24;
+  p[1] = (val >> 16) & 0xff;
+  p[2] = (val >> 8) & 0xff;
+  p[3] = val & 0xff;
+}
+
+/****************************************************************************
+ * Name: offload_add
+ *
+ * Description:
+ *   Add two partial Internet checksums in one's complement arithmetic.
+ *
+ ****************************************************************************/
+
+static inline uint16_t offload_add(uint16_t a, uint16_t b)
+{
+  uint32_t sum = (uint32_t)a + b;
+
+  return (sum & 0xffff) + (sum >> 16);
+}
+
+/****************************************************************************
+ * Name: offload_parse
+ *
+ * Description:
+ *   Locate the IP and TCP headers of a packet.  Only TCP segments whose
+ *   headers are all in the first I/O buffer and that are not IPv4
+ *   fragments are accepted.
+ *
+ ****************************************************************************/
+
+static int offload_parse(FAR netpkt_t *pkt, FAR struct offload_hdr_s *hdr)
+{
+  FAR uint8_t *l3 = IOB_DATA(pkt);
+  unsigned int tcplen;
+
+  if (pkt->io_len < 1)
+    {
+      return -EINVAL;
+    }
+
+#ifdef CONFIG_NET_IPv4
+  if ((l3[0] & IP_VERSION_MASK) == IPv4_VERSION)
+    {
+      FAR struct ipv4_hdr_s *ipv4 = (FAR struct ipv4_hdr_s *)l3;
+
+      hdr->iplen = (ipv4->vhl & IPv4_HLMASK) << 2;
+      if (hdr->iplen < IPv4_HDRLEN ||
+          pkt->io_len < hdr->iplen + TCP_HDRLEN ||
+          ipv4->proto != IP_PROTO_TCP ||
+          (offload_get16(ipv4->ipoffset) & ~IP_FLAG_DONTFRAG) != 0)
+        {
+          return -EINVAL;
+        }
+
+      hdr->type = NETDEV_F_TSO4;
+    }
+  else
+#endif
+#ifdef CONFIG_NET_IPv6
+  if ((l3[0] & IP_VERSION_MASK) == IPv6_VERSION)
+    {
+      FAR struct ipv6_hdr_s *ipv6 = (FAR struct ipv6_hdr_s *)l3;
+
+      hdr->iplen = IPv6_HDRLEN;
+      if (pkt->io_len < IPv6_HDRLEN + TCP_HDRLEN ||
+          ipv6->proto != IP_PROTO_TCP)
+        {
+          return -EINVAL;
+        }
+
+      hdr->type = NETDEV_F_TSO6;
+    }
+  else
+#endif
+    {
+      return -EINVAL;
+    }
+
+  hdr->l3  = l3;
+  hdr->tcp = (FAR struct tcp_hdr_s *)(l3 + hdr->iplen);
+
+  tcplen = (hdr->tcp->tcpoffset >> 4) << 2;
+  if (tcplen < TCP_HDRLEN || pkt->io_len < hdr->iplen + tcplen)
+    {
+      return -EINVAL;
+    }
+
+  hdr->hdrlen = hdr->iplen + tcplen;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: offload_pseudo
+ *
+ * Description:
+ *   Return the partial checksum of the TCP pseudo-header.
+ *
+ ****************************************************************************/
+
+static uint16_t offload_pseudo(FAR struct offload_hdr_s *hdr,
+                               uint16_t tcplen)
+{
+  uint16_t sum = tcplen + IP_PROTO_TCP;
+
+#ifdef CONFIG_NET_IPv4
+  if (hdr->type == NETDEV_F_TSO4)
+    {
+      FAR struct ipv4_hdr_s *ipv4 = (FAR struct ipv4_hdr_s *)hdr->l3;
+
+      return chksum(sum, (FAR uint8_t *)ipv4->srcipaddr,
+                    2 * sizeof(in_addr_t));
+    }
+#endif
+
+#ifdef CONFIG_NET_IPv6
+  if (hdr->type == NETDEV_F_TSO6)
+    {
+      FAR struct ipv6_hdr_s *ipv6 = (FAR struct ipv6_hdr_s *)hdr->l3;
+
+      return chksum(sum, (FAR uint8_t *)ipv6->srcipaddr,
+                    2 * sizeof(net_ipv6addr_t));
+    }
+#endif
+
+  return sum;
+}
+
+/****************************************************************************
+ * Name: offload_set_iplen
+ *
+ * Description:
+ *   Update the length field of the IP header to a packet of 'pktlen' bytes
+ *   (L2 header excluded), and the IPv4 header checksum with it.
+ *
+ ****************************************************************************/
+
+static void offload_set_iplen(FAR struct offload_hdr_s *hdr,
+                              uint16_t pktlen)
+{
+#ifdef CONFIG_NET_IPv4
+  if (hdr->type == NETDEV_F_TSO4)
+    {
+      FAR struct ipv4_hdr_s *ipv4 = (FAR struct ipv4_hdr_s *)hdr->l3;
+
+      offload_put16(ipv4->len, pktlen);
+      ipv4->ipchksum = 0;
+      ipv4->ipchksum = ~ipv4_chksum(ipv4);
+    }
+#endif
+
+#ifdef CONFIG_NET_IPv6
+  if (hdr->type == NETDEV_F_TSO6)
+    {
+      FAR struct ipv6_hdr_s *ipv6 = (FAR struct ipv6_hdr_s *)hdr->l3;
+
+      offload_put16(ipv6->len, pktlen - IPv6_HDRLEN);
+    }
+#endif
+}
+
+/****************************************************************************
+ * Name: offload_set_tcpchksum
+ *
+ * Description:
+ *   Set the TCP checksum of a packet of 'pktlen' bytes, given the partial
+ *   checksum of its TCP payload.
+ *
+ ****************************************************************************/
+
+static void offload_set_tcpchksum(FAR struct offload_hdr_s *hdr,
+                                  uint16_t pktlen, uint16_t paysum)
+{
+#ifdef CONFIG_NET_TCP_CHECKSUMS
+  uint16_t sum;
+
+  hdr->tcp->tcpchksum = 0;
+
+  sum = offload_pseudo(hdr, pktlen - hdr->iplen);
+  sum = chksum(sum, (FAR uint8_t *)hdr->tcp, hdr->hdrlen - hdr->iplen);
+  sum = offload_add(sum, paysum);
+
+  hdr->tcp->tcpchksum = ~((sum == 0) ? 0xffff : HTONS(sum));
+#endif
+}
+
+#ifdef CONFIG_NETDEV_GSO
+
+/****************************************************************************
+ * Name: offload_cut
+ *
+ * Description:
+ *   Cut the first 'len' bytes off the I/O buffer chain in 'rest' and return
+ *   them as a chain of their own.  Whole I/O buffers are relinked, only the
+ *   data of a buffer that straddles the cut is copied.  NULL is returned
+ *   and 'rest' is left intact if no buffer is available for that copy.
+ *
+ ****************************************************************************/
+
+static FAR struct iob_s *offload_cut(FAR struct iob_s **rest,
+                                     unsigned int len)
+{
+  FAR struct iob_s *head   = *rest;
+  FAR struct iob_s *tail   = NULL;
+  FAR struct iob_s *iob    = head;
+  unsigned int      pktlen = head->io_pktlen;
+  unsigned int      n      = 0;
+
+  DEBUGASSERT(len > 0 && len <= pktlen);
+
+  while (iob != NULL && n + iob->io_len <= len)
+    {
+      n   += iob->io_len;
+      tail = iob;
+      iob  = iob->io_flink;
+    }
+
+  if (n < len)
+    {
+      FAR struct iob_s *copy = iob_tryalloc(false);
+      unsigned int      part = len - n;
+
+      if (copy == NULL)
+        {
+          return NULL;
+        }
+
+      memcpy(copy->io_data, IOB_DATA(iob), part);
+      copy->io_len    = part;
+      iob->io_offset += part;
+      iob->io_len    -= part;
+
+      if (tail == NULL)
+        {
+          head = copy;
+        }
+      else
+        {
+          tail->io_flink = copy;
+        }
+
+      tail = copy;
+    }
+
+  tail->io_flink  = NULL;
+  head->io_pktlen = len;
+
+  if (iob != NULL)
+    {
+      iob->io_pktlen = pktlen - len;
+    }
+
+  *rest = iob;
+  return head;
+}
+
+#endif /* CONFIG_NETDEV_GSO */
+
+#ifdef CONFIG_NETDEV_GRO
+
+/****************************************************************************
+ * Name: offload_rx_parse
+ *
+ * Description:
+ *   Locate the headers of a received packet and check that it may be
+ *   coalesced: an Ethernet frame carrying a TCP segment with payload that
+ *   is addressed to this device, without padding and with valid checksums.
+ *   The partial checksum of the payload is returned in 'paysum'.
+ *
+ ****************************************************************************/
+
+static bool offload_rx_parse(FAR struct netdev_lowerhalf_s *lower,
+                             FAR netpkt_t *pkt,
+                             FAR struct offload_hdr_s *hdr,
+                             FAR uint16_t *paysum)
+{
+  FAR struct net_driver_s *dev = &lower->netdev;
+  FAR struct eth_hdr_s *eth;
+  uint16_t sum;
+
+  if (dev->d_lltype != NET_LL_ETHERNET || offload_parse(pkt, hdr) < 0 ||
+      pkt->io_pktlen <= hdr->hdrlen)
+    {
+      return false;
+    }
+
+  eth = (FAR struct eth_hdr_s *)(hdr->l3 - NET_LL_HDRLEN(dev));
+
+#ifdef CONFIG_NET_IPv4
+  if (hdr->type == NETDEV_F_TSO4)
+    {
+      FAR struct ipv4_hdr_s *ipv4 = (FAR struct ipv4_hdr_s *)hdr->l3;
+
+      if (eth->type != HTONS(ETHTYPE_IP) ||
+          offload_get16(ipv4->len) != pkt->io_pktlen ||
+          !net_ipv4addr_cmp(net_ip4addr_conv32(ipv4->destipaddr),
+                            dev->d_ipaddr))
+        {
+          return false;
+        }
+
+#ifdef CONFIG_NET_IPV4_CHECKSUMS
+      if (ipv4_chksum(ipv4) != 0xffff)
+        {
+          return false;
+        }
+#endif
+    }
+#endif
+
+#ifdef CONFIG_NET_IPv6
+  if (hdr->type == NETDEV_F_TSO6)
+    {
+      FAR struct ipv6_hdr_s *ipv6 = (FAR struct ipv6_hdr_s *)hdr->l3;
+
+      if (eth->type != HTONS(ETHTYPE_IP6) ||
+          offload_get16(ipv6->len) + IPv6_HDRLEN != pkt->io_pktlen ||
+          !NETDEV_IS_MY_V6ADDR(dev, ipv6->destipaddr))
+        {
+          return false;
+        }
+    }
+#endif
+
+  /* Segments with a bad checksum are left to the stack to drop, they must
+   * not be made valid by the checksum of a coalesced packet.
+   */
+
+  *paysum = chksum_iob(0, pkt, hdr->hdrlen);
+
+#ifdef CONFIG_NET_TCP_CHECKSUMS
+  sum = offload_pseudo(hdr, pkt->io_pktlen - hdr->iplen);
+  sum = chksum(sum, (FAR uint8_t *)hdr->tcp, hdr->hdrlen - hdr->iplen);
+  sum = offload_add(sum, *paysum);
+  if (sum != 0xffff && sum != 0)
+    {
+      return false;
+    }
+#else
+  UNUSED(sum);
+#endif
+
+  return true;
+}
+
+/****************************************************************************
+ * Name: offload_same_flow
+ *
+ * Description:
+ *   Check that two segments have the same headers, except for the fields
+ *   that differ between the segments of one burst: the IP length, ID and
+ *   checksum, and the TCP sequence number, flags, window and checksum.
+ *
+ ****************************************************************************/
+
+static bool offload_same_flow(FAR struct netdev_lowerhalf_s *lower,
+                              FAR struct offload_hdr_s *a,
+                              FAR struct offload_hdr_s *b)
+{
+  uint8_t llhdrlen = NET_LL_HDRLEN(&lower->netdev);
+  FAR uint8_t *ta = (FAR uint8_t *)a->tcp;
+  FAR uint8_t *tb = (FAR uint8_t *)b->tcp;
+
+  if (a->type != b->type || a->hdrlen != b->hdrlen ||
+      memcmp(a->l3 - llhdrlen, b->l3 - llhdrlen, llhdrlen) != 0)
+    {
+      return false;
+    }
+
+#ifdef CONFIG_NET_IPv4
+  if (a->type == NETDEV_F_TSO4)
+    {
+      /* vhl and tos, then ipoffset, ttl and proto, then the addresses and
+       * the options.
+       */
+
+      if (memcmp(a->l3, b->l3, 2) != 0 ||
+          memcmp(a->l3 + 6, b->l3 + 6, 4) != 0 ||
+          memcmp(a->l3 + 12, b->l3 + 12, a->iplen - 12) != 0)
+        {
+          return false;
+        }
+    }
+#endif
+
+#ifdef CONFIG_NET_IPv6
+  if (a->type == NETDEV_F_TSO6)
+    {
+      /* Version, traffic class and flow label, then next header, hop limit
+       * and the addresses.
+       */
+
+      if (memcmp(a->l3, b->l3, 4) != 0 ||
+          memcmp(a->l3 + 6, b->l3 + 6, IPv6_HDRLEN - 6) != 0)
+        {
+          return false;
+        }
+    }
+#endif
+
+  /* Ports, then acknowledgment number and data offset, then urgent pointer
+   * and the options.
+   */
+
+  return memcmp(ta, tb, 4) == 0 && memcmp(ta + 8, tb + 8, 5) == 0 &&
+         memcmp(ta + 18, tb + 18, a->hdrlen - a->iplen - 18) == 0;
+}
+
+#endif /* CONFIG_NETDEV_GRO */
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+#ifdef CONFIG_NETDEV_GSO
+
+/****************************************************************************
+ * Name: netdev_gso_type
+ *
+ * Description:
+ *   Return NETDEV_F_TSO4 or NETDEV_F_TSO6 if the outgoing packet is a TCP
+ *   segment over IPv4 or IPv6, and zero otherwise.
+ *
+ ****************************************************************************/
+
+int netdev_gso_type(FAR netpkt_t *pkt)
+{
+  struct offload_hdr_s hdr;
+
+  return offload_parse(pkt, &hdr) < 0 ? 0 : hdr.type;
+}
+
+/****************************************************************************
+ * Name: netdev_gso_segment
+ *
+ * Description:
+ *   Cut an outgoing TCP packet into segments of at most 'mss' bytes of
+ *   payload and pass them to 'cb' one by one.
+ *
+ * Input Parameters:
+ *   lower - The lower half driver the packet is sent on
+ *   pkt   - The packet, consumed in any case
+ *   mss   - The segment size
+ *   cb    - The function that takes each segment
+ *   arg   - The argument of cb
+ *
+ * Returned Value:
+ *   OK on success; a negated errno value on failure.
+ *
+ ****************************************************************************/
+
+int netdev_gso_segment(FAR struct netdev_lowerhalf_s *lower,
+                       FAR netpkt_t *pkt, uint16_t mss,
+                       netdev_gso_cb_t cb, FAR void *arg)
+{
+  uint8_t llhdrlen = NET_LL_HDRLEN(&lower->netdev);
+  uint8_t tmpl[CONFIG_NET_LL_GUARDSIZE + OFFLOAD_HDRMAX];
+  struct offload_hdr_s hdr;
+  FAR netpkt_t *rest;
+  FAR netpkt_t *seg;
+  FAR netpkt_t *part;
+  unsigned int paylen;
+  unsigned int off;
+  unsigned int len;
+  uint32_t seqno;
+  uint16_t ipid = 0;
+  uint8_t flags;
+  int ret;
+
+  ret = offload_parse(pkt, &hdr);
+  if (ret < 0 || mss == 0 || llhdrlen > CONFIG_NET_LL_GUARDSIZE)
+    {
+      iob_free_chain(pkt);
+      return -EINVAL;
+    }
+
+  paylen = pkt->io_pktlen - hdr.hdrlen;
+  if (paylen <= mss)
+    {
+      ret = cb(arg, pkt);
+      if (ret < 0)
+        {
+          iob_free_chain(pkt);
+        }
+
+      return ret;
+    }
+
+  /* Keep the L2, IP and TCP headers as the template of all segments and
+   * drop them from the payload.
+   */
+
+  memcpy(tmpl, hdr.l3 - llhdrlen, llhdrlen + hdr.hdrlen);
+  seqno = offload_get32(hdr.tcp->seqno);
+  flags = hdr.tcp->flags;
+
+#ifdef CONFIG_NET_IPv4
+  if (hdr.type == NETDEV_F_TSO4)
+    {
+      ipid = offload_get16(((FAR struct ipv4_hdr_s *)hdr.l3)->ipid);
+    }
+#endif
+
+  rest = iob_trimhead(pkt, hdr.hdrlen);
+
+  for (off = 0; off < paylen; off += len)
+    {
+      len = MIN(mss, paylen - off);
+
+      seg = iob_tryalloc(false);
+      if (seg == NULL)
+        {
+          ret = -ENOMEM;
+          break;
+        }
+
+      part = offload_cut(&rest, len);
+      if (part == NULL)
+        {
+          iob_free(seg);
+          ret = -ENOMEM;
+          break;
+        }
+
+      iob_reserve(seg, CONFIG_NET_LL_GUARDSIZE);
+      memcpy(IOB_DATA(seg) - llhdrlen, tmpl, llhdrlen + hdr.hdrlen);
+      seg->io_len    = hdr.hdrlen;
+      seg->io_pktlen = hdr.hdrlen;
+      iob_concat(seg, part);
+
+      /* Point the headers to the copy in this segment and fix them up */
+
+      hdr.l3  = IOB_DATA(seg);
+      hdr.tcp = (FAR struct tcp_hdr_s *)(hdr.l3 + hdr.iplen);
+
+      offload_put32(hdr.tcp->seqno, seqno + off);
+      if (off + len < paylen)
+        {
+          hdr.tcp->flags = flags & ~(TCP_FIN | TCP_PSH);
+        }
+
+#ifdef CONFIG_NET_IPv4
+      if (hdr.type == NETDEV_F_TSO4)
+        {
+          offload_put16(((FAR struct ipv4_hdr_s *)hdr.l3)->ipid, ipid++);
+        }
+#endif
+
+      offload_set_iplen(&hdr, seg->io_pktlen);
+      offload_set_tcpchksum(&hdr, seg->io_pktlen,
+                            chksum_iob(0, seg, hdr.hdrlen));
+
+      ret = cb(arg, seg);
+      if (ret < 0)
+        {
+          iob_free_chain(seg);
+          break;
+        }
+    }
+
+  if (rest != NULL)
+    {
+      iob_free_chain(rest);
+    }
+
+  return ret;
+}
+
+#endif /* CONFIG_NETDEV_GSO */
+
+#ifdef CONFIG_NETDEV_GRO
+
+/****************************************************************************
+ * Name: netdev_gro_hold
+ *
+ * Description:
+ *   Start coalescing with a received packet if nothing is held and the
+ *   packet is a pure ACK with payload, addressed to this device.
+ *
+ ****************************************************************************/
+
+bool netdev_gro_hold(FAR struct netdev_gro_s *gro,
+                     FAR struct netdev_lowerhalf_s *lower,
+                     FAR netpkt_t *pkt)
+{
+  struct offload_hdr_s hdr;
+  uint16_t paysum;
+
+  if (gro->pkt != NULL || !offload_rx_parse(lower, pkt, &hdr, &paysum) ||
+      hdr.tcp->flags != TCP_ACK)
+    {
+      return false;
+    }
+
+  gro->pkt    = pkt;
+  gro->paylen = pkt->io_pktlen - hdr.hdrlen;
+  gro->seq    = offload_get32(hdr.tcp->seqno) + gro->paylen;
+  gro->sum    = paysum;
+  gro->nsegs  = 1;
+  gro->flush  = false;
+  return true;
+}
+
+/****************************************************************************
+ * Name: netdev_gro_merge
+ *
+ * Description:
+ *   Append the payload of a received packet to the held packet if it is
+ *   the next segment of the same flow.
+ *
+ ****************************************************************************/
+
+bool netdev_gro_merge(FAR struct netdev_gro_s *gro,
+                      FAR struct netdev_lowerhalf_s *lower,
+                      FAR netpkt_t *pkt)
+{
+  struct offload_hdr_s held;
+  struct offload_hdr_s hdr;
+  unsigned int paylen;
+  uint16_t paysum;
+
+  if (gro->pkt == NULL || gro->flush ||
+      !offload_rx_parse(lower, pkt, &hdr, &paysum) ||
+      (hdr.tcp->flags & ~TCP_PSH) != TCP_ACK ||
+      offload_get32(hdr.tcp->seqno) != gro->seq)
+    {
+      return false;
+    }
+
+  paylen = pkt->io_pktlen - hdr.hdrlen;
+  if (NET_LL_HDRLEN(&lower->netdev) + gro->pkt->io_pktlen + paylen >
+      UINT16_MAX)
+    {
+      return false;
+    }
+
+  DEBUGVERIFY(offload_parse(gro->pkt, &held));
+  if (!offload_same_flow(lower, &held, &hdr))
+    {
+      return false;
+    }
+
+  /* Take the latest window, and pass the data on now if the peer asks */
+
+  memcpy(held.tcp->wnd, hdr.tcp->wnd, sizeof(hdr.tcp->wnd));
+  if ((hdr.tcp->flags & TCP_PSH) != 0)
+    {
+      held.tcp->flags |= TCP_PSH;
+      gro->flush = true;
+    }
+
+  /* The payload sum is of 16-bit words, swap it if it starts at an odd
+   * offset of the coalesced payload.
+   */
+
+  if ((gro->paylen & 1) != 0)
+    {
+      paysum = (paysum << 8) | (paysum >> 8);
+    }
+
+  gro->sum     = offload_add(gro->sum, paysum);
+  gro->paylen += paylen;
+  gro->seq    += paylen;
+
+  if (++gro->nsegs == UINT8_MAX)
+    {
+      gro->flush = true;
+    }
+
+  iob_concat(gro->pkt, iob_trimhead(pkt, hdr.hdrlen));
+  return true;
+}
+
+/****************************************************************************
+ * Name: netdev_gro_flush
+ *
+ * Description:
+ *   Stop coalescing and return the held packet, with the lengths and the
+ *   checksums of its headers updated.
+ *
+ ****************************************************************************/
+
+FAR netpkt_t *netdev_gro_flush(FAR struct netdev_gro_s *gro,
+                               FAR struct netdev_lowerhalf_s *lower)
+{
+  FAR netpkt_t *pkt = gro->pkt;
+  struct offload_hdr_s hdr;
+
+  if (pkt == NULL)
+    {
+      return NULL;
+    }
+
+  gro->pkt = NULL;
+
+  if (gro->nsegs > 1)
+    {
+      DEBUGVERIFY(offload_parse(pkt, &hdr));
+      offload_set_iplen(&hdr, pkt->io_pktlen);
+      offload_set_tcpchksum(&hdr, pkt->io_pktlen, gro->sum);
+    }
+
+  UNUSED(lower);
+  return pkt;
+}
+
+#endif /* CONFIG_NETDEV_GRO */
+#endif /* CONFIG_NETDEV_GSO || CONFIG_NETDEV_GRO */
@@ -0,0 +1,162 @@
+/****************************************************************************
+ * drivers/net/netdev_offload.h
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+#ifndef __DRIVERS_NET_NETDEV_OFFLOAD_H
+#define __DRIVERS_NET_NETDEV_OFFLOAD_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <nuttx/net/netdev_lowerhalf.h>
+
+#if defined(CONFIG_NETDEV_GSO) || defined(CONFIG_NETDEV_GRO)
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+/* Called for each segment cut by netdev_gso_segment().  The callee owns
+ * the segment if it returns OK.
+ */
+
+typedef CODE int (*netdev_gso_cb_t)(FAR void *arg, FAR netpkt_t *seg);
+
+#ifdef CONFIG_NETDEV_GRO
+/* The state of receive coalescing during one poll of an RX queue */
+
+struct netdev_gro_s
+{
+  FAR netpkt_t *pkt;      /* The packet being coalesced, NULL if none */
+  uint32_t      seq;      /* Sequence number of the next segment */
+  uint16_t      paylen;   /* Length of the TCP payload in pkt */
+  uint16_t      sum;      /* Checksum of the TCP payload in pkt */
+  uint8_t       nsegs;    /* Number of segments in pkt */
+  bool          flush;    /* pkt must be passed on now, e.g. PSH seen */
+};
+#endif
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+#ifdef CONFIG_NETDEV_GSO
+
+/****************************************************************************
+ * Name: netdev_gso_type
+ *
+ * Description:
+ *   Return NETDEV_F_TSO4 or NETDEV_F_TSO6 if the outgoing packet is a TCP
+ *   segment over IPv4 or IPv6, and zero otherwise.
+ *
+ ****************************************************************************/
+
+int netdev_gso_type(FAR netpkt_t *pkt);
+
+/****************************************************************************
+ * Name: netdev_gso_segment
+ *
+ * Description:
+ *   Cut an outgoing TCP packet into segments of at most 'mss' bytes of
+ *   payload and pass them to 'cb' one by one.  The IP and TCP headers of
+ *   each segment are copied from the packet and fixed up.  The payload is
+ *   not copied, except for the parts of the I/O buffers that straddle a
+ *   segment boundary.
+ *
+ * Input Parameters:
+ *   lower - The lower half driver the packet is sent on
+ *   pkt   - The packet, consumed in any case
+ *   mss   - The segment size
+ *   cb    - The function that takes each segment
+ *   arg   - The argument of cb
+ *
+ * Returned Value:
+ *   OK on success.  A negated errno value if the packet is not a TCP
+ *   segment, an I/O buffer could not be allocated or cb failed, in which
+ *   case the remaining segments are dropped.
+ *
+ ****************************************************************************/
+
+int netdev_gso_segment(FAR struct netdev_lowerhalf_s *lower,
+                       FAR netpkt_t *pkt, uint16_t mss,
+                       netdev_gso_cb_t cb, FAR void *arg);
+
+#endif /* CONFIG_NETDEV_GSO */
+
+#ifdef CONFIG_NETDEV_GRO
+
+/****************************************************************************
+ * Name: netdev_gro_hold
+ *
+ * Description:
+ *   Start coalescing with a received packet if nothing is held and the
+ *   packet is a TCP segment with payload, addressed to this device, that
+ *   later segments may be appended to.
+ *
+ * Returned Value:
+ *   True if the packet is now held in 'gro'.
+ *
+ ****************************************************************************/
+
+bool netdev_gro_hold(FAR struct netdev_gro_s *gro,
+                     FAR struct netdev_lowerhalf_s *lower,
+                     FAR netpkt_t *pkt);
+
+/****************************************************************************
+ * Name: netdev_gro_merge
+ *
+ * Description:
+ *   Append the payload of a received packet to the held packet if it is
+ *   the next segment of the same flow.
+ *
+ * Returned Value:
+ *   True if the packet was merged, the I/O buffers of its payload are then
+ *   part of the held packet and the rest is freed.
+ *
+ ****************************************************************************/
+
+bool netdev_gro_merge(FAR struct netdev_gro_s *gro,
+                      FAR struct netdev_lowerhalf_s *lower,
+                      FAR netpkt_t *pkt);
+
+/****************************************************************************
+ * Name: netdev_gro_flush
+ *
+ * Description:
+ *   Stop coalescing and return the held packet, with the lengths and the
+ *   checksums of its headers updated.  NULL is returned if no packet is
+ *   held.
+ *
+ ****************************************************************************/
+
+FAR netpkt_t *netdev_gro_flush(FAR struct netdev_gro_s *gro,
+                               FAR struct netdev_lowerhalf_s *lower);
+
+#endif /* CONFIG_NETDEV_GRO */
+
+#endif /* CONFIG_NETDEV_GSO || CONFIG_NETDEV_GRO */
+#endif /* __DRIVERS_NET_NETDEV_OFFLOAD_H */
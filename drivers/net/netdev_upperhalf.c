@@ -28,9 +28,11 @@
 
 #include <debug.h>
 #include <errno.h>
+#include <limits.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <string.h>
+#include <sys/param.h>
 
 #include <nuttx/kmalloc.h>
 #include <nuttx/kthread.h>
@@ -42,6 +44,8 @@
 #include <nuttx/semaphore.h>
 #include <nuttx/spinlock.h>
 
+#include "netdev_offload.h"
+
 /****************************************************************************
  * Pre-processor Definitions
  ****************************************************************************/
@@ -62,10 +66,46 @@
 #  define NETDEV_THREAD_COUNT 1
 #endif
 
+/* The number of poll contexts: one per CPU with RSS on a single queue
+ * device, and one per RX/TX queue pair on a multi-queue device.
+ */
+
+#if defined(CONFIG_NETDEV_MULTIQUEUE) && \
+    CONFIG_NETDEV_MAX_QUEUES > NETDEV_THREAD_COUNT
+#  define NETDEV_QUEUE_COUNT CONFIG_NETDEV_MAX_QUEUES
+#else
+#  define NETDEV_QUEUE_COUNT NETDEV_THREAD_COUNT
+#endif
+
+#if !defined(CONFIG_NETDEV_RX_BUDGET) || CONFIG_NETDEV_RX_BUDGET <= 0
+#  define NETDEV_RX_BUDGET INT_MAX
+#else
+#  define NETDEV_RX_BUDGET CONFIG_NETDEV_RX_BUDGET
+#endif
+
 /****************************************************************************
  * Private Types
  ****************************************************************************/
 
+/* This structure describes one poll context, deferring the poll work of
+ * one queue pair (or of one CPU with RSS) to work queue or thread.
+ */
+
+struct netdev_upperhalf_s;
+struct netdev_upper_queue_s
+{
+  FAR struct netdev_upperhalf_s *upper;
+  unsigned int index;
+
+#ifdef CONFIG_NETDEV_WORK_THREAD
+  pid_t tid;
+  sem_t sem;
+  sem_t sem_exit;
+#else
+  struct work_s work;
+#endif
+};
+
 /* This structure describes the state of the upper half driver */
 
 struct netdev_upperhalf_s
@@ -74,13 +114,9 @@ struct netdev_upperhalf_s
 
   /* Deferring poll work to work queue or thread */
 
-#ifdef CONFIG_NETDEV_WORK_THREAD
-  pid_t tid[NETDEV_THREAD_COUNT];
-  sem_t sem[NETDEV_THREAD_COUNT];
-  sem_t sem_exit[NETDEV_THREAD_COUNT];
-#else
-  struct work_s work;
-#endif
+  struct netdev_upper_queue_s queue[NETDEV_QUEUE_COUNT];
+  unsigned int nqueues;   /* Number of poll contexts in use */
+  unsigned int txqueue;   /* TX queue of the ongoing poll */
 
   /* TX queue for re-queueing replies */
 
@@ -89,6 +125,12 @@ struct netdev_upperhalf_s
 #endif
 };
 
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+static void netdev_upper_queue_work(FAR struct netdev_upper_queue_s *queue);
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
@@ -207,6 +249,7 @@ netdev_upper_alloc(FAR struct netdev_lowerhalf_s *dev)
   /* Allocate the upper-half data structure */
 
   FAR struct netdev_upperhalf_s *upper;
+  int i;
 
   DEBUGASSERT(dev != NULL && dev->netdev.d_private == NULL);
 
@@ -220,9 +263,105 @@ netdev_upper_alloc(FAR struct netdev_lowerhalf_s *dev)
   upper->lower = dev;
   dev->netdev.d_private = upper;
 
+#ifdef CONFIG_NETDEV_MULTIQUEUE
+  if (dev->nqueues > 1)
+    {
+      upper->nqueues = MIN(dev->nqueues, NETDEV_QUEUE_COUNT);
+    }
+  else
+#endif
+    {
+      upper->nqueues = NETDEV_THREAD_COUNT;
+    }
+
+  for (i = 0; i < NETDEV_QUEUE_COUNT; i++)
+    {
+      upper->queue[i].upper = upper;
+      upper->queue[i].index = i;
+#ifdef CONFIG_NETDEV_WORK_THREAD
+      upper->queue[i].tid = INVALID_PROCESS_ID;
+      nxsem_init(&upper->queue[i].sem, 0, 0);
+      nxsem_init(&upper->queue[i].sem_exit, 0, 0);
+#endif
+    }
+
   return upper;
 }
 
+/****************************************************************************
+ * Name: netdev_upper_transmit / netdev_upper_receive
+ *
+ * Description:
+ *   Send or receive a packet on one queue pair of the lower half.
+ *
+ * Assumptions:
+ *   Called with the network locked.
+ *
+ ****************************************************************************/
+
+static int netdev_upper_transmit(FAR struct netdev_upperhalf_s *upper,
+                                 FAR netpkt_t *pkt)
+{
+  FAR struct netdev_lowerhalf_s *lower = upper->lower;
+
+#ifdef CONFIG_NETDEV_MULTIQUEUE
+  if (lower->nqueues > 1 && lower->ops->transmit_queue != NULL)
+    {
+      return lower->ops->transmit_queue(lower, upper->txqueue, pkt);
+    }
+#endif
+
+  return lower->ops->transmit(lower, pkt);
+}
+
+static FAR netpkt_t *
+netdev_upper_receive(FAR struct netdev_upperhalf_s *upper,
+                     unsigned int queue)
+{
+  FAR struct netdev_lowerhalf_s *lower = upper->lower;
+
+#ifdef CONFIG_NETDEV_MULTIQUEUE
+  if (lower->nqueues > 1 && lower->ops->receive_queue != NULL)
+    {
+      return lower->ops->receive_queue(lower, queue);
+    }
+#endif
+
+  UNUSED(queue);
+  return lower->ops->receive(lower);
+}
+
+/****************************************************************************
+ * Name: netdev_upper_gso_xmit
+ *
+ * Description:
+ *   Send one segment cut by netdev_gso_segment(), taking a TX quota for it
+ *   like netpkt_get() does.
+ *
+ * Assumptions:
+ *   Called with the network locked.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NETDEV_GSO
+static int netdev_upper_gso_xmit(FAR void *arg, FAR netpkt_t *seg)
+{
+  FAR struct netdev_upperhalf_s *upper = arg;
+  FAR struct netdev_lowerhalf_s *lower = upper->lower;
+  int ret;
+
+  atomic_fetch_sub(&lower->quota[NETPKT_TX], 1);
+
+  ret = netdev_upper_transmit(upper, seg);
+  if (ret < 0)
+    {
+      atomic_fetch_add(&lower->quota[NETPKT_TX], 1);
+    }
+
+  return ret;
+}
+#endif
+
 /****************************************************************************
  * Name: netdev_upper_can_tx
  *
@@ -278,6 +417,7 @@ static int netdev_upper_txpoll(FAR struct net_driver_s *dev)
   FAR struct netdev_upperhalf_s *upper = dev->d_private;
   FAR struct netdev_lowerhalf_s *lower = upper->lower;
   FAR netpkt_t                  *pkt;
+  uint16_t                       gso = 0;
   int                            ret;
 
   DEBUGASSERT(dev->d_len > 0);
@@ -290,16 +430,51 @@ static int netdev_upper_txpoll(FAR struct net_driver_s *dev)
   pkt_input(dev);
 #endif
 
+#ifdef CONFIG_NETDEV_GSO
+  /* A TCP packet bigger than the MTU, to be cut into segments of gso bytes
+   * by the lower half if it can, or here otherwise.
+   */
+
+  if (dev->d_gso_size > 0 && dev->d_len > NETDEV_PKTSIZE(dev))
+    {
+      gso = dev->d_gso_size;
+    }
+
+  dev->d_gso_size = 0;
+
+  if (gso > 0 && (lower->features & netdev_gso_type(dev->d_iob)) == 0)
+    {
+      pkt = dev->d_iob;
+      netdev_iob_clear(dev);
+
+      ret = netdev_gso_segment(lower, pkt, gso, netdev_upper_gso_xmit,
+                               upper);
+      if (ret < 0)
+        {
+          NETDEV_TXERRORS(dev);
+          return ret;
+        }
+
+      return NETDEV_TX_CONTINUE;
+    }
+#endif
+
   pkt = netpkt_get(dev, NETPKT_TX);
 
-  if (netpkt_getdatalen(lower, pkt) > NETDEV_PKTSIZE(dev))
+  if (gso == 0 && netpkt_getdatalen(lower, pkt) > NETDEV_PKTSIZE(dev))
     {
       nerr("ERROR: Packet too long to send!\n");
       ret = -EMSGSIZE;
     }
   else
     {
-      ret = lower->ops->transmit(lower, pkt);
+#ifdef CONFIG_NETDEV_GSO
+      dev->d_gso_size = gso;
+      ret = netdev_upper_transmit(upper, pkt);
+      dev->d_gso_size = 0;
+#else
+      ret = netdev_upper_transmit(upper, pkt);
+#endif
     }
 
   if (ret != OK)
@@ -362,13 +537,15 @@ static int netdev_upper_tx(FAR struct net_driver_s *dev)
  *
  * Input Parameters:
  *   upper - Reference to the upper half driver structure
+ *   queue - The TX queue to send the packets on
  *
  * Assumptions:
  *   Called with the network locked.
  *
  ****************************************************************************/
 
-static void netdev_upper_txavail_work(FAR struct netdev_upperhalf_s *upper)
+static void netdev_upper_txavail_work(FAR struct netdev_upperhalf_s *upper,
+                                      unsigned int queue)
 {
   FAR struct net_driver_s *dev = &upper->lower->netdev;
 
@@ -376,12 +553,33 @@ static void netdev_upper_txavail_work(FAR struct netdev_upperhalf_s *upper)
 
   if (IFF_IS_UP(dev->d_flags))
     {
+      upper->txqueue = queue;
       DEBUGASSERT(dev->d_buf == NULL); /* Make sure: IOB only. */
       while (netdev_upper_can_tx(upper) &&
              netdev_upper_tx(dev) == NETDEV_TX_CONTINUE);
     }
 }
 
+/****************************************************************************
+ * Name: netdev_upper_gso_queue
+ *
+ * Description:
+ *   Queue one segment cut by netdev_gso_segment() for sending later.
+ *
+ * Assumptions:
+ *   Called with the network locked.
+ *
+ ****************************************************************************/
+
+#if defined(CONFIG_NETDEV_GSO) && CONFIG_IOB_NCHAINS > 0
+static int netdev_upper_gso_queue(FAR void *arg, FAR netpkt_t *seg)
+{
+  FAR struct netdev_upperhalf_s *upper = arg;
+
+  return iob_tryadd_queue(seg, &upper->txq);
+}
+#endif
+
 /****************************************************************************
  * Name: netdev_upper_queue_tx
  *
@@ -404,6 +602,31 @@ static void netdev_upper_queue_tx(FAR struct net_driver_s *dev)
   FAR struct netdev_upperhalf_s *upper = dev->d_private;
   int ret;
 
+#ifdef CONFIG_NETDEV_GSO
+  /* The queue holds packets of at most the MTU, cut the big ones now */
+
+  if (dev->d_gso_size > 0 && dev->d_len > NETDEV_PKTSIZE(dev))
+    {
+      FAR netpkt_t *pkt = dev->d_iob;
+      uint16_t gso = dev->d_gso_size;
+
+      dev->d_gso_size = 0;
+      netdev_iob_clear(dev);
+
+      ret = netdev_gso_segment(upper->lower, pkt, gso,
+                               netdev_upper_gso_queue, upper);
+      if (ret < 0)
+        {
+          nwarn("WARNING: Failed to queue TX segments, dropping: %d\n",
+                ret);
+        }
+
+      return;
+    }
+
+  dev->d_gso_size = 0;
+#endif
+
   if ((ret = iob_tryadd_queue(dev->d_iob, &upper->txq)) >= 0)
     {
       netdev_iob_clear(dev);
@@ -583,6 +806,66 @@ static void ip_input(FAR struct net_driver_s *dev)
 }
 #endif
 
+/****************************************************************************
+ * Name: netdev_upper_input
+ *
+ * Description:
+ *   Pass a received packet into the network stack.
+ *
+ * Input Parameters:
+ *   dev - Reference to the NuttX driver state structure
+ *   pkt - The received packet
+ *
+ * Assumptions:
+ *   Called with the network locked.
+ *
+ ****************************************************************************/
+
+static void netdev_upper_input(FAR struct net_driver_s *dev,
+                               FAR netpkt_t *pkt)
+{
+  netpkt_put(dev, pkt, NETPKT_RX);
+  NETDEV_RXPACKETS(dev);
+
+#ifdef CONFIG_NET_PKT
+  /* When packet sockets are enabled, feed the frame into the tap */
+
+  pkt_input(dev);
+#endif
+
+  switch (dev->d_lltype)
+    {
+#ifdef CONFIG_NET_LOOPBACK
+    case NET_LL_LOOPBACK:
+#endif
+#ifdef CONFIG_NET_ETHERNET
+    case NET_LL_ETHERNET:
+#endif
+#ifdef CONFIG_DRIVERS_IEEE80211
+    case NET_LL_IEEE80211:
+#endif
+#if defined(CONFIG_NET_LOOPBACK) || defined(CONFIG_NET_ETHERNET) || \
+    defined(CONFIG_DRIVERS_IEEE80211)
+      eth_input(dev);
+      break;
+#endif
+#ifdef CONFIG_NET_MBIM
+    case NET_LL_MBIM:
+      ip_input(dev);
+      break;
+#endif
+#ifdef CONFIG_NET_CAN
+    case NET_LL_CAN:
+      ninfo("CAN frame");
+      can_input(dev);
+      break;
+#endif
+    default:
+      nerr("Unknown link type %d\n", dev->d_lltype);
+      break;
+    }
+}
+
 /****************************************************************************
  * Function: netdev_upper_rxpoll_work
  *
@@ -590,23 +873,40 @@ static void ip_input(FAR struct net_driver_s *dev)
  *   Try to receive packets from device and pass packets into IP
  *   stack and send packets which is from IP stack if necessary.
  *
+ *   With CONFIG_NETDEV_GRO, consecutive TCP segments of one flow are
+ *   coalesced into one packet before they are passed into the stack.
+ *
  * Input Parameters:
  *   upper - Reference to the upper half driver structure
+ *   queue - The RX queue to receive from
+ *
+ * Returned Value:
+ *   True if the RX budget ran out before the queue was found empty.
  *
  * Assumptions:
  *   Called with the network locked.
  *
  ****************************************************************************/
 
-static void netdev_upper_rxpoll_work(FAR struct netdev_upperhalf_s *upper)
+static bool netdev_upper_rxpoll_work(FAR struct netdev_upperhalf_s *upper,
+                                     unsigned int queue)
 {
-  FAR struct netdev_lowerhalf_s *lower = upper->lower;
-  FAR struct net_driver_s       *dev   = &lower->netdev;
+  FAR struct netdev_lowerhalf_s *lower  = upper->lower;
+  FAR struct net_driver_s       *dev    = &lower->netdev;
   FAR netpkt_t                  *pkt;
+  int                            budget = NETDEV_RX_BUDGET;
+#ifdef CONFIG_NETDEV_GRO
+  struct netdev_gro_s            gro;
 
-  /* Loop while receive() successfully retrieves valid Ethernet frames. */
+  memset(&gro, 0, sizeof(gro));
+#endif
+
+  /* Loop while receive() successfully retrieves valid Ethernet frames, at
+   * most NETDEV_RX_BUDGET of them so that the other queues and devices get
+   * their turn.
+   */
 
-  while ((pkt = lower->ops->receive(lower)) != NULL)
+  while (budget-- > 0 && (pkt = netdev_upper_receive(upper, queue)) != NULL)
     {
       if (!IFF_IS_UP(dev->d_flags))
         {
@@ -617,47 +917,44 @@ static void netdev_upper_rxpoll_work(FAR struct netdev_upperhalf_s *upper)
           continue;
         }
 
-      netpkt_put(dev, pkt, NETPKT_RX);
-      NETDEV_RXPACKETS(dev);
+#ifdef CONFIG_NETDEV_GRO
+      if (netdev_gro_merge(&gro, lower, pkt))
+        {
+          /* The headers of pkt are freed, so is its quota */
 
-#ifdef CONFIG_NET_PKT
-      /* When packet sockets are enabled, feed the frame into the tap */
+          atomic_fetch_add(&lower->quota[NETPKT_RX], 1);
+          NETDEV_RXPACKETS(dev);
 
-      pkt_input(dev);
-#endif
+          if (gro.flush)
+            {
+              netdev_upper_input(dev, netdev_gro_flush(&gro, lower));
+            }
+
+          continue;
+        }
 
-      switch (dev->d_lltype)
+      if (gro.pkt != NULL)
         {
-#ifdef CONFIG_NET_LOOPBACK
-        case NET_LL_LOOPBACK:
-#endif
-#ifdef CONFIG_NET_ETHERNET
-        case NET_LL_ETHERNET:
-#endif
-#ifdef CONFIG_DRIVERS_IEEE80211
-        case NET_LL_IEEE80211:
-#endif
-#if defined(CONFIG_NET_LOOPBACK) || defined(CONFIG_NET_ETHERNET) || \
-    defined(CONFIG_DRIVERS_IEEE80211)
-          eth_input(dev);
-          break;
-#endif
-#ifdef CONFIG_NET_MBIM
-        case NET_LL_MBIM:
-          ip_input(dev);
-          break;
-#endif
-#ifdef CONFIG_NET_CAN
-        case NET_LL_CAN:
-          ninfo("CAN frame");
-          can_input(dev);
-          break;
-#endif
-        default:
-          nerr("Unknown link type %d\n", dev->d_lltype);
-          break;
+          netdev_upper_input(dev, netdev_gro_flush(&gro, lower));
         }
+
+      if (netdev_gro_hold(&gro, lower, pkt))
+        {
+          continue;
+        }
+#endif
+
+      netdev_upper_input(dev, pkt);
     }
+
+#ifdef CONFIG_NETDEV_GRO
+  if (gro.pkt != NULL)
+    {
+      netdev_upper_input(dev, netdev_gro_flush(&gro, lower));
+    }
+#endif
+
+  return budget < 0;
 }
 
 /****************************************************************************
@@ -667,20 +964,34 @@ static void netdev_upper_rxpoll_work(FAR struct netdev_upperhalf_s *upper)
  *   Perform an out-of-cycle poll on a dedicated thread or the worker thread.
  *
  * Input Parameters:
- *   arg - Reference to the upper half driver structure (cast to void *)
+ *   arg - Reference to the poll context of a queue (cast to void *)
  *
  ****************************************************************************/
 
 static void netdev_upper_work(FAR void *arg)
 {
-  FAR struct netdev_upperhalf_s *upper = arg;
-
-  /* RX may release quota and driver buffer, so do RX first. */
+  FAR struct netdev_upper_queue_s *queue = arg;
+  FAR struct netdev_upperhalf_s *upper = queue->upper;
+  bool more;
+
+  /* RX may release quota and driver buffer, so do RX first.
+   *
+   * REVISIT: The stack still needs the global network lock, so the polls
+   * of the queues are serialized here.  Only the interrupt and buffer
+   * handling of the queues is separate.
+   */
 
   net_lock();
-  netdev_upper_rxpoll_work(upper);
-  netdev_upper_txavail_work(upper);
+  more = netdev_upper_rxpoll_work(upper, queue->index);
+  netdev_upper_txavail_work(upper, queue->index);
   net_unlock();
+
+  /* Come back for the rest of the packets after others had their turn */
+
+  if (more)
+    {
+      netdev_upper_queue_work(queue);
+    }
 }
 
 /****************************************************************************
@@ -714,26 +1025,31 @@ static int netdev_upper_wait(FAR sem_t *sem)
 
 static int netdev_upper_loop(int argc, FAR char *argv[])
 {
-  FAR struct netdev_upperhalf_s *upper =
-    (FAR struct netdev_upperhalf_s *)((uintptr_t)strtoul(argv[1], NULL, 16));
-  int cpu = atoi(argv[2]);
+  FAR struct netdev_upper_queue_s *queue =
+    (FAR struct netdev_upper_queue_s *)
+    ((uintptr_t)strtoul(argv[1], NULL, 16));
 
-#ifdef CONFIG_NETDEV_RSS
-  cpu_set_t cpuset;
+#ifdef CONFIG_SMP
+  /* Bind the thread of each queue (or of each CPU with RSS) to a CPU */
+
+  if (queue->upper->nqueues > 1)
+    {
+      cpu_set_t cpuset;
 
-  CPU_ZERO(&cpuset);
-  CPU_SET(cpu, &cpuset);
-  sched_setaffinity(upper->tid[cpu], sizeof(cpu_set_t), &cpuset);
+      CPU_ZERO(&cpuset);
+      CPU_SET(queue->index % CONFIG_SMP_NCPUS, &cpuset);
+      sched_setaffinity(queue->tid, sizeof(cpu_set_t), &cpuset);
+    }
 #endif
 
-  while (netdev_upper_wait(&upper->sem[cpu]) == OK &&
-         upper->tid[cpu] != INVALID_PROCESS_ID)
+  while (netdev_upper_wait(&queue->sem) == OK &&
+         queue->tid != INVALID_PROCESS_ID)
     {
-      netdev_upper_work(upper);
+      netdev_upper_work(queue);
     }
 
   nwarn("WARNING: Netdev work thread quitting.");
-  nxsem_post(&upper->sem_exit[cpu]);
+  nxsem_post(&queue->sem_exit);
   return 0;
 }
 #endif
@@ -742,40 +1058,57 @@ static int netdev_upper_loop(int argc, FAR char *argv[])
  * Name: netdev_upper_queue_work
  *
  * Description:
- *   Called when there is any work to do.
+ *   Called when there is any work to do on a queue.
  *
  * Input Parameters:
- *   dev - Reference to the NuttX driver state structure
+ *   queue - Reference to the poll context of the queue
  *
  ****************************************************************************/
 
-static inline void netdev_upper_queue_work(FAR struct net_driver_s *dev)
+static void netdev_upper_queue_work(FAR struct netdev_upper_queue_s *queue)
 {
-  FAR struct netdev_upperhalf_s *upper = dev->d_private;
-
 #ifdef CONFIG_NETDEV_WORK_THREAD
-#  ifdef CONFIG_NETDEV_RSS
-  int cpu = this_cpu();
-#  else
-  const int cpu = 0;
-#  endif
   int semcount;
 
-  if (nxsem_get_value(&upper->sem[cpu], &semcount) == OK &&
+  if (nxsem_get_value(&queue->sem, &semcount) == OK &&
       semcount <= 0)
     {
-      nxsem_post(&upper->sem[cpu]);
+      nxsem_post(&queue->sem);
     }
 #else
-  if (work_available(&upper->work))
+  if (work_available(&queue->work))
     {
       /* Schedule to serialize the poll on the worker thread. */
 
-      work_queue(NETDEV_WORK, &upper->work, netdev_upper_work, upper, 0);
+      work_queue(NETDEV_WORK, &queue->work, netdev_upper_work, queue, 0);
     }
 #endif
 }
 
+/****************************************************************************
+ * Name: netdev_upper_this_queue
+ *
+ * Description:
+ *   Get the poll context of the current CPU, which serves the TX queue (and
+ *   with RSS, the RX interrupts) of the CPU.
+ *
+ * Input Parameters:
+ *   dev - Reference to the NuttX driver state structure
+ *
+ ****************************************************************************/
+
+static inline FAR struct netdev_upper_queue_s *
+netdev_upper_this_queue(FAR struct net_driver_s *dev)
+{
+  FAR struct netdev_upperhalf_s *upper = dev->d_private;
+
+#if NETDEV_QUEUE_COUNT > 1
+  return &upper->queue[this_cpu() % upper->nqueues];
+#else
+  return &upper->queue[0];
+#endif
+}
+
 /****************************************************************************
  * Name: netdev_upper_txavail
  *
@@ -789,7 +1122,7 @@ static inline void netdev_upper_queue_work(FAR struct net_driver_s *dev)
 
 static int netdev_upper_txavail(FAR struct net_driver_s *dev)
 {
-  netdev_upper_queue_work(dev);
+  netdev_upper_queue_work(netdev_upper_this_queue(dev));
   return OK;
 }
 
@@ -1049,36 +1382,34 @@ static int netdev_upper_ifup(FAR struct net_driver_s *dev)
   FAR struct netdev_upperhalf_s *upper = dev->d_private;
 
 #ifdef CONFIG_NETDEV_WORK_THREAD
-  int i;
+  unsigned int i;
 
-  /* Try to bring up a dedicated thread for work. */
+  /* Try to bring up a dedicated thread for work, one for each queue. */
 
-  for (i = 0; i < NETDEV_THREAD_COUNT; i++)
+  for (i = 0; i < upper->nqueues; i++)
     {
-      if (upper->tid[i] <= 0)
+      FAR struct netdev_upper_queue_s *queue = &upper->queue[i];
+
+      if (queue->tid <= 0)
         {
-          FAR char *argv[3];
+          FAR char *argv[2];
           char      arg1[32];
-          char      arg2[32];
           char      name[32];
 
-          snprintf(arg1, sizeof(arg1), "%p", upper);
+          snprintf(arg1, sizeof(arg1), "%p", queue);
           argv[0] = arg1;
-
-          snprintf(arg2, sizeof(arg2), "%d", i);
-          argv[1] = arg2;
-          argv[2] = NULL;
+          argv[1] = NULL;
 
           snprintf(name, sizeof(name), NETDEV_THREAD_NAME_FMT,
                    dev->d_ifname);
 
-          upper->tid[i] = kthread_create(name,
-                                         CONFIG_NETDEV_WORK_THREAD_PRIORITY,
-                                         CONFIG_DEFAULT_TASK_STACKSIZE,
-                                         netdev_upper_loop, argv);
-          if (upper->tid[i] < 0)
+          queue->tid = kthread_create(name,
+                                      CONFIG_NETDEV_WORK_THREAD_PRIORITY,
+                                      CONFIG_DEFAULT_TASK_STACKSIZE,
+                                      netdev_upper_loop, argv);
+          if (queue->tid < 0)
             {
-              return upper->tid[i];
+              return queue->tid;
             }
         }
     }
@@ -1097,7 +1428,12 @@ static int netdev_upper_ifdown(FAR struct net_driver_s *dev)
   FAR struct netdev_upperhalf_s *upper = dev->d_private;
 
 #ifndef CONFIG_NETDEV_WORK_THREAD
-  work_cancel(NETDEV_WORK, &upper->work);
+  unsigned int i;
+
+  for (i = 0; i < upper->nqueues; i++)
+    {
+      work_cancel(NETDEV_WORK, &upper->queue[i].work);
+    }
 #endif
 
   if (upper->lower->ops->ifdown)
@@ -1191,9 +1527,6 @@ int netdev_lower_register(FAR struct netdev_lowerhalf_s *dev,
 {
   FAR struct netdev_upperhalf_s *upper;
   int ret;
-#ifdef CONFIG_NETDEV_WORK_THREAD
-  int i;
-#endif
 
   if (dev == NULL || quota_is_valid(dev) == false || dev->ops == NULL ||
       dev->ops->transmit == NULL || dev->ops->receive == NULL)
@@ -1224,13 +1557,21 @@ int netdev_lower_register(FAR struct netdev_lowerhalf_s *dev,
       kmm_free(upper);
       dev->netdev.d_private = NULL;
     }
-
-#ifdef CONFIG_NETDEV_WORK_THREAD
-  for (i = 0; i < NETDEV_THREAD_COUNT; i++)
+#ifdef CONFIG_NETDEV_GSO
+  else
     {
-      upper->tid[i] = INVALID_PROCESS_ID;
-      nxsem_init(&upper->sem[i], 0, 0);
-      nxsem_init(&upper->sem_exit[i], 0, 0);
+      /* Let TCP send as much at once as half of the TX quota takes after
+       * the packet is cut into MTU sized segments.
+       */
+
+      int segs = netdev_lower_quota_load(dev, NETPKT_TX) / 2;
+      int seglen = NETDEV_PKTSIZE(&dev->netdev) -
+                   NET_LL_HDRLEN(&dev->netdev) -
+                   __IPv6_HDRLEN - __TCP_HDRLEN;
+
+      dev->netdev.d_gso_max = segs > 1 && seglen > 0 ?
+                              MIN(CONFIG_NETDEV_GSO_MAXSIZE,
+                                  segs * seglen) : 0;
     }
 #endif
 
@@ -1272,19 +1613,21 @@ int netdev_lower_unregister(FAR struct netdev_lowerhalf_s *dev)
     }
 
 #ifdef CONFIG_NETDEV_WORK_THREAD
-  for (i = 0; i < NETDEV_THREAD_COUNT; i++)
+  for (i = 0; i < NETDEV_QUEUE_COUNT; i++)
     {
-      if (upper->tid[i] > 0)
+      FAR struct netdev_upper_queue_s *queue = &upper->queue[i];
+
+      if (queue->tid > 0)
         {
           /* Try to tear down the dedicated thread for work. */
 
-          upper->tid[i] = INVALID_PROCESS_ID;
-          nxsem_post(&upper->sem[i]);
-          nxsem_wait(&upper->sem_exit[i]);
+          queue->tid = INVALID_PROCESS_ID;
+          nxsem_post(&queue->sem);
+          nxsem_wait(&queue->sem_exit);
         }
 
-      nxsem_destroy(&upper->sem[i]);
-      nxsem_destroy(&upper->sem_exit[i]);
+      nxsem_destroy(&queue->sem);
+      nxsem_destroy(&queue->sem_exit);
     }
 #endif
 
@@ -1346,7 +1689,7 @@ void netdev_lower_carrier_off(FAR struct netdev_lowerhalf_s *dev)
 void netdev_lower_rxready(FAR struct netdev_lowerhalf_s *dev)
 {
 #if CONFIG_NETDEV_WORK_THREAD_POLLING_PERIOD == 0
-  netdev_upper_queue_work(&dev->netdev);
+  netdev_upper_queue_work(netdev_upper_this_queue(&dev->netdev));
 #endif
 }
 
@@ -1365,10 +1708,42 @@ void netdev_lower_txdone(FAR struct netdev_lowerhalf_s *dev)
 {
   NETDEV_TXDONE(&dev->netdev);
 #if CONFIG_NETDEV_WORK_THREAD_POLLING_PERIOD == 0
-  netdev_upper_queue_work(&dev->netdev);
+  netdev_upper_queue_work(netdev_upper_this_queue(&dev->netdev));
+#endif
+}
+
+/****************************************************************************
+ * Name: netdev_lower_rxready_queue / netdev_lower_txdone_queue
+ *
+ * Description:
+ *   Notifies the networking layer about an RX packet is ready to read, or
+ *   a TX packet is sent, on one queue pair of a multi-queue device.
+ *
+ * Input Parameters:
+ *   dev   - The lower half device driver structure
+ *   queue - The index of the queue pair
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NETDEV_MULTIQUEUE
+void netdev_lower_rxready_queue(FAR struct netdev_lowerhalf_s *dev,
+                                unsigned int queue)
+{
+#if CONFIG_NETDEV_WORK_THREAD_POLLING_PERIOD == 0
+  FAR struct netdev_upperhalf_s *upper = dev->netdev.d_private;
+
+  netdev_upper_queue_work(&upper->queue[queue % upper->nqueues]);
 #endif
 }
 
+void netdev_lower_txdone_queue(FAR struct netdev_lowerhalf_s *dev,
+                               unsigned int queue)
+{
+  NETDEV_TXDONE(&dev->netdev);
+  netdev_lower_rxready_queue(dev, queue);
+}
+#endif
+
 /****************************************************************************
  * Name: netdev_lower_quota_load
  *
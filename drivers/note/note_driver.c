@@ -1787,9 +1787,11 @@ void sched_note_vprintf_ip(uint32_t tag, uintptr_t ip, FAR const char *fmt,
 
           length = SIZEOF_NOTE_PRINTF(next);
           note_common(tcb, &note->npt_cmn, length, NOTE_DUMP_PRINTF);
-          note->npt_ip = ip;
           note->npt_fmt = fmt;
+#ifndef CONFIG_DRIVERS_NOTE_PRINTF_COMPACT
+          note->npt_ip = ip;
           note->npt_type = type;
+#endif
         }
 
       /* Add the note to circular buffer */
@@ -72,10 +72,33 @@
 #define get_task_state(s)                                                    \
   ((s) == 0 ? 'X' : ((s) <= LAST_READY_TO_RUN_STATE ? 'R' : 'S'))
 
+#ifdef CONFIG_DRIVERS_NOTERAM_PERCPU
+/* The positions of a per-CPU ring run freely and wrap modulo 2^32 */
+
+#  define NOTERAM_POS_LT(a, b) ((int)((a) - (b)) < 0)
+#endif
+
 /****************************************************************************
  * Private Types
  ****************************************************************************/
 
+#ifdef CONFIG_DRIVERS_NOTERAM_PERCPU
+/* The ring of one CPU.  Only that CPU adds notes and moves head and tail,
+ * the reader only moves read and clear, so adding a note takes no lock.
+ * A reader that finds tail moved past the note it copied retries.
+ */
+
+struct noteram_cpu_s
+{
+  FAR uint8_t *buffer;         /* Slice of ni_buffer, NULL until first use */
+  unsigned int mask;           /* Size of the slice (a power of 2) - 1 */
+  volatile unsigned int head;  /* End of the newest note */
+  volatile unsigned int tail;  /* Start of the oldest note */
+  volatile unsigned int read;  /* Start of the next note to read */
+  volatile unsigned int clear; /* Notes before it were cleared */
+};
+#endif
+
 struct noteram_driver_s
 {
   struct note_driver_s driver;
@@ -87,6 +110,9 @@ struct noteram_driver_s
   volatile unsigned int ni_read;
   spinlock_t lock;
   FAR struct pollfd *pfd;
+#ifdef CONFIG_DRIVERS_NOTERAM_PERCPU
+  struct noteram_cpu_s ni_cpu[NCPUS];
+#endif
 };
 
 /* The structure to hold the context data of trace dump */
@@ -187,6 +213,267 @@ struct noteram_driver_s g_noteram_driver =
  * Private Functions
  ****************************************************************************/
 
+#ifdef CONFIG_DRIVERS_NOTERAM_PERCPU
+
+/****************************************************************************
+ * Name: noteram_cpu_setup
+ *
+ * Description:
+ *   Give the ring of a CPU its slice of the buffer.  Called by that CPU
+ *   when it adds its first note.
+ *
+ ****************************************************************************/
+
+static void noteram_cpu_setup(FAR struct noteram_driver_s *drv,
+                              FAR struct noteram_cpu_s *ring, int cpu)
+{
+  size_t size = drv->ni_bufsize / NCPUS;
+
+  /* Round down to a power of two so that positions can be masked */
+
+  while ((size & (size - 1)) != 0)
+    {
+      size &= size - 1;
+    }
+
+  DEBUGASSERT(size > UINT8_MAX);
+
+  ring->mask = size - 1;
+  SP_DMB();
+  ring->buffer = drv->ni_buffer + cpu * size;
+}
+
+/****************************************************************************
+ * Name: noteram_cpu_copy
+ *
+ * Description:
+ *   Copy len bytes at position pos out of a ring, handling wraparound.
+ *
+ ****************************************************************************/
+
+static void noteram_cpu_copy(FAR struct noteram_cpu_s *ring,
+                             unsigned int pos, FAR void *buf,
+                             unsigned int len)
+{
+  unsigned int ndx = pos & ring->mask;
+  unsigned int space = ring->mask + 1 - ndx;
+
+  space = space < len ? space : len;
+  memcpy(buf, ring->buffer + ndx, space);
+  memcpy((FAR uint8_t *)buf + space, ring->buffer, len - space);
+}
+
+/****************************************************************************
+ * Name: noteram_cpu_start
+ *
+ * Description:
+ *   Return the position of the next unread note of a ring, skipping the
+ *   notes that were overwritten before they could be read.
+ *
+ ****************************************************************************/
+
+static unsigned int noteram_cpu_start(FAR struct noteram_cpu_s *ring)
+{
+  unsigned int read = ring->read;
+  unsigned int tail = ring->tail;
+
+  return NOTERAM_POS_LT(read, tail) ? tail : read;
+}
+
+/****************************************************************************
+ * Name: noteram_buffer_clear
+ *
+ * Description:
+ *   Clear all contents of the per-CPU rings.
+ *
+ * Input Parameters:
+ *   None.
+ *
+ * Returned Value:
+ *   None.
+ *
+ ****************************************************************************/
+
+static void noteram_buffer_clear(FAR struct noteram_driver_s *drv)
+{
+  int cpu;
+
+  /* tail belongs to the CPU adding notes; it moves past clear by itself */
+
+  for (cpu = 0; cpu < NCPUS; cpu++)
+    {
+      FAR struct noteram_cpu_s *ring = &drv->ni_cpu[cpu];
+      unsigned int head = ring->head;
+
+      ring->clear = head;
+      ring->read  = head;
+    }
+
+  if (drv->ni_overwrite == NOTERAM_MODE_OVERWRITE_OVERFLOW)
+    {
+      drv->ni_overwrite = NOTERAM_MODE_OVERWRITE_DISABLE;
+    }
+}
+
+/****************************************************************************
+ * Name: noteram_rewind
+ *
+ * Description:
+ *   Restart reading at the oldest note of every ring.
+ *
+ ****************************************************************************/
+
+static void noteram_rewind(FAR struct noteram_driver_s *drv)
+{
+  int cpu;
+
+  for (cpu = 0; cpu < NCPUS; cpu++)
+    {
+      FAR struct noteram_cpu_s *ring = &drv->ni_cpu[cpu];
+      unsigned int tail = ring->tail;
+
+      ring->read = NOTERAM_POS_LT(tail, ring->clear) ? ring->clear : tail;
+    }
+}
+
+/****************************************************************************
+ * Name: noteram_unread_length
+ *
+ * Description:
+ *   Length of unread data currently in the per-CPU rings.
+ *
+ * Input Parameters:
+ *   None
+ *
+ * Returned Value:
+ *   Length of unread data currently in the per-CPU rings.
+ *
+ ****************************************************************************/
+
+static unsigned int noteram_unread_length(FAR struct noteram_driver_s *drv)
+{
+  unsigned int length = 0;
+  int cpu;
+
+  for (cpu = 0; cpu < NCPUS; cpu++)
+    {
+      FAR struct noteram_cpu_s *ring = &drv->ni_cpu[cpu];
+
+      if (ring->buffer != NULL)
+        {
+          length += ring->head - noteram_cpu_start(ring);
+        }
+    }
+
+  return length;
+}
+
+/****************************************************************************
+ * Name: noteram_get
+ *
+ * Description:
+ *   Get the oldest unread note of all per-CPU rings, so that the notes
+ *   come out merged in the order of their time stamps.
+ *
+ * Input Parameters:
+ *   buffer - Location to return the next note
+ *   buflen - The length of the user provided buffer.
+ *
+ * Returned Value:
+ *   On success, the positive, non-zero length of the return note is
+ *   provided.  Zero is returned only if the rings are empty.  A negated
+ *   errno value is returned in the event of any failure.
+ *
+ * Assumptions:
+ *   The caller holds drv->lock, which serializes the readers.
+ *
+ ****************************************************************************/
+
+static ssize_t noteram_get(FAR struct noteram_driver_s *drv,
+                           FAR uint8_t *buffer, size_t buflen)
+{
+  FAR struct noteram_cpu_s *oldest;
+  struct note_common_s note;
+  unsigned int pos = 0;
+  clock_t systime = 0;
+  ssize_t notelen = 0;
+  int cpu;
+
+  DEBUGASSERT(buffer != NULL);
+
+retry:
+  oldest = NULL;
+
+  for (cpu = 0; cpu < NCPUS; cpu++)
+    {
+      FAR struct noteram_cpu_s *ring = &drv->ni_cpu[cpu];
+      unsigned int start;
+
+      if (ring->buffer == NULL)
+        {
+          continue;
+        }
+
+      start = noteram_cpu_start(ring);
+      if (start == ring->head)
+        {
+          continue;
+        }
+
+      /* Read the note only after head, and trust it only if the CPU did
+       * not move tail past it meanwhile.
+       */
+
+      SP_DMB();
+      noteram_cpu_copy(ring, start, &note, sizeof(note));
+      SP_DMB();
+
+      if (NOTERAM_POS_LT(start, ring->tail))
+        {
+          goto retry;
+        }
+
+      if (oldest == NULL || (sclock_t)(note.nc_systime - systime) < 0)
+        {
+          oldest  = ring;
+          pos     = start;
+          systime = note.nc_systime;
+          notelen = note.nc_length;
+        }
+    }
+
+  if (oldest == NULL)
+    {
+      return 0;
+    }
+
+  /* Is the user buffer large enough to hold the note? */
+
+  if (buflen < notelen)
+    {
+      /* Skip the large note so that we do not get constipated. */
+
+      oldest->read = pos + NOTE_ALIGN(notelen);
+
+      /* and return an error */
+
+      return -EFBIG;
+    }
+
+  noteram_cpu_copy(oldest, pos, buffer, notelen);
+  SP_DMB();
+
+  if (NOTERAM_POS_LT(pos, oldest->tail))
+    {
+      goto retry;
+    }
+
+  oldest->read = pos + NOTE_ALIGN(notelen);
+  return notelen;
+}
+
+#else /* CONFIG_DRIVERS_NOTERAM_PERCPU */
+
 /****************************************************************************
  * Name: noteram_buffer_clear
  *
@@ -420,6 +707,21 @@ static ssize_t noteram_get(FAR struct noteram_driver_s *drv,
   return notelen;
 }
 
+/****************************************************************************
+ * Name: noteram_rewind
+ *
+ * Description:
+ *   Restart reading at the oldest note of the circular buffer.
+ *
+ ****************************************************************************/
+
+static void noteram_rewind(FAR struct noteram_driver_s *drv)
+{
+  drv->ni_read = drv->ni_tail;
+}
+
+#endif /* CONFIG_DRIVERS_NOTERAM_PERCPU */
+
 /****************************************************************************
  * Name: noteram_open
  ****************************************************************************/
@@ -432,7 +734,7 @@ static int noteram_open(FAR struct file *filep)
 
   /* Reset the read index of the circular buffer */
 
-  drv->ni_read = drv->ni_tail;
+  noteram_rewind(drv);
   ctx = kmm_zalloc(sizeof(*ctx));
   if (ctx == NULL)
     {
@@ -467,9 +769,31 @@ static ssize_t noteram_read(FAR struct file *filep, FAR char *buffer,
 
   if (ctx->mode == NOTERAM_MODE_READ_BINARY)
     {
-      flags = spin_lock_irqsave_wo_note(&drv->lock);
-      ret = noteram_get(drv, (FAR uint8_t *)buffer, buflen);
-      spin_unlock_irqrestore_wo_note(&drv->lock, flags);
+      size_t nread = 0;
+
+      /* Return as many whole notes as fit, back to back and unformatted.
+       * The lock is taken per note to keep the interrupt latency short.
+       */
+
+      do
+        {
+          flags = spin_lock_irqsave_wo_note(&drv->lock);
+          ret = noteram_get(drv, (FAR uint8_t *)buffer + nread,
+                            buflen - nread);
+          spin_unlock_irqrestore_wo_note(&drv->lock, flags);
+          if (ret <= 0)
+            {
+              break;
+            }
+
+          nread += ret;
+        }
+      while (buflen - nread > UINT8_MAX);
+
+      if (nread > 0)
+        {
+          ret = nread;
+        }
     }
   else
     {
@@ -670,6 +994,106 @@ errout:
   return ret;
 }
 
+#ifdef CONFIG_DRIVERS_NOTERAM_PERCPU
+
+/****************************************************************************
+ * Name: noteram_add
+ *
+ * Description:
+ *   Add the variable length note to the ring of the current CPU
+ *
+ * Input Parameters:
+ *   note    - The note buffer
+ *   notelen - The buffer length
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+static void noteram_add(FAR struct note_driver_s *driver,
+                        FAR const void *note, size_t notelen)
+{
+  FAR struct noteram_driver_s *drv = (FAR struct noteram_driver_s *)driver;
+  FAR struct noteram_cpu_s *ring;
+  unsigned int length = NOTE_ALIGN(notelen);
+  unsigned int head;
+  unsigned int tail;
+  unsigned int ndx;
+  unsigned int space;
+  irqstate_t flags;
+  int cpu;
+
+  /* Nobody else adds to this ring, keeping the interrupts of this CPU out
+   * is all the serialization needed.
+   */
+
+  flags = up_irq_save();
+
+  if (drv->ni_overwrite == NOTERAM_MODE_OVERWRITE_OVERFLOW)
+    {
+      up_irq_restore(flags);
+      return;
+    }
+
+  cpu  = this_cpu();
+  ring = &drv->ni_cpu[cpu];
+  if (ring->buffer == NULL)
+    {
+      noteram_cpu_setup(drv, ring, cpu);
+    }
+
+  DEBUGASSERT(note != NULL && length <= ring->mask);
+
+  head = ring->head;
+  tail = ring->tail;
+  if (NOTERAM_POS_LT(tail, ring->clear))
+    {
+      tail = ring->clear;
+    }
+
+  if (head + length - tail > ring->mask + 1)
+    {
+      if (drv->ni_overwrite == NOTERAM_MODE_OVERWRITE_DISABLE)
+        {
+          /* Stop recording if not in overwrite mode */
+
+          drv->ni_overwrite = NOTERAM_MODE_OVERWRITE_OVERFLOW;
+          up_irq_restore(flags);
+          return;
+        }
+
+      /* Drop the oldest notes until the new one fits */
+
+      do
+        {
+          tail += NOTE_ALIGN(ring->buffer[tail & ring->mask]);
+        }
+      while (head + length - tail > ring->mask + 1);
+    }
+
+  /* Publish tail before the old notes get overwritten, and the note before
+   * head makes it visible.
+   */
+
+  ring->tail = tail;
+  SP_DMB();
+
+  ndx   = head & ring->mask;
+  space = ring->mask + 1 - ndx;
+  space = space < notelen ? space : notelen;
+  memcpy(ring->buffer + ndx, note, space);
+  memcpy(ring->buffer, (FAR const uint8_t *)note + space, notelen - space);
+
+  SP_DMB();
+  ring->head = head + length;
+
+  up_irq_restore(flags);
+  poll_notify(&drv->pfd, 1, POLLIN);
+}
+
+#else /* CONFIG_DRIVERS_NOTERAM_PERCPU */
+
 /****************************************************************************
  * Name: noteram_add
  *
@@ -741,6 +1165,8 @@ static void noteram_add(FAR struct note_driver_s *driver,
   poll_notify(&drv->pfd, 1, POLLIN);
 }
 
+#endif /* CONFIG_DRIVERS_NOTERAM_PERCPU */
+
 /****************************************************************************
  * Name: noteram_dump_init_context
  ****************************************************************************/
@@ -863,6 +1289,23 @@ static int noteram_dump_printf(FAR struct lib_outstream_s *s,
 {
   size_t ret = 0;
 
+#ifdef CONFIG_DRIVERS_NOTE_PRINTF_COMPACT
+  /* The argument layout is only known offline, print the format string
+   * address and the raw arguments for tools/parsetrace.py.
+   */
+
+  size_t length = note->npt_cmn.nc_length - SIZEOF_NOTE_PRINTF(0);
+  size_t i;
+
+  ret += lib_sprintf(s, "%p", note->npt_fmt);
+  for (i = 0; i < length; i++)
+    {
+      ret += lib_sprintf(s, " %02x", (uint8_t)note->npt_data[i]);
+    }
+
+  lib_stream_putc(s, '\n');
+  ret++;
+#else
   if (note->npt_type == 0)
     {
       ret = lib_bsprintf(s, note->npt_fmt, note->npt_data);
@@ -907,6 +1350,7 @@ static int noteram_dump_printf(FAR struct lib_outstream_s *s,
         lib_stream_putc(s, '\n');
         ret++;
     }
+#endif
 
   return ret;
 }
@@ -1374,6 +1818,9 @@ noteram_initialize(FAR const char *devpath, size_t bufsize, bool overwrite)
   drv->ni_tail = 0;
   drv->ni_read = 0;
   drv->pfd = NULL;
+#ifdef CONFIG_DRIVERS_NOTERAM_PERCPU
+  memset(drv->ni_cpu, 0, sizeof(drv->ni_cpu));
+#endif
 
   ret = note_driver_register(&drv->driver);
   if (ret < 0)
@@ -29,10 +29,12 @@
 #include <stdint.h>
 #include <string.h>
 
+#include <nuttx/arch.h>
 #include <nuttx/compiler.h>
 #include <nuttx/kmalloc.h>
 #include <nuttx/net/ip.h>
 #include <nuttx/net/netdev_lowerhalf.h>
+#include <nuttx/net/tcp.h>
 #include <nuttx/virtio/virtio.h>
 #include <nuttx/net/wifi_sim.h>
 
@@ -44,7 +46,18 @@
 
 /* Virtio net feature bits */
 
-#define VIRTIO_NET_F_MAC      5
+#define VIRTIO_NET_F_CSUM      0
+#define VIRTIO_NET_F_MAC       5
+#define VIRTIO_NET_F_HOST_TSO4 11
+#define VIRTIO_NET_F_HOST_TSO6 12
+#define VIRTIO_NET_F_CTRL_VQ   17
+#define VIRTIO_NET_F_MQ        22
+
+/* Virtio net header flags and GSO types */
+
+#define VIRTIO_NET_HDR_F_NEEDS_CSUM 1
+#define VIRTIO_NET_HDR_GSO_TCPV4    1
+#define VIRTIO_NET_HDR_GSO_TCPV6    4
 
 /* Virtio net header size and packet buffer size */
 
@@ -52,17 +65,56 @@
 #define VIRTIO_NET_LLHDRSIZE  (sizeof(struct virtio_net_llhdr_s))
 #define VIRTIO_NET_BUFSIZE    (CONFIG_NET_ETH_PKTSIZE + CONFIG_NET_GUARDSIZE)
 
-/* Virtio net virtqueue index and number */
+/* Virtio net virtqueue index and number, the virtqueues of queue pair q
+ * are VIRTIO_NET_RXQ(q) and VIRTIO_NET_TXQ(q), with VIRTIO_NET_F_MQ the
+ * control virtqueue follows the last pair.
+ */
 
 #define VIRTIO_NET_RX         0
 #define VIRTIO_NET_TX         1
 #define VIRTIO_NET_NUM        2
 
+#define VIRTIO_NET_RXQ(q)     ((q) * VIRTIO_NET_NUM + VIRTIO_NET_RX)
+#define VIRTIO_NET_TXQ(q)     ((q) * VIRTIO_NET_NUM + VIRTIO_NET_TX)
+
+#ifdef CONFIG_NETDEV_MULTIQUEUE
+#  define VIRTIO_NET_MAX_QUEUES CONFIG_NETDEV_MAX_QUEUES
+#else
+#  define VIRTIO_NET_MAX_QUEUES 1
+#endif
+
+#define VIRTIO_NET_MAX_VQS    (VIRTIO_NET_MAX_QUEUES * VIRTIO_NET_NUM + 1)
+
+/* Control virtqueue command setting the number of queue pairs in use */
+
+#define VIRTIO_NET_CTRL_MQ              4
+#define VIRTIO_NET_CTRL_MQ_VQ_PAIRS_SET 0
+#define VIRTIO_NET_OK                   0
+#define VIRTIO_NET_CTRL_TIMEOUT         1000 /* Polls of 100us */
+
 #define VIRTIO_NET_MAX_PKT_SIZE \
     ((CONFIG_NET_LL_GUARDSIZE - ETH_HDRLEN) + VIRTIO_NET_BUFSIZE)
 #define VIRTIO_NET_MAX_NIOB \
     ((VIRTIO_NET_MAX_PKT_SIZE + CONFIG_IOB_BUFSIZE - 1) / CONFIG_IOB_BUFSIZE)
 
+/* The TX virtqueues count descriptors with TSO, as a TSO packet of up to
+ * CONFIG_NETDEV_GSO_MAXSIZE bytes of payload (after the guard and up to
+ * 120 bytes of IP and TCP headers) takes many of them, and packets
+ * otherwise.
+ */
+
+#ifdef CONFIG_NETDEV_GSO
+#  define VIRTIO_NET_TX_NIOB \
+    ((CONFIG_NET_LL_GUARDSIZE + 120 + CONFIG_NETDEV_GSO_MAXSIZE + \
+      CONFIG_IOB_BUFSIZE - 1) / CONFIG_IOB_BUFSIZE + 1)
+#  define VIRTIO_NET_TXCOST(p, pkt) virtio_net_txdescs(p, pkt)
+#  define VIRTIO_NET_TXMAX(p)       ((p)->bufnum * (VIRTIO_NET_MAX_NIOB + 1))
+#else
+#  define VIRTIO_NET_TX_NIOB        VIRTIO_NET_MAX_NIOB
+#  define VIRTIO_NET_TXCOST(p, pkt) 1
+#  define VIRTIO_NET_TXMAX(p)       ((p)->bufnum)
+#endif
+
 /****************************************************************************
  * Private Types
  ****************************************************************************/
@@ -99,6 +151,16 @@ begin_packed_struct struct virtio_net_config_s
   uint32_t supported_hash_types;
 } end_packed_struct;
 
+/* Control virtqueue command of class VIRTIO_NET_CTRL_MQ */
+
+begin_packed_struct struct virtio_net_ctrl_mq_s
+{
+  uint8_t  class;
+  uint8_t  cmd;
+  uint16_t virtqueue_pairs;
+  uint8_t  ack;                              /* Written by the device */
+} end_packed_struct;
+
 struct virtio_net_priv_s
 {
 #ifdef CONFIG_DRIVERS_WIFI_SIM
@@ -112,12 +174,26 @@ struct virtio_net_priv_s
   struct netdev_lowerhalf_s lower;     /* The netdev lowerhalf */
 #endif
 
-  spinlock_t                lock[VIRTIO_NET_NUM];
+  spinlock_t                lock[VIRTIO_NET_MAX_VQS];
 
   /* Virtio device information */
 
   FAR struct virtio_device *vdev;      /* Virtio device pointer */
   int                       bufnum;    /* TX and RX Buffer number */
+  int                       nqueues;   /* Number of queue pairs in use */
+
+  /* Buffers held by each RX and TX virtqueue */
+
+  int                       vqnum[VIRTIO_NET_MAX_VQS];
+
+#ifdef CONFIG_NETDEV_GSO
+  /* Scratch buffers of each TX queue, too big for the stack with TSO */
+
+  struct virtqueue_buf      txvb[VIRTIO_NET_MAX_QUEUES]
+                                [VIRTIO_NET_TX_NIOB + 1];
+  struct iovec              txiov[VIRTIO_NET_MAX_QUEUES]
+                                 [VIRTIO_NET_TX_NIOB];
+#endif
 };
 
 /* Virtio Link Layer Header, follow shows the iob buffer layout:
@@ -165,6 +241,12 @@ static int virtio_net_ioctl(FAR struct netdev_lowerhalf_s *dev,
                             int cmd, unsigned long arg);
 #endif
 static void virtio_net_txfree(FAR struct netdev_lowerhalf_s *dev);
+#ifdef CONFIG_NETDEV_MULTIQUEUE
+static int virtio_net_send_queue(FAR struct netdev_lowerhalf_s *dev,
+                                 unsigned int queue, FAR netpkt_t *pkt);
+static netpkt_t *virtio_net_recv_queue(FAR struct netdev_lowerhalf_s *dev,
+                                       unsigned int queue);
+#endif
 
 static int  virtio_net_probe(FAR struct virtio_device *vdev);
 static void virtio_net_remove(FAR struct virtio_device *vdev);
@@ -194,7 +276,11 @@ static const struct netdev_ops_s g_virtio_net_ops =
 #ifdef CONFIG_NETDEV_IOCTL
   virtio_net_ioctl,
 #endif
-  virtio_net_txfree
+  virtio_net_txfree,
+#ifdef CONFIG_NETDEV_MULTIQUEUE
+  virtio_net_send_queue,
+  virtio_net_recv_queue,
+#endif
 };
 
 #ifdef CONFIG_DRIVERS_WIFI_SIM
@@ -205,6 +291,81 @@ static uint8_t g_netdev_num = 0;
  * Private Functions
  ****************************************************************************/
 
+#ifdef CONFIG_NETDEV_GSO
+/****************************************************************************
+ * Name: virtio_net_txdescs
+ *
+ * Description:
+ *   Return the number of descriptors a TX packet takes in the virtqueue.
+ *
+ ****************************************************************************/
+
+static int virtio_net_txdescs(FAR struct virtio_net_priv_s *priv,
+                              FAR netpkt_t *pkt)
+{
+  int n = virtio_has_feature(priv->vdev, VIRTIO_F_ANY_LAYOUT) ? 0 : 1;
+
+  for (; pkt != NULL; pkt = pkt->io_flink)
+    {
+      n++;
+    }
+
+  return n;
+}
+
+/****************************************************************************
+ * Name: virtio_net_tso
+ *
+ * Description:
+ *   Fill the virtio net header of a TCP packet for the device to cut into
+ *   segments of d_gso_size bytes.  The device also computes the TCP
+ *   checksums, starting with the pseudo-header sum set here.
+ *
+ ****************************************************************************/
+
+static void virtio_net_tso(FAR struct netdev_lowerhalf_s *dev,
+                           FAR netpkt_t *pkt,
+                           FAR struct virtio_net_hdr_s *vhdr)
+{
+  FAR uint8_t *l3 = IOB_DATA(pkt);
+  FAR struct tcp_hdr_s *tcp;
+  uint16_t llhdrlen = NET_LL_HDRLEN(&dev->netdev);
+  uint16_t iplen = 0;
+  uint16_t sum = 0;
+
+#ifdef CONFIG_NET_IPv4
+  if ((l3[0] & IP_VERSION_MASK) == IPv4_VERSION)
+    {
+      iplen = (l3[0] & IPv4_HLMASK) << 2;
+      sum = chksum(pkt->io_pktlen - iplen + IP_PROTO_TCP,
+                   l3 + offsetof(struct ipv4_hdr_s, srcipaddr),
+                   2 * sizeof(in_addr_t));
+      vhdr->gso_type = VIRTIO_NET_HDR_GSO_TCPV4;
+    }
+#endif
+
+#ifdef CONFIG_NET_IPv6
+  if ((l3[0] & IP_VERSION_MASK) == IPv6_VERSION)
+    {
+      iplen = IPv6_HDRLEN;
+      sum = chksum(pkt->io_pktlen - iplen + IP_PROTO_TCP,
+                   l3 + offsetof(struct ipv6_hdr_s, srcipaddr),
+                   2 * sizeof(net_ipv6addr_t));
+      vhdr->gso_type = VIRTIO_NET_HDR_GSO_TCPV6;
+    }
+#endif
+
+  tcp = (FAR struct tcp_hdr_s *)(l3 + iplen);
+  tcp->tcpchksum = HTONS(sum);
+
+  vhdr->flags       = VIRTIO_NET_HDR_F_NEEDS_CSUM;
+  vhdr->hdr_len     = llhdrlen + iplen + ((tcp->tcpoffset >> 4) << 2);
+  vhdr->gso_size    = dev->netdev.d_gso_size;
+  vhdr->csum_start  = llhdrlen + iplen;
+  vhdr->csum_offset = offsetof(struct tcp_hdr_s, tcpchksum);
+}
+#endif
+
 /****************************************************************************
  * Name: virtio_net_addbuffer
  ****************************************************************************/
@@ -215,14 +376,26 @@ static int virtio_net_addbuffer(FAR struct netdev_lowerhalf_s *dev,
 {
   FAR struct virtio_net_priv_s *priv = (FAR struct virtio_net_priv_s *)dev;
   FAR struct virtio_net_llhdr_s *hdr;
-  struct virtqueue_buf vb[VIRTIO_NET_MAX_NIOB + 1];
-  struct iovec iov[VIRTIO_NET_MAX_NIOB];
+  struct virtqueue_buf vbuf[VIRTIO_NET_MAX_NIOB + 1];
+  struct iovec iovbuf[VIRTIO_NET_MAX_NIOB];
+  FAR struct virtqueue_buf *vb = vbuf;
+  FAR struct iovec *iov = iovbuf;
+  int iov_max = VIRTIO_NET_MAX_NIOB;
   int iov_cnt;
   int i;
 
+#ifdef CONFIG_NETDEV_GSO
+  if (vq_id % VIRTIO_NET_NUM == VIRTIO_NET_TX)
+    {
+      vb      = priv->txvb[vq_id / VIRTIO_NET_NUM];
+      iov     = priv->txiov[vq_id / VIRTIO_NET_NUM];
+      iov_max = VIRTIO_NET_TX_NIOB;
+    }
+#endif
+
   /* Convert netpkt to virtqueue_buf */
 
-  iov_cnt = netpkt_to_iov(dev, pkt, iov, VIRTIO_NET_MAX_NIOB);
+  iov_cnt = netpkt_to_iov(dev, pkt, iov, iov_max);
 
   /* Alloc cookie and net header from transport layer */
 
@@ -232,6 +405,13 @@ static int virtio_net_addbuffer(FAR struct netdev_lowerhalf_s *dev,
   memset(&hdr->vhdr, 0, sizeof(hdr->vhdr));
   hdr->pkt = pkt;
 
+#ifdef CONFIG_NETDEV_GSO
+  if (vq_id % VIRTIO_NET_NUM == VIRTIO_NET_TX && dev->netdev.d_gso_size > 0)
+    {
+      virtio_net_tso(dev, pkt, &hdr->vhdr);
+    }
+#endif
+
   /* Prepare buffers depends on the feature VIRTIO_F_ANY_LAYOUT */
 
   if (virtio_has_feature(priv->vdev, VIRTIO_F_ANY_LAYOUT))
@@ -241,7 +421,7 @@ static int virtio_net_addbuffer(FAR struct netdev_lowerhalf_s *dev,
       vb[0].buf = &hdr->vhdr;
       vb[0].len = iov[0].iov_len + VIRTIO_NET_HDRSIZE;
 
-#if VIRTIO_NET_MAX_NIOB > 1
+#if VIRTIO_NET_TX_NIOB > 1
       for (i = 1; i < iov_cnt; i++)
         {
           vb[i].buf = iov[i].iov_base;
@@ -266,7 +446,7 @@ static int virtio_net_addbuffer(FAR struct netdev_lowerhalf_s *dev,
     }
 
   vrtinfo("Fill vq=%u, hdr=%p, count=%d\n", vq_id, hdr, iov_cnt);
-  if (vq_id == VIRTIO_NET_RX)
+  if (vq_id % VIRTIO_NET_NUM == VIRTIO_NET_RX)
     {
       return virtqueue_add_buffer_lock(vq, vb, 0, iov_cnt, hdr,
                                        &priv->lock[vq_id]);
@@ -282,14 +462,16 @@ static int virtio_net_addbuffer(FAR struct netdev_lowerhalf_s *dev,
  * Name: virtio_net_rxfill
  ****************************************************************************/
 
-static void virtio_net_rxfill(FAR struct netdev_lowerhalf_s *dev)
+static void virtio_net_rxfill(FAR struct netdev_lowerhalf_s *dev,
+                              unsigned int queue)
 {
   FAR struct virtio_net_priv_s *priv = (FAR struct virtio_net_priv_s *)dev;
-  FAR struct virtqueue *vq = priv->vdev->vrings_info[VIRTIO_NET_RX].vq;
+  unsigned int vq_id = VIRTIO_NET_RXQ(queue);
+  FAR struct virtqueue *vq = priv->vdev->vrings_info[vq_id].vq;
   FAR netpkt_t *pkt;
   int i;
 
-  for (i = 0; i < priv->bufnum; i++)
+  for (i = 0; priv->vqnum[vq_id] < priv->bufnum; i++)
     {
       /* IOB Offload, Alloc buffer from RX netpkt */
 
@@ -312,12 +494,13 @@ static void virtio_net_rxfill(FAR struct netdev_lowerhalf_s *dev)
 
       /* Add buffer to RX virtqueue */
 
-      virtio_net_addbuffer(dev, vq, pkt, VIRTIO_NET_RX);
+      virtio_net_addbuffer(dev, vq, pkt, vq_id);
+      priv->vqnum[vq_id]++;
     }
 
   if (i > 0)
     {
-      virtqueue_kick_lock(vq, &priv->lock[VIRTIO_NET_RX]);
+      virtqueue_kick_lock(vq, &priv->lock[vq_id]);
     }
 }
 
@@ -325,28 +508,45 @@ static void virtio_net_rxfill(FAR struct netdev_lowerhalf_s *dev)
  * Name: virtio_net_txfree
  ****************************************************************************/
 
-static void virtio_net_txfree(FAR struct netdev_lowerhalf_s *dev)
+static void virtio_net_txfree_queue(FAR struct netdev_lowerhalf_s *dev,
+                                    unsigned int queue)
 {
   FAR struct virtio_net_priv_s *priv = (FAR struct virtio_net_priv_s *)dev;
-  FAR struct virtqueue *vq = priv->vdev->vrings_info[VIRTIO_NET_TX].vq;
+  unsigned int vq_id = VIRTIO_NET_TXQ(queue);
+  FAR struct virtqueue *vq = priv->vdev->vrings_info[vq_id].vq;
   FAR struct virtio_net_llhdr_s *hdr;
 
   while (1)
     {
       /* Get buffer from tx virtqueue */
 
-      hdr = virtqueue_get_buffer_lock(vq, NULL, NULL,
-                                      &priv->lock[VIRTIO_NET_TX]);
+      hdr = virtqueue_get_buffer_lock(vq, NULL, NULL, &priv->lock[vq_id]);
       if (hdr == NULL)
         {
           break;
         }
 
+      priv->vqnum[vq_id] -= VIRTIO_NET_TXCOST(priv, hdr->pkt);
       netpkt_free(dev, hdr->pkt, NETPKT_TX);
       vrtinfo("Free, hdr: %p, pkt: %p\n", hdr, hdr->pkt);
     }
 }
 
+/****************************************************************************
+ * Name: virtio_net_txfree
+ ****************************************************************************/
+
+static void virtio_net_txfree(FAR struct netdev_lowerhalf_s *dev)
+{
+  FAR struct virtio_net_priv_s *priv = (FAR struct virtio_net_priv_s *)dev;
+  int i;
+
+  for (i = 0; i < priv->nqueues; i++)
+    {
+      virtio_net_txfree_queue(dev, i);
+    }
+}
+
 /****************************************************************************
  * Name: virtio_net_ifup
  ****************************************************************************/
@@ -354,6 +554,7 @@ static void virtio_net_txfree(FAR struct netdev_lowerhalf_s *dev)
 static int virtio_net_ifup(FAR struct netdev_lowerhalf_s *dev)
 {
   FAR struct virtio_net_priv_s *priv = (FAR struct virtio_net_priv_s *)dev;
+  int i;
 
 #ifdef CONFIG_NET_IPv4
   vrtinfo("Bringing up: %u.%u.%u.%u\n",
@@ -370,9 +571,13 @@ static int virtio_net_ifup(FAR struct netdev_lowerhalf_s *dev)
 
   /* Prepare interrupt and packets for receiving */
 
-  virtqueue_enable_cb_lock(priv->vdev->vrings_info[VIRTIO_NET_RX].vq,
-                           &priv->lock[VIRTIO_NET_RX]);
-  virtio_net_rxfill(dev);
+  for (i = 0; i < priv->nqueues; i++)
+    {
+      virtqueue_enable_cb_lock(
+        priv->vdev->vrings_info[VIRTIO_NET_RXQ(i)].vq,
+        &priv->lock[VIRTIO_NET_RXQ(i)]);
+      virtio_net_rxfill(dev, i);
+    }
 
 #ifdef CONFIG_DRIVERS_WIFI_SIM
   if (priv->lower.wifi == NULL)
@@ -395,7 +600,7 @@ static int virtio_net_ifdown(FAR struct netdev_lowerhalf_s *dev)
 
   /* Disable the Ethernet interrupt */
 
-  for (i = 0; i < VIRTIO_NET_NUM; i++)
+  for (i = 0; i < priv->nqueues * VIRTIO_NET_NUM; i++)
     {
       virtqueue_disable_cb_lock(priv->vdev->vrings_info[i].vq,
                                 &priv->lock[i]);
@@ -415,77 +620,115 @@ static int virtio_net_ifdown(FAR struct netdev_lowerhalf_s *dev)
 }
 
 /****************************************************************************
- * Name: virtio_net_send
+ * Name: virtio_net_send_queue
  ****************************************************************************/
 
-static int virtio_net_send(FAR struct netdev_lowerhalf_s *dev,
-                           FAR netpkt_t *pkt)
+static int virtio_net_send_queue(FAR struct netdev_lowerhalf_s *dev,
+                                 unsigned int queue, FAR netpkt_t *pkt)
 {
   FAR struct virtio_net_priv_s *priv = (FAR struct virtio_net_priv_s *)dev;
-  FAR struct virtqueue *vq = priv->vdev->vrings_info[VIRTIO_NET_TX].vq;
+  unsigned int vq_id = VIRTIO_NET_TXQ(queue);
+  FAR struct virtqueue *vq = priv->vdev->vrings_info[vq_id].vq;
+  int cost = VIRTIO_NET_TXCOST(priv, pkt);
 
-  /* Check the send length */
+  /* Check the send length, TSO packets are only limited by the virtqueue */
 
-  if (netpkt_getdatalen(dev, pkt) > VIRTIO_NET_BUFSIZE)
+  if (cost > VIRTIO_NET_TXMAX(priv) ||
+#ifdef CONFIG_NETDEV_GSO
+      (dev->netdev.d_gso_size == 0 &&
+       netpkt_getdatalen(dev, pkt) > VIRTIO_NET_BUFSIZE)
+#else
+      netpkt_getdatalen(dev, pkt) > VIRTIO_NET_BUFSIZE
+#endif
+     )
     {
       vrterr("net send buffer too large\n");
       return -EINVAL;
     }
 
+  /* The TX quota is shared by all the queues, so this virtqueue may be
+   * full even if the quota is not exhausted.
+   */
+
+  if (priv->vqnum[vq_id] + cost > VIRTIO_NET_TXMAX(priv))
+    {
+      virtio_net_txfree_queue(dev, queue);
+      if (priv->vqnum[vq_id] + cost > VIRTIO_NET_TXMAX(priv))
+        {
+          virtqueue_enable_cb_lock(vq, &priv->lock[vq_id]);
+          return -EAGAIN;
+        }
+    }
+
   /* Add buffer to vq and notify the other side */
 
-  virtio_net_addbuffer(dev, vq, pkt, VIRTIO_NET_TX);
-  virtqueue_kick_lock(vq, &priv->lock[VIRTIO_NET_TX]);
+  virtio_net_addbuffer(dev, vq, pkt, vq_id);
+  priv->vqnum[vq_id] += cost;
+  virtqueue_kick_lock(vq, &priv->lock[vq_id]);
 
   /* Try return Netpkt TX buffer to upper-half. */
 
-  virtio_net_txfree(dev);
+  virtio_net_txfree_queue(dev, queue);
 
   /* If we have no buffer left, enable TX done callback. */
 
   if (netdev_lower_quota_load(dev, NETPKT_TX) <= 0)
     {
-      virtqueue_enable_cb_lock(vq, &priv->lock[VIRTIO_NET_TX]);
+      virtqueue_enable_cb_lock(vq, &priv->lock[vq_id]);
     }
 
   return OK;
 }
 
 /****************************************************************************
- * Name: virtio_net_recv
+ * Name: virtio_net_send
  ****************************************************************************/
 
-static netpkt_t *virtio_net_recv(FAR struct netdev_lowerhalf_s *dev)
+static int virtio_net_send(FAR struct netdev_lowerhalf_s *dev,
+                           FAR netpkt_t *pkt)
+{
+  return virtio_net_send_queue(dev, 0, pkt);
+}
+
+/****************************************************************************
+ * Name: virtio_net_recv_queue
+ ****************************************************************************/
+
+static netpkt_t *virtio_net_recv_queue(FAR struct netdev_lowerhalf_s *dev,
+                                       unsigned int queue)
 {
   FAR struct virtio_net_priv_s *priv = (FAR struct virtio_net_priv_s *)dev;
-  FAR struct virtqueue *vq = priv->vdev->vrings_info[VIRTIO_NET_RX].vq;
+  unsigned int vq_id = VIRTIO_NET_RXQ(queue);
+  FAR struct virtqueue *vq = priv->vdev->vrings_info[vq_id].vq;
   FAR struct virtio_net_llhdr_s *hdr;
   irqstate_t flags;
   uint32_t len;
 
   /* Fill the free Netpkt RX buffer to the RX virtqueue */
 
-  virtio_net_rxfill(dev);
+  virtio_net_rxfill(dev, queue);
 
   /* Get received buffer form RX virtqueue */
 
-  flags = spin_lock_irqsave(&priv->lock[VIRTIO_NET_RX]);
+  flags = spin_lock_irqsave(&priv->lock[vq_id]);
   hdr = virtqueue_get_buffer(vq, &len, NULL);
   if (hdr == NULL)
     {
       /* If we have no buffer left, enable RX callback. */
 
       virtqueue_enable_cb(vq);
-      spin_unlock_irqrestore(&priv->lock[VIRTIO_NET_RX], flags);
+      spin_unlock_irqrestore(&priv->lock[vq_id], flags);
 
       vrtinfo("get NULL buffer\n");
       return NULL;
     }
   else
     {
-      spin_unlock_irqrestore(&priv->lock[VIRTIO_NET_RX], flags);
+      spin_unlock_irqrestore(&priv->lock[vq_id], flags);
     }
 
+  priv->vqnum[vq_id]--;
+
   /* Set the received pkt length */
 
   netpkt_setdatalen(dev, hdr->pkt, len - VIRTIO_NET_HDRSIZE);
@@ -493,6 +736,15 @@ static netpkt_t *virtio_net_recv(FAR struct netdev_lowerhalf_s *dev)
   return hdr->pkt;
 }
 
+/****************************************************************************
+ * Name: virtio_net_recv
+ ****************************************************************************/
+
+static netpkt_t *virtio_net_recv(FAR struct netdev_lowerhalf_s *dev)
+{
+  return virtio_net_recv_queue(dev, 0);
+}
+
 #ifdef CONFIG_NET_MCASTGROUP
 /****************************************************************************
  * Name: virtio_net_addmac
@@ -535,7 +787,16 @@ static void virtio_net_rxready(FAR struct virtqueue *vq)
 {
   FAR struct virtio_net_priv_s *priv = vq->vq_dev->priv;
 
-  virtqueue_disable_cb_lock(vq, &priv->lock[VIRTIO_NET_RX]);
+  virtqueue_disable_cb_lock(vq, &priv->lock[vq->vq_queue_index]);
+#ifdef CONFIG_NETDEV_MULTIQUEUE
+  if (priv->nqueues > 1)
+    {
+      netdev_lower_rxready_queue((FAR struct netdev_lowerhalf_s *)priv,
+                                 vq->vq_queue_index / VIRTIO_NET_NUM);
+      return;
+    }
+#endif
+
   netdev_lower_rxready((FAR struct netdev_lowerhalf_s *)priv);
 }
 
@@ -547,10 +808,89 @@ static void virtio_net_txdone(FAR struct virtqueue *vq)
 {
   FAR struct virtio_net_priv_s *priv = vq->vq_dev->priv;
 
-  virtqueue_disable_cb_lock(vq, &priv->lock[VIRTIO_NET_TX]);
+  virtqueue_disable_cb_lock(vq, &priv->lock[vq->vq_queue_index]);
+#ifdef CONFIG_NETDEV_MULTIQUEUE
+  if (priv->nqueues > 1)
+    {
+      netdev_lower_txdone_queue((FAR struct netdev_lowerhalf_s *)priv,
+                                vq->vq_queue_index / VIRTIO_NET_NUM);
+      return;
+    }
+#endif
+
   netdev_lower_txdone((FAR struct netdev_lowerhalf_s *)priv);
 }
 
+/****************************************************************************
+ * Name: virtio_net_set_queues
+ *
+ * Description:
+ *   Tell the device how many queue pairs are used, with a command on the
+ *   control virtqueue.  This is done once at probe time, so just poll for
+ *   the answer.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NETDEV_MULTIQUEUE
+static int virtio_net_set_queues(FAR struct virtio_net_priv_s *priv,
+                                 int nqueues)
+{
+  FAR struct virtio_device *vdev = priv->vdev;
+  FAR struct virtqueue *vq =
+    vdev->vrings_info[nqueues * VIRTIO_NET_NUM].vq;
+  FAR struct virtio_net_ctrl_mq_s *ctrl;
+  struct virtqueue_buf vb[2];
+  int timeout = VIRTIO_NET_CTRL_TIMEOUT;
+  int ret;
+
+  ctrl = virtio_zalloc_buf(vdev, sizeof(*ctrl), 16);
+  if (ctrl == NULL)
+    {
+      return -ENOMEM;
+    }
+
+  ctrl->class           = VIRTIO_NET_CTRL_MQ;
+  ctrl->cmd             = VIRTIO_NET_CTRL_MQ_VQ_PAIRS_SET;
+  ctrl->virtqueue_pairs = nqueues;
+  ctrl->ack             = ~VIRTIO_NET_OK;
+
+  vb[0].buf = ctrl;
+  vb[0].len = offsetof(struct virtio_net_ctrl_mq_s, ack);
+  vb[1].buf = &ctrl->ack;
+  vb[1].len = sizeof(ctrl->ack);
+
+  ret = virtqueue_add_buffer(vq, vb, 1, 1, ctrl);
+  if (ret >= 0)
+    {
+      virtqueue_kick(vq);
+      while (virtqueue_get_buffer(vq, NULL, NULL) == NULL)
+        {
+          if (--timeout <= 0)
+            {
+              ret = -ETIMEDOUT;
+              break;
+            }
+
+          up_udelay(100);
+        }
+    }
+
+  if (ret >= 0 && ctrl->ack != VIRTIO_NET_OK)
+    {
+      ret = -EIO;
+    }
+
+  /* Leak the buffer if the device still owns it */
+
+  if (ret != -ETIMEDOUT)
+    {
+      virtio_free_buf(vdev, ctrl);
+    }
+
+  return ret;
+}
+#endif
+
 /****************************************************************************
  * Name: virtio_net_init
  ****************************************************************************/
@@ -558,28 +898,83 @@ static void virtio_net_txdone(FAR struct virtqueue *vq)
 static int virtio_net_init(FAR struct virtio_net_priv_s *priv,
                            FAR struct virtio_device *vdev)
 {
-  FAR const char *vqnames[VIRTIO_NET_NUM];
-  vq_callback callbacks[VIRTIO_NET_NUM];
+  FAR const char *vqnames[VIRTIO_NET_MAX_VQS];
+  vq_callback callbacks[VIRTIO_NET_MAX_VQS];
+  uint64_t features;
+  int nvqs;
   int ret;
+  int i;
 
-  spin_lock_init(&priv->lock[VIRTIO_NET_RX]);
-  spin_lock_init(&priv->lock[VIRTIO_NET_TX]);
-  priv->vdev = vdev;
-  vdev->priv = priv;
+  for (i = 0; i < VIRTIO_NET_MAX_VQS; i++)
+    {
+      spin_lock_init(&priv->lock[i]);
+    }
+
+  priv->vdev    = vdev;
+  priv->nqueues = 1;
+  vdev->priv    = priv;
 
   /* Initialize the virtio device */
 
   virtio_set_status(vdev, VIRTIO_CONFIG_STATUS_DRIVER);
-  virtio_negotiate_features(vdev, (1UL << VIRTIO_NET_F_MAC) |
-                                  (1UL << VIRTIO_F_ANY_LAYOUT), NULL);
+
+  features = (1UL << VIRTIO_NET_F_MAC) | (1UL << VIRTIO_F_ANY_LAYOUT);
+#ifdef CONFIG_NETDEV_GSO
+  features |= (1UL << VIRTIO_NET_F_CSUM) |
+              (1UL << VIRTIO_NET_F_HOST_TSO4) |
+              (1UL << VIRTIO_NET_F_HOST_TSO6);
+#endif
+#ifdef CONFIG_NETDEV_MULTIQUEUE
+  virtio_negotiate_features(vdev, features |
+                                  (1UL << VIRTIO_NET_F_CTRL_VQ) |
+                                  (1UL << VIRTIO_NET_F_MQ), NULL);
+  if (virtio_has_feature(vdev, VIRTIO_NET_F_CTRL_VQ) &&
+      virtio_has_feature(vdev, VIRTIO_NET_F_MQ))
+    {
+      uint16_t pairs;
+
+      /* The control virtqueue follows all the queue pairs of the device,
+       * so only use multiple queues if we can create them all.
+       */
+
+      virtio_read_config_member(vdev, struct virtio_net_config_s,
+                                max_virtqueue_pairs, &pairs);
+      if (pairs > 1 && pairs <= VIRTIO_NET_MAX_QUEUES)
+        {
+          priv->nqueues = pairs;
+        }
+      else
+        {
+          vrtwarn("Not using %u queue pairs, up to %d supported\n",
+                  pairs, VIRTIO_NET_MAX_QUEUES);
+        }
+    }
+
+  if (priv->nqueues == 1)
+#endif
+    {
+      virtio_negotiate_features(vdev, features, NULL);
+    }
+
   virtio_set_status(vdev, VIRTIO_CONFIG_FEATURES_OK);
 
-  vqnames[VIRTIO_NET_RX]   = "virtio_net_rx";
-  vqnames[VIRTIO_NET_TX]   = "virtio_net_tx";
-  callbacks[VIRTIO_NET_RX] = virtio_net_rxready;
-  callbacks[VIRTIO_NET_TX] = virtio_net_txdone;
-  ret = virtio_create_virtqueues(vdev, 0, VIRTIO_NET_NUM, vqnames,
-                                 callbacks, NULL);
+  for (i = 0; i < priv->nqueues; i++)
+    {
+      vqnames[VIRTIO_NET_RXQ(i)]   = "virtio_net_rx";
+      vqnames[VIRTIO_NET_TXQ(i)]   = "virtio_net_tx";
+      callbacks[VIRTIO_NET_RXQ(i)] = virtio_net_rxready;
+      callbacks[VIRTIO_NET_TXQ(i)] = virtio_net_txdone;
+    }
+
+  nvqs = priv->nqueues * VIRTIO_NET_NUM;
+  if (priv->nqueues > 1)
+    {
+      vqnames[nvqs]   = "virtio_net_ctrl";
+      callbacks[nvqs] = NULL;
+      nvqs++;
+    }
+
+  ret = virtio_create_virtqueues(vdev, 0, nvqs, vqnames, callbacks, NULL);
   if (ret < 0)
     {
       vrterr("virtio_device_create_virtqueue failed, ret=%d\n", ret);
@@ -588,14 +983,31 @@ static int virtio_net_init(FAR struct virtio_net_priv_s *priv,
 
   virtio_set_status(vdev, VIRTIO_CONFIG_STATUS_DRIVER_OK);
 
+#ifdef CONFIG_NETDEV_MULTIQUEUE
+  if (priv->nqueues > 1)
+    {
+      ret = virtio_net_set_queues(priv, priv->nqueues);
+      if (ret < 0)
+        {
+          /* The device keeps using the first queue pair only */
+
+          vrtwarn("Failed to enable %d queue pairs, ret=%d\n",
+                  priv->nqueues, ret);
+          priv->nqueues = 1;
+        }
+    }
+#endif
+
 #if CONFIG_DRIVERS_VIRTIO_NET_BUFNUM > 0
   priv->bufnum = CONFIG_DRIVERS_VIRTIO_NET_BUFNUM;
 #else
   /* Calculate the virtio network buffer number:
-   * 1/4 for the TX netpkts, 1/4 for the RX netpkts.
+   * 1/4 for the TX netpkts, 1/4 for the RX netpkts, shared by the queues.
    */
 
-  priv->bufnum = CONFIG_IOB_NBUFFERS / VIRTIO_NET_MAX_NIOB / 4;
+  priv->bufnum = CONFIG_IOB_NBUFFERS / VIRTIO_NET_MAX_NIOB / 4 /
+                 priv->nqueues;
+  priv->bufnum = MAX(priv->bufnum, 1);
 #endif
   priv->bufnum = MIN(vdev->vrings_info[VIRTIO_NET_RX].info.num_descs /
                      (VIRTIO_NET_MAX_NIOB + 1), priv->bufnum);
@@ -668,9 +1080,30 @@ static int virtio_net_probe(FAR struct virtio_device *vdev)
   /* Initialize the netdev lower half */
 
   netdev = (FAR struct netdev_lowerhalf_s *)priv;
-  netdev->quota[NETPKT_RX] = priv->bufnum;
-  netdev->quota[NETPKT_TX] = priv->bufnum;
+  netdev->quota[NETPKT_RX] = priv->bufnum * priv->nqueues;
+  netdev->quota[NETPKT_TX] = priv->bufnum * priv->nqueues;
   netdev->ops = &g_virtio_net_ops;
+#ifdef CONFIG_NETDEV_MULTIQUEUE
+  netdev->nqueues = priv->nqueues;
+#endif
+
+#ifdef CONFIG_NETDEV_GSO
+  /* TSO needs the checksum offload, and room for a TSO packet */
+
+  if (virtio_has_feature(vdev, VIRTIO_NET_F_CSUM) &&
+      VIRTIO_NET_TX_NIOB + 1 <= VIRTIO_NET_TXMAX(priv))
+    {
+      if (virtio_has_feature(vdev, VIRTIO_NET_F_HOST_TSO4))
+        {
+          netdev->features |= NETDEV_F_TSO4;
+        }
+
+      if (virtio_has_feature(vdev, VIRTIO_NET_F_HOST_TSO6))
+        {
+          netdev->features |= NETDEV_F_TSO6;
+        }
+    }
+#endif
 
 #ifdef CONFIG_DRIVERS_WIFI_SIM
   /* If the WiFi interfaces has reached the setting value,
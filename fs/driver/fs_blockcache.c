@@ -0,0 +1,1080 @@
+/****************************************************************************
+ * fs/driver/fs_blockcache.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mount.h>
+
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <assert.h>
+#include <debug.h>
+
+#include <nuttx/fs/fs.h>
+#include <nuttx/fs/ioctl.h>
+#include <nuttx/fs/procfs.h>
+#include <nuttx/kmalloc.h>
+#include <nuttx/mutex.h>
+#include <nuttx/queue.h>
+
+#include "driver/driver.h"
+#include "inode/inode.h"
+#include "fs_heap.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#if CONFIG_FS_BLOCKCACHE_PAGESECTORS < 1 || \
+    CONFIG_FS_BLOCKCACHE_PAGESECTORS > 32
+#  error CONFIG_FS_BLOCKCACHE_PAGESECTORS must be in the range 1..32
+#endif
+
+#if CONFIG_FS_BLOCKCACHE_READAHEAD >= CONFIG_FS_BLOCKCACHE_NPAGES
+#  error CONFIG_FS_BLOCKCACHE_READAHEAD must be less than the number of pages
+#endif
+
+#define BCACHE_PAGESECTORS CONFIG_FS_BLOCKCACHE_PAGESECTORS
+#define BCACHE_NPAGES      CONFIG_FS_BLOCKCACHE_NPAGES
+#define BCACHE_READAHEAD   CONFIG_FS_BLOCKCACHE_READAHEAD
+
+/* Page number of a free page */
+
+#define BCACHE_NOPAGE      ((blkcnt_t)-1)
+
+/* Bitmap of 'n' sectors starting at sector 'o' of a page */
+
+#define BCACHE_MASK(o, n) \
+  ((((n) >= 32) ? UINT32_MAX : ((UINT32_C(1) << (n)) - 1)) << (o))
+
+/* Determines the size of an intermediate buffer that must be large enough
+ * to handle the longest line generated by the procfs logic.
+ */
+
+#define BCACHE_LINELEN     128
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* One cached page: BCACHE_PAGESECTORS consecutive, aligned sectors */
+
+struct bcache_page_s
+{
+  dq_entry_t node;              /* Link in the LRU list, most recent first */
+  blkcnt_t index;               /* Page number, or BCACHE_NOPAGE */
+  uint32_t valid;               /* Bitmap of sectors holding media data */
+  uint32_t dirty;               /* Bitmap of sectors not written back */
+  FAR uint8_t *buffer;          /* Sector data */
+};
+
+struct bcache_dev_s
+{
+  FAR struct bcache_dev_s *flink; /* Link in the list of caches */
+  FAR struct inode *parent;       /* The cached block driver */
+  FAR char *name;                 /* Path of the cache device */
+  mutex_t lock;                   /* Protects everything below */
+  size_t sectorsize;              /* Size of one sector */
+  blkcnt_t nsectors;              /* Number of sectors of the parent */
+  blkcnt_t next;                  /* Sector following the last read */
+  dq_queue_t lru;                 /* Pages, most recently used first */
+  struct bcache_page_s pages[BCACHE_NPAGES];
+
+  /* Statistics */
+
+  uint32_t nhit;                  /* Reads served from the cache */
+  uint32_t nmiss;                 /* Reads that needed the media */
+  uint32_t nreadahead;            /* Pages loaded ahead of the reader */
+  uint32_t nmediard;              /* Read transactions to the parent */
+  uint32_t nmediawr;              /* Write transactions to the parent */
+};
+
+/* This structure describes one open procfs "file" */
+
+struct bcache_file_s
+{
+  struct procfs_file_s base;      /* Base open file structure */
+  char line[BCACHE_LINELEN];      /* Pre-allocated buffer for formatted lines */
+};
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+static int     bcache_open(FAR struct inode *inode);
+static int     bcache_close(FAR struct inode *inode);
+static ssize_t bcache_read(FAR struct inode *inode,
+                           FAR unsigned char *buffer,
+                           blkcnt_t start_sector, unsigned int nsectors);
+static ssize_t bcache_write(FAR struct inode *inode,
+                            FAR const unsigned char *buffer,
+                            blkcnt_t start_sector, unsigned int nsectors);
+static int     bcache_geometry(FAR struct inode *inode,
+                               FAR struct geometry *geometry);
+static int     bcache_ioctl(FAR struct inode *inode, int cmd,
+                            unsigned long arg);
+#ifndef CONFIG_DISABLE_PSEUDOFS_OPERATIONS
+static int     bcache_unlink(FAR struct inode *inode);
+#endif
+
+#if !defined(CONFIG_FS_PROCFS) || defined(CONFIG_FS_PROCFS_EXCLUDE_BLOCKCACHE)
+#  define bcache_procfs_register(dev)
+#  define bcache_procfs_unregister(dev)
+#else
+static int     bcache_procfs_open(FAR struct file *filep,
+                                  FAR const char *relpath,
+                                  int oflags, mode_t mode);
+static int     bcache_procfs_close(FAR struct file *filep);
+static ssize_t bcache_procfs_read(FAR struct file *filep,
+                                  FAR char *buffer, size_t buflen);
+static int     bcache_procfs_dup(FAR const struct file *oldp,
+                                 FAR struct file *newp);
+static int     bcache_procfs_stat(FAR const char *relpath,
+                                  FAR struct stat *buf);
+#endif
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static const struct block_operations g_bcache_bops =
+{
+  bcache_open,     /* open     */
+  bcache_close,    /* close    */
+  bcache_read,     /* read     */
+  bcache_write,    /* write    */
+  bcache_geometry, /* geometry */
+  bcache_ioctl     /* ioctl    */
+#ifndef CONFIG_DISABLE_PSEUDOFS_OPERATIONS
+  , bcache_unlink  /* unlink   */
+#endif
+};
+
+#if defined(CONFIG_FS_PROCFS) && !defined(CONFIG_FS_PROCFS_EXCLUDE_BLOCKCACHE)
+static FAR struct bcache_dev_s *g_bcache_list;
+static mutex_t g_bcache_list_lock = NXMUTEX_INITIALIZER;
+#endif
+
+/****************************************************************************
+ * Public Data
+ ****************************************************************************/
+
+#if defined(CONFIG_FS_PROCFS) && !defined(CONFIG_FS_PROCFS_EXCLUDE_BLOCKCACHE)
+const struct procfs_operations g_bcache_operations =
+{
+  bcache_procfs_open,  /* open */
+  bcache_procfs_close, /* close */
+  bcache_procfs_read,  /* read */
+  NULL,                /* write */
+  NULL,                /* poll */
+  bcache_procfs_dup,   /* dup */
+  NULL,                /* opendir */
+  NULL,                /* closedir */
+  NULL,                /* readdir */
+  NULL,                /* rewinddir */
+  bcache_procfs_stat   /* stat */
+};
+#endif
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: bcache_pagesectors
+ *
+ * Description:
+ *   Return the number of sectors of a page that exist on the media.  Only
+ *   the last page of the device may be short.
+ *
+ ****************************************************************************/
+
+static unsigned int bcache_pagesectors(FAR struct bcache_dev_s *dev,
+                                       blkcnt_t index)
+{
+  blkcnt_t remain = dev->nsectors - index * BCACHE_PAGESECTORS;
+
+  return remain < BCACHE_PAGESECTORS ? remain : BCACHE_PAGESECTORS;
+}
+
+/****************************************************************************
+ * Name: bcache_find
+ *
+ * Description:
+ *   Find the cached page 'index' and make it the most recently used.
+ *
+ ****************************************************************************/
+
+static FAR struct bcache_page_s *bcache_find(FAR struct bcache_dev_s *dev,
+                                             blkcnt_t index)
+{
+  FAR dq_entry_t *node;
+
+  for (node = dq_peek(&dev->lru); node != NULL; node = dq_next(node))
+    {
+      FAR struct bcache_page_s *page = (FAR struct bcache_page_s *)node;
+
+      if (page->index == index)
+        {
+          if (node != dq_peek(&dev->lru))
+            {
+              dq_rem(node, &dev->lru);
+              dq_addfirst(node, &dev->lru);
+            }
+
+          return page;
+        }
+    }
+
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: bcache_writeback
+ *
+ * Description:
+ *   Write the dirty sectors of a page back to the parent, one transaction
+ *   per run of adjacent dirty sectors.  Sectors that were not written stay
+ *   dirty.
+ *
+ ****************************************************************************/
+
+static int bcache_writeback(FAR struct bcache_dev_s *dev,
+                            FAR struct bcache_page_s *page)
+{
+  FAR struct inode *parent = dev->parent;
+  unsigned int nsectors = bcache_pagesectors(dev, page->index);
+  unsigned int i = 0;
+
+  while (page->dirty != 0 && i < nsectors)
+    {
+      unsigned int n = 0;
+      ssize_t ret;
+
+      if ((page->dirty & (UINT32_C(1) << i)) == 0)
+        {
+          i++;
+          continue;
+        }
+
+      while (i + n < nsectors && (page->dirty & (UINT32_C(1) << (i + n))))
+        {
+          n++;
+        }
+
+      ret = parent->u.i_bops->write(parent,
+                                    page->buffer + i * dev->sectorsize,
+                                    page->index * BCACHE_PAGESECTORS + i,
+                                    n);
+      dev->nmediawr++;
+      if (ret != n)
+        {
+          /* A short write leaves the rest of the run dirty; the error
+           * reaches BIOC_FLUSH and close through bcache_flush().
+           */
+
+          ferr("ERROR: Write back failed: %zd of %u\n", ret, n);
+          return ret < 0 ? ret : -EIO;
+        }
+
+      page->dirty &= ~BCACHE_MASK(i, n);
+      i += n;
+    }
+
+  page->dirty = 0;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: bcache_fill
+ *
+ * Description:
+ *   Read every sector of a page that is not valid yet, one transaction per
+ *   run of adjacent missing sectors.  A page that is not cached at all is
+ *   therefore loaded in one transaction.
+ *
+ ****************************************************************************/
+
+static int bcache_fill(FAR struct bcache_dev_s *dev,
+                       FAR struct bcache_page_s *page)
+{
+  FAR struct inode *parent = dev->parent;
+  unsigned int nsectors = bcache_pagesectors(dev, page->index);
+  unsigned int i = 0;
+
+  while (i < nsectors)
+    {
+      unsigned int n = 0;
+      ssize_t ret;
+
+      if ((page->valid & (UINT32_C(1) << i)) != 0)
+        {
+          i++;
+          continue;
+        }
+
+      while (i + n < nsectors &&
+             (page->valid & (UINT32_C(1) << (i + n))) == 0)
+        {
+          n++;
+        }
+
+      ret = parent->u.i_bops->read(parent,
+                                   page->buffer + i * dev->sectorsize,
+                                   page->index * BCACHE_PAGESECTORS + i,
+                                   n);
+      dev->nmediard++;
+      if (ret < 0)
+        {
+          return ret;
+        }
+      else if (ret != n)
+        {
+          /* Only the sectors the device returned hold valid data */
+
+          if (ret > 0)
+            {
+              page->valid |= BCACHE_MASK(i, ret);
+            }
+
+          ferr("ERROR: Read failed: %zd of %u\n", ret, n);
+          return -EIO;
+        }
+
+      page->valid |= BCACHE_MASK(i, n);
+      i += n;
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: bcache_alloc
+ *
+ * Description:
+ *   Recycle the least recently used page for page 'index', writing it back
+ *   first if it is dirty.
+ *
+ ****************************************************************************/
+
+static int bcache_alloc(FAR struct bcache_dev_s *dev, blkcnt_t index,
+                        FAR struct bcache_page_s **ppage)
+{
+  FAR struct bcache_page_s *page;
+  int ret;
+
+  page = (FAR struct bcache_page_s *)dq_tail(&dev->lru);
+  if (page->dirty != 0)
+    {
+      ret = bcache_writeback(dev, page);
+      if (ret < 0)
+        {
+          return ret;
+        }
+    }
+
+  dq_rem(&page->node, &dev->lru);
+  dq_addfirst(&page->node, &dev->lru);
+
+  page->index = index;
+  page->valid = 0;
+  *ppage      = page;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: bcache_readahead
+ *
+ * Description:
+ *   Load the pages following 'index' for a sequential reader.  Failures
+ *   are not reported; the reader will simply miss later.
+ *
+ ****************************************************************************/
+
+static void bcache_readahead(FAR struct bcache_dev_s *dev, blkcnt_t index)
+{
+  FAR struct bcache_page_s *page;
+  int i;
+
+  for (i = 1; i <= BCACHE_READAHEAD; i++)
+    {
+      blkcnt_t next = index + i;
+
+      if (next * BCACHE_PAGESECTORS >= dev->nsectors)
+        {
+          break;
+        }
+
+      if (bcache_find(dev, next) != NULL)
+        {
+          continue;
+        }
+
+      if (bcache_alloc(dev, next, &page) < 0)
+        {
+          break;
+        }
+
+      if (bcache_fill(dev, page) < 0)
+        {
+          page->index = BCACHE_NOPAGE;
+          break;
+        }
+
+      dev->nreadahead++;
+    }
+}
+
+/****************************************************************************
+ * Name: bcache_flush
+ *
+ * Description:
+ *   Write back all dirty pages.
+ *
+ ****************************************************************************/
+
+static int bcache_flush(FAR struct bcache_dev_s *dev)
+{
+  int ret = OK;
+  int i;
+
+  for (i = 0; i < BCACHE_NPAGES; i++)
+    {
+      if (dev->pages[i].dirty != 0)
+        {
+          int status = bcache_writeback(dev, &dev->pages[i]);
+          if (status < 0)
+            {
+              ret = status;
+            }
+        }
+    }
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: bcache_open
+ *
+ * Description: Open the block device
+ *
+ ****************************************************************************/
+
+static int bcache_open(FAR struct inode *inode)
+{
+  FAR struct bcache_dev_s *dev = inode->i_private;
+  FAR struct inode *parent = dev->parent;
+  int ret = OK;
+
+  if (parent->u.i_bops->open)
+    {
+      ret = parent->u.i_bops->open(parent);
+    }
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: bcache_close
+ *
+ * Description: Write back the cache and close the block device
+ *
+ ****************************************************************************/
+
+static int bcache_close(FAR struct inode *inode)
+{
+  FAR struct bcache_dev_s *dev = inode->i_private;
+  FAR struct inode *parent = dev->parent;
+  int ret;
+
+  ret = nxmutex_lock(&dev->lock);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  ret = bcache_flush(dev);
+  nxmutex_unlock(&dev->lock);
+
+  if (parent->u.i_bops->close)
+    {
+      int status = parent->u.i_bops->close(parent);
+      if (ret >= 0)
+        {
+          ret = status;
+        }
+    }
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: bcache_read
+ *
+ * Description:  Read the specified number of sectors
+ *
+ ****************************************************************************/
+
+static ssize_t bcache_read(FAR struct inode *inode,
+                           FAR unsigned char *buffer,
+                           blkcnt_t start_sector, unsigned int nsectors)
+{
+  FAR struct bcache_dev_s *dev = inode->i_private;
+  unsigned int remain;
+  bool sequential;
+  int ret;
+
+  if (start_sector >= dev->nsectors)
+    {
+      return 0;
+    }
+
+  if (start_sector + nsectors > dev->nsectors)
+    {
+      nsectors = dev->nsectors - start_sector;
+    }
+
+  ret = nxmutex_lock(&dev->lock);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  sequential = start_sector == dev->next;
+  remain     = nsectors;
+
+  while (remain > 0)
+    {
+      FAR struct bcache_page_s *page;
+      blkcnt_t index = start_sector / BCACHE_PAGESECTORS;
+      unsigned int offset = start_sector % BCACHE_PAGESECTORS;
+      unsigned int count = BCACHE_PAGESECTORS - offset;
+      uint32_t mask;
+
+      if (count > remain)
+        {
+          count = remain;
+        }
+
+      mask = BCACHE_MASK(offset, count);
+      page = bcache_find(dev, index);
+      if (page != NULL && (page->valid & mask) == mask)
+        {
+          dev->nhit++;
+        }
+      else
+        {
+          dev->nmiss++;
+          if (page == NULL)
+            {
+              ret = bcache_alloc(dev, index, &page);
+              if (ret < 0)
+                {
+                  break;
+                }
+            }
+
+          ret = bcache_fill(dev, page);
+          if (ret < 0)
+            {
+              if (page->dirty == 0)
+                {
+                  page->index = BCACHE_NOPAGE;
+                }
+
+              break;
+            }
+
+          if (sequential)
+            {
+              bcache_readahead(dev, index);
+            }
+        }
+
+      memcpy(buffer, page->buffer + offset * dev->sectorsize,
+             count * dev->sectorsize);
+
+      buffer       += count * dev->sectorsize;
+      start_sector += count;
+      remain       -= count;
+    }
+
+  dev->next = start_sector;
+  nxmutex_unlock(&dev->lock);
+
+  if (remain == nsectors && ret < 0)
+    {
+      return ret;
+    }
+
+  return nsectors - remain;
+}
+
+/****************************************************************************
+ * Name: bcache_write
+ *
+ * Description: Buffer the specified number of sectors in the cache
+ *
+ ****************************************************************************/
+
+static ssize_t bcache_write(FAR struct inode *inode,
+                            FAR const unsigned char *buffer,
+                            blkcnt_t start_sector, unsigned int nsectors)
+{
+  FAR struct bcache_dev_s *dev = inode->i_private;
+  unsigned int remain;
+  int ret;
+
+  if (start_sector >= dev->nsectors)
+    {
+      return 0;
+    }
+
+  if (start_sector + nsectors > dev->nsectors)
+    {
+      nsectors = dev->nsectors - start_sector;
+    }
+
+  ret = nxmutex_lock(&dev->lock);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  remain = nsectors;
+  while (remain > 0)
+    {
+      FAR struct bcache_page_s *page;
+      blkcnt_t index = start_sector / BCACHE_PAGESECTORS;
+      unsigned int offset = start_sector % BCACHE_PAGESECTORS;
+      unsigned int count = BCACHE_PAGESECTORS - offset;
+      uint32_t mask;
+
+      if (count > remain)
+        {
+          count = remain;
+        }
+
+      page = bcache_find(dev, index);
+      if (page == NULL)
+        {
+          ret = bcache_alloc(dev, index, &page);
+          if (ret < 0)
+            {
+              break;
+            }
+        }
+
+      mask = BCACHE_MASK(offset, count);
+      memcpy(page->buffer + offset * dev->sectorsize, buffer,
+             count * dev->sectorsize);
+      page->valid |= mask;
+      page->dirty |= mask;
+
+      buffer       += count * dev->sectorsize;
+      start_sector += count;
+      remain       -= count;
+    }
+
+  nxmutex_unlock(&dev->lock);
+
+  if (remain == nsectors && ret < 0)
+    {
+      return ret;
+    }
+
+  return nsectors - remain;
+}
+
+/****************************************************************************
+ * Name: bcache_geometry
+ *
+ * Description: Return device geometry
+ *
+ ****************************************************************************/
+
+static int bcache_geometry(FAR struct inode *inode,
+                           FAR struct geometry *geometry)
+{
+  FAR struct bcache_dev_s *dev = inode->i_private;
+  FAR struct inode *parent = dev->parent;
+
+  return parent->u.i_bops->geometry(parent, geometry);
+}
+
+/****************************************************************************
+ * Name: bcache_ioctl
+ *
+ * Description:
+ *   BIOC_FLUSH writes back the cache before it is passed on.  All other
+ *   commands go to the parent after the dirty sectors are written back, so
+ *   that the parent always sees the latest data.
+ *
+ ****************************************************************************/
+
+static int bcache_ioctl(FAR struct inode *inode, int cmd, unsigned long arg)
+{
+  FAR struct bcache_dev_s *dev = inode->i_private;
+  FAR struct inode *parent = dev->parent;
+  int ret;
+
+  ret = nxmutex_lock(&dev->lock);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  ret = bcache_flush(dev);
+  nxmutex_unlock(&dev->lock);
+
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  if (parent->u.i_bops->ioctl == NULL)
+    {
+      return cmd == BIOC_FLUSH ? OK : -ENOTTY;
+    }
+
+  ret = parent->u.i_bops->ioctl(parent, cmd, arg);
+
+  /* Drivers may not support command BIOC_FLUSH */
+
+  if (ret == -ENOTTY && cmd == BIOC_FLUSH)
+    {
+      ret = OK;
+    }
+
+  return ret;
+}
+
+#if defined(CONFIG_FS_PROCFS) && !defined(CONFIG_FS_PROCFS_EXCLUDE_BLOCKCACHE)
+
+/****************************************************************************
+ * Name: bcache_procfs_register
+ ****************************************************************************/
+
+static void bcache_procfs_register(FAR struct bcache_dev_s *dev)
+{
+  nxmutex_lock(&g_bcache_list_lock);
+  dev->flink    = g_bcache_list;
+  g_bcache_list = dev;
+  nxmutex_unlock(&g_bcache_list_lock);
+}
+
+/****************************************************************************
+ * Name: bcache_procfs_unregister
+ ****************************************************************************/
+
+static void bcache_procfs_unregister(FAR struct bcache_dev_s *dev)
+{
+  FAR struct bcache_dev_s **curr;
+
+  nxmutex_lock(&g_bcache_list_lock);
+  for (curr = &g_bcache_list; *curr != NULL; curr = &(*curr)->flink)
+    {
+      if (*curr == dev)
+        {
+          *curr = dev->flink;
+          break;
+        }
+    }
+
+  nxmutex_unlock(&g_bcache_list_lock);
+}
+
+/****************************************************************************
+ * Name: bcache_procfs_open
+ ****************************************************************************/
+
+static int bcache_procfs_open(FAR struct file *filep,
+                              FAR const char *relpath,
+                              int oflags, mode_t mode)
+{
+  FAR struct bcache_file_s *procfile;
+
+  if ((oflags & O_WRONLY) != 0 || (oflags & O_RDONLY) == 0)
+    {
+      return -EACCES;
+    }
+
+  procfile = fs_heap_zalloc(sizeof(struct bcache_file_s));
+  if (procfile == NULL)
+    {
+      return -ENOMEM;
+    }
+
+  filep->f_priv = procfile;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: bcache_procfs_close
+ ****************************************************************************/
+
+static int bcache_procfs_close(FAR struct file *filep)
+{
+  fs_heap_free(filep->f_priv);
+  filep->f_priv = NULL;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: bcache_procfs_read
+ ****************************************************************************/
+
+static ssize_t bcache_procfs_read(FAR struct file *filep,
+                                  FAR char *buffer, size_t buflen)
+{
+  FAR struct bcache_file_s *procfile = filep->f_priv;
+  FAR struct bcache_dev_s *dev;
+  size_t linesize;
+  size_t copysize;
+  size_t totalsize;
+  off_t offset = filep->f_pos;
+
+  linesize  = procfs_snprintf(procfile->line, BCACHE_LINELEN,
+                              "%-16s%11s%11s%11s%11s%11s%7s\n", "",
+                              "hit", "miss", "readahead", "mediard",
+                              "mediawr", "dirty");
+  copysize  = procfs_memcpy(procfile->line, linesize, buffer, buflen,
+                            &offset);
+  totalsize = copysize;
+
+  nxmutex_lock(&g_bcache_list_lock);
+  for (dev = g_bcache_list; dev != NULL && totalsize < buflen;
+       dev = dev->flink)
+    {
+      unsigned int ndirty = 0;
+      int i;
+
+      for (i = 0; i < BCACHE_NPAGES; i++)
+        {
+          if (dev->pages[i].dirty != 0)
+            {
+              ndirty++;
+            }
+        }
+
+      buffer    += copysize;
+      buflen    -= copysize;
+
+      linesize   = procfs_snprintf(procfile->line, BCACHE_LINELEN,
+                                   "%-15s:%11" PRIu32 "%11" PRIu32
+                                   "%11" PRIu32 "%11" PRIu32
+                                   "%11" PRIu32 "%7u\n",
+                                   dev->name, dev->nhit, dev->nmiss,
+                                   dev->nreadahead, dev->nmediard,
+                                   dev->nmediawr, ndirty);
+      copysize   = procfs_memcpy(procfile->line, linesize, buffer, buflen,
+                                 &offset);
+      totalsize += copysize;
+    }
+
+  nxmutex_unlock(&g_bcache_list_lock);
+
+  filep->f_pos += totalsize;
+  return totalsize;
+}
+
+/****************************************************************************
+ * Name: bcache_procfs_dup
+ ****************************************************************************/
+
+static int bcache_procfs_dup(FAR const struct file *oldp,
+                             FAR struct file *newp)
+{
+  FAR struct bcache_file_s *newattr;
+
+  newattr = fs_heap_malloc(sizeof(struct bcache_file_s));
+  if (newattr == NULL)
+    {
+      return -ENOMEM;
+    }
+
+  memcpy(newattr, oldp->f_priv, sizeof(struct bcache_file_s));
+  newp->f_priv = newattr;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: bcache_procfs_stat
+ ****************************************************************************/
+
+static int bcache_procfs_stat(FAR const char *relpath, FAR struct stat *buf)
+{
+  memset(buf, 0, sizeof(struct stat));
+  buf->st_mode = S_IFREG | S_IROTH | S_IRGRP | S_IRUSR;
+  return OK;
+}
+#endif
+
+/****************************************************************************
+ * Name: bcache_unlink
+ ****************************************************************************/
+
+#ifndef CONFIG_DISABLE_PSEUDOFS_OPERATIONS
+static int bcache_unlink(FAR struct inode *inode)
+{
+  FAR struct bcache_dev_s *dev = inode->i_private;
+  int ret;
+
+  /* Keep the device, and its dirty pages, if they can not be written */
+
+  ret = nxmutex_lock(&dev->lock);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  ret = bcache_flush(dev);
+  nxmutex_unlock(&dev->lock);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  bcache_procfs_unregister(dev);
+
+  inode_release(dev->parent);
+  nxmutex_destroy(&dev->lock);
+  fs_heap_free(dev->pages[0].buffer);
+  fs_heap_free(dev->name);
+  fs_heap_free(dev);
+  return OK;
+}
+#endif
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: register_blockcache
+ *
+ * Description:
+ *   Register a block driver that caches the sectors of another block
+ *   driver in a small LRU page cache.  Reads load whole pages of
+ *   CONFIG_FS_BLOCKCACHE_PAGESECTORS sectors, sequential readers get the
+ *   following pages read ahead, and writes are held in the cache until the
+ *   page is evicted, the device is closed, or BIOC_FLUSH is received.
+ *
+ * Input Parameters:
+ *   cache  - The path to the cache inode
+ *   mode   - Access privileges
+ *   parent - The path to the block driver to be cached
+ *
+ * Returned Value:
+ *   Zero on success; a negated errno value is returned on a failure.
+ *
+ ****************************************************************************/
+
+int register_blockcache(FAR const char *cache, mode_t mode,
+                        FAR const char *parent)
+{
+  FAR struct bcache_dev_s *dev;
+  FAR struct inode *inode;
+  struct geometry geo;
+  size_t pagesize;
+  int ret;
+  int i;
+
+  if (mode & (S_IWOTH | S_IWGRP | S_IWUSR))
+    {
+      ret = find_blockdriver(parent, 0, &inode);
+    }
+  else
+    {
+      ret = find_blockdriver(parent, MS_RDONLY, &inode);
+    }
+
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  ret = inode->u.i_bops->geometry(inode, &geo);
+  if (ret < 0)
+    {
+      goto errout_with_inode;
+    }
+
+  dev = fs_heap_zalloc(sizeof(*dev));
+  if (dev == NULL)
+    {
+      ret = -ENOMEM;
+      goto errout_with_inode;
+    }
+
+  pagesize = geo.geo_sectorsize * BCACHE_PAGESECTORS;
+  dev->pages[0].buffer = fs_heap_malloc(pagesize * BCACHE_NPAGES);
+  dev->name = fs_heap_strdup(cache);
+  if (dev->pages[0].buffer == NULL || dev->name == NULL)
+    {
+      ret = -ENOMEM;
+      goto errout_with_dev;
+    }
+
+  dev->parent     = inode;
+  dev->sectorsize = geo.geo_sectorsize;
+  dev->nsectors   = geo.geo_nsectors;
+  dev->next       = BCACHE_NOPAGE;
+  nxmutex_init(&dev->lock);
+
+  for (i = 0; i < BCACHE_NPAGES; i++)
+    {
+      dev->pages[i].index  = BCACHE_NOPAGE;
+      dev->pages[i].buffer = dev->pages[0].buffer + i * pagesize;
+      dq_addlast(&dev->pages[i].node, &dev->lru);
+    }
+
+  ret = register_blockdriver(cache, &g_bcache_bops, mode, dev);
+  if (ret < 0)
+    {
+      nxmutex_destroy(&dev->lock);
+      goto errout_with_dev;
+    }
+
+  /* The cache keeps the reference to the parent from find_blockdriver() */
+
+  bcache_procfs_register(dev);
+  return OK;
+
+errout_with_dev:
+  fs_heap_free(dev->pages[0].buffer);
+  fs_heap_free(dev->name);
+  fs_heap_free(dev);
+
+errout_with_inode:
+  inode_release(inode);
+  return ret;
+}
@@ -1492,6 +1492,20 @@ static int fat_sync(FAR struct file *filep)
       ret          = fat_updatefsinfo(fs);
     }
 
+  /* Ask the block driver (e.g. a block cache) to write back any sectors
+   * that it still buffers.  Drivers may not support BIOC_FLUSH.
+   */
+
+  inode = fs->fs_blkdriver;
+  if (ret >= 0 && inode->u.i_bops->ioctl != NULL)
+    {
+      ret = inode->u.i_bops->ioctl(inode, BIOC_FLUSH, 0);
+      if (ret == -ENOTTY)
+        {
+          ret = OK;
+        }
+    }
+
 errout_with_lock:
   nxmutex_unlock(&fs->fs_lock);
   return ret;
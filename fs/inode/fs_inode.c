@@ -24,8 +24,10 @@
  * Included Files
  ****************************************************************************/
 
+#include <nuttx/atomic.h>
 #include <nuttx/fs/fs.h>
 #include <nuttx/rwsem.h>
+#include <nuttx/spinlock.h>
 
 #include "inode/inode.h"
 
@@ -43,6 +45,19 @@
 
 static rw_semaphore_t g_inode_lock = RWSEM_INITIALIZER;
 
+#ifdef CONFIG_FS_INODE_RCU
+/* g_inode_seq is odd while a writer holds the inode tree, and is advanced
+ * again when the writer leaves.  g_inode_readers counts the lookups that
+ * walk the tree without the lock; inodes freed while it is non-zero are
+ * deferred until it drops back to zero.  g_inode_nwrite is the nesting
+ * level of the (recursive) write lock and is protected by it.
+ */
+
+static atomic_uint g_inode_seq;
+static atomic_int g_inode_readers;
+static int g_inode_nwrite;
+#endif
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -74,6 +89,14 @@ void inode_initialize(void)
 void inode_lock(void)
 {
   down_write(&g_inode_lock);
+
+#ifdef CONFIG_FS_INODE_RCU
+  if (g_inode_nwrite++ == 0)
+    {
+      atomic_fetch_add(&g_inode_seq, 1);
+      SP_DMB();
+    }
+#endif
 }
 
 /****************************************************************************
@@ -99,7 +122,24 @@ void inode_rlock(void)
 
 void inode_unlock(void)
 {
+#ifdef CONFIG_FS_INODE_RCU
+  bool last = --g_inode_nwrite == 0;
+
+  if (last)
+    {
+      SP_DMB();
+      atomic_fetch_add(&g_inode_seq, 1);
+    }
+
+  up_write(&g_inode_lock);
+
+  if (last)
+    {
+      inode_reclaim();
+    }
+#else
   up_write(&g_inode_lock);
+#endif
 }
 
 /****************************************************************************
@@ -114,3 +154,77 @@ void inode_runlock(void)
 {
   up_read(&g_inode_lock);
 }
+
+#ifdef CONFIG_FS_INODE_RCU
+
+/****************************************************************************
+ * Name: inode_rcu_read_lock
+ *
+ * Description:
+ *   Enter a lockless read side section of the inode tree.  The returned
+ *   sequence is odd if a writer currently holds the tree, in which case
+ *   the caller must not walk it.  Every call must be paired with
+ *   inode_rcu_read_unlock().
+ *
+ ****************************************************************************/
+
+unsigned int inode_rcu_read_lock(void)
+{
+  atomic_fetch_add(&g_inode_readers, 1);
+  SP_DMB();
+  return atomic_load(&g_inode_seq);
+}
+
+/****************************************************************************
+ * Name: inode_rcu_read_unlock
+ *
+ * Description:
+ *   Leave a lockless read side section.  Returns true if 'seq' was even
+ *   and no writer touched the tree since inode_rcu_read_lock(), i.e. if
+ *   whatever was looked up in the section is consistent.
+ *
+ ****************************************************************************/
+
+bool inode_rcu_read_unlock(unsigned int seq)
+{
+  bool valid;
+
+  SP_DMB();
+  valid = (seq & 1) == 0 && atomic_load(&g_inode_seq) == seq;
+
+  if (atomic_fetch_sub(&g_inode_readers, 1) == 1)
+    {
+      inode_reclaim();
+    }
+
+  return valid;
+}
+
+/****************************************************************************
+ * Name: inode_rcu_seq
+ *
+ * Description:
+ *   Return the current write sequence of the inode tree.
+ *
+ ****************************************************************************/
+
+unsigned int inode_rcu_seq(void)
+{
+  return atomic_load(&g_inode_seq);
+}
+
+/****************************************************************************
+ * Name: inode_rcu_readers
+ *
+ * Description:
+ *   Return the number of lockless readers currently walking the tree.
+ *
+ ****************************************************************************/
+
+int inode_rcu_readers(void)
+{
+  SP_DMB();
+  return atomic_load(&g_inode_readers);
+}
+
+#endif /* CONFIG_FS_INODE_RCU */
@@ -26,13 +26,92 @@
 
 #include <nuttx/config.h>
 
+#include <stdbool.h>
 #include <assert.h>
 #include <errno.h>
 
+#include <nuttx/atomic.h>
 #include <nuttx/fs/fs.h>
 
 #include "inode/inode.h"
 
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+#ifdef CONFIG_FS_INODE_RCU
+
+/****************************************************************************
+ * Name: inode_tryaddref
+ *
+ * Description:
+ *   Take a reference on an inode found by a lockless lookup, unless its
+ *   last reference is already gone.
+ *
+ ****************************************************************************/
+
+static bool inode_tryaddref(FAR struct inode *inode)
+{
+  short crefs = atomic_load(&inode->i_crefs);
+
+  do
+    {
+      if (crefs <= 0)
+        {
+          return false;
+        }
+    }
+  while (!atomic_compare_exchange_weak(&inode->i_crefs, &crefs, crefs + 1));
+
+  return true;
+}
+
+/****************************************************************************
+ * Name: inode_rcu_find
+ *
+ * Description:
+ *   Try inode_find() without taking the inode lock.  Returns -EAGAIN if a
+ *   writer modified the tree meanwhile and the lookup has to be repeated
+ *   under the lock.
+ *
+ ****************************************************************************/
+
+static int inode_rcu_find(FAR struct inode_search_s *desc)
+{
+  FAR const char *path = desc->path;
+  bool nofollow = desc->nofollow;
+  bool found = false;
+  unsigned int seq;
+  int ret = -EAGAIN;
+
+  seq = inode_rcu_read_lock();
+  if ((seq & 1) == 0)
+    {
+      ret = inode_search(desc);
+      if (ret >= 0)
+        {
+          found = inode_tryaddref(desc->node);
+        }
+    }
+
+  if (inode_rcu_read_unlock(seq) && (ret < 0 || found))
+    {
+      return ret;
+    }
+
+  /* The tree changed under us, drop whatever was found */
+
+  if (found)
+    {
+      inode_release(desc->node);
+    }
+
+  RELEASE_SEARCH(desc);
+  SETUP_SEARCH(desc, path, nofollow);
+  return -EAGAIN;
+}
+#endif
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -53,6 +132,18 @@ int inode_find(FAR struct inode_search_s *desc)
 {
   int ret;
 
+#ifdef CONFIG_FS_INODE_RCU
+  /* Resolve the path without blocking on the inode lock if no writer is
+   * active, and fall back to the locked search otherwise.
+   */
+
+  ret = inode_rcu_find(desc);
+  if (ret != -EAGAIN)
+    {
+      return ret;
+    }
+#endif
+
   /* Find the node matching the path.  If found, increment the count of
    * references on the node.
    */
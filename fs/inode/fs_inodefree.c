@@ -30,11 +30,49 @@
 #include <errno.h>
 
 #include <nuttx/kmalloc.h>
+#include <nuttx/spinlock.h>
 #include <nuttx/fs/fs.h>
 
 #include "inode/inode.h"
 #include "fs_heap.h"
 
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+#ifdef CONFIG_FS_INODE_RCU
+/* Inodes freed while lockless readers were walking the tree, chained
+ * through i_peer.
+ */
+
+static FAR struct inode *g_inode_deferred;
+static spinlock_t g_inode_deferred_lock = SP_UNLOCKED;
+#endif
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: inode_dofree
+ ****************************************************************************/
+
+static void inode_dofree(FAR struct inode *inode)
+{
+#ifdef CONFIG_PSEUDOFS_SOFTLINKS
+  /* If the inode is a symbolic link, the free the path to the linked
+   * entity.
+   */
+
+  if (INODE_IS_SOFTLINK(inode) && inode->u.i_link != NULL)
+    {
+      fs_heap_free(inode->u.i_link);
+    }
+#endif
+
+  fs_heap_free(inode);
+}
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -49,6 +87,10 @@
 
 void inode_free(FAR struct inode *inode)
 {
+#ifdef CONFIG_FS_INODE_RCU
+  irqstate_t flags;
+#endif
+
   /* Verify that we were passed valid pointer to an inode */
 
   if (inode != NULL)
@@ -65,17 +107,59 @@ void inode_free(FAR struct inode *inode)
       inode_free(inode->i_peer);
       inode_free(inode->i_child);
 
-#ifdef CONFIG_PSEUDOFS_SOFTLINKS
-      /* If the inode is a symbolic link, the free the path to the linked
-       * entity.
+#ifdef CONFIG_FS_INODE_RCU
+      /* A lockless reader that started before the inode was unlinked may
+       * still be looking at it.  Defer the free until all readers left.
        */
 
-      if (INODE_IS_SOFTLINK(inode) && inode->u.i_link != NULL)
+      flags = spin_lock_irqsave(&g_inode_deferred_lock);
+      if (inode_rcu_readers() > 0)
         {
-          fs_heap_free(inode->u.i_link);
+          inode->i_child   = NULL;
+          inode->i_peer    = g_inode_deferred;
+          g_inode_deferred = inode;
+          spin_unlock_irqrestore(&g_inode_deferred_lock, flags);
+          return;
         }
+
+      spin_unlock_irqrestore(&g_inode_deferred_lock, flags);
 #endif
 
-      fs_heap_free(inode);
+      inode_dofree(inode);
+    }
+}
+
+#ifdef CONFIG_FS_INODE_RCU
+
+/****************************************************************************
+ * Name: inode_reclaim
+ *
+ * Description:
+ *   Free the inodes whose release was deferred by inode_free() because
+ *   lockless readers were active.  Does nothing while readers remain.
+ *
+ ****************************************************************************/
+
+void inode_reclaim(void)
+{
+  FAR struct inode *inode = NULL;
+  irqstate_t flags;
+
+  flags = spin_lock_irqsave(&g_inode_deferred_lock);
+  if (inode_rcu_readers() == 0)
+    {
+      inode            = g_inode_deferred;
+      g_inode_deferred = NULL;
+    }
+
+  spin_unlock_irqrestore(&g_inode_deferred_lock, flags);
+
+  while (inode != NULL)
+    {
+      FAR struct inode *next = inode->i_peer;
+
+      inode_dofree(inode);
+      inode = next;
     }
 }
+#endif
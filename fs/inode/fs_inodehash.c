@@ -0,0 +1,416 @@
+/****************************************************************************
+ * fs/inode/fs_inodehash.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+
+#include <nuttx/spinlock.h>
+#include <nuttx/fs/fs.h>
+
+#include "inode/inode.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#if (CONFIG_FS_INODE_HASH_SIZE & (CONFIG_FS_INODE_HASH_SIZE - 1)) != 0
+#  error CONFIG_FS_INODE_HASH_SIZE must be a power of two
+#endif
+
+#define INODE_HASH_MASK  (CONFIG_FS_INODE_HASH_SIZE - 1)
+
+#if CONFIG_FS_INODE_CACHE_SIZE > 0
+#  if (CONFIG_FS_INODE_CACHE_SIZE & (CONFIG_FS_INODE_CACHE_SIZE - 1)) != 0
+#    error CONFIG_FS_INODE_CACHE_SIZE must be a power of two
+#  endif
+#  define INODE_CACHE_MASK (CONFIG_FS_INODE_CACHE_SIZE - 1)
+#endif
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+#if CONFIG_FS_INODE_CACHE_SIZE > 0
+/* One entry of the direct mapped cache of absolute path lookups */
+
+struct inode_cache_s
+{
+  uint32_t hash;                /* Hash of the full path */
+  FAR struct inode *inode;      /* The terminal inode of the path */
+};
+#endif
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/* Hash table of all inodes in the pseudo file system (except the root),
+ * keyed by the parent inode and the name of the node.  The table is only
+ * modified with the inode lock held for writing, so readers holding the
+ * inode lock for reading may walk the chains without further locking.
+ */
+
+static FAR struct inode *g_inode_hash[CONFIG_FS_INODE_HASH_SIZE];
+
+#if CONFIG_FS_INODE_CACHE_SIZE > 0
+/* Concurrent readers may all update the path cache, so it has its own
+ * lock.  The whole cache is flushed whenever the tree changes.
+ */
+
+static struct inode_cache_s g_inode_cache[CONFIG_FS_INODE_CACHE_SIZE];
+static spinlock_t g_inode_cache_lock = SP_UNLOCKED;
+#endif
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: inode_namehash
+ *
+ * Description:
+ *   Hash one path segment (terminated by '/' or NUL) below 'parent'.
+ *
+ ****************************************************************************/
+
+static uint32_t inode_namehash(FAR struct inode *parent,
+                               FAR const char *name)
+{
+  uint32_t hash = (uint32_t)((uintptr_t)parent >> 3) * 2654435761u;
+
+  while (*name != '\0' && *name != '/')
+    {
+      hash = (hash ^ (uint8_t)*name++) * 16777619u;
+    }
+
+  return hash;
+}
+
+/****************************************************************************
+ * Name: inode_namecmp
+ *
+ * Description:
+ *   Return true if the path segment 'name' is the name of 'inode'.
+ *
+ ****************************************************************************/
+
+static bool inode_namecmp(FAR struct inode *inode, FAR const char *name)
+{
+  FAR const char *nname = inode->i_name;
+
+  while (*nname != '\0' && *nname == *name)
+    {
+      nname++;
+      name++;
+    }
+
+  return *nname == '\0' && (*name == '\0' || *name == '/');
+}
+
+#if CONFIG_FS_INODE_CACHE_SIZE > 0
+
+/****************************************************************************
+ * Name: inode_pathhash
+ ****************************************************************************/
+
+static uint32_t inode_pathhash(FAR const char *path, size_t len)
+{
+  uint32_t hash = 2166136261u;
+
+  while (len-- > 0)
+    {
+      hash = (hash ^ (uint8_t)*path++) * 16777619u;
+    }
+
+  return hash;
+}
+
+/****************************************************************************
+ * Name: inode_pathmatch
+ *
+ * Description:
+ *   Return true if 'path' is the absolute path of 'inode', by walking from
+ *   the inode up to the root and comparing the segments from the end of
+ *   the path.  Paths that cross a mountpoint never match.
+ *
+ ****************************************************************************/
+
+static bool inode_pathmatch(FAR struct inode *inode,
+                            FAR const char *path, size_t len)
+{
+  FAR const char *end = path + len;
+
+  while (inode != g_root_inode)
+    {
+      size_t nlen;
+
+      /* A node may have been turned into a mountpoint after it was cached,
+       * in which case the path must now resolve into the mounted volume.
+       */
+
+      if (inode == NULL || INODE_IS_MOUNTPT(inode))
+        {
+          return false;
+        }
+
+      nlen = strlen(inode->i_name);
+      if ((size_t)(end - path) < nlen + 1)
+        {
+          return false;
+        }
+
+      end -= nlen;
+      if (memcmp(end, inode->i_name, nlen) != 0 || *--end != '/')
+        {
+          return false;
+        }
+
+      inode = inode->i_parent;
+    }
+
+  return end == path;
+}
+
+/****************************************************************************
+ * Name: inode_cache_flush
+ ****************************************************************************/
+
+static void inode_cache_flush(void)
+{
+  irqstate_t flags;
+
+  flags = spin_lock_irqsave(&g_inode_cache_lock);
+  memset(g_inode_cache, 0, sizeof(g_inode_cache));
+  spin_unlock_irqrestore(&g_inode_cache_lock, flags);
+}
+#else
+#  define inode_cache_flush()
+#endif
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: inode_hash_insert
+ *
+ * Description:
+ *   Add a newly linked inode to the inode hash table.  i_parent must already
+ *   be set.
+ *
+ * Assumptions:
+ *   The caller holds the inode lock for writing.
+ *
+ ****************************************************************************/
+
+void inode_hash_insert(FAR struct inode *inode)
+{
+  FAR struct inode **bucket;
+
+  DEBUGASSERT(inode != NULL && inode->i_parent != NULL);
+
+  bucket = &g_inode_hash[inode_namehash(inode->i_parent, inode->i_name) &
+                         INODE_HASH_MASK];
+
+  inode->i_hash = *bucket;
+  inode_rcu_publish();
+  *bucket       = inode;
+
+  inode_cache_flush();
+}
+
+/****************************************************************************
+ * Name: inode_hash_remove
+ *
+ * Description:
+ *   Remove an inode from the inode hash table.  Nothing happens if the
+ *   inode is not in the table.
+ *
+ * Assumptions:
+ *   The caller holds the inode lock for writing.
+ *
+ ****************************************************************************/
+
+void inode_hash_remove(FAR struct inode *inode)
+{
+  FAR struct inode **curr;
+
+  DEBUGASSERT(inode != NULL);
+
+  if (inode->i_parent == NULL)
+    {
+      return;
+    }
+
+  curr = &g_inode_hash[inode_namehash(inode->i_parent, inode->i_name) &
+                       INODE_HASH_MASK];
+
+  for (; *curr != NULL; curr = &(*curr)->i_hash)
+    {
+      if (*curr == inode)
+        {
+          *curr         = inode->i_hash;
+          inode->i_hash = NULL;
+          inode_cache_flush();
+          break;
+        }
+    }
+}
+
+/****************************************************************************
+ * Name: inode_hash_remove_tree
+ *
+ * Description:
+ *   Remove an inode and all of its descendants from the inode hash table.
+ *   Used when a node is unlinked: its children keep their parent pointer
+ *   and would otherwise stay in the table until inode_free(), which may
+ *   run without the inode lock.
+ *
+ * Assumptions:
+ *   The caller holds the inode lock for writing.
+ *
+ ****************************************************************************/
+
+void inode_hash_remove_tree(FAR struct inode *inode)
+{
+  FAR struct inode *child;
+
+  inode_hash_remove(inode);
+
+  for (child = inode->i_child; child != NULL; child = child->i_peer)
+    {
+      inode_hash_remove_tree(child);
+    }
+}
+
+/****************************************************************************
+ * Name: inode_hash_find
+ *
+ * Description:
+ *   Find the child of 'parent' whose name is the path segment 'name' (which
+ *   is terminated by either '/' or NUL).
+ *
+ * Assumptions:
+ *   The caller holds the inode lock.
+ *
+ ****************************************************************************/
+
+FAR struct inode *inode_hash_find(FAR struct inode *parent,
+                                  FAR const char *name)
+{
+  FAR struct inode *inode;
+
+  inode = g_inode_hash[inode_namehash(parent, name) & INODE_HASH_MASK];
+  for (; inode != NULL; inode = inode->i_hash)
+    {
+      if (inode->i_parent == parent && inode_namecmp(inode, name))
+        {
+          break;
+        }
+    }
+
+  return inode;
+}
+
+#if CONFIG_FS_INODE_CACHE_SIZE > 0
+
+/****************************************************************************
+ * Name: inode_cache_find
+ *
+ * Description:
+ *   Look up an absolute path in the path cache.  Returns the terminal inode
+ *   of the path, or NULL on a miss.
+ *
+ * Assumptions:
+ *   The caller holds the inode lock.
+ *
+ ****************************************************************************/
+
+FAR struct inode *inode_cache_find(FAR const char *path)
+{
+  FAR struct inode *inode;
+  irqstate_t flags;
+  size_t len = strlen(path);
+  uint32_t hash = inode_pathhash(path, len);
+  FAR struct inode_cache_s *entry;
+
+  entry = &g_inode_cache[hash & INODE_CACHE_MASK];
+
+  flags = spin_lock_irqsave(&g_inode_cache_lock);
+  inode = entry->hash == hash ? entry->inode : NULL;
+  spin_unlock_irqrestore(&g_inode_cache_lock, flags);
+
+  /* The cache is flushed on every change to the tree, so the inode is
+   * still linked.  Confirm that it really is the one named by 'path'.
+   */
+
+  if (inode != NULL && !inode_pathmatch(inode, path, len))
+    {
+      inode = NULL;
+    }
+
+  return inode;
+}
+
+/****************************************************************************
+ * Name: inode_cache_add
+ *
+ * Description:
+ *   Remember that 'path' resolves to 'inode', unless the tree was written
+ *   since 'seq' was sampled.
+ *
+ * Assumptions:
+ *   The caller holds the inode lock.
+ *
+ ****************************************************************************/
+
+void inode_cache_add(FAR const char *path, FAR struct inode *inode,
+                     unsigned int seq)
+{
+  uint32_t hash = inode_pathhash(path, strlen(path));
+  FAR struct inode_cache_s *entry;
+  irqstate_t flags;
+
+  entry = &g_inode_cache[hash & INODE_CACHE_MASK];
+
+  /* A lockless lookup that raced with a writer may have found an inode
+   * that the writer has since unlinked, after the cache was flushed.
+   */
+
+  flags = spin_lock_irqsave(&g_inode_cache_lock);
+  if (inode_rcu_seq() == seq)
+    {
+      entry->hash  = hash;
+      entry->inode = inode;
+    }
+
+  spin_unlock_irqrestore(&g_inode_cache_lock, flags);
+}
+
+#endif /* CONFIG_FS_INODE_CACHE_SIZE > 0 */
@@ -79,6 +79,29 @@ static FAR struct inode *inode_unlink(FAR const char *path)
       inode = desc.node;
       DEBUGASSERT(inode != NULL);
 
+#ifdef CONFIG_FS_INODE_HASH
+      /* The search does not return the peer to the "left" when the node
+       * was found through the inode hash table, so look it up here.
+       */
+
+      desc.parent = inode->i_parent;
+      desc.peer   = NULL;
+      if (desc.parent->i_child != inode)
+        {
+          desc.peer = desc.parent->i_child;
+          while (desc.peer->i_peer != inode)
+            {
+              desc.peer = desc.peer->i_peer;
+            }
+        }
+
+      /* Drop the whole subtree from the hash table while the lock is
+       * held; inode_free() may later run without it.
+       */
+
+      inode_hash_remove_tree(inode);
+#endif
+
       /* If peer is non-null, then remove the node from the right of
        * of that peer node.
        */
@@ -117,6 +117,7 @@ static void inode_insert(FAR struct inode *inode,
     {
       inode->i_peer   = peer->i_peer;
       inode->i_parent = parent;
+      inode_rcu_publish();
       peer->i_peer    = inode;
     }
 
@@ -127,8 +128,11 @@ static void inode_insert(FAR struct inode *inode,
       DEBUGASSERT(parent != NULL);
       inode->i_peer   = parent->i_child;
       inode->i_parent = parent;
+      inode_rcu_publish();
       parent->i_child = inode;
     }
+
+  inode_hash_insert(inode);
 }
 
 /****************************************************************************
@@ -161,6 +161,16 @@ static int _inode_linktarget(FAR struct inode *inode,
     {
       FAR const char *link = (FAR const char *)inode->u.i_link;
 
+      /* A lockless lookup may see a link whose target was just taken over
+       * by pseudorename().
+       */
+
+      if (link == NULL)
+        {
+          ret = -ENOENT;
+          break;
+        }
+
       /* Reset and reinitialize the search descriptor.  */
 
       RELEASE_SEARCH(desc);
@@ -221,6 +231,13 @@ static int _inode_search(FAR struct inode_search_s *desc)
   FAR struct inode *left    = NULL;
   FAR struct inode *above   = NULL;
   FAR const char   *relpath = NULL;
+#ifdef CONFIG_FS_INODE_HASH
+  FAR struct inode *node;
+#endif
+#if defined(CONFIG_FS_INODE_HASH) && CONFIG_FS_INODE_CACHE_SIZE > 0
+  unsigned int seq = inode_rcu_seq();
+  bool cacheable = true;
+#endif
   int ret = -ENOENT;
 
   /* Get the search path, skipping over the leading '/'.  The leading '/' is
@@ -235,6 +252,23 @@ static int _inode_search(FAR struct inode_search_s *desc)
       return -EINVAL;
     }
 
+#if defined(CONFIG_FS_INODE_HASH) && CONFIG_FS_INODE_CACHE_SIZE > 0
+  /* Hot absolute paths resolve directly through the path cache */
+
+  inode = inode_cache_find(name);
+  if (inode != NULL)
+    {
+      desc->path    = name + strlen(name);
+      desc->node    = inode;
+      desc->peer    = NULL;
+      desc->parent  = inode->i_parent;
+      desc->relpath = desc->path;
+      return OK;
+    }
+
+  inode = g_root_inode;
+#endif
+
   /* Traverse the pseudo file system node tree until either (1) all nodes
    * have been examined without finding the matching node, or (2) the
    * matching node is found.
@@ -242,7 +276,25 @@ static int _inode_search(FAR struct inode_search_s *desc)
 
   while (inode != NULL)
     {
-      int result = _inode_compare(name, inode);
+      int result;
+
+#ifdef CONFIG_FS_INODE_HASH
+      /* At the head of each level, try the hash table first.  On a miss,
+       * fall through to the ordered walk so that the insertion point is
+       * still returned in 'left'.
+       */
+
+      if (left == NULL && above != NULL &&
+          (node = inode_hash_find(above, name)) != NULL)
+        {
+          inode  = node;
+          result = 0;
+        }
+      else
+#endif
+        {
+          result = _inode_compare(name, inode);
+        }
 
       /* Case 1:  The name is less than the name of the node.
        * Since the names are ordered, these means that there
@@ -306,6 +358,10 @@ static int _inode_search(FAR struct inode_search_s *desc)
                 {
                   int status;
 
+#if defined(CONFIG_FS_INODE_HASH) && CONFIG_FS_INODE_CACHE_SIZE > 0
+                  cacheable = false;
+#endif
+
                   /* If this intermediate inode in the is a soft link, then
                    * (1) recursively look-up the inode referenced by the
                    * soft link, and (2) continue searching with that inode
@@ -407,6 +463,14 @@ static int _inode_search(FAR struct inode_search_s *desc)
    *   (4) When the node matching the full path is found
    */
 
+#if defined(CONFIG_FS_INODE_HASH) && CONFIG_FS_INODE_CACHE_SIZE > 0
+  if (ret == OK && cacheable && *name == '\0' &&
+      inode != g_root_inode && !INODE_IS_MOUNTPT(inode))
+    {
+      inode_cache_add(desc->path, inode, seq);
+    }
+#endif
+
   desc->path    = name;
   desc->node    = inode;
   desc->peer    = left;
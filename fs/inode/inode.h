@@ -38,6 +38,7 @@
 
 #include <nuttx/kmalloc.h>
 #include <nuttx/sched.h>
+#include <nuttx/spinlock.h>
 #include <nuttx/fs/fs.h>
 #include <nuttx/lib/lib.h>
 
@@ -71,6 +72,17 @@
     } \
   while (0)
 
+/* Order the initialization of an inode before it is linked into the tree,
+ * so that lockless readers never see a half built node.
+ */
+
+#ifdef CONFIG_FS_INODE_RCU
+#  define inode_rcu_publish() SP_DMB()
+#else
+#  define inode_rcu_publish()
+#  define inode_rcu_seq()     0
+#endif
+
 #if CONFIG_FS_BACKTRACE > 0
 #  define FS_ADD_BACKTRACE(filep) \
      do \
@@ -211,6 +223,58 @@ void inode_unlock(void);
 
 void inode_runlock(void);
 
+#ifdef CONFIG_FS_INODE_RCU
+
+/****************************************************************************
+ * Name: inode_rcu_read_lock and inode_rcu_read_unlock
+ *
+ * Description:
+ *   Bracket a lookup that walks the inode tree without taking the inode
+ *   lock.  inode_rcu_read_lock() returns the write sequence of the tree,
+ *   which is odd while a writer holds it.  inode_rcu_read_unlock() returns
+ *   true only if no writer was active during the section; otherwise the
+ *   result of the lookup must be discarded and the lookup repeated with the
+ *   inode lock held.  Inodes are not freed while any such section is
+ *   active.
+ *
+ ****************************************************************************/
+
+unsigned int inode_rcu_read_lock(void);
+bool inode_rcu_read_unlock(unsigned int seq);
+
+/****************************************************************************
+ * Name: inode_rcu_seq
+ *
+ * Description:
+ *   Return the current write sequence of the inode tree.
+ *
+ ****************************************************************************/
+
+unsigned int inode_rcu_seq(void);
+
+/****************************************************************************
+ * Name: inode_rcu_readers
+ *
+ * Description:
+ *   Return the number of active lockless read side sections.
+ *
+ ****************************************************************************/
+
+int inode_rcu_readers(void);
+
+/****************************************************************************
+ * Name: inode_reclaim
+ *
+ * Description:
+ *   Free the inodes whose release was deferred by inode_free() because
+ *   lockless readers were active.  Does nothing while readers remain.
+ *
+ ****************************************************************************/
+
+void inode_reclaim(void);
+
+#endif /* CONFIG_FS_INODE_RCU */
+
 /****************************************************************************
  * Name: inode_search
  *
@@ -325,6 +389,52 @@ int inode_getpath(FAR struct inode *inode, FAR char *path, size_t len);
 
 void inode_free(FAR struct inode *inode);
 
+/****************************************************************************
+ * Name: inode_hash_insert, inode_hash_remove[_tree] and inode_hash_find
+ *
+ * Description:
+ *   Maintain and query the hash table of pseudo file system inodes, keyed
+ *   by the parent inode and the node name.  'name' of inode_hash_find() is
+ *   a path segment terminated by either '/' or NUL.
+ *   inode_hash_remove_tree() also removes all descendants of the inode.
+ *
+ * Assumptions:
+ *   The caller holds the inode lock, for writing when modifying the table.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_FS_INODE_HASH
+void inode_hash_insert(FAR struct inode *inode);
+void inode_hash_remove(FAR struct inode *inode);
+void inode_hash_remove_tree(FAR struct inode *inode);
+FAR struct inode *inode_hash_find(FAR struct inode *parent,
+                                  FAR const char *name);
+#else
+#  define inode_hash_insert(inode)
+#  define inode_hash_remove(inode)
+#  define inode_hash_remove_tree(inode)
+#endif
+
+/****************************************************************************
+ * Name: inode_cache_find and inode_cache_add
+ *
+ * Description:
+ *   Look up or record the terminal inode of an absolute path in the path
+ *   cache.  The cache is flushed by any change to the inode hash table.
+ *   'seq' is the inode_rcu_seq() sampled before the lookup started; the
+ *   entry is only recorded if the tree has not been written since.
+ *
+ * Assumptions:
+ *   The caller holds the inode lock.
+ *
+ ****************************************************************************/
+
+#if defined(CONFIG_FS_INODE_HASH) && CONFIG_FS_INODE_CACHE_SIZE > 0
+FAR struct inode *inode_cache_find(FAR const char *path);
+void inode_cache_add(FAR const char *path, FAR struct inode *inode,
+                     unsigned int seq);
+#endif
+
 /****************************************************************************
  * Name: inode_nextname
  *
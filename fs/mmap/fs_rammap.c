@@ -27,101 +27,391 @@
 #include <nuttx/config.h>
 #include <sys/types.h>
 #include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/param.h>
 
 #include <assert.h>
 #include <debug.h>
 #include <errno.h>
+#include <fcntl.h>
 #include <inttypes.h>
+#include <limits.h>
 #include <string.h>
 #include <unistd.h>
 
 #include <nuttx/fs/fs.h>
+#include <nuttx/fs/ioctl.h>
 #include <nuttx/kmalloc.h>
+#include <nuttx/mutex.h>
+#include <nuttx/nuttx.h>
+#include <nuttx/queue.h>
 #include <nuttx/sched.h>
 
 #include "fs_rammap.h"
+#include "inode/inode.h"
 #include "sched/sched.h"
 #include "fs_heap.h"
 
 /****************************************************************************
- * Public Data
+ * Pre-processor Definitions
  ****************************************************************************/
 
+#define RAMMAP_PAGESIZE    CONFIG_FS_RAMMAP_PAGESIZE
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* One copy of a range of a file in memory.  All shared mappings of the
+ * same file that fall into the range use the same copy.  The file is
+ * identified by its inode, and for a file on a mountpoint also by its path
+ * relative to the mountpoint.
+ */
+
+struct rammap_region_s
+{
+  sq_entry_t node;            /* Entry in g_rammap_regions */
+  FAR struct file *filep;     /* Referenced file used for writeback */
+  FAR struct inode *inode;    /* Inode of the file, NULL if not shared */
+  FAR char *path;             /* Path in the mountpoint, or NULL */
+  FAR uint8_t *buffer;        /* The file data in memory */
+  off_t offset;               /* File offset of buffer[0] */
+  size_t length;              /* Length of the buffer */
+  unsigned int refs;          /* Number of mappings of the region */
+  enum mm_map_type_e type;    /* Where the buffer was allocated */
+  bool writeback;             /* Written back when the last mapping goes */
+  bool loading;               /* Still being read, not shared yet */
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/* The lock is recursive: writing a region back re-enters through
+ * rammap_invalidate().
+ */
+
+static rmutex_t g_rammap_lock = NXRMUTEX_INITIALIZER;
+static sq_queue_t g_rammap_regions;
+
+/* The region being written back, which stays valid */
+
+static FAR struct rammap_region_s *g_rammap_writer;
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
 
 /****************************************************************************
- * Name: msync_rammap
+ * Name: rammap_write
  ****************************************************************************/
 
-static int msync_rammap(FAR struct mm_map_entry_s *entry, FAR void *start,
-                        size_t length, int flags)
+static int rammap_write(FAR struct rammap_region_s *region, size_t offset,
+                        size_t length)
 {
-  FAR struct file *filep = (FAR void *)((uintptr_t)entry->priv.p & ~3);
-  FAR uint8_t *wrbuffer = start;
-  ssize_t nwrite = 0;
-  off_t offset;
-  off_t fpos;
-  off_t opos;
+  FAR const uint8_t *wrbuffer = region->buffer + offset;
+  off_t fpos = region->offset + offset;
+  ssize_t nwrite;
 
-  offset = (uintptr_t)start - (uintptr_t)entry->vaddr;
-  if (length > entry->length - offset)
+  while (length > 0)
     {
-      length = entry->length - offset;
+      nwrite = file_pwrite(region->filep, wrbuffer, length, fpos);
+      if (nwrite < 0)
+        {
+          /* Handle the special case where the write was interrupted by a
+           * signal.
+           */
+
+          if (nwrite == -EINTR)
+            {
+              continue;
+            }
+
+          /* All other write errors are bad. */
+
+          ferr("ERROR: Write failed: offset=%" PRIdOFF " nwrite=%zd\n",
+               fpos, nwrite);
+          return nwrite;
+        }
+
+      /* Increment number of bytes written */
+
+      wrbuffer += nwrite;
+      fpos     += nwrite;
+      length   -= nwrite;
     }
 
-  opos = file_seek(filep, 0, SEEK_CUR);
-  if (opos < 0)
+  return OK;
+}
+
+/****************************************************************************
+ * Name: rammap_changed
+ *
+ * Description:
+ *   Return true if a page of the region differs from the file.  The part
+ *   of the page beyond the end of the file matches if it is zero, as it
+ *   was when the file was read.
+ *
+ ****************************************************************************/
+
+static bool rammap_changed(FAR struct rammap_region_s *region,
+                           size_t offset, size_t length,
+                           FAR uint8_t *page)
+{
+  FAR const uint8_t *data = region->buffer + offset;
+  ssize_t nread;
+  size_t i;
+
+  do
     {
-      ferr("ERROR: Get current position failed\n");
-      return opos;
+      nread = file_pread(region->filep, page, length,
+                         region->offset + offset);
     }
+  while (nread == -EINTR);
 
-  fpos = file_seek(filep, entry->offset + offset, SEEK_SET);
-  if (fpos < 0)
+  if (nread < 0 || memcmp(data, page, nread) != 0)
     {
-      ferr("ERROR: Seek to position %"PRIdOFF" failed\n", fpos);
-      return fpos;
+      return true;
     }
 
-  while (length > 0)
+  for (i = nread; i < length; i++)
     {
-      nwrite = file_write(filep, wrbuffer, length);
-      if (nwrite < 0)
+      if (data[i] != 0)
         {
-          /* Handle the special case where the write was interrupted by a
-           * signal.
-           */
+          return true;
+        }
+    }
 
-          if (nwrite != -EINTR)
-            {
-              /* All other write errors are bad. */
+  return false;
+}
 
-              ferr("ERROR: Write failed: offset=%"PRIdOFF" nwrite=%zd\n",
-                   entry->offset, nwrite);
+/****************************************************************************
+ * Name: rammap_sync
+ *
+ * Description:
+ *   Write a range of the region back to the file.  Nothing records which
+ *   pages were modified through the mapping, so each page is compared with
+ *   the file and only the pages that differ are written.  Must be called
+ *   with g_rammap_lock held.
+ *
+ ****************************************************************************/
+
+static int rammap_sync(FAR struct rammap_region_s *region, size_t offset,
+                       size_t length)
+{
+  FAR uint8_t *page;
+  size_t index;
+  size_t end;
+  size_t len;
+  int ret = OK;
+
+  g_rammap_writer = region;
+
+  /* Without a page to compare with, write the whole range */
+
+  page = fs_heap_malloc(RAMMAP_PAGESIZE);
+  if (page == NULL)
+    {
+      ret = rammap_write(region, offset, length);
+      g_rammap_writer = NULL;
+      return ret;
+    }
+
+  end = offset + length;
+  for (index = offset / RAMMAP_PAGESIZE; index * RAMMAP_PAGESIZE < end;
+       index++)
+    {
+      offset = index * RAMMAP_PAGESIZE;
+      len    = MIN(RAMMAP_PAGESIZE, region->length - offset);
+      if (rammap_changed(region, offset, len, page))
+        {
+          ret = rammap_write(region, offset, len);
+          if (ret < 0)
+            {
               break;
             }
         }
+    }
 
-      /* Increment number of bytes written */
+  g_rammap_writer = NULL;
+  fs_heap_free(page);
+  return ret;
+}
 
-      wrbuffer += nwrite;
-      length   -= nwrite;
+/****************************************************************************
+ * Name: rammap_release
+ *
+ * Description:
+ *   Drop one reference to the region.  The last reference writes the dirty
+ *   pages of a shared writable region back and frees the region.
+ *
+ ****************************************************************************/
+
+static int rammap_release(FAR struct rammap_region_s *region)
+{
+  int ret = OK;
+
+  nxrmutex_lock(&g_rammap_lock);
+  if (--region->refs > 0)
+    {
+      nxrmutex_unlock(&g_rammap_lock);
+      return OK;
+    }
+
+  if (region->inode != NULL)
+    {
+      sq_rem(&region->node, &g_rammap_regions);
+      region->inode = NULL;
+    }
+
+  if (region->writeback)
+    {
+      ret = rammap_sync(region, 0, region->length);
+    }
+
+  nxrmutex_unlock(&g_rammap_lock);
+
+  if (region->type == MAP_KERNEL)
+    {
+      fs_heap_free(region->buffer);
+    }
+  else if (region->type == MAP_USER)
+    {
+      kumm_free(region->buffer);
+    }
+
+  if (region->filep != NULL)
+    {
+      fs_putfilep(region->filep);
+    }
+
+  fs_heap_free(region->path);
+  fs_heap_free(region);
+  return ret;
+}
+
+/****************************************************************************
+ * Name: rammap_find
+ *
+ * Description:
+ *   Find a shared region holding the range of the file to be mapped and
+ *   take a reference to it.
+ *
+ ****************************************************************************/
+
+static FAR struct rammap_region_s *
+rammap_find(FAR struct inode *inode, FAR const char *path,
+            FAR struct mm_map_entry_s *entry, enum mm_map_type_e type)
+{
+  FAR struct rammap_region_s *region;
+  FAR sq_entry_t *node;
+
+  nxrmutex_lock(&g_rammap_lock);
+  sq_for_every(&g_rammap_regions, node)
+    {
+      region = container_of(node, struct rammap_region_s, node);
+      if (region->inode != inode || region->type != type ||
+          region->loading ||
+          (path != NULL && strcmp(region->path, path) != 0) ||
+          entry->offset < region->offset ||
+          entry->offset + entry->length > region->offset + region->length)
+        {
+          continue;
+        }
+
+      /* A writable mapping needs a region that can be written back */
+
+      if ((entry->prot & PROT_WRITE) != 0 && !region->writeback)
+        {
+          continue;
+        }
+
+      region->refs++;
+      nxrmutex_unlock(&g_rammap_lock);
+      return region;
     }
 
-  /* Restore file pos */
+  nxrmutex_unlock(&g_rammap_lock);
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: rammap_shared
+ *
+ * Description:
+ *   Return true if a mapping may share its region with other mappings of
+ *   the same file.  Shared regions must be visible to every process
+ *   mapping the file, so user regions are not shared in the KERNEL build
+ *   where each process has its own user heap.  A file on a mountpoint is
+ *   told apart by its path, which is returned in 'path'.
+ *
+ ****************************************************************************/
 
-  fpos = file_seek(filep, opos, SEEK_SET);
-  if (fpos < 0)
+static bool rammap_shared(FAR struct file *filep,
+                          FAR struct mm_map_entry_s *entry,
+                          enum mm_map_type_e type, FAR char **path)
+{
+  *path = NULL;
+
+  if ((entry->flags & MAP_SHARED) == 0)
     {
-      /* Ensure that we finally seek back to the current file pos */
+      return false;
+    }
 
-      ferr("ERROR: Seek back to position %"PRIdOFF" failed\n", fpos);
-      return fpos;
+#ifdef CONFIG_BUILD_KERNEL
+  if (type != MAP_KERNEL)
+    {
+      return false;
     }
+#endif
+
+#ifndef CONFIG_DISABLE_MOUNTPOINT
+  if (INODE_IS_MOUNTPT(filep->f_inode))
+    {
+      *path = fs_heap_malloc(PATH_MAX);
+      if (*path == NULL)
+        {
+          return false;
+        }
 
-  return nwrite >= 0 ? 0 : nwrite;
+      if (file_ioctl(filep, FIOC_FILEPATH, (unsigned long)*path) < 0)
+        {
+          fs_heap_free(*path);
+          *path = NULL;
+          return false;
+        }
+    }
+#endif
+
+  return true;
+}
+
+/****************************************************************************
+ * Name: msync_rammap
+ ****************************************************************************/
+
+static int msync_rammap(FAR struct mm_map_entry_s *entry, FAR void *start,
+                        size_t length, int flags)
+{
+  FAR struct rammap_region_s *region = entry->priv.p;
+  size_t offset;
+  int ret;
+
+  offset = (uintptr_t)start - (uintptr_t)entry->vaddr;
+  if (length > entry->length - offset)
+    {
+      length = entry->length - offset;
+    }
+
+  /* Convert the offset in the mapping to an offset in the region */
+
+  offset += (FAR uint8_t *)entry->vaddr - region->buffer;
+
+  nxrmutex_lock(&g_rammap_lock);
+  ret = rammap_sync(region, offset, length);
+  nxrmutex_unlock(&g_rammap_lock);
+
+  return ret;
 }
 
 /****************************************************************************
@@ -133,9 +423,7 @@ static int unmap_rammap(FAR struct task_group_s *group,
                         FAR void *start,
                         size_t length)
 {
-  FAR struct file *filep = (FAR void *)((uintptr_t)entry->priv.p & ~3);
-  enum mm_map_type_e type =
-                    (enum mm_map_type_e)((uintptr_t)entry->priv.p & 3);
+  FAR struct rammap_region_s *region = entry->priv.p;
   FAR void *newaddr = NULL;
   off_t offset;
   int ret = OK;
@@ -154,52 +442,63 @@ static int unmap_rammap(FAR struct task_group_s *group,
       return -ENOSYS;
     }
 
-  /* Okay.. the region is being unmapped to the end.  Make sure the length
-   * indicates that.
-   */
-
-  length = entry->length - offset;
-
   /* Are we unmapping the entire region (offset == 0)? */
 
-  if (length >= entry->length)
+  if (offset == 0)
     {
-      /* Free the region */
+      /* Remove the mapping from the list, then drop the reference to the
+       * region.  This frees the region if it was the last mapping.
+       */
 
-      if (type == MAP_KERNEL)
-        {
-          fs_heap_free(entry->vaddr);
-        }
-      else if (type == MAP_USER)
+      int status;
+
+      ret    = mm_map_remove(get_group_mm(group), entry);
+      status = rammap_release(region);
+      if (ret >= 0)
         {
-          kumm_free(entry->vaddr);
+          ret = status;
         }
-
-      fs_putfilep(filep);
-
-      /* Then remove the mapping from the list */
-
-      ret = mm_map_remove(get_group_mm(group), entry);
     }
 
   /* No.. We have been asked to "unmap' only a portion of the memory
-   * (offset > 0).
+   * (offset > 0).  Shrink the copy if no other mapping can use it, after
+   * writing back the dirty pages that are dropped.
    */
 
   else
     {
-      if (type == MAP_KERNEL)
+      nxrmutex_lock(&g_rammap_lock);
+      if (region->inode == NULL && region->refs == 1 &&
+          entry->vaddr == region->buffer)
         {
-          newaddr = fs_heap_realloc(entry->vaddr, length);
-        }
-      else if (type == MAP_USER)
-        {
-          newaddr = kumm_realloc(entry->vaddr, length);
+          if (region->writeback)
+            {
+              ret = rammap_sync(region, offset, region->length - offset);
+              if (ret < 0)
+                {
+                  nxrmutex_unlock(&g_rammap_lock);
+                  return ret;
+                }
+            }
+
+          if (region->type == MAP_KERNEL)
+            {
+              newaddr = fs_heap_realloc(region->buffer, offset);
+            }
+          else if (region->type == MAP_USER)
+            {
+              newaddr = kumm_realloc(region->buffer, offset);
+            }
+
+          if (newaddr != NULL)
+            {
+              DEBUGASSERT(newaddr == region->buffer);
+              region->length = offset;
+            }
         }
 
-      DEBUGASSERT(newaddr == entry->vaddr);
-      entry->vaddr = newaddr;
-      entry->length = length;
+      nxrmutex_unlock(&g_rammap_lock);
+      entry->length = offset;
     }
 
   return ret;
@@ -237,63 +536,91 @@ static int unmap_rammap(FAR struct task_group_s *group,
 int rammap(FAR struct file *filep, FAR struct mm_map_entry_s *entry,
            enum mm_map_type_e type)
 {
+  FAR struct rammap_region_s *region;
   FAR uint8_t *rdbuffer;
+  FAR char *path = NULL;
+  size_t length = entry->length;
   ssize_t nread;
   off_t fpos;
+  bool shared = false;
   int ret;
-  size_t length = entry->length;
+
+  region = fs_heap_zalloc(sizeof(*region));
+  if (region == NULL)
+    {
+      return -ENOMEM;
+    }
+
+  region->offset = entry->offset;
+  region->length = length;
+  region->refs   = 1;
 
   ret = file_ioctl(filep, BIOC_XIPBASE, (unsigned long)&entry->vaddr);
   if (ret == OK)
     {
-      type = MAP_XIP;
+      region->type   = MAP_XIP;
+      region->buffer = entry->vaddr;
       goto out;
     }
 
-  /* There is a major design flaw that I have not yet thought of fix for:
-   * The goal is to have a single region of memory that represents a single
-   * file and can be shared by many threads.  That is, given a filename a
-   * thread should be able to open the file, get a file descriptor, and
-   * call mmap() to get a memory region.  Different file descriptors opened
-   * with the same file path should get the same memory region when mapped.
-   *
-   * The design flaw is that I don't have sufficient knowledge to know that
-   * these different file descriptors map to the same file.  So, for the time
-   * being, a new memory region is created each time that rammap() is called.
-   * Not very useful!
-   */
+  /* Shared mappings of the same file use the same copy of the file */
+
+  shared = rammap_shared(filep, entry, type, &path);
+  if (shared)
+    {
+      FAR struct rammap_region_s *found;
+
+      found = rammap_find(filep->f_inode, path, entry, type);
+      if (found != NULL)
+        {
+          fs_heap_free(path);
+          fs_heap_free(region);
+
+          region       = found;
+          entry->vaddr = region->buffer + (entry->offset - region->offset);
+          goto add;
+        }
+    }
 
   /* Allocate a region of memory of the specified size */
 
+  region->type      = type;
+  region->writeback = (entry->flags & MAP_SHARED) != 0 &&
+                      (entry->prot & PROT_WRITE) != 0;
   rdbuffer = type == MAP_KERNEL ? fs_heap_malloc(length)
                                 : kumm_malloc(length);
   if (!rdbuffer)
     {
       ferr("ERROR: Region allocation failed, length: %zu\n", length);
+      fs_heap_free(path);
+      fs_heap_free(region);
       return -ENOMEM;
     }
 
-  entry->vaddr = rdbuffer; /* save the buffer firstly */
+  region->buffer = rdbuffer;
+  entry->vaddr   = rdbuffer;
 
-  /* Seek to the specified file offset */
+  /* List the region before the file is read, so that rammap_invalidate()
+   * sees it if the file changes meanwhile.  It is only shared once read.
+   */
 
-  fpos = file_seek(filep, entry->offset, SEEK_SET);
-  if (fpos < 0)
+  if (shared)
     {
-      /* Seek failed... errno has already been set, but EINVAL is probably
-       * the correct response.
-       */
-
-      ferr("ERROR: Seek to position %zu failed\n", (size_t)entry->offset);
-      ret = fpos;
-      goto errout_with_region;
+      nxrmutex_lock(&g_rammap_lock);
+      region->inode   = filep->f_inode;
+      region->path    = path;
+      region->loading = true;
+      path            = NULL;
+      sq_addlast(&region->node, &g_rammap_regions);
+      nxrmutex_unlock(&g_rammap_lock);
     }
 
   /* Read the file data into the memory region */
 
+  fpos = entry->offset;
   while (length > 0)
     {
-      nread = file_read(filep, rdbuffer, length);
+      nread = file_pread(filep, rdbuffer, length, fpos);
       if (nread < 0)
         {
           /* Handle the special case where the read was interrupted by a
@@ -310,6 +637,8 @@ int rammap(FAR struct file *filep, FAR struct mm_map_entry_s *entry,
               ret = nread;
               goto errout_with_region;
             }
+
+          continue;
         }
 
       /* Check for end of file. */
@@ -322,6 +651,7 @@ int rammap(FAR struct file *filep, FAR struct mm_map_entry_s *entry,
       /* Increment number of bytes read */
 
       rdbuffer += nread;
+      fpos     += nread;
       length   -= nread;
     }
 
@@ -329,31 +659,93 @@ int rammap(FAR struct file *filep, FAR struct mm_map_entry_s *entry,
 
   memset(rdbuffer, 0, length);
 
-  /* Add the buffer to the list of regions */
-
 out:
   fs_reffilep(filep);
-  entry->priv.p = (FAR void *)((uintptr_t)filep | type);
+  region->filep = filep;
+
+  /* Share the region with later mappings, unless the file changed while
+   * it was read and rammap_invalidate() took it off the list.
+   */
+
+  if (shared)
+    {
+      nxrmutex_lock(&g_rammap_lock);
+      region->loading = false;
+      nxrmutex_unlock(&g_rammap_lock);
+    }
+
+add:
+  entry->priv.p = region;
   entry->munmap = unmap_rammap;
   entry->msync = msync_rammap;
 
   ret = mm_map_add(get_current_mm(), entry);
   if (ret < 0)
     {
-      goto errout_with_region;
+      rammap_release(region);
     }
 
-  return OK;
+  return ret;
 
 errout_with_region:
+  if (region->inode != NULL)
+    {
+      nxrmutex_lock(&g_rammap_lock);
+      if (region->inode != NULL)
+        {
+          sq_rem(&region->node, &g_rammap_regions);
+        }
+
+      nxrmutex_unlock(&g_rammap_lock);
+    }
+
   if (type == MAP_KERNEL)
     {
-      fs_heap_free(entry->vaddr);
+      fs_heap_free(region->buffer);
     }
   else if (type == MAP_USER)
     {
-      kumm_free(entry->vaddr);
+      kumm_free(region->buffer);
     }
 
+  fs_heap_free(region->path);
+  fs_heap_free(path);
+  fs_heap_free(region);
   return ret;
 }
+
+/****************************************************************************
+ * Name: rammap_invalidate
+ *
+ * Description:
+ *   Stop sharing the regions of a file that changed other than through
+ *   its mappings, so that later mappings read the file again.  Existing
+ *   mappings keep their copy, and a region still being read is never
+ *   shared.  Nothing is done unless some file has a shared region.
+ *
+ ****************************************************************************/
+
+void rammap_invalidate(FAR struct inode *inode)
+{
+  FAR struct rammap_region_s *region;
+  FAR sq_entry_t *node;
+  FAR sq_entry_t *next;
+
+  if (sq_empty(&g_rammap_regions))
+    {
+      return;
+    }
+
+  nxrmutex_lock(&g_rammap_lock);
+  sq_for_every_safe(&g_rammap_regions, node, next)
+    {
+      region = container_of(node, struct rammap_region_s, node);
+      if (region->inode == inode && region != g_rammap_writer)
+        {
+          sq_rem(&region->node, &g_rammap_regions);
+          region->inode = NULL;
+        }
+    }
+
+  nxrmutex_unlock(&g_rammap_lock);
+}
@@ -32,8 +32,11 @@
  * - All of the file must be present in memory.  This limits the size of
  *   files that may be memory mapped (especially on MCUs with no significant
  *   RAM resources).
- * - All mapped files are read-only.  You can write to the in-memory image,
- *   but the file contents will not change.
+ * - Changes to the in-memory image are only written to the file by msync()
+ *   and, for shared writable mappings, by the final munmap().  Only the
+ *   pages modified since they were read or written are written back.
+ * - Shared mappings of the same file use the same in-memory image until the
+ *   file is changed by other means than the mappings.
  * - There are not access privileges.
  */
 
@@ -99,8 +102,24 @@ enum mm_map_type_e
 
 int rammap(FAR struct file *filep, FAR struct mm_map_entry_s *entry,
            enum mm_map_type_e type);
+
+/****************************************************************************
+ * Name: rammap_invalidate
+ *
+ * Description:
+ *   Called by the VFS after a file was written, truncated, unlinked or
+ *   renamed.  Later mappings of the file no longer share the in-memory
+ *   image of earlier ones but read the file again.
+ *
+ * Input Parameters:
+ *   inode - The inode of the file, or of the mountpoint holding it
+ *
+ ****************************************************************************/
+
+void rammap_invalidate(FAR struct inode *inode);
 #else
 #  define rammap(file, entry, type) (-ENOSYS)
+#  define rammap_invalidate(inode)
 #endif /* CONFIG_FS_RAMMAP */
 
 #endif /* __FS_MMAP_FS_RAMMAP_H */
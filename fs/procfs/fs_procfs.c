@@ -82,6 +82,7 @@ extern const struct procfs_operations g_pressure_operations;
  * configuration.
  */
 
+extern const struct procfs_operations g_bcache_operations;
 extern const struct procfs_operations g_mount_operations;
 extern const struct procfs_operations g_net_operations;
 extern const struct procfs_operations g_netroute_operations;
@@ -130,6 +131,11 @@ static const struct procfs_entry_s g_procfs_entries[] =
   { "fdt",          &g_fdt_operations,      PROCFS_FILE_TYPE   },
 #endif
 
+#if defined(CONFIG_FS_BLOCKCACHE) && \
+    !defined(CONFIG_FS_PROCFS_EXCLUDE_BLOCKCACHE)
+  { "fs/blockcache", &g_bcache_operations,  PROCFS_FILE_TYPE   },
+#endif
+
 #ifndef CONFIG_FS_PROCFS_EXCLUDE_BLOCKS
   { "fs/blocks",    &g_mount_operations,    PROCFS_FILE_TYPE   },
 #endif
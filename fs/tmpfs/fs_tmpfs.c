@@ -26,6 +26,7 @@
 
 #include <nuttx/config.h>
 
+#include <sys/param.h>
 #include <sys/stat.h>
 #include <sys/statfs.h>
 #include <stdint.h>
@@ -54,7 +55,10 @@
 #  warning CONFIG_FS_TMPFS_DIRECTORY_FREEGUARD needs to be > ALLOCGUARD
 #endif
 
-#if CONFIG_FS_TMPFS_FILE_FREEGUARD <= CONFIG_FS_TMPFS_FILE_ALLOCGUARD
+#ifdef CONFIG_FS_TMPFS_PAGED
+#  define TMPFS_PAGESIZE     CONFIG_FS_TMPFS_PAGESIZE
+#  define TMPFS_NPAGES(size) (((size) + TMPFS_PAGESIZE - 1) / TMPFS_PAGESIZE)
+#elif CONFIG_FS_TMPFS_FILE_FREEGUARD <= CONFIG_FS_TMPFS_FILE_ALLOCGUARD
 #  warning CONFIG_FS_TMPFS_FILE_FREEGUARD needs to be > ALLOCGUARD
 #endif
 
@@ -96,6 +100,15 @@ static int  tmpfs_realloc_directory(FAR struct tmpfs_directory_s *tdo,
               unsigned int nentries);
 static int  tmpfs_realloc_file(FAR struct tmpfs_file_s *tfo,
               size_t newsize);
+#ifdef CONFIG_FS_TMPFS_PAGED
+static FAR uint8_t *tmpfs_alloc_page(FAR struct tmpfs_file_s *tfo,
+              size_t index);
+static void tmpfs_read_pages(FAR struct tmpfs_file_s *tfo,
+              FAR char *buffer, size_t pos, size_t len);
+static size_t tmpfs_write_pages(FAR struct tmpfs_file_s *tfo,
+              FAR const char *buffer, size_t pos, size_t len);
+#endif
+static void tmpfs_free_data(FAR struct tmpfs_file_s *tfo);
 static void tmpfs_release_lockedobject(FAR struct tmpfs_object_s *to);
 static void tmpfs_release_lockedfile(FAR struct tmpfs_file_s *tfo);
 static int  tmpfs_release_file(FAR struct tmpfs_file_s *tfo);
@@ -272,6 +285,207 @@ static int tmpfs_realloc_directory(FAR struct tmpfs_directory_s *tdo,
  * Name: tmpfs_realloc_file
  ****************************************************************************/
 
+#ifdef CONFIG_FS_TMPFS_PAGED
+static int tmpfs_realloc_file(FAR struct tmpfs_file_s *tfo,
+                              size_t newsize)
+{
+  FAR uint8_t **newpages;
+  size_t npages;
+  size_t offset;
+  size_t count;
+  size_t i;
+
+  if (newsize > SIZE_MAX - TMPFS_PAGESIZE)
+    {
+      return -ENOMEM;
+    }
+
+  npages = TMPFS_NPAGES(newsize);
+
+  /* Are we growing or shrinking the object? */
+
+  if (newsize < tfo->tfo_size)
+    {
+      /* Shrinking ... Free the pages beyond the new end of the file */
+
+      for (i = npages; i < tfo->tfo_npages; i++)
+        {
+          if (tfo->tfo_pages[i] != NULL)
+            {
+              fs_heap_free(tfo->tfo_pages[i]);
+              tfo->tfo_pages[i] = NULL;
+              tfo->tfo_alloc -= TMPFS_PAGESIZE;
+            }
+        }
+
+      /* Data beyond the end of the file must read back as zero if the
+       * file grows again.
+       */
+
+      offset = newsize % TMPFS_PAGESIZE;
+      if (offset != 0 && tfo->tfo_pages[npages - 1] != NULL)
+        {
+          memset(tfo->tfo_pages[npages - 1] + offset, 0,
+                 TMPFS_PAGESIZE - offset);
+        }
+
+      if (npages == 0)
+        {
+          fs_heap_free(tfo->tfo_pages);
+          tfo->tfo_pages  = NULL;
+          tfo->tfo_npages = 0;
+        }
+    }
+  else if (npages > tfo->tfo_npages)
+    {
+      /* Growing ... Only the page table is reallocated, the pages are
+       * allocated when they are first written.  Double the table to
+       * account for frequent appends.
+       */
+
+      count = tfo->tfo_npages * 2;
+      if (count < npages)
+        {
+          count = npages;
+        }
+
+      if (count > SIZE_MAX / sizeof(FAR uint8_t *))
+        {
+          return -ENOMEM;
+        }
+
+      newpages = fs_heap_realloc(tfo->tfo_pages,
+                                 count * sizeof(FAR uint8_t *));
+      if (newpages == NULL)
+        {
+          return -ENOMEM;
+        }
+
+      memset(&newpages[tfo->tfo_npages], 0,
+             (count - tfo->tfo_npages) * sizeof(FAR uint8_t *));
+      tfo->tfo_pages  = newpages;
+      tfo->tfo_npages = count;
+    }
+
+  tfo->tfo_size = newsize;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: tmpfs_alloc_page
+ *
+ * Description:
+ *   Return the page at 'index' of the page table, allocating a zeroed page
+ *   if it is still a hole.
+ *
+ ****************************************************************************/
+
+static FAR uint8_t *tmpfs_alloc_page(FAR struct tmpfs_file_s *tfo,
+                                     size_t index)
+{
+  DEBUGASSERT(index < tfo->tfo_npages);
+
+  if (tfo->tfo_pages[index] == NULL)
+    {
+      tfo->tfo_pages[index] = fs_heap_zalloc(TMPFS_PAGESIZE);
+      if (tfo->tfo_pages[index] != NULL)
+        {
+          tfo->tfo_alloc += TMPFS_PAGESIZE;
+        }
+    }
+
+  return tfo->tfo_pages[index];
+}
+
+/****************************************************************************
+ * Name: tmpfs_read_pages
+ ****************************************************************************/
+
+static void tmpfs_read_pages(FAR struct tmpfs_file_s *tfo,
+                             FAR char *buffer, size_t pos, size_t len)
+{
+  FAR uint8_t *page;
+  size_t offset;
+  size_t nbytes;
+
+  while (len > 0)
+    {
+      page   = tfo->tfo_pages[pos / TMPFS_PAGESIZE];
+      offset = pos % TMPFS_PAGESIZE;
+      nbytes = MIN(TMPFS_PAGESIZE - offset, len);
+
+      /* Holes read back as zero */
+
+      if (page != NULL)
+        {
+          memcpy(buffer, page + offset, nbytes);
+        }
+      else
+        {
+          memset(buffer, 0, nbytes);
+        }
+
+      buffer += nbytes;
+      pos    += nbytes;
+      len    -= nbytes;
+    }
+}
+
+/****************************************************************************
+ * Name: tmpfs_write_pages
+ *
+ * Description:
+ *   Copy data into the pages of the file, allocating the pages as needed.
+ *   The page table must already cover the range.  Returns the number of
+ *   bytes copied, which is less than 'len' if a page could not be
+ *   allocated.
+ *
+ ****************************************************************************/
+
+static size_t tmpfs_write_pages(FAR struct tmpfs_file_s *tfo,
+                                FAR const char *buffer, size_t pos,
+                                size_t len)
+{
+  FAR uint8_t *page;
+  size_t nwritten = 0;
+  size_t offset;
+  size_t nbytes;
+
+  while (nwritten < len)
+    {
+      page = tmpfs_alloc_page(tfo, pos / TMPFS_PAGESIZE);
+      if (page == NULL)
+        {
+          break;
+        }
+
+      offset = pos % TMPFS_PAGESIZE;
+      nbytes = MIN(TMPFS_PAGESIZE - offset, len - nwritten);
+
+      memcpy(page + offset, buffer + nwritten, nbytes);
+      nwritten += nbytes;
+      pos      += nbytes;
+    }
+
+  return nwritten;
+}
+
+/****************************************************************************
+ * Name: tmpfs_free_data
+ ****************************************************************************/
+
+static void tmpfs_free_data(FAR struct tmpfs_file_s *tfo)
+{
+  size_t i;
+
+  for (i = 0; i < tfo->tfo_npages; i++)
+    {
+      fs_heap_free(tfo->tfo_pages[i]);
+    }
+
+  fs_heap_free(tfo->tfo_pages);
+}
+#else
 static int tmpfs_realloc_file(FAR struct tmpfs_file_s *tfo,
                               size_t newsize)
 {
@@ -346,6 +560,16 @@ static int tmpfs_realloc_file(FAR struct tmpfs_file_s *tfo,
   return OK;
 }
 
+/****************************************************************************
+ * Name: tmpfs_free_data
+ ****************************************************************************/
+
+static void tmpfs_free_data(FAR struct tmpfs_file_s *tfo)
+{
+  fs_heap_free(tfo->tfo_data);
+}
+#endif
+
 /****************************************************************************
  * Name: tmpfs_release_lockedobject
  ****************************************************************************/
@@ -383,7 +607,7 @@ static void tmpfs_release_lockedfile(FAR struct tmpfs_file_s *tfo)
     {
       tmpfs_unlock_file(tfo);
       nxrmutex_destroy(&tfo->tfo_lock);
-      fs_heap_free(tfo->tfo_data);
+      tmpfs_free_data(tfo);
       fs_heap_free(tfo);
     }
 
@@ -582,7 +806,12 @@ tmpfs_alloc_file(FAR struct tmpfs_directory_s *parent)
   tfo->tfo_parent = parent;
   tfo->tfo_flags  = 0;
   tfo->tfo_size   = 0;
+#ifdef CONFIG_FS_TMPFS_PAGED
+  tfo->tfo_npages = 0;
+  tfo->tfo_pages  = NULL;
+#else
   tfo->tfo_data   = NULL;
+#endif
 
   nxrmutex_init(&tfo->tfo_lock);
   tmpfs_lock_file(tfo);
@@ -1181,8 +1410,14 @@ static int tmpfs_statfs_callout(FAR struct tmpfs_directory_s *tdo,
 
       tmptfo             = (FAR struct tmpfs_file_s *)to;
       tmpbuf->tsf_alloc += sizeof(struct tmpfs_file_s);
-      tmpbuf->tsf_avail += to->to_alloc - tmptfo->tfo_size;
       tmpbuf->tsf_files++;
+
+      /* A sparse file may use less memory than its size */
+
+      if (to->to_alloc > tmptfo->tfo_size)
+        {
+          tmpbuf->tsf_avail += to->to_alloc - tmptfo->tfo_size;
+        }
     }
   else /* if (to->to_type == TMPFS_DIRECTORY) */
     {
@@ -1257,7 +1492,7 @@ static int tmpfs_free_callout(FAR struct tmpfs_directory_s *tdo,
           return TMPFS_UNLINKED;
         }
 
-      fs_heap_free(tfo->tfo_data);
+      tmpfs_free_data(tfo);
     }
   else /* if (to->to_type == TMPFS_DIRECTORY) */
     {
@@ -1578,6 +1813,10 @@ static ssize_t tmpfs_read(FAR struct file *filep, FAR char *buffer,
 
   /* Copy data from the memory object to the user buffer */
 
+#ifdef CONFIG_FS_TMPFS_PAGED
+  tmpfs_read_pages(tfo, buffer, startpos, nread);
+  filep->f_pos += nread;
+#else
   if (tfo->tfo_data != NULL)
     {
       memcpy(buffer, &tfo->tfo_data[startpos], nread);
@@ -1587,6 +1826,7 @@ static ssize_t tmpfs_read(FAR struct file *filep, FAR char *buffer,
     {
       DEBUGASSERT(tfo->tfo_size == 0 && nread == 0);
     }
+#endif
 
   /* Release the lock on the file */
 
@@ -1603,6 +1843,7 @@ static ssize_t tmpfs_write(FAR struct file *filep, FAR const char *buffer,
 {
   FAR struct tmpfs_file_s *tfo;
   ssize_t nwritten;
+  size_t oldsize;
   off_t startpos;
   off_t endpos;
   int ret;
@@ -1636,6 +1877,7 @@ static ssize_t tmpfs_write(FAR struct file *filep, FAR const char *buffer,
 
   nwritten = buflen;
   endpos   = startpos + buflen;
+  oldsize  = tfo->tfo_size;
 
   if (endpos > tfo->tfo_size)
     {
@@ -1648,16 +1890,43 @@ static ssize_t tmpfs_write(FAR struct file *filep, FAR const char *buffer,
         }
     }
 
-  /* Copy data from the memory object to the user buffer */
+  /* Copy data from the user buffer to the memory object */
+
+#ifdef CONFIG_FS_TMPFS_PAGED
+  nwritten = tmpfs_write_pages(tfo, buffer, startpos, buflen);
+  if ((size_t)nwritten < buflen)
+    {
+      /* Out of memory, drop the part of the file that was not written */
 
+      endpos = startpos + nwritten;
+      if (endpos < tfo->tfo_size)
+        {
+          tmpfs_realloc_file(tfo, MAX(oldsize, (size_t)endpos));
+        }
+
+      if (nwritten == 0)
+        {
+          ret = -ENOMEM;
+          goto errout_with_lock;
+        }
+    }
+#else
   if (tfo->tfo_data != NULL)
     {
+      /* Zero the hole left by a write beyond the end of the file */
+
+      if (startpos > oldsize)
+        {
+          memset(&tfo->tfo_data[oldsize], 0, startpos - oldsize);
+        }
+
       memcpy(&tfo->tfo_data[startpos], buffer, nwritten);
     }
   else
     {
       DEBUGASSERT(tfo->tfo_size == 0 && nwritten == 0);
     }
+#endif
 
   filep->f_pos = endpos;
 
@@ -1780,7 +2049,32 @@ static int tmpfs_mmap(FAR struct file *filep, FAR struct mm_map_entry_s *map)
   if (map->offset >= 0 && map->offset < tfo->tfo_size &&
       map->length && map->offset + map->length <= tfo->tfo_size)
     {
+#ifdef CONFIG_FS_TMPFS_PAGED
+      FAR uint8_t *page;
+      size_t offset = map->offset % TMPFS_PAGESIZE;
+
+      /* Only a range inside one page is contiguous in memory, let the
+       * caller fall back to a copy otherwise.
+       */
+
+      if (offset + map->length > TMPFS_PAGESIZE)
+        {
+          return -ENOTTY;
+        }
+
+      tmpfs_lock_file(tfo);
+      page = tmpfs_alloc_page(tfo, map->offset / TMPFS_PAGESIZE);
+      tmpfs_unlock_file(tfo);
+
+      if (page == NULL)
+        {
+          return -ENOMEM;
+        }
+
+      map->vaddr = page + offset;
+#else
       map->vaddr = tfo->tfo_data + map->offset;
+#endif
       map->priv.p = tfo;
       map->munmap = tmpfs_unmap;
       ret = mm_map_add(get_current_mm(), map);
@@ -1834,7 +2128,32 @@ static int tmpfs_ioctl(FAR struct file *filep, int cmd, unsigned long arg)
     {
       FAR uintptr_t *ptr = (FAR uintptr_t *)arg;
 
+#ifdef CONFIG_FS_TMPFS_PAGED
+      FAR uint8_t *page = NULL;
+
+      /* Only a file held in a single page is contiguous in memory */
+
+      if (tfo->tfo_size > TMPFS_PAGESIZE)
+        {
+          return -ENOTTY;
+        }
+
+      if (tfo->tfo_npages > 0)
+        {
+          tmpfs_lock_file(tfo);
+          page = tmpfs_alloc_page(tfo, 0);
+          tmpfs_unlock_file(tfo);
+
+          if (page == NULL)
+            {
+              return -ENOMEM;
+            }
+        }
+
+      *ptr = (uintptr_t)page;
+#else
       *ptr = (uintptr_t)tfo->tfo_data;
+#endif
       return OK;
     }
 
@@ -1968,14 +2287,16 @@ static int tmpfs_truncate(FAR struct file *filep, off_t length)
           goto errout_with_lock;
         }
 
+#ifndef CONFIG_FS_TMPFS_PAGED
       /* If the size has increased, then we need to zero the newly added
-       * memory.
+       * memory.  New pages are zeroed when they are allocated.
        */
 
       if (length > oldsize)
         {
           memset(&tfo->tfo_data[oldsize], 0, length - oldsize);
         }
+#endif
 
       ret = OK;
     }
@@ -2418,7 +2739,7 @@ static int tmpfs_unlink(FAR struct inode *mountpt, FAR const char *relpath)
   else
     {
       nxrmutex_destroy(&tfo->tfo_lock);
-      fs_heap_free(tfo->tfo_data);
+      tmpfs_free_data(tfo);
       fs_heap_free(tfo);
     }
 
@@ -2746,6 +3067,7 @@ static void tmpfs_stat_common(FAR struct tmpfs_object_s *to,
                               FAR struct stat *buf)
 {
   size_t objsize;
+  size_t allocsize;
 
   /* Is the tmpfs object a regular file? */
 
@@ -2763,6 +3085,11 @@ static void tmpfs_stat_common(FAR struct tmpfs_object_s *to,
       /* Get the size of the object */
 
       objsize = tfo->tfo_size;
+#ifdef CONFIG_FS_TMPFS_PAGED
+      allocsize = tfo->tfo_alloc;
+#else
+      allocsize = objsize;
+#endif
     }
   else /* if (to->to_type == TMPFS_DIRECTORY) */
     {
@@ -2775,14 +3102,15 @@ static void tmpfs_stat_common(FAR struct tmpfs_object_s *to,
 
       /* Get the size of the object */
 
-      objsize = SIZEOF_TMPFS_DIRECTORY(tdo->tdo_nentries);
+      objsize   = SIZEOF_TMPFS_DIRECTORY(tdo->tdo_nentries);
+      allocsize = objsize;
     }
 
   /* Fake the rest of the information */
 
   buf->st_size    = objsize;
   buf->st_blksize = CONFIG_FS_TMPFS_BLOCKSIZE;
-  buf->st_blocks  = (objsize + CONFIG_FS_TMPFS_BLOCKSIZE - 1) /
+  buf->st_blocks  = (allocsize + CONFIG_FS_TMPFS_BLOCKSIZE - 1) /
                     CONFIG_FS_TMPFS_BLOCKSIZE;
 }
 
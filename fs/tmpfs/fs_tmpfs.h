@@ -106,6 +106,10 @@ struct tmpfs_directory_s
 #define SIZEOF_TMPFS_DIRECTORY(n) ((n) * sizeof(struct tmpfs_dirent_s))
 
 /* The form of a regular file memory object
+ *
+ * With CONFIG_FS_TMPFS_PAGED the file data is held in pages of
+ * CONFIG_FS_TMPFS_PAGESIZE bytes, tfo_alloc then counts the bytes in the
+ * allocated pages and may be less than tfo_size for a sparse file.
  *
  * NOTE that in this very simplified implementation, there is no per-open
  * state.  The file memory object also serves as the open file object,
@@ -128,7 +132,12 @@ struct tmpfs_file_s
 
   uint8_t       tfo_flags; /* See TFO_FLAG_* definitions */
   size_t        tfo_size;  /* Valid file size */
+#ifdef CONFIG_FS_TMPFS_PAGED
+  size_t        tfo_npages; /* Number of entries in tfo_pages */
+  FAR uint8_t **tfo_pages;  /* Page table, NULL entries are holes */
+#else
   FAR uint8_t  *tfo_data;  /* File data starts here */
+#endif
 };
 
 /* This structure represents one instance of a TMPFS file system */
@@ -42,6 +42,7 @@
 #include <nuttx/list.h>
 #include <nuttx/mutex.h>
 #include <nuttx/signal.h>
+#include <nuttx/spinlock.h>
 
 #include "inode/inode.h"
 #include "fs_heap.h"
@@ -53,8 +54,13 @@
 struct epoll_node_s
 {
   struct list_node         node;
+  struct list_node         rnode;  /* Link in the ready list */
   epoll_data_t             data;
   bool                     notified;
+  pollevent_t              revents; /* Edge triggered events not reported
+                                     * yet, moved out of pfd.revents by
+                                     * the poll callback.
+                                     */
   struct pollfd            pfd;
   FAR struct epoll_head_s *eph;
 };
@@ -67,6 +73,13 @@ struct epoll_head_s
   int                   crefs;
   mutex_t               lock;
   sem_t                 sem;
+  spinlock_t            spinlock; /* Protect the ready list, which is
+                                   * updated from the poll callback.
+                                   */
+  struct list_node      ready;    /* The ready list, store the setuped epoll
+                                   * node notified by the poll callback, so
+                                   * epoll_wait only visits these nodes.
+                                   */
   struct list_node      setup;    /* The setup list, store all the setuped
                                    * epoll node.
                                    */
@@ -242,6 +255,8 @@ static int epoll_do_create(int size, int flags)
 
   epn = (FAR epoll_node_t *)(eph + 1);
 
+  spin_lock_init(&eph->spinlock);
+  list_initialize(&eph->ready);
   list_initialize(&eph->setup);
   list_initialize(&eph->teardown);
   list_initialize(&eph->oneshot);
@@ -268,6 +283,34 @@ static int epoll_do_create(int size, int flags)
   return fd;
 }
 
+/****************************************************************************
+ * Name: epoll_unready
+ *
+ * Description:
+ *   Remove the epoll node from the ready list after its poll was teardown.
+ *
+ * Input Parameters:
+ *   eph       - The epoll head pointer
+ *   epn       - The epoll node pointer
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+static void epoll_unready(FAR epoll_head_t *eph, FAR epoll_node_t *epn)
+{
+  irqstate_t flags;
+
+  flags = spin_lock_irqsave(&eph->spinlock);
+  if (list_in_list(&epn->rnode))
+    {
+      list_delete(&epn->rnode);
+    }
+
+  spin_unlock_irqrestore(&eph->spinlock, flags);
+}
+
 /****************************************************************************
  * Name: epoll_setup
  *
@@ -302,6 +345,7 @@ static int epoll_setup(FAR epoll_head_t *eph)
 
       epn->notified    = false;
       epn->pfd.revents = 0;
+      epn->revents     = 0;
       ret = poll_fdsetup(epn->pfd.fd, &epn->pfd, true);
       if (ret < 0)
         {
@@ -339,18 +383,52 @@ static int epoll_setup(FAR epoll_head_t *eph)
 static int epoll_teardown(FAR epoll_head_t *eph, FAR struct epoll_event *evs,
                           int maxevents)
 {
-  FAR epoll_node_t *tepn;
   FAR epoll_node_t *epn;
+  pollevent_t revents;
+  irqstate_t flags;
+  bool pending;
+  int semcount = 0;
   int i = 0;
 
   nxmutex_lock(&eph->lock);
 
-  list_for_every_entry_safe(&eph->setup, epn, tepn, epoll_node_t, node)
+  while (i < maxevents)
     {
-      /* Only check the notifed fd */
+      /* Only check the notifed fd, which the poll callback has queued to
+       * the ready list, so the cost doesn't depend on the number of the
+       * registered fd.
+       */
+
+      revents = 0;
+      flags = spin_lock_irqsave(&eph->spinlock);
+      epn = list_remove_head_type(&eph->ready, epoll_node_t, rnode);
+      if (epn != NULL &&
+          (epn->pfd.events & (EPOLLET | EPOLLONESHOT)) == EPOLLET)
+        {
+          /* Edge triggered fd keeps the poll setup, consume the events
+           * here, then only the next notification from the driver can
+           * queue it to the ready list again.
+           */
+
+          revents       = epn->revents;
+          epn->revents  = 0;
+          epn->notified = false;
+        }
 
-      if (!epn->notified)
+      spin_unlock_irqrestore(&eph->spinlock, flags);
+      if (epn == NULL)
         {
+          break;
+        }
+
+      if ((epn->pfd.events & (EPOLLET | EPOLLONESHOT)) == EPOLLET)
+        {
+          if (revents != 0)
+            {
+              evs[i].data     = epn->data;
+              evs[i++].events = revents;
+            }
+
           continue;
         }
 
@@ -359,7 +437,7 @@ static int epoll_teardown(FAR epoll_head_t *eph, FAR struct epoll_event *evs,
       poll_fdsetup(epn->pfd.fd, &epn->pfd, false);
       list_delete(&epn->node);
 
-      if (epn->pfd.revents != 0 && i < maxevents)
+      if (epn->pfd.revents != 0)
         {
           evs[i].data     = epn->data;
           evs[i++].events = epn->pfd.revents;
@@ -378,6 +456,23 @@ static int epoll_teardown(FAR epoll_head_t *eph, FAR struct epoll_event *evs,
         }
     }
 
+  /* The user buffer is full, leave the remaining notified fd in the ready
+   * list and wake up the next epoll_wait to report them.
+   */
+
+  flags = spin_lock_irqsave(&eph->spinlock);
+  pending = !list_is_empty(&eph->ready);
+  spin_unlock_irqrestore(&eph->spinlock, flags);
+
+  if (pending)
+    {
+      nxsem_get_value(&eph->sem, &semcount);
+      if (semcount < 1)
+        {
+          nxsem_post(&eph->sem);
+        }
+    }
+
   nxmutex_unlock(&eph->lock);
   return i;
 }
@@ -400,15 +495,38 @@ static int epoll_teardown(FAR epoll_head_t *eph, FAR struct epoll_event *evs,
 static void epoll_default_cb(FAR struct pollfd *fds)
 {
   FAR epoll_node_t *epn = fds->arg;
+  FAR epoll_head_t *eph = epn->eph;
+  pollevent_t revents = fds->revents;
+  irqstate_t flags;
   int semcount = 0;
 
-  epn->notified = true;
-  if (fds->revents != 0)
+  flags = spin_lock_irqsave(&eph->spinlock);
+  if ((fds->events & (EPOLLET | EPOLLONESHOT)) == EPOLLET)
+    {
+      /* Edge triggered fd stays set up while epoll_wait() consumes its
+       * events, so move them under the spinlock here.  Reading and
+       * clearing pfd.revents from epoll_wait() would race with the
+       * unlocked update in poll_notify() and lose an edge.
+       */
+
+      epn->revents |= revents;
+      fds->revents  = 0;
+    }
+
+  if (!epn->notified)
     {
-      nxsem_get_value(&epn->eph->sem, &semcount);
+      epn->notified = true;
+      list_add_tail(&eph->ready, &epn->rnode);
+    }
+
+  spin_unlock_irqrestore(&eph->spinlock, flags);
+
+  if (revents != 0)
+    {
+      nxsem_get_value(&eph->sem, &semcount);
       if (semcount < 1)
         {
-          nxsem_post(&epn->eph->sem);
+          nxsem_post(&eph->sem);
         }
     }
 }
@@ -502,6 +620,15 @@ int epoll_ctl(int epfd, int op, int fd, FAR struct epoll_event *ev)
       case EPOLL_CTL_ADD:
         finfo("%p CTL ADD: fd=%d ev=%08" PRIx32 "\n", eph, fd, ev->events);
 
+        /* EPOLLEXCLUSIVE can't be combined with EPOLLONESHOT */
+
+        if ((ev->events & (EPOLLEXCLUSIVE | EPOLLONESHOT)) ==
+            (EPOLLEXCLUSIVE | EPOLLONESHOT))
+          {
+            ret = -EINVAL;
+            goto err;
+          }
+
         /* Check repetition */
 
         list_for_every_entry(&eph->setup, epn, epoll_node_t, node)
@@ -564,6 +691,7 @@ int epoll_ctl(int epfd, int op, int fd, FAR struct epoll_event *ev)
         epn->pfd.arg     = epn;
         epn->pfd.cb      = epoll_default_cb;
         epn->pfd.revents = 0;
+        epn->revents     = 0;
 
         ret = poll_fdsetup(fd, &epn->pfd, true);
         if (ret < 0)
@@ -582,6 +710,7 @@ int epoll_ctl(int epfd, int op, int fd, FAR struct epoll_event *ev)
             if (epn->pfd.fd == fd)
               {
                 poll_fdsetup(fd, &epn->pfd, false);
+                epoll_unready(eph, epn);
                 list_delete(&epn->node);
                 list_add_tail(&eph->free, &epn->node);
                 goto out;
@@ -612,19 +741,36 @@ int epoll_ctl(int epfd, int op, int fd, FAR struct epoll_event *ev)
 
       case EPOLL_CTL_MOD:
         finfo("%p CTL MOD: fd=%d ev=%08" PRIx32 "\n", eph, fd, ev->events);
+
+        /* EPOLLEXCLUSIVE is only allowed with EPOLL_CTL_ADD */
+
+        if ((ev->events & EPOLLEXCLUSIVE) != 0)
+          {
+            ret = -EINVAL;
+            goto err;
+          }
+
         list_for_every_entry(&eph->setup, epn, epoll_node_t, node)
           {
             if (epn->pfd.fd == fd)
               {
+                if ((epn->pfd.events & EPOLLEXCLUSIVE) != 0)
+                  {
+                    ret = -EINVAL;
+                    goto err;
+                  }
+
                 if (epn->pfd.events != (ev->events | POLLALWAYS))
                   {
                     poll_fdsetup(fd, &epn->pfd, false);
+                    epoll_unready(eph, epn);
 
                     epn->notified    = false;
                     epn->data        = ev->data;
                     epn->pfd.events  = ev->events | POLLALWAYS;
                     epn->pfd.fd      = fd;
                     epn->pfd.revents = 0;
+                    epn->revents     = 0;
 
                     ret = poll_fdsetup(fd, &epn->pfd, true);
                     if (ret < 0)
@@ -641,6 +787,12 @@ int epoll_ctl(int epfd, int op, int fd, FAR struct epoll_event *ev)
           {
             if (epn->pfd.fd == fd)
               {
+                if ((epn->pfd.events & EPOLLEXCLUSIVE) != 0)
+                  {
+                    ret = -EINVAL;
+                    goto err;
+                  }
+
                 if (epn->pfd.events != (ev->events | POLLALWAYS))
                   {
                     epn->notified    = false;
@@ -648,6 +800,7 @@ int epoll_ctl(int epfd, int op, int fd, FAR struct epoll_event *ev)
                     epn->pfd.events  = ev->events | POLLALWAYS;
                     epn->pfd.fd      = fd;
                     epn->pfd.revents = 0;
+                    epn->revents     = 0;
 
                     ret = poll_fdsetup(fd, &epn->pfd, true);
                     if (ret < 0)
@@ -672,6 +825,7 @@ int epoll_ctl(int epfd, int op, int fd, FAR struct epoll_event *ev)
                 epn->pfd.events  = ev->events | POLLALWAYS;
                 epn->pfd.fd      = fd;
                 epn->pfd.revents = 0;
+                epn->revents     = 0;
 
                 ret = poll_fdsetup(fd, &epn->pfd, true);
                 if (ret < 0)
@@ -41,6 +41,7 @@
 
 #include "sched/sched.h"
 #include "inode/inode.h"
+#include "mmap/fs_rammap.h"
 #include "driver/driver.h"
 #include "notify/notify.h"
 
@@ -246,6 +247,10 @@ static int file_vopen(FAR struct file *filep, FAR const char *path,
       if (inode->u.i_mops->open != NULL)
         {
           ret = inode->u.i_mops->open(filep, desc.relpath, oflags, mode);
+          if (ret >= 0 && (oflags & O_TRUNC) != 0)
+            {
+              rammap_invalidate(inode);
+            }
         }
     }
 #endif
@@ -260,7 +260,9 @@ void poll_default_cb(FAR struct pollfd *fds)
  *
  * Description:
  *   Notify the poll, this function should be called by drivers to notify
- *   the caller the poll is ready.
+ *   the caller the poll is ready.  Among the fds with POLLEXCLUSIVE, only
+ *   the first one without pending events is notified to avoid waking up
+ *   all the waiters for one event.
  *
  * Input Parameters:
  *   afds     - The fds array
@@ -276,6 +278,7 @@ void poll_notify(FAR struct pollfd **afds, int nfds, pollevent_t eventset)
 {
   int i;
   FAR struct pollfd *fds;
+  bool exclusive = false;
 
   DEBUGASSERT(afds != NULL && nfds >= 1);
 
@@ -284,6 +287,21 @@ void poll_notify(FAR struct pollfd **afds, int nfds, pollevent_t eventset)
       fds = afds[i];
       if (fds != NULL)
         {
+          /* Skip the exclusive waiters which have pending events (they
+           * will be woken up anyway), or another one has been notified.
+           */
+
+          if ((fds->events & POLLEXCLUSIVE) != 0)
+            {
+              if (exclusive || fds->revents != 0 ||
+                  (eventset & (fds->events | POLLERR | POLLHUP)) == 0)
+                {
+                  continue;
+                }
+
+              exclusive = true;
+            }
+
           /* The error event must be set in fds->revents */
 
           fds->revents |= eventset & (fds->events | POLLERR | POLLHUP);
@@ -36,6 +36,7 @@
 
 #include "notify/notify.h"
 #include "inode/inode.h"
+#include "mmap/fs_rammap.h"
 
 /****************************************************************************
  * Public Functions
@@ -54,6 +55,7 @@
 int file_truncate(FAR struct file *filep, off_t length)
 {
   struct inode *inode;
+  int ret;
 
   /* Was this file opened for write access? */
 
@@ -102,7 +104,13 @@ int file_truncate(FAR struct file *filep, off_t length)
 
   /* Yes, then tell the file system to truncate this file */
 
-  return inode->u.i_ops->truncate(filep, length);
+  ret = inode->u.i_ops->truncate(filep, length);
+  if (ret >= 0)
+    {
+      rammap_invalidate(inode);
+    }
+
+  return ret;
 }
 
 /****************************************************************************
@@ -35,6 +35,7 @@
 
 #include "notify/notify.h"
 #include "inode/inode.h"
+#include "mmap/fs_rammap.h"
 
 /****************************************************************************
  * Pre-processor Definitions
@@ -99,6 +100,10 @@ int nx_unlink(FAR const char *pathname)
             {
               goto errout_with_inode;
             }
+
+          /* A new file may be created at the same path */
+
+          rammap_invalidate(inode);
         }
       else
         {
@@ -0,0 +1,1337 @@
+/****************************************************************************
+ * fs/vfs/fs_uring.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stddef.h>
+#include <string.h>
+#include <poll.h>
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <debug.h>
+
+#include <sys/io_uring.h>
+#include <sys/socket.h>
+
+#include <nuttx/nuttx.h>
+#include <nuttx/fs/uio.h>
+#include <nuttx/kmalloc.h>
+#include <nuttx/list.h>
+#include <nuttx/mm/map.h>
+#include <nuttx/mutex.h>
+#include <nuttx/sched.h>
+#include <nuttx/semaphore.h>
+#include <nuttx/spinlock.h>
+#include <nuttx/wqueue.h>
+
+#ifdef CONFIG_NET
+#  include <nuttx/net/net.h>
+#endif
+
+#include "inode/inode.h"
+#include "fs_heap.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Poll states of a request, see uring_arm() */
+
+#define URING_IDLE   0 /* No poll set up */
+#define URING_ARMING 1 /* file_poll() setup in progress */
+#define URING_FIRED  2 /* Ready reported during the setup */
+#define URING_ARMED  3 /* Waiting on the pending list */
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* The ring header shared with the user.  It is followed by the CQEs and
+ * then by the SQ index array, all in one allocation that is mapped at
+ * both IORING_OFF_SQ_RING and IORING_OFF_CQ_RING.  The SQEs themselves
+ * live in a second allocation mapped at IORING_OFF_SQES.
+ */
+
+struct uring_rings_s
+{
+  volatile uint32_t sq_head;        /* Advanced by the kernel */
+  volatile uint32_t sq_tail;        /* Advanced by the user */
+  uint32_t          sq_ring_mask;
+  uint32_t          sq_ring_entries;
+  uint32_t          sq_flags;
+  volatile uint32_t sq_dropped;     /* SQEs with an invalid index */
+  volatile uint32_t cq_head;        /* Advanced by the user */
+  volatile uint32_t cq_tail;        /* Advanced by the kernel */
+  uint32_t          cq_ring_mask;
+  uint32_t          cq_ring_entries;
+  uint32_t          cq_overflow;    /* Always zero, see IORING_FEAT_NODROP */
+  uint32_t          cq_flags;
+  struct io_uring_cqe cqes[1];      /* cq_ring_entries CQEs */
+};
+
+/* This structure describes the internal state of one ring */
+
+struct uring_priv_s
+{
+  mutex_t                       sqlock;   /* Serializes submitters */
+  mutex_t                       cqlock;   /* Serializes completions */
+  sem_t                         waitsem;  /* Wakes io_uring_enter() waiters */
+  FAR struct uring_rings_s     *rings;    /* Shared ring header and CQEs */
+  FAR uint32_t                 *sq_array; /* Shared SQ index array */
+  FAR struct io_uring_sqe      *sqes;     /* Shared SQEs */
+  size_t                        ringsize; /* Size of rings */
+  size_t                        sqessize; /* Size of sqes */
+  unsigned int                  inflight; /* Submitted but not completed */
+  unsigned int                  nwaiters; /* Threads waiting on waitsem */
+  unsigned int                  crefs;    /* Opens plus live mappings */
+  unsigned int                  nopens;   /* Open file descriptions */
+  spinlock_t                    lock;     /* Protects pending and states */
+  struct list_node              pending;  /* Requests waiting on a poll */
+  bool                          closed;   /* Cancel whatever still runs */
+
+  /* The following is a list if poll structures of threads waiting for
+   * completions.
+   */
+
+#ifdef CONFIG_IO_URING_POLL
+  FAR struct pollfd *fds[CONFIG_IO_URING_NPOLLWAITERS];
+#endif
+};
+
+/* One submitted operation.  The SQE is copied so the user may reuse its
+ * slot as soon as sq_head moves past it.
+ */
+
+struct uring_op_s
+{
+  struct io_uring_sqe           sqe;      /* Copy of the user SQE */
+  FAR struct file              *filep;    /* Reference on sqe.fd */
+};
+
+/* A chain of operations linked with IOSQE_IO_LINK, run in order */
+
+struct uring_req_s
+{
+  struct work_s                 work;     /* Used to punt to the workers */
+  struct list_node              node;     /* Entry of priv->pending */
+  struct pollfd                 fds;      /* Waits for the next operation */
+  FAR struct uring_priv_s      *priv;     /* The ring to complete to */
+  unsigned int                  count;    /* Number of operations */
+  unsigned int                  next;     /* Next operation to run */
+  uint8_t                       state;    /* URING_IDLE, URING_ARMED, ... */
+  bool                          ready;    /* A poll reported the op ready */
+  bool                          failed;   /* Cancel the rest of the chain */
+  struct uring_op_s             op[1];    /* count operations */
+};
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+static int uring_do_open(FAR struct file *filep);
+static int uring_do_close(FAR struct file *filep);
+static int uring_do_mmap(FAR struct file *filep,
+                         FAR struct mm_map_entry_s *map);
+#ifdef CONFIG_IO_URING_POLL
+static int uring_do_poll(FAR struct file *filep, FAR struct pollfd *fds,
+                         bool setup);
+#endif
+
+static void uring_run(FAR struct uring_req_s *req, bool nonblock);
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static const struct file_operations g_uring_fops =
+{
+  uring_do_open,  /* open */
+  uring_do_close, /* close */
+  NULL,           /* read */
+  NULL,           /* write */
+  NULL,           /* seek */
+  NULL,           /* ioctl */
+  uring_do_mmap,  /* mmap */
+  NULL,           /* truncate */
+#ifdef CONFIG_IO_URING_POLL
+  uring_do_poll   /* poll */
+#endif
+};
+
+static struct inode g_uring_inode =
+{
+  NULL,                   /* i_parent */
+  NULL,                   /* i_peer */
+  NULL,                   /* i_child */
+  1,                      /* i_crefs */
+  FSNODEFLAG_TYPE_DRIVER, /* i_flags */
+  {
+    &g_uring_fops         /* u */
+  }
+};
+
+/* The worker pool shared by all rings, created on first use */
+
+static mutex_t g_uring_lock = NXMUTEX_INITIALIZER;
+static FAR struct kwork_wqueue_s *g_uring_wq;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static void uring_destroy(FAR struct uring_priv_s *priv)
+{
+  kumm_free(priv->sqes);
+  kumm_free(priv->rings);
+  nxsem_destroy(&priv->waitsem);
+  nxmutex_destroy(&priv->cqlock);
+  nxmutex_destroy(&priv->sqlock);
+  fs_heap_free(priv);
+}
+
+/****************************************************************************
+ * Name: uring_release
+ *
+ * Description:
+ *   Drop one open or mapping reference.  The ring is freed once the last
+ *   reference is gone and no operation is still running, otherwise the
+ *   last completion frees it.
+ *
+ ****************************************************************************/
+
+static void uring_release(FAR struct uring_priv_s *priv)
+{
+  bool destroy;
+
+  nxmutex_lock(&priv->cqlock);
+  DEBUGASSERT(priv->crefs > 0);
+  priv->crefs--;
+  destroy = priv->crefs == 0 && priv->inflight == 0;
+  nxmutex_unlock(&priv->cqlock);
+
+  if (destroy)
+    {
+      finfo("destroy\n");
+      uring_destroy(priv);
+    }
+}
+
+/****************************************************************************
+ * Name: uring_complete
+ *
+ * Description:
+ *   Post one CQE.  Submission reserved its slot, so the CQ can not be
+ *   full here.
+ *
+ ****************************************************************************/
+
+static void uring_complete(FAR struct uring_priv_s *priv,
+                           uint64_t user_data, int res)
+{
+  FAR struct uring_rings_s *rings = priv->rings;
+  FAR struct io_uring_cqe *cqe;
+  uint32_t tail;
+  bool destroy;
+
+  nxmutex_lock(&priv->cqlock);
+
+  tail = rings->cq_tail;
+  DEBUGASSERT(tail - rings->cq_head < rings->cq_ring_entries);
+
+  cqe            = &rings->cqes[tail & rings->cq_ring_mask];
+  cqe->user_data = user_data;
+  cqe->res       = res;
+  cqe->flags     = 0;
+
+  /* Publish the CQE before the new tail */
+
+  SP_DMB();
+  rings->cq_tail = tail + 1;
+
+  DEBUGASSERT(priv->inflight > 0);
+  priv->inflight--;
+
+  while (priv->nwaiters > 0)
+    {
+      priv->nwaiters--;
+      nxsem_post(&priv->waitsem);
+    }
+
+#ifdef CONFIG_IO_URING_POLL
+  poll_notify(priv->fds, CONFIG_IO_URING_NPOLLWAITERS, POLLIN);
+#endif
+
+  destroy = priv->crefs == 0 && priv->inflight == 0;
+  nxmutex_unlock(&priv->cqlock);
+
+  if (destroy)
+    {
+      uring_destroy(priv);
+    }
+}
+
+/****************************************************************************
+ * Name: uring_op_rw
+ *
+ * Description:
+ *   Run a read, write or fsync operation.  An offset of (uint64_t)-1 uses
+ *   the file position, anything else is positional I/O.
+ *
+ ****************************************************************************/
+
+static ssize_t uring_op_rw(FAR struct uring_op_s *op)
+{
+  FAR struct io_uring_sqe *sqe = &op->sqe;
+  FAR struct file *filep = op->filep;
+  FAR void *buf = (FAR void *)(uintptr_t)sqe->addr;
+  FAR const struct iovec *iov = buf;
+  bool write = sqe->opcode == IORING_OP_WRITE ||
+               sqe->opcode == IORING_OP_WRITEV;
+  struct uio uio;
+  ssize_t total;
+  ssize_t nbytes;
+  uint32_t i;
+
+  switch (sqe->opcode)
+    {
+      case IORING_OP_FSYNC:
+        return file_fsync(filep);
+
+      case IORING_OP_READ:
+      case IORING_OP_WRITE:
+        if (sqe->off == UINT64_MAX)
+          {
+            return write ? file_write(filep, buf, sqe->len) :
+                           file_read(filep, buf, sqe->len);
+          }
+
+        return write ? file_pwrite(filep, buf, sqe->len, sqe->off) :
+                       file_pread(filep, buf, sqe->len, sqe->off);
+
+      default:
+        break;
+    }
+
+  if (sqe->off == UINT64_MAX)
+    {
+      uio.uio_iov    = iov;
+      uio.uio_iovcnt = sqe->len;
+      return write ? file_writev(filep, &uio) : file_readv(filep, &uio);
+    }
+
+  /* There are no positional vector file operations, so transfer one
+   * iovec at a time and stop at the first short transfer.
+   */
+
+  for (total = 0, i = 0; i < sqe->len; i++)
+    {
+      off_t pos = sqe->off + total;
+
+      if (write)
+        {
+          nbytes = file_pwrite(filep, iov[i].iov_base, iov[i].iov_len, pos);
+        }
+      else
+        {
+          nbytes = file_pread(filep, iov[i].iov_base, iov[i].iov_len, pos);
+        }
+
+      if (nbytes < 0)
+        {
+          return total > 0 ? total : nbytes;
+        }
+
+      total += nbytes;
+      if ((size_t)nbytes < iov[i].iov_len)
+        {
+          break;
+        }
+    }
+
+  return total;
+}
+
+/****************************************************************************
+ * Name: uring_op_poll
+ *
+ * Description:
+ *   Run a poll operation.  Only the current state is checked, -EAGAIN is
+ *   returned if no requested event is pending.
+ *
+ ****************************************************************************/
+
+static int uring_op_poll(FAR struct uring_op_s *op)
+{
+  struct pollfd fds;
+  int ret;
+
+  memset(&fds, 0, sizeof(fds));
+  fds.events = op->sqe.poll_events | POLLERR | POLLHUP;
+
+  ret = file_poll(op->filep, &fds, true);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  file_poll(op->filep, &fds, false);
+  return fds.revents != 0 ? fds.revents : -EAGAIN;
+}
+
+/****************************************************************************
+ * Name: uring_op_sock
+ *
+ * Description:
+ *   Run a send or receive operation on a socket without waiting.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET
+static ssize_t uring_op_sock(FAR struct uring_op_s *op)
+{
+  FAR struct io_uring_sqe *sqe = &op->sqe;
+  FAR struct socket *psock;
+  FAR void *buf = (FAR void *)(uintptr_t)sqe->addr;
+  int flags = sqe->msg_flags | MSG_DONTWAIT;
+
+  psock = file_socket(op->filep);
+  if (psock == NULL)
+    {
+      return -ENOTSOCK;
+    }
+
+  if (sqe->opcode == IORING_OP_SEND)
+    {
+      return psock_send(psock, buf, sqe->len, flags);
+    }
+
+  return psock_recv(psock, buf, sqe->len, flags);
+}
+#endif
+
+/****************************************************************************
+ * Name: uring_execute
+ *
+ * Description:
+ *   Run one operation.  Poll, send and receive never wait and return
+ *   -EAGAIN if nothing is pending.  Reads and writes of drivers may sleep,
+ *   so they return -EAGAIN without side effects unless ready is set;
+ *   regular files are always run in place since that is cheaper than a
+ *   context switch.
+ *
+ ****************************************************************************/
+
+static ssize_t uring_execute(FAR struct uring_op_s *op, bool ready)
+{
+  FAR struct io_uring_sqe *sqe = &op->sqe;
+
+  if (sqe->opcode == IORING_OP_NOP)
+    {
+      return OK;
+    }
+  else if (op->filep == NULL)
+    {
+      return -EBADF;
+    }
+
+  switch (sqe->opcode)
+    {
+      case IORING_OP_READV:
+      case IORING_OP_WRITEV:
+      case IORING_OP_READ:
+      case IORING_OP_WRITE:
+      case IORING_OP_FSYNC:
+        if (!ready && !INODE_IS_MOUNTPT(op->filep->f_inode))
+          {
+            return -EAGAIN;
+          }
+
+        return uring_op_rw(op);
+
+      case IORING_OP_POLL_ADD:
+        return uring_op_poll(op);
+
+      case IORING_OP_SEND:
+      case IORING_OP_RECV:
+#ifdef CONFIG_NET
+        return uring_op_sock(op);
+#else
+        return -EOPNOTSUPP;
+#endif
+
+      default:
+        return -EINVAL;
+    }
+}
+
+/****************************************************************************
+ * Name: uring_pollevents
+ *
+ * Description:
+ *   Return the poll events that tell an operation can make progress, or
+ *   zero if it can not be waited for with a poll.
+ *
+ ****************************************************************************/
+
+static pollevent_t uring_pollevents(FAR struct uring_op_s *op)
+{
+  switch (op->sqe.opcode)
+    {
+      case IORING_OP_POLL_ADD:
+        return op->sqe.poll_events | POLLERR | POLLHUP;
+
+      case IORING_OP_READV:
+      case IORING_OP_READ:
+      case IORING_OP_RECV:
+        return POLLIN | POLLERR | POLLHUP;
+
+      case IORING_OP_WRITEV:
+      case IORING_OP_WRITE:
+      case IORING_OP_SEND:
+        return POLLOUT | POLLERR | POLLHUP;
+
+      default:
+        return 0;
+    }
+}
+
+static void uring_worker(FAR void *arg)
+{
+  uring_run(arg, false);
+}
+
+/****************************************************************************
+ * Name: uring_resume
+ *
+ * Description:
+ *   Worker side of uring_poll_cb(): drop the poll and run the chain again
+ *   from the operation that was waiting.
+ *
+ ****************************************************************************/
+
+static void uring_resume(FAR void *arg)
+{
+  FAR struct uring_req_s *req = arg;
+
+  file_poll(req->op[req->next].filep, &req->fds, false);
+
+  req->ready = true;
+  uring_run(req, false);
+}
+
+/****************************************************************************
+ * Name: uring_poll_cb
+ *
+ * Description:
+ *   Called by poll_notify(), possibly from an interrupt handler, when the
+ *   operation a request waits for may make progress.  The request is
+ *   handed to a worker, nothing is run here.
+ *
+ ****************************************************************************/
+
+static void uring_poll_cb(FAR struct pollfd *fds)
+{
+  FAR struct uring_req_s *req = fds->arg;
+  FAR struct uring_priv_s *priv = req->priv;
+  irqstate_t flags;
+  bool resume = false;
+
+  flags = spin_lock_irqsave(&priv->lock);
+
+  if (req->state == URING_ARMING)
+    {
+      /* uring_arm() is still in file_poll() and retries by itself */
+
+      req->state = URING_FIRED;
+    }
+  else if (req->state == URING_ARMED)
+    {
+      list_delete(&req->node);
+      req->state = URING_IDLE;
+      resume     = true;
+    }
+
+  spin_unlock_irqrestore(&priv->lock, flags);
+
+  if (resume)
+    {
+      work_queue_wq(g_uring_wq, &req->work, uring_resume, req, 0);
+    }
+}
+
+/****************************************************************************
+ * Name: uring_arm
+ *
+ * Description:
+ *   Park a request whose next operation returned -EAGAIN until a poll
+ *   reports it can make progress.  No thread waits meanwhile;
+ *   uring_poll_cb() resumes the request on a worker.
+ *
+ * Returned Value:
+ *   Zero if the request is parked and must not be touched any more,
+ *   -EAGAIN if it became ready already and should be run again, -ENOSYS
+ *   if the file can not be polled, -ECANCELED if the ring is closed, or
+ *   the error of file_poll().
+ *
+ ****************************************************************************/
+
+static int uring_arm(FAR struct uring_req_s *req, FAR struct uring_op_s *op)
+{
+  FAR struct uring_priv_s *priv = req->priv;
+  irqstate_t flags;
+  int ret;
+
+  memset(&req->fds, 0, sizeof(req->fds));
+  req->fds.events = uring_pollevents(op);
+  req->fds.arg    = req;
+  req->fds.cb     = uring_poll_cb;
+
+  if (req->fds.events == 0)
+    {
+      return -ENOSYS;
+    }
+
+  /* The callback may run from file_poll() already, so the state is set
+   * first and the request only goes on the pending list afterwards.
+   */
+
+  flags = spin_lock_irqsave(&priv->lock);
+  if (priv->closed)
+    {
+      spin_unlock_irqrestore(&priv->lock, flags);
+      return -ECANCELED;
+    }
+
+  req->state = URING_ARMING;
+  spin_unlock_irqrestore(&priv->lock, flags);
+
+  ret = file_poll(op->filep, &req->fds, true);
+
+  flags = spin_lock_irqsave(&priv->lock);
+  if (ret >= 0 && req->state == URING_ARMING && !priv->closed)
+    {
+      req->state = URING_ARMED;
+      list_add_tail(&priv->pending, &req->node);
+      spin_unlock_irqrestore(&priv->lock, flags);
+      return OK;
+    }
+
+  if (ret >= 0)
+    {
+      ret = req->state == URING_FIRED ? -EAGAIN : -ECANCELED;
+    }
+
+  req->state = URING_IDLE;
+  spin_unlock_irqrestore(&priv->lock, flags);
+
+  if (ret == -EAGAIN || ret == -ECANCELED)
+    {
+      file_poll(op->filep, &req->fds, false);
+    }
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: uring_cancel
+ *
+ * Description:
+ *   Called when the last file description of the ring is closed.  Every
+ *   request waiting on a poll is resumed so that it completes with
+ *   -ECANCELED and drops its file references, and requests still running
+ *   are canceled at their next operation.
+ *
+ ****************************************************************************/
+
+static void uring_cancel(FAR struct uring_priv_s *priv)
+{
+  FAR struct uring_req_s *req;
+  irqstate_t flags;
+
+  flags = spin_lock_irqsave(&priv->lock);
+  priv->closed = true;
+
+  while (!list_is_empty(&priv->pending))
+    {
+      req = container_of(list_remove_head(&priv->pending),
+                         struct uring_req_s, node);
+      req->state = URING_IDLE;
+      spin_unlock_irqrestore(&priv->lock, flags);
+
+      work_queue_wq(g_uring_wq, &req->work, uring_resume, req, 0);
+
+      flags = spin_lock_irqsave(&priv->lock);
+    }
+
+  spin_unlock_irqrestore(&priv->lock, flags);
+}
+
+/****************************************************************************
+ * Name: uring_run
+ *
+ * Description:
+ *   Run the remaining operations of a chain and post their completions.
+ *   Once an operation fails, or the ring is closed, the rest of the chain
+ *   completes with -ECANCELED.  An operation that can not make progress
+ *   yet parks the request on a poll; one that would block and can not be
+ *   polled moves the chain to a worker when nonblock is set.  The request
+ *   is freed here once all of its operations have completed.
+ *
+ ****************************************************************************/
+
+static void uring_run(FAR struct uring_req_s *req, bool nonblock)
+{
+  FAR struct uring_priv_s *priv = req->priv;
+
+  while (req->next < req->count)
+    {
+      FAR struct uring_op_s *op = &req->op[req->next];
+      ssize_t res;
+      int ret;
+
+      if (req->failed || priv->closed)
+        {
+          res = -ECANCELED;
+        }
+      else if (nonblock && (op->sqe.flags & IOSQE_ASYNC) != 0)
+        {
+          res = -EAGAIN;
+        }
+      else
+        {
+          res = uring_execute(op, req->ready);
+          req->ready = false;
+
+          if (res == -EAGAIN)
+            {
+              ret = uring_arm(req, op);
+              if (ret >= 0)
+                {
+                  return;
+                }
+              else if (ret == -EAGAIN)
+                {
+                  /* Ready already; a driver may still sleep in its read
+                   * or write, so the submitter hands it to a worker.
+                   */
+
+                  req->ready = true;
+                  if (!nonblock)
+                    {
+                      continue;
+                    }
+                }
+              else if (ret != -ENOSYS)
+                {
+                  res = ret;
+                }
+            }
+        }
+
+      /* Drivers without poll support and IOSQE_ASYNC run on a worker */
+
+      if (res == -EAGAIN && nonblock &&
+          work_queue_wq(g_uring_wq, &req->work, uring_worker, req, 0) >= 0)
+        {
+          return;
+        }
+      else if (res == -EAGAIN)
+        {
+          res = uring_execute(op, true);
+        }
+
+      if (op->filep != NULL)
+        {
+          fs_putfilep(op->filep);
+        }
+
+      req->failed |= res < 0;
+      req->next++;
+
+      /* The last completion may free priv, so it must not be touched
+       * afterwards.
+       */
+
+      uring_complete(priv, op->sqe.user_data,
+                     res > INT32_MAX ? INT32_MAX : res);
+    }
+
+  fs_heap_free(req);
+}
+
+/****************************************************************************
+ * Name: uring_submit
+ *
+ * Description:
+ *   Consume up to to_submit SQEs.  A chain is only accepted when the CQ
+ *   has room for all of its completions on top of the ones already in
+ *   flight, so completions are never dropped.
+ *
+ * Returned Value:
+ *   The number of SQEs consumed, or -EBUSY if none could be because the
+ *   CQ is full.
+ *
+ ****************************************************************************/
+
+static int uring_submit(FAR struct uring_priv_s *priv,
+                        unsigned int to_submit)
+{
+  FAR struct uring_rings_s *rings = priv->rings;
+  FAR struct uring_req_s *req;
+  unsigned int submitted = 0;
+  unsigned int count;
+  unsigned int i;
+  uint32_t mask = rings->sq_ring_mask;
+  uint32_t head;
+  uint32_t tail;
+  uint32_t idx;
+  int ret = OK;
+
+  nxmutex_lock(&priv->sqlock);
+
+  head = rings->sq_head;
+  tail = rings->sq_tail;
+
+  /* Read the SQEs only after the tail that published them */
+
+  SP_DMB();
+
+  while (submitted < to_submit && head != tail)
+    {
+      idx = priv->sq_array[head & mask];
+      if (idx >= rings->sq_ring_entries)
+        {
+          rings->sq_dropped++;
+          head++;
+          submitted++;
+          continue;
+        }
+
+      /* Measure the chain; it ends at the first SQE without
+       * IOSQE_IO_LINK, at an invalid index or at the submission limit.
+       */
+
+      for (count = 1; head + count != tail &&
+                      submitted + count < to_submit; count++)
+        {
+          if ((priv->sqes[idx].flags & IOSQE_IO_LINK) == 0)
+            {
+              break;
+            }
+
+          idx = priv->sq_array[(head + count) & mask];
+          if (idx >= rings->sq_ring_entries)
+            {
+              break;
+            }
+        }
+
+      /* Reserve the completions */
+
+      nxmutex_lock(&priv->cqlock);
+      if (rings->cq_tail - rings->cq_head + priv->inflight + count >
+          rings->cq_ring_entries)
+        {
+          nxmutex_unlock(&priv->cqlock);
+          ret = -EBUSY;
+          break;
+        }
+
+      priv->inflight += count;
+      nxmutex_unlock(&priv->cqlock);
+
+      req = fs_heap_malloc(sizeof(struct uring_req_s) +
+                           (count - 1) * sizeof(struct uring_op_s));
+      if (req == NULL)
+        {
+          nxmutex_lock(&priv->cqlock);
+          priv->inflight -= count;
+          nxmutex_unlock(&priv->cqlock);
+          ret = -ENOMEM;
+          break;
+        }
+
+      req->priv   = priv;
+      req->count  = count;
+      req->next   = 0;
+      req->failed = false;
+
+      for (i = 0; i < count; i++)
+        {
+          FAR struct uring_op_s *op = &req->op[i];
+
+          idx = priv->sq_array[(head + i) & mask];
+          memcpy(&op->sqe, &priv->sqes[idx], sizeof(op->sqe));
+
+          op->filep = NULL;
+          if (op->sqe.opcode != IORING_OP_NOP &&
+              fs_getfilep(op->sqe.fd, &op->filep) < 0)
+            {
+              op->filep = NULL;
+            }
+        }
+
+      /* The SQE slots may be reused from here on */
+
+      head      += count;
+      submitted += count;
+      rings->sq_head = head;
+
+      uring_run(req, true);
+    }
+
+  rings->sq_head = head;
+  nxmutex_unlock(&priv->sqlock);
+
+  return submitted > 0 ? submitted : ret;
+}
+
+/****************************************************************************
+ * Name: uring_wait
+ *
+ * Description:
+ *   Wait until at least min_complete CQEs are available, or until nothing
+ *   is left in flight that could produce them.
+ *
+ ****************************************************************************/
+
+static int uring_wait(FAR struct uring_priv_s *priv,
+                      unsigned int min_complete)
+{
+  FAR struct uring_rings_s *rings = priv->rings;
+  int ret = OK;
+
+  if (min_complete > rings->cq_ring_entries)
+    {
+      min_complete = rings->cq_ring_entries;
+    }
+
+  nxmutex_lock(&priv->cqlock);
+
+  while (rings->cq_tail - rings->cq_head < min_complete &&
+         priv->inflight > 0)
+    {
+      priv->nwaiters++;
+      nxmutex_unlock(&priv->cqlock);
+
+      ret = nxsem_wait(&priv->waitsem);
+
+      /* An interrupted wait may leave nwaiters raised; that only costs a
+       * spurious wakeup of the next waiter.
+       */
+
+      nxmutex_lock(&priv->cqlock);
+      if (ret < 0)
+        {
+          break;
+        }
+    }
+
+  nxmutex_unlock(&priv->cqlock);
+  return ret;
+}
+
+static int uring_do_open(FAR struct file *filep)
+{
+  FAR struct uring_priv_s *priv = filep->f_priv;
+
+  nxmutex_lock(&priv->cqlock);
+  priv->crefs++;
+  priv->nopens++;
+  nxmutex_unlock(&priv->cqlock);
+
+  return OK;
+}
+
+static int uring_do_close(FAR struct file *filep)
+{
+  FAR struct uring_priv_s *priv = filep->f_priv;
+  bool last;
+
+  nxmutex_lock(&priv->cqlock);
+  DEBUGASSERT(priv->nopens > 0);
+  last = --priv->nopens == 0;
+  nxmutex_unlock(&priv->cqlock);
+
+  /* Nobody can reap the completions any more, so stop waiting for them */
+
+  if (last)
+    {
+      uring_cancel(priv);
+    }
+
+  uring_release(priv);
+  return OK;
+}
+
+static int uring_do_munmap(FAR struct task_group_s *group,
+                           FAR struct mm_map_entry_s *entry,
+                           FAR void *start, size_t length)
+{
+  FAR struct uring_priv_s *priv = entry->priv.p;
+  int ret;
+
+  /* Partial unmaps are not supported; any unmap drops the whole region */
+
+  ret = mm_map_remove(get_group_mm(group), entry);
+  uring_release(priv);
+  return ret;
+}
+
+static int uring_do_mmap(FAR struct file *filep,
+                         FAR struct mm_map_entry_s *map)
+{
+  FAR struct uring_priv_s *priv = filep->f_priv;
+  FAR void *base;
+  size_t size;
+  int ret;
+
+  switch (map->offset)
+    {
+      case IORING_OFF_SQ_RING:
+      case IORING_OFF_CQ_RING:
+        base = priv->rings;
+        size = priv->ringsize;
+        break;
+
+      case IORING_OFF_SQES:
+        base = priv->sqes;
+        size = priv->sqessize;
+        break;
+
+      default:
+        return -EINVAL;
+    }
+
+  if (map->length == 0 || map->length > size)
+    {
+      return -EINVAL;
+    }
+
+  map->vaddr  = base;
+  map->priv.p = priv;
+  map->munmap = uring_do_munmap;
+
+  nxmutex_lock(&priv->cqlock);
+  priv->crefs++;
+  nxmutex_unlock(&priv->cqlock);
+
+  ret = mm_map_add(get_current_mm(), map);
+  if (ret < 0)
+    {
+      uring_release(priv);
+    }
+
+  return ret;
+}
+
+#ifdef CONFIG_IO_URING_POLL
+static int uring_do_poll(FAR struct file *filep, FAR struct pollfd *fds,
+                         bool setup)
+{
+  FAR struct uring_priv_s *priv = filep->f_priv;
+  FAR struct uring_rings_s *rings = priv->rings;
+  pollevent_t eventset;
+  int ret = OK;
+  int i;
+
+  nxmutex_lock(&priv->cqlock);
+
+  if (!setup)
+    {
+      /* This is a request to tear down the poll. */
+
+      FAR struct pollfd **slot = (FAR struct pollfd **)fds->priv;
+
+      /* Remove all memory of the poll setup */
+
+      *slot     = NULL;
+      fds->priv = NULL;
+      goto out;
+    }
+
+  /* This is a request to set up the poll. Find an available
+   * slot for the poll structure reference
+   */
+
+  for (i = 0; i < CONFIG_IO_URING_NPOLLWAITERS; i++)
+    {
+      /* Find an available slot */
+
+      if (!priv->fds[i])
+        {
+          /* Bind the poll structure and this slot */
+
+          priv->fds[i] = fds;
+          fds->priv    = &priv->fds[i];
+          break;
+        }
+    }
+
+  if (i >= CONFIG_IO_URING_NPOLLWAITERS)
+    {
+      fds->priv = NULL;
+      ret       = -EBUSY;
+      goto out;
+    }
+
+  /* POLLIN when there are CQEs to reap, POLLOUT when another SQE would
+   * fit into the CQ.
+   */
+
+  eventset = 0;
+  if (rings->cq_tail != rings->cq_head)
+    {
+      eventset |= POLLIN;
+    }
+
+  if (rings->cq_tail - rings->cq_head + priv->inflight <
+      rings->cq_ring_entries)
+    {
+      eventset |= POLLOUT;
+    }
+
+  poll_notify(&fds, 1, eventset);
+
+out:
+  nxmutex_unlock(&priv->cqlock);
+  return ret;
+}
+#endif
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: io_uring_setup
+ *
+ * Description:
+ *   Create a submission/completion ring pair with at least 'entries' SQ
+ *   slots and return a file descriptor for it.  The rings are mapped with
+ *   mmap() at the IORING_OFF_* offsets using the layout returned in 'p'.
+ *
+ * Returned Value:
+ *   A new file descriptor on success; -1 (ERROR) with errno set on
+ *   failure.
+ *
+ ****************************************************************************/
+
+int io_uring_setup(unsigned int entries, FAR struct io_uring_params *p)
+{
+  FAR struct uring_priv_s *priv;
+  FAR struct uring_rings_s *rings;
+  size_t arrayoff;
+  uint32_t sq_entries;
+  uint32_t cq_entries;
+  int fd;
+  int ret;
+
+  if (p == NULL || entries == 0 ||
+      entries > CONFIG_IO_URING_MAXENTRIES || p->flags != 0)
+    {
+      ret = -EINVAL;
+      goto errout;
+    }
+
+  sq_entries = 1;
+  while (sq_entries < entries)
+    {
+      sq_entries <<= 1;
+    }
+
+  cq_entries = 2 * sq_entries;
+
+  /* Create the worker pool on first use */
+
+  nxmutex_lock(&g_uring_lock);
+  if (g_uring_wq == NULL)
+    {
+      g_uring_wq = work_queue_create("io_uring", CONFIG_IO_URING_PRIORITY,
+                                     NULL, CONFIG_IO_URING_STACKSIZE,
+                                     CONFIG_IO_URING_NTHREADS);
+    }
+
+  nxmutex_unlock(&g_uring_lock);
+  if (g_uring_wq == NULL)
+    {
+      ret = -ENOMEM;
+      goto errout;
+    }
+
+  priv = fs_heap_zalloc(sizeof(struct uring_priv_s));
+  if (priv == NULL)
+    {
+      ret = -ENOMEM;
+      goto errout;
+    }
+
+  arrayoff       = offsetof(struct uring_rings_s, cqes) +
+                   cq_entries * sizeof(struct io_uring_cqe);
+  priv->ringsize = arrayoff + sq_entries * sizeof(uint32_t);
+  priv->sqessize = sq_entries * sizeof(struct io_uring_sqe);
+
+  /* The rings are accessed by the user, so they come from the user heap */
+
+  priv->rings = kumm_zalloc(priv->ringsize);
+  priv->sqes  = kumm_zalloc(priv->sqessize);
+  if (priv->rings == NULL || priv->sqes == NULL)
+    {
+      kumm_free(priv->rings);
+      kumm_free(priv->sqes);
+      fs_heap_free(priv);
+      ret = -ENOMEM;
+      goto errout;
+    }
+
+  nxmutex_init(&priv->sqlock);
+  nxmutex_init(&priv->cqlock);
+  nxsem_init(&priv->waitsem, 0, 0);
+  priv->sq_array = (FAR uint32_t *)((FAR uint8_t *)priv->rings + arrayoff);
+  priv->crefs    = 1;
+  priv->nopens   = 1;
+  spin_lock_init(&priv->lock);
+  list_initialize(&priv->pending);
+
+  rings                  = priv->rings;
+  rings->sq_ring_mask    = sq_entries - 1;
+  rings->sq_ring_entries = sq_entries;
+  rings->cq_ring_mask    = cq_entries - 1;
+  rings->cq_ring_entries = cq_entries;
+
+  fd = file_allocate(&g_uring_inode, O_RDWR | O_CLOEXEC, 0, priv, 0, true);
+  if (fd < 0)
+    {
+      uring_destroy(priv);
+      ret = fd;
+      goto errout;
+    }
+
+  memset(&p->sq_off, 0, sizeof(p->sq_off));
+  memset(&p->cq_off, 0, sizeof(p->cq_off));
+
+  p->sq_entries          = sq_entries;
+  p->cq_entries          = cq_entries;
+  p->features            = IORING_FEAT_SINGLE_MMAP | IORING_FEAT_NODROP;
+
+  p->sq_off.head         = offsetof(struct uring_rings_s, sq_head);
+  p->sq_off.tail         = offsetof(struct uring_rings_s, sq_tail);
+  p->sq_off.ring_mask    = offsetof(struct uring_rings_s, sq_ring_mask);
+  p->sq_off.ring_entries = offsetof(struct uring_rings_s, sq_ring_entries);
+  p->sq_off.flags        = offsetof(struct uring_rings_s, sq_flags);
+  p->sq_off.dropped      = offsetof(struct uring_rings_s, sq_dropped);
+  p->sq_off.array        = arrayoff;
+
+  p->cq_off.head         = offsetof(struct uring_rings_s, cq_head);
+  p->cq_off.tail         = offsetof(struct uring_rings_s, cq_tail);
+  p->cq_off.ring_mask    = offsetof(struct uring_rings_s, cq_ring_mask);
+  p->cq_off.ring_entries = offsetof(struct uring_rings_s, cq_ring_entries);
+  p->cq_off.overflow     = offsetof(struct uring_rings_s, cq_overflow);
+  p->cq_off.cqes         = offsetof(struct uring_rings_s, cqes);
+  p->cq_off.flags        = offsetof(struct uring_rings_s, cq_flags);
+
+  return fd;
+
+errout:
+  set_errno(-ret);
+  return ERROR;
+}
+
+/****************************************************************************
+ * Name: io_uring_enter
+ *
+ * Description:
+ *   Submit up to 'to_submit' SQEs from the ring and, with
+ *   IORING_ENTER_GETEVENTS, wait for at least 'min_complete' CQEs.
+ *   Operations that can complete without sleeping run in the caller,
+ *   those that must wait for a file to become ready are completed when
+ *   a poll reports it, and the rest run on a shared pool of worker
+ *   threads.  Closing the ring cancels the operations still waiting.
+ *
+ * Returned Value:
+ *   The number of SQEs consumed on success; -1 (ERROR) with errno set on
+ *   failure.  EBUSY means the CQ must be reaped before more SQEs can be
+ *   submitted.
+ *
+ ****************************************************************************/
+
+int io_uring_enter(int fd, unsigned int to_submit,
+                   unsigned int min_complete, unsigned int flags)
+{
+  FAR struct uring_priv_s *priv;
+  FAR struct file *filep;
+  int submitted = 0;
+  int ret;
+
+  if ((flags & ~IORING_ENTER_GETEVENTS) != 0)
+    {
+      ret = -EINVAL;
+      goto errout;
+    }
+
+  ret = fs_getfilep(fd, &filep);
+  if (ret < 0)
+    {
+      goto errout;
+    }
+
+  if (filep->f_inode != &g_uring_inode)
+    {
+      ret = -EOPNOTSUPP;
+      goto errout_with_filep;
+    }
+
+  priv = filep->f_priv;
+
+  if (to_submit > 0)
+    {
+      submitted = uring_submit(priv, to_submit);
+      if (submitted < 0)
+        {
+          ret = submitted;
+          goto errout_with_filep;
+        }
+    }
+
+  if ((flags & IORING_ENTER_GETEVENTS) != 0)
+    {
+      ret = uring_wait(priv, min_complete);
+      if (ret < 0 && submitted == 0)
+        {
+          goto errout_with_filep;
+        }
+    }
+
+  fs_putfilep(filep);
+  return submitted;
+
+errout_with_filep:
+  fs_putfilep(filep);
+errout:
+  set_errno(-ret);
+  return ERROR;
+}
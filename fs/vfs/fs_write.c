@@ -37,6 +37,7 @@
 
 #include "notify/notify.h"
 #include "inode/inode.h"
+#include "mmap/fs_rammap.h"
 
 /****************************************************************************
  * Private Functions
@@ -174,6 +175,11 @@ ssize_t file_writev(FAR struct file *filep, FAR const struct uio *uio)
     }
 #endif
 
+  if (ret > 0)
+    {
+      rammap_invalidate(inode);
+    }
+
   return ret;
 }
 
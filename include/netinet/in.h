@@ -114,6 +114,8 @@
 #define IP_TTL                (__SO_PROTOCOL + 14) /* The IP TTL (time to live)
                                                     * of IP packets sent by the
                                                     * network stack */
+#define IP_RECVERR            (__SO_PROTOCOL + 15) /* Error queue control
+                                                    * message type */
 
 /* SOL_IPV6 protocol-level socket options. */
 
@@ -136,6 +138,8 @@
                                                     * field */
 #define IPV6_RECVHOPLIMIT     (__SO_PROTOCOL + 11) /* Access the hop limit field */
 #define IPV6_HOPLIMIT         (__SO_PROTOCOL + 12) /* Hop limit */
+#define IPV6_RECVERR          (__SO_PROTOCOL + 13) /* Error queue control
+                                                    * message type */
 
 /* Values used with SIOCSIFMCFILTER and SIOCGIFMCFILTER ioctl's */
 
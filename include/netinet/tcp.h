@@ -27,6 +27,7 @@
  * Included Files
  ****************************************************************************/
 
+#include <stdint.h>
 #include <sys/socket.h>
 
 /****************************************************************************
@@ -58,4 +59,126 @@
                                            * Argument: max retry count */
 #define TCP_MAXSEG    (__SO_PROTOCOL + 4) /* The maximum segment size */
 
+/* Congestion control algorithm of the connection.
+ * Argument: the name of the algorithm, e.g. "cubic"
+ */
+
+#define TCP_CONGESTION  (__SO_PROTOCOL + 5)
+#define TCP_CA_NAME_MAX 16                  /* Maximum length of the name */
+
+/* Return a buffer loaned by recvmsg(MSG_ZEROCOPY) to the stack.
+ * Argument: the struct iovec that recvmsg() filled in
+ */
+
+#define TCP_ZEROCOPY_RELEASE (__SO_PROTOCOL + 6)
+
+/* Statistics of the connection.
+ * Argument: struct tcp_info, may be truncated to the length passed in
+ */
+
+#define TCP_INFO             (__SO_PROTOCOL + 7)
+
+/* Values of tcpi_options */
+
+#define TCPI_OPT_TIMESTAMPS  0x01 /* Timestamps option negotiated */
+#define TCPI_OPT_SACK        0x02 /* SACK permitted option negotiated */
+#define TCPI_OPT_WSCALE      0x04 /* Window scale option negotiated */
+
+/****************************************************************************
+ * Public Type Definitions
+ ****************************************************************************/
+
+/* Returned by getsockopt(TCP_INFO).  The layout up to tcpi_snd_wnd follows
+ * Linux so that existing tools can be built unmodified; tcpi_state uses the
+ * Linux numbering too (1: ESTABLISHED ... 10: LISTEN, 11: CLOSING).  Fields
+ * the stack does not track read as zero.  The NuttX specific fields follow
+ * at the end.
+ */
+
+struct tcp_info
+{
+  uint8_t  tcpi_state;           /* Connection state */
+  uint8_t  tcpi_ca_state;
+  uint8_t  tcpi_retransmits;     /* Retransmissions of the oldest segment */
+  uint8_t  tcpi_probes;
+  uint8_t  tcpi_backoff;
+  uint8_t  tcpi_options;         /* TCPI_OPT_* */
+  uint8_t  tcpi_snd_wscale : 4;  /* Window scale of the peer */
+  uint8_t  tcpi_rcv_wscale : 4;  /* Our window scale */
+  uint8_t  tcpi_delivery_rate_app_limited : 1;
+  uint8_t  tcpi_fastopen_client_fail : 2;
+
+  uint32_t tcpi_rto;             /* Retransmission timeout (units: usec) */
+  uint32_t tcpi_ato;
+  uint32_t tcpi_snd_mss;         /* Maximum segment size to send */
+  uint32_t tcpi_rcv_mss;
+
+  uint32_t tcpi_unacked;         /* Bytes sent but not yet ACKed */
+  uint32_t tcpi_sacked;
+  uint32_t tcpi_lost;
+  uint32_t tcpi_retrans;
+  uint32_t tcpi_fackets;
+
+  /* Times since the events (units: msec) */
+
+  uint32_t tcpi_last_data_sent;
+  uint32_t tcpi_last_ack_sent;
+  uint32_t tcpi_last_data_recv;
+  uint32_t tcpi_last_ack_recv;
+
+  /* Metrics */
+
+  uint32_t tcpi_pmtu;
+  uint32_t tcpi_rcv_ssthresh;
+  uint32_t tcpi_rtt;             /* Smoothed RTT (units: usec) */
+  uint32_t tcpi_rttvar;          /* RTT variation (units: usec) */
+  uint32_t tcpi_snd_ssthresh;    /* Slow start threshold (units: segments) */
+  uint32_t tcpi_snd_cwnd;        /* Congestion window (units: segments) */
+  uint32_t tcpi_advmss;
+  uint32_t tcpi_reordering;
+
+  uint32_t tcpi_rcv_rtt;
+  uint32_t tcpi_rcv_space;       /* Receive window advertised to the peer */
+
+  uint32_t tcpi_total_retrans;   /* Segments retransmitted */
+
+  uint64_t tcpi_pacing_rate;     /* Units: bytes per second */
+  uint64_t tcpi_max_pacing_rate;
+  uint64_t tcpi_bytes_acked;     /* Bytes ACKed by the peer */
+  uint64_t tcpi_bytes_received;  /* Bytes received in sequence */
+  uint32_t tcpi_segs_out;        /* Segments sent, retransmissions included */
+  uint32_t tcpi_segs_in;         /* Segments received */
+
+  uint32_t tcpi_notsent_bytes;   /* Bytes queued but never sent */
+  uint32_t tcpi_min_rtt;         /* Minimum RTT seen (units: usec) */
+  uint32_t tcpi_data_segs_in;    /* Segments received with payload */
+  uint32_t tcpi_data_segs_out;   /* Segments sent with payload */
+
+  uint64_t tcpi_delivery_rate;
+
+  uint64_t tcpi_busy_time;
+  uint64_t tcpi_rwnd_limited;
+  uint64_t tcpi_sndbuf_limited;
+
+  uint32_t tcpi_delivered;
+  uint32_t tcpi_delivered_ce;
+
+  uint64_t tcpi_bytes_sent;      /* Payload bytes sent, retransmissions
+                                  * included */
+  uint64_t tcpi_bytes_retrans;   /* Payload bytes retransmitted */
+  uint32_t tcpi_dsack_dups;
+  uint32_t tcpi_reord_seen;
+
+  uint32_t tcpi_rcv_ooopack;     /* Out-of-order segments received */
+
+  uint32_t tcpi_snd_wnd;         /* Send window advertised by the peer */
+
+  /* NuttX specific */
+
+  uint64_t tcpi_lock_wait;       /* Time the socket calls of this connection
+                                  * waited for the network lock
+                                  * (units: usec) */
+  uint32_t tcpi_lock_waits;      /* Number of those acquisitions */
+};
+
 #endif /* __INCLUDE_NETINET_TCP_H */
@@ -33,6 +33,15 @@
  * Pre-processor Definitions
  ****************************************************************************/
 
+/* UDP protocol (SOL_UDP) socket options */
+
+#define UDP_SEGMENT   (__SO_PROTOCOL + 0) /* Split sends into datagrams of this
+                                           * many payload bytes (int) */
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
 /* UDP header as specified by RFC 768, August 1980. */
 
 struct udphdr
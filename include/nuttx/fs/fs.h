@@ -445,6 +445,9 @@ struct inode
   struct timespec   i_ctime;    /* Time of last status change */
 #endif
   FAR void         *i_private;  /* Per inode driver private data */
+#ifdef CONFIG_FS_INODE_HASH
+  FAR struct inode *i_hash;     /* Link to next inode in hash chain */
+#endif
   char              i_name[1];  /* Name of inode (variable) */
 };
 
@@ -699,6 +702,30 @@ int register_blockpartition(FAR const char *partition,
                             off_t firstsector, off_t nsectors);
 #endif
 
+/****************************************************************************
+ * Name: register_blockcache
+ *
+ * Description:
+ *   Register a block driver that caches the sectors of another block
+ *   driver in a size bounded LRU page cache with read-ahead and write-back.
+ *   Cached writes reach the parent when their page is evicted, when the
+ *   device is closed, or on BIOC_FLUSH.
+ *
+ * Input Parameters:
+ *   cache  - The path to the cache inode
+ *   mode   - Access privileges
+ *   parent - The path to the block driver to be cached
+ *
+ * Returned Value:
+ *   Zero on success; a negated errno value is returned on a failure.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_FS_BLOCKCACHE
+int register_blockcache(FAR const char *cache, mode_t mode,
+                        FAR const char *parent);
+#endif
+
 /****************************************************************************
  * Name: unregister_driver
  *
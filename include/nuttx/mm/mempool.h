@@ -93,6 +93,29 @@ struct mempool_procfs_entry_s
 };
 #endif
 
+#ifdef CONFIG_MM_MEMPOOL_CACHE
+
+/* This structure describes a magazine, a list of free blocks */
+
+struct mempool_magazine_s
+{
+  FAR sq_entry_t *head;  /* The free block list */
+  size_t          count; /* The number of free blocks */
+};
+
+/* This structure describes the magazines of one CPU, the previous magazine
+ * is always either full or empty.
+ */
+
+struct mempool_cache_s
+{
+  struct mempool_magazine_s loaded;   /* The magazine used first */
+  struct mempool_magazine_s previous; /* The magazine swapped out */
+  size_t                    nhit;     /* The allocations without lock */
+  size_t                    nmiss;    /* The allocations from the queue */
+};
+#endif
+
 /* This structure describes memory buffer pool */
 
 struct mempool_s
@@ -106,6 +129,9 @@ struct mempool_s
   mempool_alloc_t alloc;    /* The alloc function for mempool */
   mempool_free_t  free;     /* The free function for mempool */
   mempool_check_t check;    /* The check function for mempool */
+#ifdef CONFIG_MM_MEMPOOL_CACHE
+  size_t     cachesize;     /* The number of free blocks in one magazine */
+#endif
 
   /* Private data for memory pool */
 
@@ -116,6 +142,14 @@ struct mempool_s
   size_t     nalloc;  /* The number of used block in mempool */
   spinlock_t lock;    /* The protect lock to mempool */
   sem_t      waitsem; /* The semaphore of waiter get free block */
+#ifdef CONFIG_MM_MEMPOOL_CACHE
+  FAR sq_entry_t *depot; /* The full magazines shared by all CPUs */
+  size_t     ndepot;     /* The number of full magazines in depot */
+
+  /* The magazines of each CPU */
+
+  struct mempool_cache_s cache[CONFIG_SMP_NCPUS];
+#endif
 #if defined(CONFIG_FS_PROCFS) && !defined(CONFIG_FS_PROCFS_EXCLUDE_MEMPOOL)
   struct mempool_procfs_entry_s procfs; /* The entry of procfs */
 #endif
@@ -143,6 +177,11 @@ struct mempoolinfo_s
   unsigned long aordblks; /* This is the number of used blocks */
   unsigned long sizeblks; /* This is the size of a mempool blocks */
   unsigned long nwaiter;  /* This is the number of waiter for mempool */
+#ifdef CONFIG_MM_MEMPOOL_CACHE
+  unsigned long ncached;  /* This is the number of blocks in magazines */
+  unsigned long nhit;     /* This is the number of hits of magazines */
+  unsigned long nmiss;    /* This is the number of misses of magazines */
+#endif
 };
 
 /****************************************************************************
@@ -333,6 +372,8 @@ void mempool_procfs_unregister(FAR struct mempool_procfs_entry_s *entry);
  *   chunksize       - The multiples pool chunk size.
  *   expandsize      - The expend mempry for all pools in multiples pool.
  *   dict_expendsize - The expend size for multiple dictnoary.
+ *   cachesize       - The number of free blocks in one per-CPU magazine
+ *                     of every pool, 0 disables the per-CPU magazines.
  * Returned Value:
  *   Return an initialized multiple pool pointer on success,
  *   otherwise NULL is returned.
@@ -348,7 +389,7 @@ mempool_multiple_init(FAR const char *name,
                       mempool_multiple_alloc_size_t alloc_size,
                       mempool_multiple_free_t free, FAR void *arg,
                       size_t chunksize, size_t expandsize,
-                      size_t dict_expendsize);
+                      size_t dict_expendsize, size_t cachesize);
 
 /****************************************************************************
  * Name: mempool_multiple_alloc
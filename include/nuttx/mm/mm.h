@@ -174,6 +174,7 @@ struct mempool_init_s
   size_t            chunksize;
   size_t            expandsize;
   size_t            dict_expendsize;
+  size_t            cachesize;
 };
 
 /****************************************************************************
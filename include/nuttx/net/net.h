@@ -181,6 +181,12 @@ struct sock_intf_s
                     FAR struct file *infile, FAR off_t *offset,
                     size_t count);
 #endif
+  CODE int        (*si_sendmmsg)(FAR struct socket *psock,
+                    FAR struct mmsghdr *msgvec, unsigned int vlen,
+                    int flags);
+  CODE int        (*si_recvmmsg)(FAR struct socket *psock,
+                    FAR struct mmsghdr *msgvec, unsigned int vlen,
+                    int flags, FAR const struct timespec *timeout);
 };
 
 /* Each socket refers to a connection structure of type FAR void *.  Each
@@ -220,6 +226,13 @@ struct socket_conn_s
   uint8_t       s_boundto;   /* Index of the interface we are bound to.
                               * Unbound: 0, Bound: 1-MAX_IFINDEX */
 #  endif
+#  ifdef CONFIG_NET_ZEROCOPY
+  uint32_t      s_zcnext;    /* Id of the next MSG_ZEROCOPY send */
+  uint32_t      s_zclo;      /* First completed id not yet reported */
+  uint32_t      s_zchi;      /* Last completed id not yet reported */
+  bool          s_zcready;   /* s_zclo..s_zchi is valid */
+  bool          s_zccopied;  /* Some of the range was copied */
+#  endif
 #endif
 
   /* Definitions of 8-bit socket flags */
@@ -928,6 +941,53 @@ ssize_t psock_sendmsg(FAR struct socket *psock, FAR struct msghdr *msg,
 ssize_t psock_recvmsg(FAR struct socket *psock, FAR struct msghdr *msg,
                       int flags);
 
+/****************************************************************************
+ * Name: psock_sendmmsg
+ *
+ * Description:
+ *   psock_sendmmsg() sends up to 'vlen' messages with a single call.  It is
+ *   the internal OS interface of sendmmsg(), see psock_sendmsg().
+ *
+ * Input Parameters:
+ *   psock     A pointer to a NuttX-specific, internal socket structure
+ *   msgvec    The messages to send; msg_len receives the bytes sent
+ *   vlen      The number of messages in msgvec
+ *   flags     Send flags
+ *
+ * Returned Value:
+ *   The number of messages sent.  A negated errno value is returned only
+ *   if the first message could not be sent.
+ *
+ ****************************************************************************/
+
+int psock_sendmmsg(FAR struct socket *psock, FAR struct mmsghdr *msgvec,
+                   unsigned int vlen, int flags);
+
+/****************************************************************************
+ * Name: psock_recvmmsg
+ *
+ * Description:
+ *   psock_recvmmsg() receives up to 'vlen' messages with a single call.  It
+ *   is the internal OS interface of recvmmsg(), see psock_recvmsg().
+ *
+ * Input Parameters:
+ *   psock     A pointer to a NuttX-specific, internal socket structure
+ *   msgvec    The message buffers; msg_len receives the bytes received
+ *   vlen      The number of messages in msgvec
+ *   flags     Receive flags, MSG_WAITFORONE turns on MSG_DONTWAIT after
+ *             the first message
+ *   timeout   If not NULL, stop once this much time has passed
+ *
+ * Returned Value:
+ *   The number of messages received.  A negated errno value is returned
+ *   only if no message was received.
+ *
+ ****************************************************************************/
+
+int psock_recvmmsg(FAR struct socket *psock, FAR struct mmsghdr *msgvec,
+                   unsigned int vlen, int flags,
+                   FAR const struct timespec *timeout);
+
 /****************************************************************************
  * Name: psock_send
  *
@@ -474,6 +474,17 @@ struct net_driver_s
 
   uint16_t d_sndlen;
 
+#ifdef CONFIG_NETDEV_GSO
+  /* TCP segmentation offload.  d_gso_max is the largest TCP payload that
+   * the driver accepts in one packet (zero if it does not segment).
+   * d_gso_size is the segment size of the outgoing packet if it carries
+   * more than one segment, and zero otherwise.
+   */
+
+  uint16_t d_gso_max;
+  uint16_t d_gso_size;
+#endif
+
   /* Multicast group support */
 
 #ifdef CONFIG_NET_IGMP
@@ -810,6 +821,44 @@ void netdev_carrier_off(FAR struct net_driver_s *dev);
 
 uint16_t chksum(uint16_t sum, FAR const uint8_t *data, uint16_t len);
 
+/****************************************************************************
+ * Name: chksum_copy
+ *
+ * Description:
+ *   Copy a buffer and calculate the raw change sum over the copied data in
+ *   the same pass.
+ *
+ * Input Parameters:
+ *   sum  - Partial calculations carried over from a previous call to
+ *          chksum().  This should be zero on the first time that check
+ *          sum is called.
+ *   dest - Destination of the copy.
+ *   src  - Beginning of the data to copy and include in the checksum.
+ *   len  - Length of the data to copy and include in the checksum.
+ *
+ * Returned Value:
+ *   The updated checksum value.
+ *
+ ****************************************************************************/
+
+uint16_t chksum_copy(uint16_t sum, FAR uint8_t *dest,
+                     FAR const uint8_t *src, uint16_t len);
+
+/****************************************************************************
+ * Name: up_chksum_partial
+ *
+ * Description:
+ *   Return the 16-bit one's complement sum of the data loaded in native
+ *   byte order.  A trailing odd byte is summed as if followed by a zero
+ *   byte.  Provided by architecture-specific logic if
+ *   CONFIG_NET_ARCH_CHKSUM_PARTIAL is defined.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_ARCH_CHKSUM_PARTIAL
+uint16_t up_chksum_partial(FAR const uint8_t *data, size_t len);
+#endif
+
 /****************************************************************************
  * Name: chksum_iob
  *
@@ -830,6 +879,31 @@ uint16_t chksum(uint16_t sum, FAR const uint8_t *data, uint16_t len);
 
 uint16_t chksum_iob(uint16_t sum, FAR struct iob_s *iob, uint16_t offset);
 
+/****************************************************************************
+ * Name: chksum_iob_copyin
+ *
+ * Description:
+ *   Append data to the end of an iob chain, extending the chain as
+ *   necessary, and calculate the raw change sum over the appended data
+ *   while it is copied.
+ *
+ * Input Parameters:
+ *   iob       - The head of the iob chain to append to.
+ *   src       - Beginning of the data to copy.
+ *   len       - Length of the data to copy.
+ *   can_block - True if the allocation of further iobs may wait.
+ *   sum       - The location of the running checksum.  This should be
+ *               zero before the first call.  It is updated on return.
+ *
+ * Returned Value:
+ *   The number of bytes copied, or -ENOMEM if the chain could not be
+ *   extended.
+ *
+ ****************************************************************************/
+
+int chksum_iob_copyin(FAR struct iob_s *iob, FAR const uint8_t *src,
+                      unsigned int len, bool can_block, FAR uint16_t *sum);
+
 /****************************************************************************
  * Name: net_chksum
  *
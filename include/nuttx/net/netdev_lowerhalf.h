@@ -72,6 +72,11 @@
 #define NETPKT_BUFLEN   CONFIG_IOB_BUFSIZE
 #define NETPKT_BUFNUM   CONFIG_IOB_NBUFFERS
 
+/* Offload features of a lower half driver */
+
+#define NETDEV_F_TSO4   (1 << 0) /* TCP segmentation offload over IPv4 */
+#define NETDEV_F_TSO6   (1 << 1) /* TCP segmentation offload over IPv6 */
+
 /****************************************************************************
  * Public Types
  ****************************************************************************/
@@ -119,6 +124,25 @@ struct netdev_lowerhalf_s
 
   atomic_int quota[NETPKT_TYPENUM];
 
+#ifdef CONFIG_NETDEV_MULTIQUEUE
+  /* Number of RX/TX queue pairs, set before registering (0 means 1).
+   * The quota above is shared by all the queues.
+   */
+
+  uint8_t nqueues;
+#endif
+
+#ifdef CONFIG_NETDEV_GSO
+  /* Offloads of the hardware (NETDEV_F_*), set before registering.  With
+   * NETDEV_F_TSO4/TSO6, transmit() may get TCP packets longer than the
+   * MTU, which the hardware must cut into segments of netdev.d_gso_size
+   * bytes of payload.  netdev.d_gso_size is only valid during transmit()
+   * and is zero for packets that fit the MTU.
+   */
+
+  uint8_t features;
+#endif
+
   /* The structure used by net stack.
    * Note: Do not change its fields unless you know what you are doing.
    *
@@ -172,6 +196,20 @@ struct netdev_ops_s
   /* reclaim - try to reclaim packets sent by netdev. */
 
   CODE void (*reclaim)(FAR struct netdev_lowerhalf_s *dev);
+
+#ifdef CONFIG_NETDEV_MULTIQUEUE
+  /* transmit_queue/receive_queue - Like transmit and receive, on the queue
+   *   pair 'queue' (0 ~ nqueues - 1).  Optional, transmit and receive are
+   *   used for all the queues if not provided.  As receive, receive_queue
+   *   should re-enable the RX interrupt of the queue when it finds the
+   *   queue empty.
+   */
+
+  CODE int (*transmit_queue)(FAR struct netdev_lowerhalf_s *dev,
+                             unsigned int queue, FAR netpkt_t *pkt);
+  CODE FAR netpkt_t *(*receive_queue)(FAR struct netdev_lowerhalf_s *dev,
+                                      unsigned int queue);
+#endif
 };
 
 /* This structure is a set of wireless handlers, leave unsupported operations
@@ -308,6 +346,27 @@ void netdev_lower_rxready(FAR struct netdev_lowerhalf_s *dev);
 
 void netdev_lower_txdone(FAR struct netdev_lowerhalf_s *dev);
 
+/****************************************************************************
+ * Name: netdev_lower_rxready_queue / netdev_lower_txdone_queue
+ *
+ * Description:
+ *   Like netdev_lower_rxready and netdev_lower_txdone, for the queue pair
+ *   'queue' of a multi-queue device.  Only the poll work of that queue is
+ *   scheduled.
+ *
+ * Input Parameters:
+ *   dev   - The lower half device driver structure
+ *   queue - The index of the queue pair
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NETDEV_MULTIQUEUE
+void netdev_lower_rxready_queue(FAR struct netdev_lowerhalf_s *dev,
+                                unsigned int queue);
+void netdev_lower_txdone_queue(FAR struct netdev_lowerhalf_s *dev,
+                               unsigned int queue);
+#endif
+
 /****************************************************************************
  * Name: netdev_lower_quota_load
  *
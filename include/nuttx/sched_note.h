@@ -480,9 +480,13 @@ struct note_heap_s
 struct note_printf_s
 {
   struct note_common_s npt_cmn; /* Common note parameters */
+#ifndef CONFIG_DRIVERS_NOTE_PRINTF_COMPACT
   uintptr_t npt_ip;             /* Instruction pointer called from */
+#endif
   FAR const char *npt_fmt;      /* Printf format string */
+#ifndef CONFIG_DRIVERS_NOTE_PRINTF_COMPACT
   uint32_t npt_type;            /* Printf parameter type */
+#endif
   char npt_data[1];             /* Print arguments */
 };
 
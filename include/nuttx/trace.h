@@ -138,9 +138,11 @@
 #ifdef CONFIG_TRACE_NET
 #  define net_trace_begin() trace_begin(NOTE_TAG_NET)
 #  define net_trace_end() trace_end(NOTE_TAG_NET)
+#  define net_trace_printf(fmt, ...) sched_note_printf(NOTE_TAG_NET, fmt, ##__VA_ARGS__)
 #else
 #  define net_trace_begin()
 #  define net_trace_end()
+#  define net_trace_printf(...)
 #endif
 
 #ifdef CONFIG_TRACE_SCHED
@@ -88,6 +88,9 @@ struct wdog_s
   FAR void          *picbase;    /* PIC base address */
 #endif
   clock_t            expired;    /* Timer associated with the absoulute time */
+#ifdef CONFIG_WDOG_PERCPU
+  uint8_t            cpu;        /* CPU whose queue holds the watchdog */
+#endif
 };
 
 /****************************************************************************
@@ -141,6 +144,32 @@ extern "C"
 int wd_start(FAR struct wdog_s *wdog, sclock_t delay,
              wdentry_t wdentry, wdparm_t arg);
 
+/****************************************************************************
+ * Name: wd_start_cpu
+ *
+ * Description:
+ *   This function is the same as wd_start() except that the watchdog
+ *   function is executed on the specified CPU instead of the CPU calling
+ *   wd_start_cpu().
+ *
+ * Input Parameters:
+ *   wdog     - Watchdog ID
+ *   cpu      - The CPU to execute the watchdog function on
+ *   delay    - Delay count in clock ticks
+ *   wdentry  - Function to call on timeout
+ *   arg      - Parameter to pass to wdentry
+ *
+ * Returned Value:
+ *   Zero (OK) is returned on success; a negated errno value is return to
+ *   indicate the nature of any failure.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_WDOG_PERCPU
+int wd_start_cpu(FAR struct wdog_s *wdog, int cpu, sclock_t delay,
+                 wdentry_t wdentry, wdparm_t arg);
+#endif
+
 /****************************************************************************
  * Name: wd_start_abstick
  *
@@ -0,0 +1,179 @@
+/****************************************************************************
+ * include/sys/io_uring.h
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+#ifndef __INCLUDE_SYS_IO_URING_H
+#define __INCLUDE_SYS_IO_URING_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Offsets passed to mmap() to map the rings.  The submission and the
+ * completion ring share one mapping (IORING_FEAT_SINGLE_MMAP).
+ */
+
+#define IORING_OFF_SQ_RING      0
+#define IORING_OFF_CQ_RING      0x8000000
+#define IORING_OFF_SQES         0x10000000
+
+/* io_uring_params.features */
+
+#define IORING_FEAT_SINGLE_MMAP (1u << 0)
+#define IORING_FEAT_NODROP      (1u << 1)
+
+/* io_uring_sqe.flags */
+
+#define IOSQE_IO_LINK           (1u << 2) /* Run the next SQE after this one */
+#define IOSQE_ASYNC             (1u << 4) /* Always run in a worker thread */
+
+/* io_uring_sqe.fsync_flags */
+
+#define IORING_FSYNC_DATASYNC   (1u << 0)
+
+/* io_uring_enter() flags */
+
+#define IORING_ENTER_GETEVENTS  (1u << 0)
+
+/* Operation codes, numbered as on Linux */
+
+#define IORING_OP_NOP           0
+#define IORING_OP_READV         1
+#define IORING_OP_WRITEV        2
+#define IORING_OP_FSYNC         3
+#define IORING_OP_POLL_ADD      6
+#define IORING_OP_READ          22
+#define IORING_OP_WRITE         23
+#define IORING_OP_SEND          26
+#define IORING_OP_RECV          27
+
+/****************************************************************************
+ * Public Type Definitions
+ ****************************************************************************/
+
+/* Submission queue entry.  'off' of (uint64_t)-1 uses and advances the
+ * current file position.
+ */
+
+struct io_uring_sqe
+{
+  uint8_t  opcode;              /* IORING_OP_* */
+  uint8_t  flags;               /* IOSQE_* */
+  uint16_t ioprio;              /* Unused */
+  int32_t  fd;                  /* File descriptor to do the I/O on */
+  uint64_t off;                 /* File offset */
+  uint64_t addr;                /* Buffer or iovec array */
+  uint32_t len;                 /* Buffer size or number of iovecs */
+  union
+  {
+    uint32_t rw_flags;
+    uint32_t fsync_flags;       /* IORING_FSYNC_* */
+    uint32_t poll_events;       /* POLL* events to wait for */
+    uint32_t msg_flags;         /* MSG_* flags of send and recv */
+  };
+  uint64_t user_data;           /* Passed back in the completion */
+};
+
+/* Completion queue entry */
+
+struct io_uring_cqe
+{
+  uint64_t user_data;           /* From the submission */
+  int32_t  res;                 /* Result, or a negated errno value */
+  uint32_t flags;
+};
+
+/* Offsets of the submission ring fields in the ring mapping */
+
+struct io_sqring_offsets
+{
+  uint32_t head;
+  uint32_t tail;
+  uint32_t ring_mask;
+  uint32_t ring_entries;
+  uint32_t flags;
+  uint32_t dropped;
+  uint32_t array;
+  uint32_t resv1;
+  uint64_t resv2;
+};
+
+/* Offsets of the completion ring fields in the ring mapping */
+
+struct io_cqring_offsets
+{
+  uint32_t head;
+  uint32_t tail;
+  uint32_t ring_mask;
+  uint32_t ring_entries;
+  uint32_t overflow;
+  uint32_t cqes;
+  uint32_t flags;
+  uint32_t resv1;
+  uint64_t resv2;
+};
+
+/* Passed to and returned by io_uring_setup() */
+
+struct io_uring_params
+{
+  uint32_t sq_entries;          /* Returned: entries in the submission ring */
+  uint32_t cq_entries;          /* Returned: entries in the completion ring */
+  uint32_t flags;               /* Must be zero */
+  uint32_t sq_thread_cpu;
+  uint32_t sq_thread_idle;
+  uint32_t features;            /* Returned: IORING_FEAT_* */
+  uint32_t wq_fd;
+  uint32_t resv[3];
+  struct io_sqring_offsets sq_off;
+  struct io_cqring_offsets cq_off;
+};
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+#ifdef __cplusplus
+#define EXTERN extern "C"
+extern "C"
+{
+#else
+#define EXTERN extern
+#endif
+
+int io_uring_setup(unsigned int entries, FAR struct io_uring_params *p);
+int io_uring_enter(int fd, unsigned int to_submit,
+                   unsigned int min_complete, unsigned int flags);
+
+#undef EXTERN
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __INCLUDE_SYS_IO_URING_H */
@@ -68,6 +68,10 @@
  *     Indicate that should ALWAYS call the poll callback whether the
  *     drvier notified the user expected event or not, and this value is
  *     used inside kernal only (events only).
+ *   POLLEXCLUSIVE
+ *     Indicate that only one of the exclusive waiters of the same file is
+ *     notified per event, this value is used by EPOLLEXCLUSIVE
+ *     (events only).
  */
 
 #define POLLIN       (0x01)  /* NuttX does not make priority distinctions */
@@ -87,6 +91,10 @@
 
 #define POLLALWAYS   (0x10000) /* For not conflict with Linux */
 
+/* Same value as Linux EPOLLEXCLUSIVE */
+
+#define POLLEXCLUSIVE (0x10000000)
+
 /****************************************************************************
  * Public Type Definitions
  ****************************************************************************/
@@ -136,9 +136,13 @@
 #define MSG_ERRQUEUE     0x002000 /* Fetch message from error queue.  */
 #define MSG_NOSIGNAL     0x004000 /* Do not generate SIGPIPE.  */
 #define MSG_MORE         0x008000 /* Sender will send more.  */
+#define MSG_WAITFORONE   0x010000 /* recvmmsg(): block until 1+ packets avail */
 #define MSG_CMSG_CLOEXEC 0x100000 /* Set close_on_exit for file
                                    * descriptor received through SCM_RIGHTS.
                                    */
+#define MSG_ZEROCOPY    0x4000000 /* Send from (or receive into) buffers
+                                   * shared with the stack, see SO_ZEROCOPY.
+                                   */
 
 /* Protocol levels supported by get/setsockopt(): */
 
@@ -220,6 +224,14 @@
 #define SO_PEERCRED     18 /* Return the credentials of the peer process
                             * connected to this socket.
                             */
+#define SO_ZEROCOPY     19 /* Enables MSG_ZEROCOPY transfers (get/set).
+                            * arg: integer value
+                            */
+#define SO_REUSEPORT    20 /* Allow several sockets to bind the same port and
+                            * share its traffic (get/set).
+                            * arg: pointer to integer containing a boolean
+                            * value
+                            */
 
 /* The options are unsupported but included for compatibility
  * and portability
@@ -312,6 +324,17 @@
 #define DENY_INET_SOCK_ENABLE  0x01   /* Deny to create INET socket */
 #define DENY_INET_SOCK_DISABLE 0x02   /* Not deny to create INET socket */
 
+/* Values of ee_origin and ee_code in struct sock_extended_err */
+
+#define SO_EE_ORIGIN_NONE           0
+#define SO_EE_ORIGIN_LOCAL          1
+#define SO_EE_ORIGIN_ICMP           2
+#define SO_EE_ORIGIN_ICMP6          3
+#define SO_EE_ORIGIN_ZEROCOPY       5 /* MSG_ZEROCOPY completion, the ids
+                                       * ee_info..ee_data have completed */
+
+#define SO_EE_CODE_ZEROCOPY_COPIED  1 /* The data was copied after all */
+
 /****************************************************************************
  * Type Definitions
  ****************************************************************************/
@@ -372,6 +395,16 @@ struct msghdr
   unsigned int msg_flags;
 };
 
+struct timespec; /* Forward reference, see time.h */
+
+/* Used with sendmmsg() and recvmmsg() */
+
+struct mmsghdr
+{
+  struct msghdr msg_hdr;        /* Message header */
+  unsigned int msg_len;         /* Number of bytes transferred */
+};
+
 struct cmsghdr
 {
   unsigned long cmsg_len;       /* Data byte count, including hdr */
@@ -386,6 +419,21 @@ struct ucred
   gid_t gid;
 };
 
+/* Reported by recvmsg(MSG_ERRQUEUE) as IP_RECVERR/IPV6_RECVERR control
+ * message.
+ */
+
+struct sock_extended_err
+{
+  uint32_t ee_errno;            /* Error number */
+  uint8_t  ee_origin;           /* Where the error originated */
+  uint8_t  ee_type;             /* Type */
+  uint8_t  ee_code;             /* Code */
+  uint8_t  ee_pad;              /* Padding */
+  uint32_t ee_info;             /* Additional information */
+  uint32_t ee_data;             /* Other data */
+};
+
 /****************************************************************************
  * Inline Functions
  ****************************************************************************/
@@ -459,6 +507,11 @@ int getpeername(int sockfd, FAR struct sockaddr *addr,
 ssize_t recvmsg(int sockfd, FAR struct msghdr *msg, int flags);
 ssize_t sendmsg(int sockfd, FAR struct msghdr *msg, int flags);
 
+int recvmmsg(int sockfd, FAR struct mmsghdr *msgvec, unsigned int vlen,
+             int flags, FAR struct timespec *timeout);
+int sendmmsg(int sockfd, FAR struct mmsghdr *msgvec, unsigned int vlen,
+             int flags);
+
 #if CONFIG_FORTIFY_SOURCE > 0
 fortify_function(send) ssize_t send(int sockfd, FAR const void *buf,
                                     size_t len, int flags)
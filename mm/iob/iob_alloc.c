@@ -380,6 +380,7 @@ FAR struct iob_s *iob_alloc_dynamic(uint16_t size)
       iob->io_free    = iob_free_dynamic; /* Customer free callback */
       iob->io_data    = (FAR uint8_t *)ROUNDUP((uintptr_t)(iob + 1),
                                                CONFIG_IOB_ALIGNMENT);
+      iob->io_priv    = iob->io_data;     /* Argument of io_free */
     }
 
   return iob;
@@ -404,7 +405,8 @@ FAR struct iob_s *iob_alloc_dynamic(uint16_t size)
  *   size    - The size of the data parameter
  *   free_cb - Notify the caller when the iob is freed. The caller can
  *             perform additional operations on the data before it is freed.
- *             The free_cb is called when the iob is freed.
+ *             The free_cb is called with io_priv, which is 'data' unless
+ *             the caller changes it after the allocation.
  *
  ****************************************************************************/
 
@@ -424,6 +426,7 @@ FAR struct iob_s *iob_alloc_with_data(FAR void *data, uint16_t size,
       iob->io_bufsize = size;    /* Total length of the iob buffer */
       iob->io_pktlen  = 0;       /* Total length of the packet */
       iob->io_free    = free_cb; /* Customer free callback */
+      iob->io_priv    = data;    /* Argument of io_free */
       iob->io_data    = data;
     }
 
@@ -40,6 +40,13 @@
  * Pre-processor Definitions
  ****************************************************************************/
 
+/* A full magazine in the depot is linked by its first block, the first word
+ * of the block links the blocks in the magazine, and the second word links
+ * the magazines in the depot.
+ */
+
+#define MEMPOOL_MAGAZINE_NEXT(blk) (((FAR sq_entry_t **)(blk))[1])
+
 #if CONFIG_MM_BACKTRACE >= 0
 #define MEMPOOL_MAGIC_FREE  0xAAAAAAAA
 #define MEMPOOL_MAGIC_ALLOC 0x55555555
@@ -98,6 +105,170 @@ static inline void mempool_add_queue(FAR struct mempool_s *pool,
     }
 }
 
+#ifdef CONFIG_MM_MEMPOOL_CACHE
+static inline FAR sq_entry_t *
+mempool_magazine_pop(FAR struct mempool_magazine_s *mag)
+{
+  FAR sq_entry_t *blk = mag->head;
+
+  mag->head = blk->flink;
+  mag->count--;
+  blk->flink = NULL;
+  return blk;
+}
+
+static inline void mempool_magazine_push(FAR struct mempool_magazine_s *mag,
+                                         FAR sq_entry_t *blk)
+{
+  blk->flink = mag->head;
+  mag->head = blk;
+  mag->count++;
+}
+
+static inline void mempool_magazine_swap(FAR struct mempool_cache_s *cache)
+{
+  struct mempool_magazine_s tmp = cache->loaded;
+
+  cache->loaded = cache->previous;
+  cache->previous = tmp;
+}
+
+/* Allocate a block from the magazines of the current CPU, they are
+ * protected by disabling the local interrupts.  The mempool lock is only
+ * taken to exchange the empty magazines for a full one in the depot.
+ */
+
+static inline FAR sq_entry_t *
+mempool_cache_allocate(FAR struct mempool_s *pool)
+{
+  FAR struct mempool_cache_s *cache;
+  FAR sq_entry_t *blk;
+  irqstate_t flags;
+
+  flags = up_irq_save();
+  cache = &pool->cache[this_cpu()];
+  if (cache->loaded.count == 0)
+    {
+      if (cache->previous.count > 0)
+        {
+          /* The previous magazine is full, use it */
+
+          mempool_magazine_swap(cache);
+        }
+      else
+        {
+          /* Both magazines are empty, load a full one from the depot */
+
+          spin_lock(&pool->lock);
+          blk = pool->depot;
+          if (blk != NULL)
+            {
+              pool->depot = MEMPOOL_MAGAZINE_NEXT(blk);
+              pool->ndepot--;
+            }
+
+          spin_unlock(&pool->lock);
+          if (blk == NULL)
+            {
+              up_irq_restore(flags);
+              return NULL;
+            }
+
+          cache->loaded.head = blk;
+          cache->loaded.count = pool->cachesize;
+        }
+    }
+
+  blk = mempool_magazine_pop(&cache->loaded);
+  cache->nhit++;
+  up_irq_restore(flags);
+  return blk;
+}
+
+/* Fill the loaded magazine of the current CPU from the free queue, the
+ * caller must hold the mempool lock with the interrupts disabled.
+ */
+
+static inline void mempool_cache_refill(FAR struct mempool_s *pool)
+{
+  FAR struct mempool_cache_s *cache = &pool->cache[this_cpu()];
+  FAR sq_entry_t *blk;
+
+  cache->nmiss++;
+  while (cache->loaded.count < pool->cachesize &&
+         (blk = mempool_remove_queue(pool, &pool->queue)) != NULL)
+    {
+      mempool_magazine_push(&cache->loaded, blk);
+      pool->nalloc++;
+    }
+}
+
+/* Move all blocks of the magazine back to the free queue, the caller must
+ * hold the mempool lock with the interrupts disabled.
+ */
+
+static inline void mempool_magazine_drain(FAR struct mempool_s *pool,
+                                          FAR struct mempool_magazine_s *mag)
+{
+  while (mag->count > 0)
+    {
+      sq_addlast(mempool_magazine_pop(mag), &pool->queue);
+      pool->nalloc--;
+    }
+}
+
+/* Release a block to the magazines of the current CPU, return false if the
+ * block can't be cached.
+ */
+
+static inline bool mempool_cache_release(FAR struct mempool_s *pool,
+                                         FAR void *blk)
+{
+  FAR struct mempool_cache_s *cache;
+  irqstate_t flags;
+
+  /* The block of the interrupt mempool always goes back to iqueue */
+
+  if (pool->cachesize == 0 ||
+      ((FAR char *)blk >= pool->ibase &&
+       (FAR char *)blk < pool->ibase + pool->interruptsize))
+    {
+      return false;
+    }
+
+  flags = up_irq_save();
+  cache = &pool->cache[this_cpu()];
+  if (cache->loaded.count >= pool->cachesize)
+    {
+      if (cache->previous.count == 0)
+        {
+          /* The previous magazine is empty, use it */
+
+          mempool_magazine_swap(cache);
+        }
+      else
+        {
+          /* Both magazines are full, give the previous one to the depot */
+
+          spin_lock(&pool->lock);
+          MEMPOOL_MAGAZINE_NEXT(cache->previous.head) = pool->depot;
+          pool->depot = cache->previous.head;
+          pool->ndepot++;
+          spin_unlock(&pool->lock);
+
+          cache->previous = cache->loaded;
+          cache->loaded.head = NULL;
+          cache->loaded.count = 0;
+        }
+    }
+
+  mempool_magazine_push(&cache->loaded, blk);
+  kasan_poison(blk, pool->blocksize);
+  up_irq_restore(flags);
+  return true;
+}
+#endif
+
 #if CONFIG_MM_BACKTRACE >= 0
 static inline void mempool_add_backtrace(FAR struct mempool_s *pool,
                                          FAR struct mempool_backtrace_s *buf)
@@ -303,6 +474,24 @@ int mempool_init(FAR struct mempool_s *pool, FAR const char *name)
     }
 
   spin_initialize(&pool->lock, SP_UNLOCKED);
+
+#ifdef CONFIG_MM_MEMPOOL_CACHE
+  /* Only the expandable mempool can use the per-CPU magazines, otherwise
+   * the blocks held by other CPU's magazines may make the mempool look
+   * exhausted.  The block must be large enough to link the magazines.
+   */
+
+  if (pool->expandsize < blocksize + sizeof(sq_entry_t) ||
+      pool->blocksize < 2 * sizeof(FAR sq_entry_t *))
+    {
+      pool->cachesize = 0;
+    }
+
+  memset(pool->cache, 0, sizeof(pool->cache));
+  pool->depot = NULL;
+  pool->ndepot = 0;
+#endif
+
   if (pool->wait && pool->expandsize == 0)
     {
       nxsem_init(&pool->waitsem, 0, 0);
@@ -342,6 +531,17 @@ FAR void *mempool_allocate(FAR struct mempool_s *pool)
   FAR sq_entry_t *blk;
   irqstate_t flags;
 
+#ifdef CONFIG_MM_MEMPOOL_CACHE
+  if (pool->cachesize > 0)
+    {
+      blk = mempool_cache_allocate(pool);
+      if (blk != NULL)
+        {
+          goto out;
+        }
+    }
+#endif
+
 retry:
   flags = spin_lock_irqsave(&pool->lock);
   blk = mempool_remove_queue(pool, &pool->queue);
@@ -394,7 +594,18 @@ retry:
     }
 
   pool->nalloc++;
+#ifdef CONFIG_MM_MEMPOOL_CACHE
+  if (pool->cachesize > 0)
+    {
+      mempool_cache_refill(pool);
+    }
+#endif
+
   spin_unlock_irqrestore(&pool->lock, flags);
+
+#ifdef CONFIG_MM_MEMPOOL_CACHE
+out:
+#endif
   blk = kasan_unpoison(blk, pool->blocksize);
 #ifdef CONFIG_MM_FILL_ALLOCATIONS
   memset(blk, MM_ALLOC_MAGIC, pool->blocksize);
@@ -421,8 +632,8 @@ retry:
 
 void mempool_release(FAR struct mempool_s *pool, FAR void *blk)
 {
-  irqstate_t flags = spin_lock_irqsave(&pool->lock);
   size_t blocksize = MEMPOOL_REALBLOCKSIZE(pool);
+  irqstate_t flags;
 #if CONFIG_MM_BACKTRACE >= 0
   FAR struct mempool_backtrace_s *buf =
     (FAR struct mempool_backtrace_s *)((FAR char *)blk + pool->blocksize);
@@ -434,12 +645,20 @@ void mempool_release(FAR struct mempool_s *pool, FAR void *blk)
 
 #endif
 
-  pool->nalloc--;
-
 #ifdef CONFIG_MM_FILL_ALLOCATIONS
   memset(blk, MM_FREE_MAGIC, pool->blocksize);
 #endif
 
+#ifdef CONFIG_MM_MEMPOOL_CACHE
+  if (mempool_cache_release(pool, blk))
+    {
+      return;
+    }
+#endif
+
+  flags = spin_lock_irqsave(&pool->lock);
+  pool->nalloc--;
+
   if (pool->interruptsize > blocksize)
     {
       if ((FAR char *)blk >= pool->ibase &&
@@ -489,6 +708,9 @@ int mempool_info(FAR struct mempool_s *pool, FAR struct mempoolinfo_s *info)
 {
   size_t blocksize = MEMPOOL_REALBLOCKSIZE(pool);
   irqstate_t flags;
+#ifdef CONFIG_MM_MEMPOOL_CACHE
+  int i;
+#endif
 
   DEBUGASSERT(pool != NULL && info != NULL);
 
@@ -496,6 +718,24 @@ int mempool_info(FAR struct mempool_s *pool, FAR struct mempoolinfo_s *info)
   info->ordblks = sq_count(&pool->queue);
   info->iordblks = sq_count(&pool->iqueue);
   info->aordblks = pool->nalloc;
+#ifdef CONFIG_MM_MEMPOOL_CACHE
+  info->nhit = 0;
+  info->nmiss = 0;
+  info->ncached = pool->ndepot * pool->cachesize;
+  for (i = 0; i < CONFIG_SMP_NCPUS; i++)
+    {
+      info->ncached += pool->cache[i].loaded.count +
+                       pool->cache[i].previous.count;
+      info->nhit += pool->cache[i].nhit;
+      info->nmiss += pool->cache[i].nmiss;
+    }
+
+  /* The blocks in the magazines and the depot are free */
+
+  info->aordblks -= info->ncached;
+  info->ordblks += info->ncached;
+#endif
+
   info->arena = sq_count(&pool->equeue) * sizeof(sq_entry_t) +
     (info->aordblks + info->ordblks + info->iordblks) * blocksize;
   spin_unlock_irqrestore(&pool->lock, flags);
@@ -610,6 +850,31 @@ int mempool_deinit(FAR struct mempool_s *pool)
   size_t blocksize = MEMPOOL_REALBLOCKSIZE(pool);
   FAR sq_entry_t *blk;
   size_t count = 0;
+#ifdef CONFIG_MM_MEMPOOL_CACHE
+  struct mempool_magazine_s mag;
+  irqstate_t flags;
+  int i;
+
+  /* Give back the blocks in the magazines and the depot before checking */
+
+  flags = spin_lock_irqsave(&pool->lock);
+  for (i = 0; i < CONFIG_SMP_NCPUS; i++)
+    {
+      mempool_magazine_drain(pool, &pool->cache[i].loaded);
+      mempool_magazine_drain(pool, &pool->cache[i].previous);
+    }
+
+  while (pool->depot != NULL)
+    {
+      mag.head = pool->depot;
+      mag.count = pool->cachesize;
+      pool->depot = MEMPOOL_MAGAZINE_NEXT(mag.head);
+      pool->ndepot--;
+      mempool_magazine_drain(pool, &mag);
+    }
+
+  spin_unlock_irqrestore(&pool->lock, flags);
+#endif
 
   if (pool->nalloc != 0)
     {
@@ -386,6 +386,8 @@ static void mempool_multiple_check(FAR struct mempool_s *pool,
  *   chunksize       - The multiples pool chunk size.
  *   expandsize      - The expand memory for all pools in multiples pool.
  *   dict_expendsize - The expand size for multiple dictionaries.
+ *   cachesize       - The number of free blocks in one per-CPU magazine
+ *                     of every pool, 0 disables the per-CPU magazines.
  * Returned Value:
  *   Return an initialized multiple pool pointer on success,
  *   otherwise NULL is returned.
@@ -399,7 +401,7 @@ mempool_multiple_init(FAR const char *name,
                       mempool_multiple_alloc_size_t alloc_size,
                       mempool_multiple_free_t free, FAR void *arg,
                       size_t chunksize, size_t expandsize,
-                      size_t dict_expendsize)
+                      size_t dict_expendsize, size_t cachesize)
 {
   FAR struct mempool_multiple_s *mpool;
   FAR struct mempool_s *pools;
@@ -463,6 +465,9 @@ mempool_multiple_init(FAR const char *name,
       pools[i].alloc = mempool_multiple_alloc_callback;
       pools[i].free = mempool_multiple_free_callback;
       pools[i].check = mempool_multiple_check;
+#ifdef CONFIG_MM_MEMPOOL_CACHE
+      pools[i].cachesize = cachesize;
+#endif
 
       ret = mempool_init(pools + i, name);
       if (ret < 0)
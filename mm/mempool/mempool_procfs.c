@@ -42,7 +42,11 @@
  * to handle the longest line generated by this logic.
  */
 
-#define MEMPOOLINFO_LINELEN 80
+#ifdef CONFIG_MM_MEMPOOL_CACHE
+#  define MEMPOOLINFO_LINELEN 128
+#else
+#  define MEMPOOLINFO_LINELEN 80
+#endif
 
 /****************************************************************************
  * Private Types
@@ -141,10 +145,17 @@ static ssize_t mempool_read(FAR struct file *filep, FAR char *buffer,
 
   offset    = filep->f_pos;
   procfile  = filep->f_priv;
+#ifdef CONFIG_MM_MEMPOOL_CACHE
+  linesize  = procfs_snprintf(procfile->line, MEMPOOLINFO_LINELEN,
+                              "%13s%11s%9s%9s%9s%9s%9s%9s%11s%11s\n", "",
+                              "total", "bsize", "nused", "nfree", "nifree",
+                              "nwaiter", "ncached", "nhit", "nmiss");
+#else
   linesize  = procfs_snprintf(procfile->line, MEMPOOLINFO_LINELEN,
                               "%13s%11s%9s%9s%9s%9s%9s\n", "", "total",
                               "bsize", "nused", "nfree", "nifree",
                               "nwaiter");
+#endif
 
   copysize  = procfs_memcpy(procfile->line, linesize, buffer, buflen,
                             &offset);
@@ -162,12 +173,23 @@ static ssize_t mempool_read(FAR struct file *filep, FAR char *buffer,
           buflen    -= copysize;
 
           mempool_info(pool, &minfo);
+#ifdef CONFIG_MM_MEMPOOL_CACHE
+          linesize   = procfs_snprintf(procfile->line, MEMPOOLINFO_LINELEN,
+                                       "%12s:%11lu%9lu%9lu%9lu%9lu%9lu"
+                                       "%9lu%11lu%11lu\n",
+                                       entry->name, minfo.arena,
+                                       minfo.sizeblks, minfo.aordblks,
+                                       minfo.ordblks, minfo.iordblks,
+                                       minfo.nwaiter, minfo.ncached,
+                                       minfo.nhit, minfo.nmiss);
+#else
           linesize   = procfs_snprintf(procfile->line, MEMPOOLINFO_LINELEN,
                                        "%12s:%11lu%9lu%9lu%9lu%9lu%9lu\n",
                                        entry->name, minfo.arena,
                                        minfo.sizeblks, minfo.aordblks,
                                        minfo.ordblks, minfo.iordblks,
                                        minfo.nwaiter);
+#endif
           copysize   = procfs_memcpy(procfile->line, linesize, buffer,
                                      buflen, &offset);
           totalsize += copysize;
@@ -328,6 +328,11 @@ mm_initialize_pool(FAR const char *name,
       def.chunksize       = CONFIG_MM_HEAP_MEMPOOL_CHUNK_SIZE;
       def.expandsize      = CONFIG_MM_HEAP_MEMPOOL_EXPAND_SIZE;
       def.dict_expendsize = CONFIG_MM_HEAP_MEMPOOL_DICTIONARY_EXPAND_SIZE;
+#  ifdef CONFIG_MM_HEAP_MEMPOOL_CACHE_SIZE
+      def.cachesize       = CONFIG_MM_HEAP_MEMPOOL_CACHE_SIZE;
+#  else
+      def.cachesize       = 0;
+#  endif
 
       init = &def;
     }
@@ -346,7 +351,8 @@ mm_initialize_pool(FAR const char *name,
                                (mempool_multiple_alloc_size_t)mm_malloc_size,
                                (mempool_multiple_free_t)mm_free, heap,
                                init->chunksize, init->expandsize,
-                               init->dict_expendsize);
+                               init->dict_expendsize,
+                               init->cachesize);
     }
 
   return heap;
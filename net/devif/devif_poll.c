@@ -1165,6 +1165,9 @@ int devif_poll_out(FAR struct net_driver_s *dev,
 
   if (dev->d_len == 0)
     {
+#ifdef CONFIG_NETDEV_GSO
+      dev->d_gso_size = 0;
+#endif
       return 0;
     }
 
@@ -1173,6 +1176,9 @@ int devif_poll_out(FAR struct net_driver_s *dev,
   bstop = devif_loopback(dev);
   if (bstop)
     {
+#ifdef CONFIG_NETDEV_GSO
+      dev->d_gso_size = 0;
+#endif
       return bstop;
     }
 
@@ -826,6 +826,11 @@ static int inet_getsockopt(FAR struct socket *psock, int level, int option,
         return tcp_getsockopt(psock, option, value, value_len);
 #endif
 
+#ifdef CONFIG_NET_UDPPROTO_OPTIONS
+      case IPPROTO_UDP:/* UDP protocol socket options (see include/netinet/udp.h) */
+        return udp_getsockopt(psock, option, value, value_len);
+#endif
+
 #ifdef CONFIG_NET_IPv4
       case IPPROTO_IP:/* IPv4 protocol socket options (see include/netinet/in.h) */
         return ipv4_getsockopt(psock, option, value, value_len);
@@ -1212,7 +1217,7 @@ static int inet_listen(FAR struct socket *psock, int backlog)
 
           conn->lport = tcp_selectport(PF_INET,
                                 (FAR const union ip_addr_u *)
-                                &conn->u.ipv4.laddr, 0);
+                                &conn->u.ipv4.laddr, 0, 0);
         }
 #endif /* CONFIG_NET_IPv4 */
 
@@ -1227,7 +1232,7 @@ static int inet_listen(FAR struct socket *psock, int backlog)
 
           conn->lport = tcp_selectport(PF_INET6,
                                 (FAR const union ip_addr_u *)
-                                conn->u.ipv6.laddr, 0);
+                                conn->u.ipv6.laddr, 0, 0);
         }
 #endif /* CONFIG_NET_IPv6 */
     }
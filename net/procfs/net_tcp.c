@@ -33,6 +33,7 @@
 
 #include <arpa/inet.h>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
 
 #include <nuttx/net/netstats.h>
 
@@ -46,9 +47,17 @@
 #ifdef NET_TCP_HAVE_STACK
 
 #ifdef CONFIG_NET_IPv6
-#  define TCP_LINELEN 180
+#  define TCP_BASELEN 180
 #else
-#  define TCP_LINELEN 120
+#  define TCP_BASELEN 120
+#endif
+
+/* Room for the TCP_INFO columns; srtt, rttvar and lkwait are in usec */
+
+#ifdef CONFIG_NET_TCP_INFO
+#  define TCP_LINELEN (TCP_BASELEN + 64)
+#else
+#  define TCP_LINELEN TCP_BASELEN
 #endif
 
 /****************************************************************************
@@ -62,6 +71,9 @@ static ssize_t netprocfs_tcpstats(FAR struct netprocfs_file_s *priv,
   int addrlen = (domain == PF_INET) ?
                 INET_ADDRSTRLEN : INET6_ADDRSTRLEN;
   FAR struct tcp_conn_s *conn = NULL;
+#ifdef CONFIG_NET_TCP_INFO
+  struct tcp_info info;
+#endif
   char remote[INET6_ADDRSTRLEN];
   char local[INET6_ADDRSTRLEN];
   int len = 0;
@@ -116,13 +128,25 @@ static ssize_t netprocfs_tcpstats(FAR struct netprocfs_file_s *priv,
                       (conn->readahead) ? conn->readahead->io_pktlen : 0);
 
       len += snprintf(buffer + len, buflen - len,
-                      " %*s:%-6" PRIu16 " %*s:%-6" PRIu16 "\n",
+                      " %*s:%-6" PRIu16 " %*s:%-6" PRIu16,
                       (domain == PF_INET6) ? addrlen / 2 : addrlen,
                       inet_ntop(domain, laddr, local, addrlen),
                       ntohs(conn->lport),
                       (domain == PF_INET6) ? addrlen / 2 : addrlen,
                       inet_ntop(domain, raddr, remote, addrlen),
                       ntohs(conn->rport));
+
+#ifdef CONFIG_NET_TCP_INFO
+      tcp_getinfo(conn, &info);
+      len += snprintf(buffer + len, buflen - len,
+                      " %8" PRIu32 " %8" PRIu32 " %5" PRIu32 " %5" PRIu32
+                      " %10" PRIu64 " %10" PRIu64 " %8" PRIu64,
+                      info.tcpi_rtt, info.tcpi_rttvar, info.tcpi_snd_cwnd,
+                      info.tcpi_total_retrans, info.tcpi_bytes_sent,
+                      info.tcpi_bytes_received, info.tcpi_lock_wait);
+#endif
+
+      len += snprintf(buffer + len, buflen - len, "\n");
     }
 
   net_unlock();
@@ -171,7 +195,12 @@ ssize_t netprocfs_read_tcpstats(FAR struct netprocfs_file_s *priv,
 #endif
                                           "rxsz "
                                           "%-*s "
-                                          "%-*s\n"
+                                          "%-*s"
+#ifdef CONFIG_NET_TCP_INFO
+                                          "     srtt   rttvar  cwnd  retr"
+                                          "    txbytes    rxbytes   lkwait"
+#endif
+                                          "\n"
                                           ,
                                           INET6_ADDRSTRLEN / 2,
                                           "local_address",
@@ -92,6 +92,7 @@ static ssize_t netprocfs_udpstats(FAR struct netprocfs_file_s *priv,
       laddr = net_ip_binding_laddr(&conn->u, domain);
       raddr = net_ip_binding_raddr(&conn->u, domain);
 
+      udp_conn_lock(conn);
       len += snprintf(buffer + len, buflen - len,
                       "    %2" PRIu8
                       ": %3" PRIx8
@@ -105,6 +106,7 @@ static ssize_t netprocfs_udpstats(FAR struct netprocfs_file_s *priv,
                       udp_wrbuffer_inqueue_size(conn),
 #endif
                       (conn->readahead) ? conn->readahead->io_pktlen : 0);
+      udp_conn_unlock(conn);
 
       len += snprintf(buffer + len, buflen - len,
                       " %*s:%-6" PRIu16 " %*s:%-6" PRIu16 "\n",
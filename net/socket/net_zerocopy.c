@@ -0,0 +1,433 @@
+/****************************************************************************
+ * net/socket/net_zerocopy.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+#if defined(CONFIG_NET) && defined(CONFIG_NET_ZEROCOPY)
+
+#include <sys/socket.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <assert.h>
+#include <debug.h>
+
+#include <netinet/in.h>
+
+#include <nuttx/kmalloc.h>
+#include <nuttx/queue.h>
+#include <nuttx/spinlock.h>
+#include <nuttx/mm/iob.h>
+#include <nuttx/net/net.h>
+
+#include "socket/socket.h"
+#include "utils/utils.h"
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* One MSG_ZEROCOPY send.  The I/O buffers handed to the stack point into
+ * the user buffer and carry the region in io_priv.  The outstanding
+ * regions are kept on a list so that a closing socket can detach itself.
+ */
+
+struct zerocopy_s
+{
+  dq_entry_t                node;   /* Supports a doubly linked list */
+  FAR const uint8_t        *base;   /* Start of the user buffer */
+  size_t                    len;    /* Length of the user buffer */
+  FAR struct socket_conn_s *conn;   /* Socket to notify, NULL if gone */
+  uint32_t                  id;     /* Notification id */
+  unsigned int              refs;   /* Sender + outstanding I/O buffers */
+  unsigned int              nloans; /* Number of I/O buffers ever loaned */
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static dq_queue_t g_zerocopy_list;
+static spinlock_t g_zerocopy_lock = SP_UNLOCKED;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: zerocopy_notify
+ *
+ * Description:
+ *   Record the completion of send 'id' in its socket.  Completions arrive
+ *   in send order (the write queues are FIFO), so a single id range per
+ *   socket is enough.
+ *
+ * Assumptions:
+ *   g_zerocopy_lock is held.
+ *
+ ****************************************************************************/
+
+static void zerocopy_notify(FAR struct socket_conn_s *conn, uint32_t id,
+                            bool copied)
+{
+  if (!conn->s_zcready)
+    {
+      conn->s_zclo     = id;
+      conn->s_zccopied = false;
+      conn->s_zcready  = true;
+    }
+
+  conn->s_zchi = id;
+  if (copied)
+    {
+      conn->s_zccopied = true;
+    }
+}
+
+/****************************************************************************
+ * Name: zerocopy_complete
+ *
+ * Description:
+ *   The last reference to a region is gone; notify its socket, if any.
+ *
+ * Assumptions:
+ *   g_zerocopy_lock is held.
+ *
+ ****************************************************************************/
+
+static void zerocopy_complete(FAR struct zerocopy_s *zc)
+{
+  dq_rem(&zc->node, &g_zerocopy_list);
+
+  if (zc->conn != NULL)
+    {
+      zerocopy_notify(zc->conn, zc->id, zc->nloans == 0);
+    }
+}
+
+/****************************************************************************
+ * Name: zerocopy_iob_free
+ *
+ * Description:
+ *   io_free callback of the I/O buffers created by zerocopy_iob().  'data'
+ *   is the owning region, recorded in io_priv.
+ *
+ ****************************************************************************/
+
+static void zerocopy_iob_free(FAR void *data)
+{
+  FAR struct zerocopy_s *zc = data;
+  irqstate_t flags;
+  bool done;
+
+  flags = spin_lock_irqsave(&g_zerocopy_lock);
+
+  DEBUGASSERT(zc->refs > 0 && zc->nloans > 0);
+  done = --zc->refs == 0;
+  if (done)
+    {
+      zerocopy_complete(zc);
+    }
+
+  spin_unlock_irqrestore(&g_zerocopy_lock, flags);
+
+  if (done)
+    {
+      kmm_free(zc);
+    }
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: zerocopy_alloc
+ *
+ * Description:
+ *   Begin a MSG_ZEROCOPY send of the user buffer 'buf'.  The returned
+ *   region keeps track of the I/O buffers that reference the user memory;
+ *   the caller holds one reference until zerocopy_release() is called.
+ *
+ * Input Parameters:
+ *   conn - The connection that sends the data
+ *   buf  - The user buffer that will be referenced by I/O buffers
+ *   len  - The length of the user buffer
+ *
+ * Returned Value:
+ *   The new region on success; NULL if out of memory.
+ *
+ ****************************************************************************/
+
+FAR struct zerocopy_s *zerocopy_alloc(FAR struct socket_conn_s *conn,
+                                      FAR const void *buf, size_t len)
+{
+  FAR struct zerocopy_s *zc;
+  irqstate_t flags;
+
+  zc = kmm_zalloc(sizeof(struct zerocopy_s));
+  if (zc == NULL)
+    {
+      return NULL;
+    }
+
+  zc->base = buf;
+  zc->len  = len;
+  zc->conn = conn;
+  zc->refs = 1;
+
+  flags = spin_lock_irqsave(&g_zerocopy_lock);
+  dq_addlast(&zc->node, &g_zerocopy_list);
+  spin_unlock_irqrestore(&g_zerocopy_lock, flags);
+
+  return zc;
+}
+
+/****************************************************************************
+ * Name: zerocopy_iob
+ *
+ * Description:
+ *   Allocate an I/O buffer that refers to 'len' bytes of the user buffer
+ *   at 'data' instead of holding a copy of them.  The region is not
+ *   complete until this I/O buffer has been freed.
+ *
+ * Input Parameters:
+ *   zc   - The region returned by zerocopy_alloc()
+ *   data - The user data, must lie within the region
+ *   len  - Number of bytes to reference
+ *
+ * Returned Value:
+ *   A single I/O buffer with io_len and io_pktlen set to 'len'; NULL if
+ *   out of memory.
+ *
+ ****************************************************************************/
+
+FAR struct iob_s *zerocopy_iob(FAR struct zerocopy_s *zc,
+                               FAR const void *data, uint16_t len)
+{
+  FAR struct iob_s *iob;
+  irqstate_t flags;
+
+  DEBUGASSERT((FAR const uint8_t *)data >= zc->base &&
+              (FAR const uint8_t *)data + len <= zc->base + zc->len);
+
+  /* The stack never writes to the payload of a transmit I/O buffer, so
+   * casting away const is safe here.
+   */
+
+  iob = iob_alloc_with_data((FAR void *)data, len, zerocopy_iob_free);
+  if (iob == NULL)
+    {
+      return NULL;
+    }
+
+  iob->io_priv   = zc;
+  iob->io_len    = len;
+  iob->io_pktlen = len;
+
+  flags = spin_lock_irqsave(&g_zerocopy_lock);
+  zc->refs++;
+  zc->nloans++;
+  spin_unlock_irqrestore(&g_zerocopy_lock, flags);
+
+  return iob;
+}
+
+/****************************************************************************
+ * Name: zerocopy_release
+ *
+ * Description:
+ *   Drop the reference of the sender.  If anything was sent, the region
+ *   consumes the next notification id of the socket, which is reported on
+ *   the error queue once the last I/O buffer referencing the user memory
+ *   has been freed.  If the data was copied, completion is immediate.
+ *
+ * Input Parameters:
+ *   zc   - The region returned by zerocopy_alloc()
+ *   sent - The number of bytes accepted by the send operation
+ *
+ ****************************************************************************/
+
+void zerocopy_release(FAR struct zerocopy_s *zc, ssize_t sent)
+{
+  FAR struct zerocopy_s *done = NULL;
+  irqstate_t flags;
+
+  flags = spin_lock_irqsave(&g_zerocopy_lock);
+
+  /* A failed send does not consume an id (the I/O buffers it managed to
+   * queue, if any, have already been taken back).
+   */
+
+  if (sent <= 0 && zc->refs == 1)
+    {
+      dq_rem(&zc->node, &g_zerocopy_list);
+      done = zc;
+    }
+  else
+    {
+      if (zc->conn != NULL)
+        {
+          zc->id = zc->conn->s_zcnext++;
+        }
+
+      if (--zc->refs == 0)
+        {
+          zerocopy_complete(zc);
+          done = zc;
+        }
+    }
+
+  spin_unlock_irqrestore(&g_zerocopy_lock, flags);
+
+  if (done != NULL)
+    {
+      kmm_free(done);
+    }
+}
+
+/****************************************************************************
+ * Name: zerocopy_copied
+ *
+ * Description:
+ *   A MSG_ZEROCOPY send was served by copying the data.  Consume the next
+ *   notification id of the socket and complete it right away.
+ *
+ ****************************************************************************/
+
+void zerocopy_copied(FAR struct socket_conn_s *conn)
+{
+  irqstate_t flags;
+
+  flags = spin_lock_irqsave(&g_zerocopy_lock);
+  zerocopy_notify(conn, conn->s_zcnext++, true);
+  spin_unlock_irqrestore(&g_zerocopy_lock, flags);
+}
+
+/****************************************************************************
+ * Name: zerocopy_conn_release
+ *
+ * Description:
+ *   Detach all outstanding regions from a connection that is being freed.
+ *
+ ****************************************************************************/
+
+void zerocopy_conn_release(FAR struct socket_conn_s *conn)
+{
+  FAR dq_entry_t *entry;
+  irqstate_t flags;
+
+  flags = spin_lock_irqsave(&g_zerocopy_lock);
+
+  for (entry = dq_peek(&g_zerocopy_list); entry; entry = dq_next(entry))
+    {
+      FAR struct zerocopy_s *zc = (FAR struct zerocopy_s *)entry;
+
+      if (zc->conn == conn)
+        {
+          zc->conn = NULL;
+        }
+    }
+
+  conn->s_zcready = false;
+  spin_unlock_irqrestore(&g_zerocopy_lock, flags);
+}
+
+/****************************************************************************
+ * Name: zerocopy_recverr
+ *
+ * Description:
+ *   Implements recvmsg(MSG_ERRQUEUE): report the range of completed
+ *   MSG_ZEROCOPY sends as a struct sock_extended_err control message.
+ *
+ * Returned Value:
+ *   Zero on success; -EAGAIN if there is nothing to report.
+ *
+ ****************************************************************************/
+
+ssize_t zerocopy_recverr(FAR struct socket *psock, FAR struct msghdr *msg)
+{
+  FAR struct socket_conn_s *conn = psock->s_conn;
+  struct sock_extended_err serr;
+  irqstate_t flags;
+  int level = SOL_IP;
+  int type = IP_RECVERR;
+
+  memset(&serr, 0, sizeof(serr));
+  serr.ee_origin = SO_EE_ORIGIN_ZEROCOPY;
+
+  flags = spin_lock_irqsave(&g_zerocopy_lock);
+  if (!conn->s_zcready)
+    {
+      spin_unlock_irqrestore(&g_zerocopy_lock, flags);
+      return -EAGAIN;
+    }
+
+  serr.ee_info = conn->s_zclo;
+  serr.ee_data = conn->s_zchi;
+  if (conn->s_zccopied)
+    {
+      serr.ee_code = SO_EE_CODE_ZEROCOPY_COPIED;
+    }
+
+  spin_unlock_irqrestore(&g_zerocopy_lock, flags);
+
+#ifdef CONFIG_NET_IPv6
+  if (psock->s_domain == PF_INET6)
+    {
+      level = SOL_IPV6;
+      type  = IPV6_RECVERR;
+    }
+#endif
+
+  /* Leave the range queued if the caller gave no room to report it */
+
+  if (cmsg_append(msg, level, type, &serr, sizeof(serr)) == NULL)
+    {
+      msg->msg_flags |= MSG_CTRUNC;
+      return -ENOBUFS;
+    }
+
+  flags = spin_lock_irqsave(&g_zerocopy_lock);
+
+  /* More sends may have completed in the meantime, they stay queued */
+
+  if (conn->s_zchi == serr.ee_data)
+    {
+      conn->s_zcready = false;
+    }
+  else
+    {
+      conn->s_zclo = serr.ee_data + 1;
+    }
+
+  spin_unlock_irqrestore(&g_zerocopy_lock, flags);
+
+  msg->msg_flags |= MSG_ERRQUEUE;
+  return 0;
+}
+
+#endif /* CONFIG_NET && CONFIG_NET_ZEROCOPY */
@@ -91,9 +91,11 @@ ssize_t psock_recvfrom(FAR struct socket *psock, FAR void *buf, size_t len,
   msg.msg_controllen = 0;
   msg.msg_flags = 0;
 
-  /* And let psock_recvmsg do all of the work */
+  /* And let psock_recvmsg do all of the work.  A buffer lent out by
+   * MSG_ZEROCOPY could not be reported back through this interface.
+   */
 
-  ret = psock_recvmsg(psock, &msg, flags);
+  ret = psock_recvmsg(psock, &msg, flags & ~MSG_ZEROCOPY);
   if (ret >= 0 && fromlen != NULL)
     *fromlen = msg.msg_namelen;
 
@@ -0,0 +1,242 @@
+/****************************************************************************
+ * net/socket/recvmmsg.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <assert.h>
+#include <errno.h>
+#include <stdbool.h>
+
+#include <nuttx/cancelpt.h>
+#include <nuttx/clock.h>
+#include <nuttx/fs/fs.h>
+#include <nuttx/net/net.h>
+
+#include "socket/socket.h"
+
+#ifdef CONFIG_NET
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: net_recvmmsg
+ *
+ * Description:
+ *   Receive the messages of a recvmmsg() batch one by one.  No lock is
+ *   held across the batch; each psock_recvmsg() takes the locks of its
+ *   protocol, e.g. the connection lock of a UDP socket, per message.
+ *
+ *   As on Linux, the timeout is only checked after each message has been
+ *   received; it does not bound a receive that is already blocked.
+ *
+ * Input Parameters:
+ *   psock     A pointer to a NuttX-specific, internal socket structure
+ *   msgvec    The messages to fill; msg_len receives the bytes received
+ *   vlen      The number of messages in msgvec
+ *   flags     Receive flags, MSG_WAITFORONE included
+ *   timeout   Optional timeout for the whole batch
+ *
+ * Returned Value:
+ *   The number of messages received.  A negated errno value is returned
+ *   only if the first message could not be received.
+ *
+ ****************************************************************************/
+
+int net_recvmmsg(FAR struct socket *psock, FAR struct mmsghdr *msgvec,
+                 unsigned int vlen, int flags,
+                 FAR const struct timespec *timeout)
+{
+  bool waitforone = (flags & MSG_WAITFORONE) != 0;
+  clock_t deadline = 0;
+  unsigned int i;
+  ssize_t ret = OK;
+
+  if (timeout != NULL)
+    {
+      deadline = clock_systime_ticks() + clock_time2ticks(timeout);
+    }
+
+  flags &= ~MSG_WAITFORONE;
+
+  for (i = 0; i < vlen; i++)
+    {
+      ret = psock_recvmsg(psock, &msgvec[i].msg_hdr, flags);
+      if (ret < 0)
+        {
+          break;
+        }
+
+      msgvec[i].msg_len = ret;
+
+      /* A zero-length read on a stream socket means end of file, there
+       * is nothing more to come.
+       */
+
+      if (ret == 0 && psock->s_type == SOCK_STREAM)
+        {
+          i++;
+          break;
+        }
+
+      /* Do not block for the remaining messages once one has arrived */
+
+      if (waitforone)
+        {
+          flags |= MSG_DONTWAIT;
+        }
+
+      if (timeout != NULL &&
+          (sclock_t)(clock_systime_ticks() - deadline) >= 0)
+        {
+          i++;
+          break;
+        }
+    }
+
+  return i > 0 ? (int)i : (int)ret;
+}
+
+/****************************************************************************
+ * Name: psock_recvmmsg
+ *
+ * Description:
+ *   psock_recvmmsg() receives up to 'vlen' messages with a single call.
+ *   It is the internal OS interface of recvmmsg(), see psock_recvmsg().
+ *
+ * Input Parameters:
+ *   psock     A pointer to a NuttX-specific, internal socket structure
+ *   msgvec    The messages to fill; msg_len receives the bytes received
+ *   vlen      The number of messages in msgvec
+ *   flags     Receive flags
+ *   timeout   Optional timeout for the whole batch
+ *
+ * Returned Value:
+ *   The number of messages received.  A negated errno value is returned
+ *   only if the first message could not be received.
+ *
+ ****************************************************************************/
+
+int psock_recvmmsg(FAR struct socket *psock, FAR struct mmsghdr *msgvec,
+                   unsigned int vlen, int flags,
+                   FAR const struct timespec *timeout)
+{
+  /* Verify that non-NULL pointers were passed */
+
+  if (msgvec == NULL && vlen > 0)
+    {
+      return -EFAULT;
+    }
+
+  if (timeout != NULL &&
+      (timeout->tv_sec < 0 || timeout->tv_nsec < 0 ||
+       timeout->tv_nsec >= NSEC_PER_SEC))
+    {
+      return -EINVAL;
+    }
+
+  /* Verify that the sockfd corresponds to valid, allocated socket */
+
+  if (psock == NULL || psock->s_conn == NULL)
+    {
+      return -EBADF;
+    }
+
+  if (vlen > NET_MMSG_MAXVLEN)
+    {
+      vlen = NET_MMSG_MAXVLEN;
+    }
+
+  DEBUGASSERT(psock->s_sockif != NULL);
+
+  if (psock->s_sockif->si_recvmmsg != NULL)
+    {
+      return psock->s_sockif->si_recvmmsg(psock, msgvec, vlen, flags,
+                                          timeout);
+    }
+
+  return net_recvmmsg(psock, msgvec, vlen, flags, timeout);
+}
+
+/****************************************************************************
+ * Function: recvmmsg
+ *
+ * Description:
+ *   The recvmmsg() call receives multiple messages from a socket with a
+ *   single call.  It is equivalent to calling recvmsg() for each element
+ *   of msgvec, storing the number of bytes received in its msg_len.
+ *
+ * Parameters:
+ *   sockfd   Socket descriptor of socket
+ *   msgvec   The messages to fill
+ *   vlen     The number of messages in msgvec
+ *   flags    Receive flags; MSG_WAITFORONE turns on MSG_DONTWAIT after the
+ *            first message has been received
+ *   timeout  Optional timeout for the whole batch, checked after each
+ *            message
+ *
+ * Returned Value:
+ *   On success, returns the number of messages received.  If the first
+ *   message cannot be received, -1 is returned and errno is set as for
+ *   recvmsg().
+ *
+ ****************************************************************************/
+
+int recvmmsg(int sockfd, FAR struct mmsghdr *msgvec, unsigned int vlen,
+             int flags, FAR struct timespec *timeout)
+{
+  FAR struct socket *psock;
+  FAR struct file *filep;
+  int ret;
+
+  /* recvmmsg() is a cancellation point */
+
+  enter_cancellation_point();
+
+  /* Get the underlying socket structure */
+
+  ret = sockfd_socket(sockfd, &filep, &psock);
+
+  /* Let psock_recvmmsg() do all of the work */
+
+  if (ret == OK)
+    {
+      ret = psock_recvmmsg(psock, msgvec, vlen, flags, timeout);
+      fs_putfilep(filep);
+    }
+
+  if (ret < 0)
+    {
+      set_errno(-ret);
+      ret = ERROR;
+    }
+
+  leave_cancellation_point();
+  return ret;
+}
+
+#endif /* CONFIG_NET */
@@ -78,7 +78,35 @@ ssize_t psock_recvmsg(FAR struct socket *psock, FAR struct msghdr *msg,
 
   /* Verify that non-NULL pointers were passed */
 
-  if (msg == NULL || msg->msg_iov == NULL || msg->msg_iov->iov_base == NULL)
+  if (msg == NULL)
+    {
+      return -EINVAL;
+    }
+
+#ifdef CONFIG_NET_ZEROCOPY
+  /* The error queue only carries control messages, no data buffer is
+   * needed.
+   */
+
+  if ((flags & MSG_ERRQUEUE) != 0)
+    {
+      if (psock == NULL || psock->s_conn == NULL)
+        {
+          return -EBADF;
+        }
+
+      msg_control         = msg->msg_control;
+      msg_controllen      = msg->msg_controllen;
+
+      ret = zerocopy_recverr(psock, msg);
+
+      msg->msg_control    = msg_control;
+      msg->msg_controllen = msg_controllen - msg->msg_controllen;
+      return ret;
+    }
+#endif
+
+  if (msg->msg_iov == NULL || msg->msg_iov->iov_base == NULL)
     {
       return -EINVAL;
     }
@@ -0,0 +1,189 @@
+/****************************************************************************
+ * net/socket/sendmmsg.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <assert.h>
+#include <errno.h>
+
+#include <nuttx/cancelpt.h>
+#include <nuttx/fs/fs.h>
+#include <nuttx/net/net.h>
+
+#include "socket/socket.h"
+
+#ifdef CONFIG_NET
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: net_sendmmsg
+ *
+ * Description:
+ *   Send the messages of a sendmmsg() batch one by one.  No lock is held
+ *   across the batch; each psock_sendmsg() takes the locks of its
+ *   protocol per message.
+ *
+ * Input Parameters:
+ *   psock     A pointer to a NuttX-specific, internal socket structure
+ *   msgvec    The messages to send; msg_len receives the bytes sent
+ *   vlen      The number of messages in msgvec
+ *   flags     Send flags
+ *
+ * Returned Value:
+ *   The number of messages sent.  A negated errno value is returned only
+ *   if the first message could not be sent.
+ *
+ ****************************************************************************/
+
+int net_sendmmsg(FAR struct socket *psock, FAR struct mmsghdr *msgvec,
+                 unsigned int vlen, int flags)
+{
+  unsigned int i;
+  ssize_t ret = OK;
+
+  for (i = 0; i < vlen; i++)
+    {
+      ret = psock_sendmsg(psock, &msgvec[i].msg_hdr, flags);
+      if (ret < 0)
+        {
+          break;
+        }
+
+      msgvec[i].msg_len = ret;
+    }
+
+  return i > 0 ? (int)i : (int)ret;
+}
+
+/****************************************************************************
+ * Name: psock_sendmmsg
+ *
+ * Description:
+ *   psock_sendmmsg() sends up to 'vlen' messages with a single call.  It is
+ *   the internal OS interface of sendmmsg(), see psock_sendmsg().
+ *
+ * Input Parameters:
+ *   psock     A pointer to a NuttX-specific, internal socket structure
+ *   msgvec    The messages to send; msg_len receives the bytes sent
+ *   vlen      The number of messages in msgvec
+ *   flags     Send flags
+ *
+ * Returned Value:
+ *   The number of messages sent.  A negated errno value is returned only
+ *   if the first message could not be sent.
+ *
+ ****************************************************************************/
+
+int psock_sendmmsg(FAR struct socket *psock, FAR struct mmsghdr *msgvec,
+                   unsigned int vlen, int flags)
+{
+  /* Verify that non-NULL pointers were passed */
+
+  if (msgvec == NULL && vlen > 0)
+    {
+      return -EFAULT;
+    }
+
+  /* Verify that the sockfd corresponds to valid, allocated socket */
+
+  if (psock == NULL || psock->s_conn == NULL)
+    {
+      return -EBADF;
+    }
+
+  if (vlen > NET_MMSG_MAXVLEN)
+    {
+      vlen = NET_MMSG_MAXVLEN;
+    }
+
+  DEBUGASSERT(psock->s_sockif != NULL);
+
+  if (psock->s_sockif->si_sendmmsg != NULL)
+    {
+      return psock->s_sockif->si_sendmmsg(psock, msgvec, vlen, flags);
+    }
+
+  return net_sendmmsg(psock, msgvec, vlen, flags);
+}
+
+/****************************************************************************
+ * Function: sendmmsg
+ *
+ * Description:
+ *   The sendmmsg() call sends multiple messages on a socket with a single
+ *   call.  It is equivalent to calling sendmsg() for each element of
+ *   msgvec, storing the number of bytes sent in its msg_len.
+ *
+ * Parameters:
+ *   sockfd   Socket descriptor of socket
+ *   msgvec   The messages to send
+ *   vlen     The number of messages in msgvec
+ *   flags    Send flags
+ *
+ * Returned Value:
+ *   On success, returns the number of messages sent, which may be less
+ *   than vlen.  If the first message cannot be sent, -1 is returned and
+ *   errno is set as for sendmsg().
+ *
+ ****************************************************************************/
+
+int sendmmsg(int sockfd, FAR struct mmsghdr *msgvec, unsigned int vlen,
+             int flags)
+{
+  FAR struct socket *psock;
+  FAR struct file *filep;
+  int ret;
+
+  /* sendmmsg() is a cancellation point */
+
+  enter_cancellation_point();
+
+  /* Get the underlying socket structure */
+
+  ret = sockfd_socket(sockfd, &filep, &psock);
+
+  /* Let psock_sendmmsg() do all of the work */
+
+  if (ret == OK)
+    {
+      ret = psock_sendmmsg(psock, msgvec, vlen, flags);
+      fs_putfilep(filep);
+    }
+
+  if (ret < 0)
+    {
+      set_errno(-ret);
+      ret = ERROR;
+    }
+
+  leave_cancellation_point();
+  return ret;
+}
+
+#endif /* CONFIG_NET */
@@ -139,6 +139,12 @@ static int psock_socketlevel_option(FAR struct socket *psock, int option,
       case SO_REUSEADDR:  /* Allow reuse of local addresses */
 #ifdef CONFIG_NET_TIMESTAMP
       case SO_TIMESTAMP:  /* Generates a timestamp for each incoming packet */
+#endif
+#ifdef CONFIG_NET_ZEROCOPY
+      case SO_ZEROCOPY:   /* Enables MSG_ZEROCOPY transfers */
+#endif
+#ifdef CONFIG_NET_REUSEPORT
+      case SO_REUSEPORT:  /* Allow several sockets to share a local port */
 #endif
         {
           int setting;
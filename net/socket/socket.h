@@ -66,10 +66,12 @@
 #define _SO_TYPE         _SO_BIT(SO_TYPE)
 #define _SO_TIMESTAMP    _SO_BIT(SO_TIMESTAMP)
 #define _SO_BINDTODEVICE _SO_BIT(SO_BINDTODEVICE)
+#define _SO_ZEROCOPY     _SO_BIT(SO_ZEROCOPY)
+#define _SO_REUSEPORT    _SO_BIT(SO_REUSEPORT)
 
 /* This is the largest option value.  REVISIT: belongs in sys/socket.h */
 
-#define _SO_MAXOPT       (18)
+#define _SO_MAXOPT       (20)
 
 /* Macros to set, test, clear options */
 
@@ -123,6 +125,18 @@
 #  define _SO_SETERRNO(s,e)
 #endif /* CONFIG_NET_SOCKOPTS */
 
+/* Upper bound on the number of messages handled by one sendmmsg() or
+ * recvmmsg() call (the same limit as Linux UIO_MAXIOV).
+ */
+
+#define NET_MMSG_MAXVLEN 1024
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+struct zerocopy_s;  /* Forward reference, see net_zerocopy.c */
+
 /****************************************************************************
  * Public Data
  ****************************************************************************/
@@ -182,6 +196,136 @@ net_sockif(sa_family_t family, int type, int protocol);
 int net_timeo(clock_t start_time, socktimeo_t timeo);
 #endif
 
+/****************************************************************************
+ * Name: net_sendmmsg
+ *
+ * Description:
+ *   Send the messages of a sendmmsg() batch one by one with
+ *   psock_sendmsg().
+ *
+ * Returned Value:
+ *   The number of messages sent.  A negated errno value is returned only
+ *   if the first message could not be sent.
+ *
+ ****************************************************************************/
+
+int net_sendmmsg(FAR struct socket *psock, FAR struct mmsghdr *msgvec,
+                 unsigned int vlen, int flags);
+
+/****************************************************************************
+ * Name: net_recvmmsg
+ *
+ * Description:
+ *   Receive the messages of a recvmmsg() batch one by one with
+ *   psock_recvmsg(), honouring MSG_WAITFORONE and the batch timeout.
+ *
+ * Returned Value:
+ *   The number of messages received.  A negated errno value is returned
+ *   only if the first message could not be received.
+ *
+ ****************************************************************************/
+
+int net_recvmmsg(FAR struct socket *psock, FAR struct mmsghdr *msgvec,
+                 unsigned int vlen, int flags,
+                 FAR const struct timespec *timeout);
+
+#ifdef CONFIG_NET_ZEROCOPY
+/****************************************************************************
+ * Name: zerocopy_alloc
+ *
+ * Description:
+ *   Begin a MSG_ZEROCOPY send of the user buffer 'buf'.  The returned
+ *   region keeps track of the I/O buffers that reference the user memory;
+ *   the caller holds one reference until zerocopy_release() is called.
+ *
+ * Input Parameters:
+ *   conn - The connection that sends the data
+ *   buf  - The user buffer that will be referenced by I/O buffers
+ *   len  - The length of the user buffer
+ *
+ * Returned Value:
+ *   The new region on success; NULL if out of memory.
+ *
+ ****************************************************************************/
+
+FAR struct zerocopy_s *zerocopy_alloc(FAR struct socket_conn_s *conn,
+                                      FAR const void *buf, size_t len);
+
+/****************************************************************************
+ * Name: zerocopy_iob
+ *
+ * Description:
+ *   Allocate an I/O buffer that refers to 'len' bytes of the user buffer
+ *   at 'data' instead of holding a copy of them.  The region is not
+ *   complete until this I/O buffer has been freed.
+ *
+ * Input Parameters:
+ *   zc   - The region returned by zerocopy_alloc()
+ *   data - The user data, must lie within the region
+ *   len  - Number of bytes to reference
+ *
+ * Returned Value:
+ *   A single I/O buffer with io_len and io_pktlen set to 'len'; NULL if
+ *   out of memory.
+ *
+ ****************************************************************************/
+
+FAR struct iob_s *zerocopy_iob(FAR struct zerocopy_s *zc,
+                               FAR const void *data, uint16_t len);
+
+/****************************************************************************
+ * Name: zerocopy_release
+ *
+ * Description:
+ *   Drop the reference of the sender.  If anything was sent, the region
+ *   consumes the next notification id of the socket, which is reported on
+ *   the error queue once the last I/O buffer referencing the user memory
+ *   has been freed.  If the data was copied, completion is immediate.
+ *
+ * Input Parameters:
+ *   zc   - The region returned by zerocopy_alloc()
+ *   sent - The number of bytes accepted by the send operation
+ *
+ ****************************************************************************/
+
+void zerocopy_release(FAR struct zerocopy_s *zc, ssize_t sent);
+
+/****************************************************************************
+ * Name: zerocopy_copied
+ *
+ * Description:
+ *   A MSG_ZEROCOPY send was served by copying the data.  Consume the next
+ *   notification id of the socket and complete it right away.
+ *
+ ****************************************************************************/
+
+void zerocopy_copied(FAR struct socket_conn_s *conn);
+
+/****************************************************************************
+ * Name: zerocopy_conn_release
+ *
+ * Description:
+ *   Detach all outstanding regions from a connection that is being freed.
+ *
+ ****************************************************************************/
+
+void zerocopy_conn_release(FAR struct socket_conn_s *conn);
+
+/****************************************************************************
+ * Name: zerocopy_recverr
+ *
+ * Description:
+ *   Implements recvmsg(MSG_ERRQUEUE): report the range of completed
+ *   MSG_ZEROCOPY sends as a struct sock_extended_err control message.
+ *
+ * Returned Value:
+ *   Zero on success; -EAGAIN if there is nothing to report.
+ *
+ ****************************************************************************/
+
+ssize_t zerocopy_recverr(FAR struct socket *psock, FAR struct msghdr *msg);
+#endif
+
 #undef EXTERN
 #if defined(__cplusplus)
 }
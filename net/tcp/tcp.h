@@ -72,6 +72,10 @@
 #if defined(CONFIG_NET_TCP_FAST_RETRANSMIT) && !defined(CONFIG_NET_TCP_CC_NEWRENO)
 #  define TCP_WBNACK(wrb)            ((wrb)->wb_nack)
 #endif
+#ifdef CONFIG_NET_TCP_RACK
+#  define TCP_WBSACKED(wrb)          ((wrb)->wb_sacked)
+#  define TCP_WBXMITTS(wrb)          ((wrb)->wb_xmitts)
+#endif
 #  define TCP_WBIOB(wrb)             ((wrb)->wb_iob)
 #  define TCP_WBCOPYOUT(wrb,dest,n)  (iob_copyout(dest,(wrb)->wb_iob,(n),0))
 #  define TCP_WBCOPYIN(wrb,src,n,off) \
@@ -105,13 +109,24 @@
 #define TCP_WSCALE            0x01U /* Window Scale option enabled */
 #define TCP_SACK              0x02U /* Selective ACKs enabled */
 #define TCP_CLOSE_ARRANGED    0x04U /* Connection is arranged to be freed */
+#define TCP_TSTAMP            0x40U /* Timestamps option enabled */
 
 #ifdef CONFIG_NET_TCP_CC_NEWRENO
 /* The TCP flags for congestion control */
 
 #define TCP_INFR              0x08U /* The flag in Fast Recovery */
 #define TCP_INFT              0x10U /* The flag in Fast Transmitted */
+#define TCP_CCRTT             0x20U /* A segment is timed for RTT sample */
+
+/* The congestion control algorithm of new connections */
 
+#if defined(CONFIG_NET_TCP_CC_DEFAULT_CUBIC)
+#  define TCP_CC_DEFAULT      (&g_tcp_cc_cubic)
+#elif defined(CONFIG_NET_TCP_CC_DEFAULT_BBR)
+#  define TCP_CC_DEFAULT      (&g_tcp_cc_bbr)
+#else
+#  define TCP_CC_DEFAULT      (&g_tcp_cc_newreno)
+#endif
 #endif
 
 /* The Max Range count of TCP Selective ACKs */
@@ -127,6 +142,47 @@
 #define TCP_RTO_MAX 240 /* 120s,The unit is half a second */
 #define TCP_RTO_MIN 1   /* 0.5s */
 
+#ifdef CONFIG_NET_TCP_TIMESTAMPS
+/* The timestamps option is sent as NOOP, NOOP, TS so that the timestamps
+ * are 32-bit aligned (RFC 7323, Appendix A).
+ */
+
+#  define TCP_TSOPT_SIZE      (2 * TCP_OPT_NOOP_LEN + TCP_OPT_TS_LEN)
+
+/* A timestamp older than 24 days can not be compared any more, the clock
+ * of the peer may have wrapped since (RFC 7323, Section 5.5).
+ */
+
+#  define TCP_PAWS_IDLE       (24 * 24 * 60 * 60 * 1000U)
+#endif
+
+#if defined(CONFIG_NET_TCP_TIMESTAMPS) || defined(CONFIG_NET_TCP_RACK)
+/* The clock of the timestamps option and of RACK (units: milliseconds) */
+
+#  define TCP_TS_NOW()        ((uint32_t)TICK2MSEC(clock_systime_ticks()))
+#endif
+
+#ifdef CONFIG_NET_TCP_HASH
+/* Connections are hashed by their 4-tuple for input demultiplexing and by
+ * their local port for the port lookups of bind(), connect() and listen().
+ */
+
+#  define TCP_HASH_MASK       (CONFIG_NET_TCP_HASH_SIZE - 1)
+#  define tcp_porthash(port) \
+     ((((uint32_t)(port) * 0x9e3779b1u) >> 16) & TCP_HASH_MASK)
+#endif
+
+/* Counters of struct tcp_stats_s, compiled out without CONFIG_NET_TCP_INFO */
+
+#ifdef CONFIG_NET_TCP_INFO
+#  define TCP_STATS_INC(conn,field)   ((conn)->stats.field++)
+#  define TCP_STATS_ADD(conn,field,n) ((conn)->stats.field += (n))
+#else
+#  define TCP_STATS_INC(conn,field)
+#  define TCP_STATS_ADD(conn,field,n)
+#  define tcp_stats_lock(conn)        net_lock()
+#endif
+
 /****************************************************************************
  * Public Type Definitions
  ****************************************************************************/
@@ -135,6 +191,7 @@ struct file;      /* Forward reference */
 struct sockaddr;  /* Forward reference */
 struct socket;    /* Forward reference */
 struct pollfd;    /* Forward reference */
+struct tcp_info;  /* Forward reference */
 
 /* Representation of a TCP connection.
  *
@@ -149,6 +206,7 @@ struct net_driver_s;      /* Forward reference */
 struct devif_callback_s;  /* Forward reference */
 struct tcp_backlog_s;     /* Forward reference */
 struct tcp_hdr_s;         /* Forward reference */
+struct tcp_conn_s;        /* Forward reference */
 
 /* This is a container that holds the poll-related information */
 
@@ -176,6 +234,109 @@ struct tcp_sack_s
   uint32_t right;   /* Right edge of the SACK */
 };
 
+#ifdef CONFIG_NET_TCP_CC_NEWRENO
+/* Congestion control algorithm, selected per connection with the
+ * TCP_CONGESTION socket option.  The common code in tcp_cc.c counts
+ * duplicate ACKs, runs fast retransmit and fast recovery (RFC 6582) and
+ * takes the RTT samples; the algorithm decides how the window grows and
+ * how far it is reduced on loss.  All methods are called with the network
+ * locked.
+ *
+ *   init       - Reset the private state of the algorithm.  Called when the
+ *                connection starts and when the algorithm is changed.
+ *   ssthresh   - Return the slow start threshold after a loss, detected by
+ *                either duplicate ACKs or a retransmission timeout.
+ *   cong_avoid - Grow cwnd after 'acked' new bytes were acknowledged
+ *                outside of fast recovery in the established state.
+ *   acked      - Optional.  Called on every ACK with the number of bytes
+ *                it acknowledged, zero for a duplicate ACK, and the RTT
+ *                sample it completed (units: microseconds), or zero.
+ */
+
+struct tcp_cc_ops_s
+{
+  FAR const char *name;
+  CODE void (*init)(FAR struct tcp_conn_s *conn);
+  CODE uint32_t (*ssthresh)(FAR struct tcp_conn_s *conn);
+  CODE void (*cong_avoid)(FAR struct tcp_conn_s *conn, uint32_t acked);
+  CODE void (*acked)(FAR struct tcp_conn_s *conn, uint32_t acked,
+                     uint32_t rtt);
+};
+
+#ifdef CONFIG_NET_TCP_CC_CUBIC
+/* CUBIC state (RFC 9438) */
+
+struct tcp_cubic_s
+{
+  uint32_t epoch;         /* Start of the congestion avoidance epoch
+                           * (units: microseconds, 0: none) */
+  uint32_t k;             /* Time to grow back to origin (units: msec) */
+  uint32_t origin;        /* Window at the plateau of the curve */
+  uint32_t wmax;          /* Window before the last reduction */
+  uint32_t west;          /* Window of the Reno-friendly region */
+  uint32_t minrtt;        /* Minimum RTT seen (units: microseconds) */
+};
+#endif
+
+#ifdef CONFIG_NET_TCP_CC_BBR
+/* BBR state */
+
+#define TCP_BBR_BW_ROUNDS 10  /* Rounds in the bandwidth max filter */
+
+struct tcp_bbr_s
+{
+  /* Delivery rate of the last rounds (units: bytes per second) */
+
+  uint32_t bw[TCP_BBR_BW_ROUNDS];
+
+  uint32_t full_bw;       /* Bandwidth at the last growth in STARTUP */
+  uint32_t minrtt;        /* Minimum RTT (units: microseconds) */
+  uint32_t minrtt_stamp;  /* When minrtt was taken */
+  uint32_t round_end;     /* Sequence number that ends the round */
+  uint32_t round_stamp;   /* When the round started */
+  uint32_t round_count;   /* Number of rounds */
+  uint32_t delivered;     /* Bytes delivered in this round */
+  uint32_t dupacked;      /* Bytes counted for duplicate ACKs that are
+                           * not cumulatively acknowledged yet */
+  uint32_t probertt_end;  /* End of PROBE_RTT, 0 while draining */
+  uint32_t prior_cwnd;    /* cwnd before PROBE_RTT */
+  uint8_t  mode;          /* STARTUP, DRAIN, PROBE_BW or PROBE_RTT */
+  uint8_t  cycle;         /* Phase of the PROBE_BW gain cycle */
+  uint8_t  full_bw_cnt;   /* Rounds without bandwidth growth */
+  bool     full_bw_reached;
+};
+#endif
+#endif /* CONFIG_NET_TCP_CC_NEWRENO */
+
+#ifdef CONFIG_NET_TCP_INFO
+/* Statistics of a connection, reported by getsockopt(TCP_INFO) and
+ * /proc/net/tcp.
+ */
+
+struct tcp_stats_s
+{
+  uint64_t bytes_sent;      /* Payload bytes sent, retransmissions included */
+  uint64_t bytes_retrans;   /* Payload bytes retransmitted */
+  uint64_t bytes_acked;     /* Payload bytes ACKed by the peer */
+  uint64_t bytes_received;  /* Payload bytes received in sequence */
+  uint64_t lock_wait;       /* Time socket calls waited for the network lock
+                             * (units: perf_gettime() ticks) */
+  uint32_t lock_waits;      /* Number of those acquisitions */
+  uint32_t segs_in;         /* Segments received */
+  uint32_t segs_out;        /* Segments sent */
+  uint32_t data_segs_in;    /* Segments received with payload */
+  uint32_t data_segs_out;   /* Segments sent with payload */
+  uint32_t total_retrans;   /* Segments retransmitted */
+  uint32_t snd_max;         /* End of the highest payload sent */
+  uint32_t srtt;            /* Smoothed RTT, scaled by 8 (units: usec) */
+  uint32_t rttvar;          /* RTT variation, scaled by 4 (units: usec) */
+  uint32_t min_rtt;         /* Minimum RTT seen (units: usec) */
+  clock_t  last_data_sent;  /* When payload was last sent */
+  clock_t  last_data_recv;  /* When payload was last received */
+  clock_t  last_ack_recv;   /* When new data was last ACKed */
+};
+#endif
+
 struct tcp_conn_s
 {
   /* Common prologue of all connection structures. */
@@ -209,6 +370,15 @@ struct tcp_conn_s
   /* TCP-specific content follows */
 
   union ip_binding_u u;   /* IP address binding */
+#ifdef CONFIG_NET_TCP_HASH
+  FAR struct tcp_conn_s *ehash; /* Next in the 4-tuple hash chain */
+  FAR struct tcp_conn_s *phash; /* Next in the local port hash chain */
+  FAR struct tcp_conn_s *lhash; /* Next in the listener hash chain */
+#endif
+#ifdef CONFIG_NET_REUSEPORT
+  FAR struct tcp_conn_s *listener; /* Listener chosen for a SYN_RCVD
+                                    * connection, see tcp_connlistener() */
+#endif
   uint8_t  rcvseq[4];     /* The sequence number that we expect to
                            * receive next */
   uint8_t  sndseq[4];     /* The sequence number that was last sent by us */
@@ -252,6 +422,51 @@ struct tcp_conn_s
   uint32_t cwnd;          /* The Congestion window */
   uint32_t max_cwnd;      /* The Congestion window maximum value */
   uint32_t ssthresh;      /* The Slow start threshold */
+  uint32_t cc_sndmax;     /* Highest sequence number sent */
+  uint32_t cc_rttseq;     /* End of the segment timed for an RTT sample */
+  uint32_t cc_rttstamp;   /* When it was sent (units: microseconds) */
+
+  FAR const struct tcp_cc_ops_s *cc_ops; /* Congestion control algorithm */
+
+#if defined(CONFIG_NET_TCP_CC_CUBIC) || defined(CONFIG_NET_TCP_CC_BBR)
+  union
+  {
+#ifdef CONFIG_NET_TCP_CC_CUBIC
+    struct tcp_cubic_s cubic;
+#endif
+#ifdef CONFIG_NET_TCP_CC_BBR
+    struct tcp_bbr_s bbr;
+#endif
+  } cc_priv;              /* Private state of the algorithm */
+#endif
+#endif
+#ifdef CONFIG_NET_TCP_TIMESTAMPS
+  uint32_t ts_recent;     /* Latest timestamp of the peer to echo */
+  uint32_t ts_recent_age; /* When ts_recent was updated
+                           * (units: milliseconds) */
+  uint32_t ts_ecr;        /* Timestamp echoed by the last segment
+                           * (units: milliseconds) */
+#endif
+#ifdef CONFIG_NET_TCP_RACK
+  /* RACK-TLP timer handle and state, times in milliseconds */
+
+  struct   work_s rackwork;
+  uint32_t rack_xmitts;   /* Send time of the last delivered segment */
+  uint32_t rack_endseq;   /* End of the last delivered segment */
+  uint32_t rack_rtt;      /* RTT of the last delivered segment */
+  uint32_t rack_srtt;     /* Smoothed RTT, scaled by 8 */
+  bool     rack_probe;    /* The timer is armed for a tail loss probe */
+  bool     rack_timeout;  /* Trigger from RACK timer expiry */
+  bool     rack_armed;    /* rackwork is queued for this connection */
+#endif
+#ifdef CONFIG_NET_TCP_PACING
+  /* Pacing timer handle, rate and state */
+
+  struct   work_s pacework;
+  uint32_t pacing_rate;   /* Pacing rate (units: bytes per second, 0: off) */
+  uint32_t pacing_next;   /* Earliest time of the next segment
+                           * (units: microseconds) */
+  bool     pacing_armed;  /* pacework is queued for this connection */
 #endif
 #ifdef CONFIG_NET_TCP_WINDOW_SCALE
   uint32_t snd_wnd;       /* Sequence and acknowledgement numbers of last
@@ -278,6 +493,9 @@ struct tcp_conn_s
   uint16_t tx_unacked;    /* Number bytes sent but not yet ACKed */
 #endif
   uint16_t flags;         /* Flags of TCP-specific options */
+#ifdef CONFIG_NET_TCP_INFO
+  struct tcp_stats_s stats; /* Statistics of the connection */
+#endif
 #ifdef CONFIG_NET_SOLINGER
   sclock_t ltimeout;      /* Linger timeout expiration */
 #endif
@@ -298,6 +516,14 @@ struct tcp_conn_s
 
   FAR struct iob_s *readahead;   /* Read-ahead buffering */
 
+#ifdef CONFIG_NET_ZEROCOPY_RECV
+  /* Read-ahead I/O buffers lent to the user by recvmsg(MSG_ZEROCOPY) and
+   * not yet returned with TCP_ZEROCOPY_RELEASE.
+   */
+
+  FAR struct iob_s *zcloans[CONFIG_NET_ZEROCOPY_RXLOANS];
+#endif
+
 #ifdef CONFIG_NET_TCP_OUT_OF_ORDER
 
   /* Number of out-of-order segments */
@@ -413,6 +639,11 @@ struct tcp_wrbuffer_s
                             * segment sent */
 #if defined(CONFIG_NET_TCP_FAST_RETRANSMIT) && !defined(CONFIG_NET_TCP_CC_NEWRENO)
   uint8_t    wb_nack;      /* The number of ack count */
+#endif
+#ifdef CONFIG_NET_TCP_RACK
+  bool       wb_sacked;    /* The whole segment has been SACKed */
+  uint32_t   wb_xmitts;    /* When the segment was last sent
+                            * (units: milliseconds) */
 #endif
   struct iob_s *wb_iob;    /* Head of the I/O buffer chain */
 };
@@ -455,6 +686,18 @@ extern "C"
 {
 #endif
 
+#ifdef CONFIG_NET_TCP_CC_NEWRENO
+/* The congestion control algorithms */
+
+extern const struct tcp_cc_ops_s g_tcp_cc_newreno;
+#ifdef CONFIG_NET_TCP_CC_CUBIC
+extern const struct tcp_cc_ops_s g_tcp_cc_cubic;
+#endif
+#ifdef CONFIG_NET_TCP_CC_BBR
+extern const struct tcp_cc_ops_s g_tcp_cc_bbr;
+#endif
+#endif
+
 /****************************************************************************
  * Public Function Prototypes
  ****************************************************************************/
@@ -639,7 +882,9 @@ FAR struct tcp_conn_s *tcp_alloc_accept(FAR struct net_driver_s *dev,
  * Description:
  *   If the port number is zero; select an unused port for the connection.
  *   If the port number is non-zero, verify that no other connection has
- *   been created with this port number.
+ *   been created with this port number.  'opt' holds the socket options of
+ *   the connection being bound; with SO_REUSEPORT it may share the port
+ *   with other SO_REUSEPORT connections.
  *
  * Returned Value:
  *   Selected or verified port number in network order on success, a negated
@@ -652,7 +897,7 @@ FAR struct tcp_conn_s *tcp_alloc_accept(FAR struct net_driver_s *dev,
 
 int tcp_selectport(uint8_t domain,
                    FAR const union ip_addr_u *ipaddr,
-                   uint16_t portno);
+                   uint16_t portno, sockopt_t opt);
 
 /****************************************************************************
  * Name: tcp_bind
@@ -1046,6 +1291,55 @@ void tcp_update_keeptimer(FAR struct tcp_conn_s *conn, int timeout);
 
 void tcp_stop_timer(FAR struct tcp_conn_s *conn);
 
+/****************************************************************************
+ * Name: tcp_pacing_hold
+ *
+ * Description:
+ *   Check whether the pacer lets the connection send a segment now.  If
+ *   not, the pacing timer is started to poll the connection again when the
+ *   next segment is due.
+ *
+ * Input Parameters:
+ *   conn - The TCP connection of interest
+ *
+ * Returned Value:
+ *   true if the segment must be held back.
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_TCP_PACING
+bool tcp_pacing_hold(FAR struct tcp_conn_s *conn);
+#endif
+
+/****************************************************************************
+ * Name: tcp_rack_settimer
+ *
+ * Description:
+ *   Start the RACK timer of the connection, either to check the unacked
+ *   segments for loss again when their reordering window has passed, or
+ *   to send a tail loss probe.  A zero timeout stops the timer.
+ *
+ * Input Parameters:
+ *   conn    - The TCP connection of interest
+ *   timeout - Time for the next timeout (units: milliseconds)
+ *   probe   - True if a tail loss probe is due on expiry
+ *
+ * Returned Value:
+ *   None
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_TCP_RACK
+void tcp_rack_settimer(FAR struct tcp_conn_s *conn, uint32_t timeout,
+                       bool probe);
+#endif
+
 /****************************************************************************
  * Name: tcp_findlistener
  *
@@ -1066,6 +1360,38 @@ FAR struct tcp_conn_s *tcp_findlistener(FAR union ip_binding_u *uaddr,
                                         uint16_t portno);
 #endif
 
+/****************************************************************************
+ * Name: tcp_reuseport_select
+ *
+ * Description:
+ *   If 'listener' belongs to a SO_REUSEPORT group, return the member of the
+ *   group that owns the flow with the given hash; otherwise 'listener'.
+ *
+ * Assumptions:
+ *   The network is locked
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_REUSEPORT
+FAR struct tcp_conn_s *tcp_reuseport_select(FAR struct tcp_conn_s *listener,
+                                            uint32_t hash);
+#endif
+
+/****************************************************************************
+ * Name: tcp_connlistener
+ *
+ * Description:
+ *   Return the listener that a connection in the TCP_SYN_RCVD state will
+ *   be accepted by (if any).  With SO_REUSEPORT this is the member of the
+ *   group that was chosen when the SYN arrived, as long as it listens.
+ *
+ * Assumptions:
+ *   The network is locked
+ *
+ ****************************************************************************/
+
+FAR struct tcp_conn_s *tcp_connlistener(FAR struct tcp_conn_s *conn);
+
 /****************************************************************************
  * Name: tcp_unlisten
  *
@@ -1122,7 +1448,7 @@ bool tcp_islistener(FAR union ip_binding_u *uaddr, uint16_t portno);
  ****************************************************************************/
 
 int tcp_accept_connection(FAR struct net_driver_s *dev,
-                          FAR struct tcp_conn_s *conn, uint16_t portno);
+                          FAR struct tcp_conn_s *conn);
 
 /****************************************************************************
  * Name: tcp_send
@@ -2308,7 +2634,201 @@ void tcp_cc_update(FAR struct tcp_conn_s *conn, FAR struct tcp_hdr_s *tcp);
  ****************************************************************************/
 
 void tcp_cc_recv_ack(FAR struct tcp_conn_s *conn, FAR struct tcp_hdr_s *tcp);
-#endif
+
+/****************************************************************************
+ * Name: tcp_cc_sent
+ *
+ * Description:
+ *   Account a data segment handed to the device: time it for an RTT
+ *   sample and advance the pacer.
+ *
+ * Input Parameters:
+ *   conn   - The TCP connection of interest
+ *   seq    - The sequence number of the segment
+ *   len    - The length of the segment
+ *   rexmit - True if the segment is retransmitted
+ *
+ * Returned Value:
+ *   None
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+void tcp_cc_sent(FAR struct tcp_conn_s *conn, uint32_t seq, uint32_t len,
+                 bool rexmit);
+
+/****************************************************************************
+ * Name: tcp_cc_timeout
+ *
+ * Description:
+ *   Collapse the congestion window after a retransmission timeout.
+ *
+ * Input Parameters:
+ *   conn   - The TCP connection of interest
+ *
+ * Returned Value:
+ *   None
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+void tcp_cc_timeout(FAR struct tcp_conn_s *conn);
+
+/****************************************************************************
+ * Name: tcp_cc_find
+ *
+ * Description:
+ *   Find a congestion control algorithm by name, e.g. "cubic".
+ *
+ * Input Parameters:
+ *   name   - The name of the algorithm
+ *
+ * Returned Value:
+ *   The algorithm or NULL if there is no algorithm of that name.
+ *
+ ****************************************************************************/
+
+FAR const struct tcp_cc_ops_s *tcp_cc_find(FAR const char *name);
+
+/****************************************************************************
+ * Name: tcp_cc_select
+ *
+ * Description:
+ *   Switch the connection to another congestion control algorithm.
+ *
+ * Input Parameters:
+ *   conn   - The TCP connection of interest
+ *   ops    - The algorithm
+ *
+ * Returned Value:
+ *   None
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+void tcp_cc_select(FAR struct tcp_conn_s *conn,
+                   FAR const struct tcp_cc_ops_s *ops);
+
+/****************************************************************************
+ * Name: tcp_cc_slow_start
+ *
+ * Description:
+ *   Grow cwnd by up to one MSS per ACK (RFC 5681 slow start).  A helper
+ *   for the congestion control algorithms.
+ *
+ * Input Parameters:
+ *   conn   - The TCP connection of interest
+ *   acked  - The number of newly acknowledged bytes
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+void tcp_cc_slow_start(FAR struct tcp_conn_s *conn, uint32_t acked);
+
+/****************************************************************************
+ * Name: tcp_cc_now
+ *
+ * Description:
+ *   Return the time base of congestion control and pacing.
+ *
+ * Returned Value:
+ *   The system time in microseconds, modulo 2^32.
+ *
+ ****************************************************************************/
+
+uint32_t tcp_cc_now(void);
+#endif /* CONFIG_NET_TCP_CC_NEWRENO */
+
+#ifdef CONFIG_NET_TCP_INFO
+/****************************************************************************
+ * Name: tcp_stats_rtt
+ *
+ * Description:
+ *   Feed an RTT sample into the smoothed RTT reported by TCP_INFO.  The
+ *   retransmission timer keeps its own, coarser estimate in conn->sa.
+ *
+ * Input Parameters:
+ *   conn   - The TCP connection of interest
+ *   rtt    - The RTT sample (units: microseconds)
+ *
+ * Returned Value:
+ *   None
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+void tcp_stats_rtt(FAR struct tcp_conn_s *conn, uint32_t rtt);
+
+/****************************************************************************
+ * Name: tcp_stats_send
+ *
+ * Description:
+ *   Account an outgoing segment.  A segment whose payload ends at or below
+ *   the highest sequence number sent so far is counted as retransmitted.
+ *
+ * Input Parameters:
+ *   conn    - The TCP connection of interest
+ *   seq     - The sequence number of the segment
+ *   datalen - The length of the payload
+ *
+ * Returned Value:
+ *   None
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+void tcp_stats_send(FAR struct tcp_conn_s *conn, uint32_t seq,
+                    uint32_t datalen);
+
+/****************************************************************************
+ * Name: tcp_stats_lock
+ *
+ * Description:
+ *   Take the network lock on behalf of a socket call of the connection and
+ *   account the time spent waiting for it.
+ *
+ * Input Parameters:
+ *   conn   - The TCP connection of interest, may be NULL
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+void tcp_stats_lock(FAR struct tcp_conn_s *conn);
+
+/****************************************************************************
+ * Name: tcp_getinfo
+ *
+ * Description:
+ *   Fill in the TCP_INFO statistics of a connection.
+ *
+ * Input Parameters:
+ *   conn   - The TCP connection of interest
+ *   info   - The location to return the statistics
+ *
+ * Returned Value:
+ *   None
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+void tcp_getinfo(FAR struct tcp_conn_s *conn, FAR struct tcp_info *info);
+#endif /* CONFIG_NET_TCP_INFO */
 
 #ifdef __cplusplus
 }
@@ -214,7 +214,12 @@ void tcp_appsend(FAR struct net_driver_s *dev, FAR struct tcp_conn_s *conn,
        * MSS (the minimum of the MSS and the available window).
        */
 
+#ifdef CONFIG_NETDEV_GSO
+      DEBUGASSERT(dev->d_sndlen <= conn->mss ||
+                  dev->d_gso_size == conn->mss);
+#else
       DEBUGASSERT(dev->d_sndlen <= conn->mss);
+#endif
 
 #if !defined(CONFIG_NET_TCP_WRITE_BUFFERS) || defined(CONFIG_NET_SENDFILE)
 
@@ -260,9 +260,13 @@ int tcp_ofoseg_bufsize(FAR struct tcp_conn_s *conn)
 uint16_t tcp_callback(FAR struct net_driver_s *dev,
                       FAR struct tcp_conn_s *conn, uint16_t flags)
 {
-#if defined(CONFIG_NET_TCP_NOTIFIER) || defined(CONFIG_NET_TCP_OUT_OF_ORDER)
+#if defined(CONFIG_NET_TCP_NOTIFIER) || \
+    defined(CONFIG_NET_TCP_OUT_OF_ORDER) || defined(CONFIG_NET_TCP_INFO)
   uint16_t orig = flags;
 #endif
+#ifdef CONFIG_NET_TCP_INFO
+  uint32_t rcvseq = tcp_getsequence(conn->rcvseq);
+#endif
 
   /* Prepare device buffer */
 
@@ -323,6 +327,18 @@ uint16_t tcp_callback(FAR struct net_driver_s *dev,
     }
 #endif
 
+#ifdef CONFIG_NET_TCP_INFO
+  /* Whoever took the data, in order or from the out-of-order pool, has
+   * advanced rcvseq past it.
+   */
+
+  if ((orig & TCP_NEWDATA) != 0)
+    {
+      conn->stats.bytes_received +=
+        TCP_SEQ_SUB(tcp_getsequence(conn->rcvseq), rcvseq);
+    }
+#endif
+
   /* Check if there is a connection-related event and a connection
    * callback.
    */
@@ -24,8 +24,15 @@
  * Included Files
  ****************************************************************************/
 
+#include <nuttx/config.h>
+
+#include <sys/param.h>
+#include <string.h>
+#include <time.h>
 #include <debug.h>
 
+#include <nuttx/clock.h>
+
 #include "tcp/tcp.h"
 
 /****************************************************************************
@@ -74,10 +81,103 @@
     } \
  } while(0)
 
+/* The pacer lets a connection that was idle send one tick's worth of data
+ * at once, so the pacing is not limited by the resolution of the timer.
+ */
+
+#define TCP_PACING_SLACK USEC_PER_TICK
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+static void newreno_init(FAR struct tcp_conn_s *conn);
+static uint32_t newreno_ssthresh(FAR struct tcp_conn_s *conn);
+static void newreno_cong_avoid(FAR struct tcp_conn_s *conn, uint32_t acked);
+
+/****************************************************************************
+ * Public Data
+ ****************************************************************************/
+
+const struct tcp_cc_ops_s g_tcp_cc_newreno =
+{
+  "newreno",            /* name */
+  newreno_init,         /* init */
+  newreno_ssthresh,     /* ssthresh */
+  newreno_cong_avoid,   /* cong_avoid */
+  NULL                  /* acked */
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static FAR const struct tcp_cc_ops_s * const g_tcp_cc_algs[] =
+{
+  &g_tcp_cc_newreno,
+#ifdef CONFIG_NET_TCP_CC_CUBIC
+  &g_tcp_cc_cubic,
+#endif
+#ifdef CONFIG_NET_TCP_CC_BBR
+  &g_tcp_cc_bbr,
+#endif
+};
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
 
+/****************************************************************************
+ * Name: newreno_init
+ ****************************************************************************/
+
+static void newreno_init(FAR struct tcp_conn_s *conn)
+{
+  /* NewReno keeps no state besides cwnd and ssthresh */
+}
+
+/****************************************************************************
+ * Name: newreno_ssthresh
+ *
+ * Description:
+ *   ssthresh = max (FlightSize / 2, 2*SMSS) referring to rfc5681
+ *
+ ****************************************************************************/
+
+static uint32_t newreno_ssthresh(FAR struct tcp_conn_s *conn)
+{
+  return MAX(conn->tx_unacked / 2, 2 * conn->mss);
+}
+
+/****************************************************************************
+ * Name: newreno_cong_avoid
+ ****************************************************************************/
+
+static void newreno_cong_avoid(FAR struct tcp_conn_s *conn, uint32_t acked)
+{
+  uint32_t increase;
+
+  if (conn->cwnd < conn->ssthresh)
+    {
+      tcp_cc_slow_start(conn, acked);
+    }
+  else
+    {
+      /* cong avoid (RFC 5681):
+       * Grow cwnd linearly by approximately maxseg per RTT using
+       * maxseg^2 / cwnd per ACK as the increment.
+       * If cwnd > maxseg^2, fix the cwnd increment at 1 byte to
+       * avoid capping cwnd.
+       */
+
+      increase = MAX((conn->mss * conn->mss / conn->cwnd), 1);
+
+      CC_CWND_INC(conn->cwnd, increase);
+      conn->cwnd = MIN(conn->cwnd, conn->max_cwnd);
+      ninfo("update congestion avoidance cwnd to %u\n", conn->cwnd);
+    }
+}
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -117,6 +217,12 @@ void tcp_cc_init(FAR struct tcp_conn_s *conn)
 
   conn->ssthresh = 2 * TCP_IPV4_DEFAULT_MSS;
   conn->dupacks = 0;
+  conn->flags &= ~TCP_CCRTT;
+#ifdef CONFIG_NET_TCP_PACING
+  conn->pacing_rate = 0;
+#endif
+
+  conn->cc_ops->init(conn);
 }
 
 /****************************************************************************
@@ -140,15 +246,14 @@ void tcp_cc_init(FAR struct tcp_conn_s *conn)
 
 void tcp_cc_update(FAR struct tcp_conn_s *conn, FAR struct tcp_hdr_s *tcp)
 {
-  /* After Fast retransmitted, set ssthresh to the maximum of
-   * the unacked and the 2*SMSS, and enter to Fast Recovery.
-   * ssthresh = max (FlightSize / 2, 2*SMSS) referring to rfc5681
+  /* After Fast retransmitted, let the algorithm reduce ssthresh, and
+   * enter to Fast Recovery.
    * cwnd=ssthresh + 3*SMSS  referring to rfc5681
    */
 
   if (conn->flags & TCP_INFT)
     {
-      conn->ssthresh = MAX(conn->tx_unacked / 2, 2 * conn->mss);
+      conn->ssthresh = conn->cc_ops->ssthresh(conn);
       conn->cwnd = conn->ssthresh + 3 * conn->mss;
 
       conn->flags &= ~TCP_INFT;
@@ -162,6 +267,7 @@ void tcp_cc_update(FAR struct tcp_conn_s *conn, FAR struct tcp_hdr_s *tcp)
   else
     {
       conn->last_ackno = tcp_getsequence(tcp->ackno);
+      conn->cc_sndmax = conn->last_ackno;
       CC_INIT_CWND(conn->cwnd, conn->mss);
       conn->max_cwnd = conn->snd_wnd;
       conn->ssthresh = MAX(conn->snd_wnd, conn->ssthresh);
@@ -220,7 +326,12 @@ void tcp_cc_recv_ack(FAR struct tcp_conn_s *conn, FAR struct tcp_hdr_s *tcp)
               CC_CWND_INC(conn->cwnd, conn->mss);
             }
 
-          if (conn->dupacks >= TCP_FAST_RETRANSMISSION_THRESH)
+          /* Enter fast recovery only once per window of data, so that
+           * further losses in it do not reduce the window again (RFC6582).
+           */
+
+          if (conn->dupacks >= TCP_FAST_RETRANSMISSION_THRESH &&
+              (conn->flags & TCP_INFR) == 0)
             {
               /* Do fast retransmit, but it is delayed in
                * psock_send_eventhandler. Set the TCP_INFT flag.
@@ -229,6 +340,15 @@ void tcp_cc_recv_ack(FAR struct tcp_conn_s *conn, FAR struct tcp_hdr_s *tcp)
               conn->flags |= TCP_INFT;
               conn->fr_recover = tcp_getsequence(conn->sndseq);
             }
+
+          /* Each duplicate ACK reports one more segment that has left the
+           * network.
+           */
+
+          if (conn->cc_ops->acked != NULL)
+            {
+              conn->cc_ops->acked(conn, 0, 0);
+            }
         }
     }
   else if (TCP_SEQ_GT(ackno, conn->last_ackno) &&
@@ -237,12 +357,36 @@ void tcp_cc_recv_ack(FAR struct tcp_conn_s *conn, FAR struct tcp_hdr_s *tcp)
       /* We come here when the ACK acknowledges new data. */
 
       uint32_t acked = TCP_SEQ_SUB(ackno, conn->last_ackno);
+      uint32_t rtt = 0;
 
       /* Reset dupacks and update last_ackno. */
 
       conn->dupacks = 0;
       conn->last_ackno = ackno;
 
+      /* Complete the RTT sample if the timed segment is acknowledged. */
+
+      if ((conn->flags & TCP_CCRTT) != 0 &&
+          TCP_SEQ_GTE(ackno, conn->cc_rttseq))
+        {
+          conn->flags &= ~TCP_CCRTT;
+          rtt = MAX(tcp_cc_now() - conn->cc_rttstamp, 1);
+
+#ifdef CONFIG_NET_TCP_INFO
+          /* With timestamps every ACK already gives a sample */
+
+          if ((conn->flags & TCP_TSTAMP) == 0)
+            {
+              tcp_stats_rtt(conn, rtt);
+            }
+#endif
+        }
+
+      if (conn->cc_ops->acked != NULL)
+        {
+          conn->cc_ops->acked(conn, acked, rtt);
+        }
+
       /* When the ackno covers more than the fr_recover, exit the
        * fast recovery. Then, reset the "IN Fast Recovery" flags.
        * Also reset the congestion window to the slow start threshold.
@@ -269,34 +413,214 @@ void tcp_cc_recv_ack(FAR struct tcp_conn_s *conn, FAR struct tcp_hdr_s *tcp)
 
       if (conn->tcpstateflags >= TCP_ESTABLISHED)
         {
-          uint32_t increase;
+          conn->cc_ops->cong_avoid(conn, acked);
+        }
+    }
+}
 
-          if (conn->cwnd < conn->ssthresh)
-            {
-              /* slow start (RFC 5681):
-               * Grow cwnd exponentially by maxseg(smss) per ACK.
-               */
+/****************************************************************************
+ * Name: tcp_cc_sent
+ *
+ * Description:
+ *   Account a data segment handed to the device: time it for an RTT
+ *   sample and advance the pacer.
+ *
+ * Input Parameters:
+ *   conn   - The TCP connection of interest
+ *   seq    - The sequence number of the segment
+ *   len    - The length of the segment
+ *   rexmit - True if the segment is retransmitted
+ *
+ * Returned Value:
+ *   None
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
 
-              increase = acked > 0 ? MIN(acked, conn->mss) : conn->mss;
+void tcp_cc_sent(FAR struct tcp_conn_s *conn, uint32_t seq, uint32_t len,
+                 bool rexmit)
+{
+  uint32_t end = TCP_SEQ_ADD(seq, len);
 
-              CC_CWND_INC(conn->cwnd, increase);
-              ninfo("update slow start cwnd to %u\n", conn->cwnd);
-            }
-          else
-            {
-              /* cong avoid (RFC 5681):
-               * Grow cwnd linearly by approximately maxseg per RTT using
-               * maxseg^2 / cwnd per ACK as the increment.
-               * If cwnd > maxseg^2, fix the cwnd increment at 1 byte to
-               * avoid capping cwnd.
-               */
+  /* Time one segment per round trip.  The ACK of a retransmitted segment
+   * is ambiguous, so a retransmission cancels the sample (Karn).
+   */
+
+  if (rexmit)
+    {
+      conn->flags &= ~TCP_CCRTT;
+    }
+  else if ((conn->flags & TCP_CCRTT) == 0)
+    {
+      conn->flags      |= TCP_CCRTT;
+      conn->cc_rttseq   = end;
+      conn->cc_rttstamp = tcp_cc_now();
+    }
 
-              increase = MAX((conn->mss * conn->mss / conn->cwnd), 1);
+  if (TCP_SEQ_GT(end, conn->cc_sndmax))
+    {
+      conn->cc_sndmax = end;
+    }
 
-              CC_CWND_INC(conn->cwnd, increase);
-              conn->cwnd = MIN(conn->cwnd, conn->max_cwnd);
-              ninfo("update congestion avoidance cwnd to %u\n", conn->cwnd);
-            }
+#ifdef CONFIG_NET_TCP_PACING
+  if (conn->pacing_rate > 0)
+    {
+      uint32_t start = tcp_cc_now() - TCP_PACING_SLACK;
+
+      if (TCP_SEQ_LT(conn->pacing_next, start))
+        {
+          conn->pacing_next = start;
+        }
+
+      conn->pacing_next += (uint64_t)len * USEC_PER_SEC / conn->pacing_rate;
+    }
+#endif
+}
+
+/****************************************************************************
+ * Name: tcp_cc_timeout
+ *
+ * Description:
+ *   Collapse the congestion window after a retransmission timeout.
+ *
+ * Input Parameters:
+ *   conn   - The TCP connection of interest
+ *
+ * Returned Value:
+ *   None
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+void tcp_cc_timeout(FAR struct tcp_conn_s *conn)
+{
+  /* If conn is TCP_INFR, it should enter to slow start */
+
+  conn->flags &= ~(TCP_INFR | TCP_CCRTT);
+
+  /* update the max_cwnd */
+
+  conn->max_cwnd = (conn->max_cwnd + 7 * conn->cwnd) >> 3;
+
+  /* reset cwnd and ssthresh, refers to RFC5861. */
+
+  conn->ssthresh = conn->cc_ops->ssthresh(conn);
+  conn->cwnd = conn->mss;
+}
+
+/****************************************************************************
+ * Name: tcp_cc_find
+ *
+ * Description:
+ *   Find a congestion control algorithm by name, e.g. "cubic".
+ *
+ * Input Parameters:
+ *   name   - The name of the algorithm
+ *
+ * Returned Value:
+ *   The algorithm or NULL if there is no algorithm of that name.
+ *
+ ****************************************************************************/
+
+FAR const struct tcp_cc_ops_s *tcp_cc_find(FAR const char *name)
+{
+  size_t i;
+
+  for (i = 0; i < nitems(g_tcp_cc_algs); i++)
+    {
+      if (strcmp(g_tcp_cc_algs[i]->name, name) == 0)
+        {
+          return g_tcp_cc_algs[i];
         }
     }
+
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: tcp_cc_select
+ *
+ * Description:
+ *   Switch the connection to another congestion control algorithm.
+ *
+ * Input Parameters:
+ *   conn   - The TCP connection of interest
+ *   ops    - The algorithm
+ *
+ * Returned Value:
+ *   None
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+void tcp_cc_select(FAR struct tcp_conn_s *conn,
+                   FAR const struct tcp_cc_ops_s *ops)
+{
+  if (conn->cc_ops != ops)
+    {
+      /* A running connection keeps its window, the new algorithm takes
+       * over from there.
+       */
+
+      conn->cc_ops = ops;
+#ifdef CONFIG_NET_TCP_PACING
+      conn->pacing_rate = 0;
+#endif
+      ops->init(conn);
+    }
+}
+
+/****************************************************************************
+ * Name: tcp_cc_slow_start
+ *
+ * Description:
+ *   Grow cwnd by up to one MSS per ACK (RFC 5681 slow start).  A helper
+ *   for the congestion control algorithms.
+ *
+ * Input Parameters:
+ *   conn   - The TCP connection of interest
+ *   acked  - The number of newly acknowledged bytes
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+void tcp_cc_slow_start(FAR struct tcp_conn_s *conn, uint32_t acked)
+{
+  uint32_t increase;
+
+  /* slow start (RFC 5681):
+   * Grow cwnd exponentially by maxseg(smss) per ACK.
+   */
+
+  increase = acked > 0 ? MIN(acked, conn->mss) : conn->mss;
+
+  CC_CWND_INC(conn->cwnd, increase);
+  ninfo("update slow start cwnd to %u\n", conn->cwnd);
+}
+
+/****************************************************************************
+ * Name: tcp_cc_now
+ *
+ * Description:
+ *   Return the time base of congestion control and pacing.
+ *
+ * Returned Value:
+ *   The system time in microseconds, modulo 2^32.
+ *
+ ****************************************************************************/
+
+uint32_t tcp_cc_now(void)
+{
+  struct timespec ts;
+
+  clock_systime_timespec(&ts);
+  return (uint32_t)ts.tv_sec * USEC_PER_SEC + ts.tv_nsec / NSEC_PER_USEC;
 }
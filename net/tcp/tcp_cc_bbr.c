@@ -0,0 +1,430 @@
+/****************************************************************************
+ * net/tcp/tcp_cc_bbr.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/param.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <string.h>
+#include <debug.h>
+
+#include <nuttx/clock.h>
+
+#include "tcp/tcp.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Gains are scaled by BBR_UNIT */
+
+#define BBR_UNIT              256
+#define BBR_HIGH_GAIN         739   /* 2/ln(2), doubles the rate per round */
+#define BBR_DRAIN_GAIN        89    /* 1/BBR_HIGH_GAIN, drains the queue */
+#define BBR_CWND_GAIN         512   /* cwnd of two BDPs in PROBE_BW */
+#define BBR_FULL_BW_GAIN      320   /* Growth expected per STARTUP round */
+#define BBR_FULL_BW_ROUNDS    3     /* Rounds without growth to leave
+                                     * STARTUP */
+#define BBR_CYCLE_LEN         8     /* Phases of the PROBE_BW gain cycle */
+
+#define BBR_MINRTT_WIN        (10 * USEC_PER_SEC)
+#define BBR_PROBE_RTT_TIME    (200 * USEC_PER_MSEC)
+#define BBR_MIN_CWND(conn)    (4 * (uint32_t)(conn)->mss)
+
+/* State machine */
+
+#define BBR_STARTUP           0     /* Ramp up to fill the pipe */
+#define BBR_DRAIN             1     /* Drain the queue built in STARTUP */
+#define BBR_PROBE_BW          2     /* Cruise, probing for more bandwidth */
+#define BBR_PROBE_RTT         3     /* Drain the pipe to measure min RTT */
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+static void bbr_init(FAR struct tcp_conn_s *conn);
+static uint32_t bbr_ssthresh(FAR struct tcp_conn_s *conn);
+static void bbr_cong_avoid(FAR struct tcp_conn_s *conn, uint32_t acked);
+static void bbr_acked(FAR struct tcp_conn_s *conn, uint32_t acked,
+                      uint32_t rtt);
+
+/****************************************************************************
+ * Public Data
+ ****************************************************************************/
+
+const struct tcp_cc_ops_s g_tcp_cc_bbr =
+{
+  "bbr",                /* name */
+  bbr_init,             /* init */
+  bbr_ssthresh,         /* ssthresh */
+  bbr_cong_avoid,       /* cong_avoid */
+  bbr_acked             /* acked */
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/* Pacing gains of PROBE_BW: probe for bandwidth, drain what the probe
+ * queued, then cruise at the estimated bandwidth.
+ */
+
+static const uint16_t g_bbr_cycle_gain[BBR_CYCLE_LEN] =
+{
+  BBR_UNIT * 5 / 4, BBR_UNIT * 3 / 4, BBR_UNIT, BBR_UNIT,
+  BBR_UNIT, BBR_UNIT, BBR_UNIT, BBR_UNIT
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: bbr_max_bw
+ *
+ * Description:
+ *   The bottleneck bandwidth: the maximum delivery rate of the last
+ *   TCP_BBR_BW_ROUNDS rounds.
+ *
+ ****************************************************************************/
+
+static uint32_t bbr_max_bw(FAR struct tcp_bbr_s *bbr)
+{
+  uint32_t bw = 0;
+  int i;
+
+  for (i = 0; i < TCP_BBR_BW_ROUNDS; i++)
+    {
+      bw = MAX(bw, bbr->bw[i]);
+    }
+
+  return bw;
+}
+
+/****************************************************************************
+ * Name: bbr_bdp
+ *
+ * Description:
+ *   The bandwidth-delay product scaled by 'gain', or zero while either of
+ *   the two is unknown.
+ *
+ ****************************************************************************/
+
+static uint32_t bbr_bdp(FAR struct tcp_bbr_s *bbr, uint32_t gain)
+{
+  uint64_t bdp;
+
+  bdp = (uint64_t)bbr_max_bw(bbr) * bbr->minrtt / USEC_PER_SEC;
+  return MIN(bdp * gain / BBR_UNIT, UINT32_MAX);
+}
+
+/****************************************************************************
+ * Name: bbr_pacing_gain
+ ****************************************************************************/
+
+static uint32_t bbr_pacing_gain(FAR struct tcp_bbr_s *bbr)
+{
+  switch (bbr->mode)
+    {
+      case BBR_STARTUP:
+        return BBR_HIGH_GAIN;
+
+      case BBR_DRAIN:
+        return BBR_DRAIN_GAIN;
+
+      case BBR_PROBE_BW:
+        return g_bbr_cycle_gain[bbr->cycle];
+
+      default:
+        return BBR_UNIT;
+    }
+}
+
+/****************************************************************************
+ * Name: bbr_set_pacing_rate
+ ****************************************************************************/
+
+static void bbr_set_pacing_rate(FAR struct tcp_conn_s *conn)
+{
+  FAR struct tcp_bbr_s *bbr = &conn->cc_priv.bbr;
+  uint32_t bw = bbr_max_bw(bbr);
+  uint64_t rate;
+
+  if (bw > 0)
+    {
+      rate = (uint64_t)bw * bbr_pacing_gain(bbr) / BBR_UNIT;
+    }
+  else if (bbr->minrtt > 0)
+    {
+      /* No bandwidth sample yet, spread the window over one RTT */
+
+      rate = (uint64_t)conn->cwnd * USEC_PER_SEC / bbr->minrtt *
+             BBR_HIGH_GAIN / BBR_UNIT;
+    }
+  else
+    {
+      return;
+    }
+
+  /* STARTUP may only raise the rate, a round with an application limited
+   * sample must not slow the ramp up.
+   */
+
+  if (bbr->full_bw_reached || rate > conn->pacing_rate)
+    {
+      conn->pacing_rate = MIN(MAX(rate, 1), UINT32_MAX);
+    }
+}
+
+/****************************************************************************
+ * Name: bbr_enter_probe_bw
+ ****************************************************************************/
+
+static void bbr_enter_probe_bw(FAR struct tcp_bbr_s *bbr)
+{
+  /* Start in a random phase, but not in the probe, so that flows that
+   * share the bottleneck do not probe at the same time.
+   */
+
+  bbr->mode  = BBR_PROBE_BW;
+  bbr->cycle = BBR_CYCLE_LEN - 1 - bbr->round_count % (BBR_CYCLE_LEN - 1);
+}
+
+/****************************************************************************
+ * Name: bbr_new_round
+ *
+ * Description:
+ *   Take the delivery rate sample of the round that just ended and advance
+ *   the state machine.
+ *
+ ****************************************************************************/
+
+static void bbr_new_round(FAR struct tcp_conn_s *conn, uint32_t now)
+{
+  FAR struct tcp_bbr_s *bbr = &conn->cc_priv.bbr;
+  uint32_t elapsed = now - bbr->round_stamp;
+  uint32_t bw;
+
+  if (bbr->round_stamp != 0 && elapsed > 0)
+    {
+      bbr->bw[bbr->round_count % TCP_BBR_BW_ROUNDS] =
+        MIN((uint64_t)bbr->delivered * USEC_PER_SEC / elapsed, UINT32_MAX);
+    }
+
+  bbr->round_count++;
+  bbr->round_end   = conn->cc_sndmax;
+  bbr->round_stamp = now | 1;
+  bbr->delivered   = 0;
+
+  /* The pipe is full once the bandwidth stops growing by 25% per round */
+
+  bw = bbr_max_bw(bbr);
+  if (!bbr->full_bw_reached)
+    {
+      if ((uint64_t)bw * BBR_UNIT >= (uint64_t)bbr->full_bw *
+                                     BBR_FULL_BW_GAIN)
+        {
+          bbr->full_bw     = bw;
+          bbr->full_bw_cnt = 0;
+        }
+      else if (++bbr->full_bw_cnt >= BBR_FULL_BW_ROUNDS)
+        {
+          bbr->full_bw_reached = true;
+        }
+    }
+
+  if (bbr->mode == BBR_PROBE_BW)
+    {
+      bbr->cycle = (bbr->cycle + 1) % BBR_CYCLE_LEN;
+    }
+}
+
+/****************************************************************************
+ * Name: bbr_init
+ ****************************************************************************/
+
+static void bbr_init(FAR struct tcp_conn_s *conn)
+{
+  memset(&conn->cc_priv.bbr, 0, sizeof(struct tcp_bbr_s));
+  conn->cc_priv.bbr.mode = BBR_STARTUP;
+}
+
+/****************************************************************************
+ * Name: bbr_ssthresh
+ *
+ * Description:
+ *   BBR does not take a loss as a congestion signal.  Fast recovery keeps
+ *   what is in flight (packet conservation) and the model restores the
+ *   window afterwards.
+ *
+ ****************************************************************************/
+
+static uint32_t bbr_ssthresh(FAR struct tcp_conn_s *conn)
+{
+  return MAX(conn->tx_unacked, BBR_MIN_CWND(conn));
+}
+
+/****************************************************************************
+ * Name: bbr_cong_avoid
+ ****************************************************************************/
+
+static void bbr_cong_avoid(FAR struct tcp_conn_s *conn, uint32_t acked)
+{
+  FAR struct tcp_bbr_s *bbr = &conn->cc_priv.bbr;
+  uint32_t target;
+
+  if (bbr->mode == BBR_PROBE_RTT)
+    {
+      conn->cwnd = BBR_MIN_CWND(conn);
+      return;
+    }
+
+  /* A cwnd of cwnd_gain BDPs plus a few segments for delayed and stretched
+   * ACKs.  Until the pipe is full, grow like slow start towards it.
+   */
+
+  target = bbr_bdp(bbr, bbr->mode == BBR_PROBE_BW ?
+                        BBR_CWND_GAIN : BBR_HIGH_GAIN);
+  if (target > 0)
+    {
+      target += 3 * conn->mss;
+    }
+
+  if (bbr->full_bw_reached && target > 0)
+    {
+      conn->cwnd = MIN(conn->cwnd + acked, target);
+    }
+  else if (target == 0 || conn->cwnd < target)
+    {
+      conn->cwnd += acked;
+    }
+
+  conn->cwnd = MAX(conn->cwnd, BBR_MIN_CWND(conn));
+  conn->cwnd = MIN(conn->cwnd, conn->max_cwnd);
+  ninfo("update bbr cwnd to %" PRIu32 " mode %u pacing %" PRIu32 "\n",
+        conn->cwnd, bbr->mode, conn->pacing_rate);
+}
+
+/****************************************************************************
+ * Name: bbr_acked
+ ****************************************************************************/
+
+static void bbr_acked(FAR struct tcp_conn_s *conn, uint32_t acked,
+                      uint32_t rtt)
+{
+  FAR struct tcp_bbr_s *bbr = &conn->cc_priv.bbr;
+  uint32_t now = tcp_cc_now();
+  bool expired;
+
+  /* Without SACK, a duplicate ACK is taken as the delivery of one segment.
+   * The cumulative ACK that ends the recovery covers these again and must
+   * not count twice, or it would look like a burst of bandwidth.
+   */
+
+  if (acked == 0)
+    {
+      bbr->dupacked  += conn->mss;
+      bbr->delivered += conn->mss;
+      return;
+    }
+  else if (bbr->dupacked >= acked)
+    {
+      bbr->dupacked  -= acked;
+    }
+  else
+    {
+      bbr->delivered += acked - bbr->dupacked;
+      bbr->dupacked   = 0;
+    }
+
+  /* Min RTT filter, a sample older than BBR_MINRTT_WIN expires */
+
+  expired = bbr->minrtt != 0 &&
+            now - bbr->minrtt_stamp > BBR_MINRTT_WIN;
+  if (rtt > 0 && (bbr->minrtt == 0 || rtt <= bbr->minrtt || expired))
+    {
+      bbr->minrtt       = rtt;
+      bbr->minrtt_stamp = now;
+    }
+
+  /* A round ends when the data sent at its start is acknowledged */
+
+  if (bbr->round_stamp == 0 ||
+      TCP_SEQ_GTE(conn->last_ackno, bbr->round_end))
+    {
+      bbr_new_round(conn, now);
+    }
+
+  if (bbr->mode == BBR_STARTUP && bbr->full_bw_reached)
+    {
+      bbr->mode = BBR_DRAIN;
+    }
+
+  if (bbr->mode == BBR_DRAIN &&
+      conn->tx_unacked <= bbr_bdp(bbr, BBR_UNIT))
+    {
+      bbr_enter_probe_bw(bbr);
+    }
+
+  /* Drain the pipe down to four segments for BBR_PROBE_RTT_TIME once the
+   * min RTT was not refreshed for BBR_MINRTT_WIN.
+   */
+
+  if (expired && bbr->mode != BBR_PROBE_RTT)
+    {
+      bbr->mode           = BBR_PROBE_RTT;
+      bbr->prior_cwnd     = conn->cwnd;
+      bbr->probertt_end = 0;
+    }
+
+  if (bbr->mode == BBR_PROBE_RTT)
+    {
+      if (bbr->probertt_end == 0)
+        {
+          if (conn->tx_unacked <= BBR_MIN_CWND(conn))
+            {
+              bbr->probertt_end = (now + BBR_PROBE_RTT_TIME) | 1;
+            }
+        }
+      else if ((int32_t)(now - bbr->probertt_end) >= 0)
+        {
+          bbr->minrtt_stamp = now;
+          conn->cwnd        = MAX(conn->cwnd, bbr->prior_cwnd);
+
+          if (bbr->full_bw_reached)
+            {
+              bbr_enter_probe_bw(bbr);
+            }
+          else
+            {
+              bbr->mode = BBR_STARTUP;
+            }
+        }
+    }
+
+  bbr_set_pacing_rate(conn);
+}
@@ -0,0 +1,267 @@
+/****************************************************************************
+ * net/tcp/tcp_cc_cubic.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/param.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <string.h>
+#include <debug.h>
+
+#include <nuttx/clock.h>
+
+#include "tcp/tcp.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* beta_cubic = 0.7 and the fast convergence factor (1 + beta_cubic) / 2,
+ * both scaled by 1024.
+ */
+
+#define CUBIC_BETA        717
+#define CUBIC_FAST_BETA   870
+
+/* alpha_cubic = 3 * (1 - beta_cubic) / (1 + beta_cubic), scaled by 1024,
+ * makes the Reno-friendly estimate grow as fast as Reno on average.
+ */
+
+#define CUBIC_ALPHA       542
+
+/* C = 0.4 segments / second^3.  K = cbrt(W / C) seconds for a reduction
+ * of W segments is computed as cbrt(W * CUBIC_K_SCALE) milliseconds.
+ */
+
+#define CUBIC_K_SCALE     2500000000ull
+
+/* Bound |t - K| (units: msec) so that its cube fits in 64 bits */
+
+#define CUBIC_MAX_DELTA   131072
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+static void cubic_init(FAR struct tcp_conn_s *conn);
+static uint32_t cubic_ssthresh(FAR struct tcp_conn_s *conn);
+static void cubic_cong_avoid(FAR struct tcp_conn_s *conn, uint32_t acked);
+static void cubic_acked(FAR struct tcp_conn_s *conn, uint32_t acked,
+                        uint32_t rtt);
+
+/****************************************************************************
+ * Public Data
+ ****************************************************************************/
+
+const struct tcp_cc_ops_s g_tcp_cc_cubic =
+{
+  "cubic",              /* name */
+  cubic_init,           /* init */
+  cubic_ssthresh,       /* ssthresh */
+  cubic_cong_avoid,     /* cong_avoid */
+  cubic_acked           /* acked */
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: cubic_cbrt
+ *
+ * Description:
+ *   Integer cube root, rounded down.
+ *
+ ****************************************************************************/
+
+static uint32_t cubic_cbrt(uint64_t x)
+{
+  uint64_t y = 0;
+  uint64_t b;
+  int s;
+
+  for (s = 63; s >= 0; s -= 3)
+    {
+      y <<= 1;
+      b = 3 * y * (y + 1) + 1;
+      if ((x >> s) >= b)
+        {
+          x -= b << s;
+          y++;
+        }
+    }
+
+  return (uint32_t)y;
+}
+
+/****************************************************************************
+ * Name: cubic_window
+ *
+ * Description:
+ *   W_cubic(t) = C * (t - K)^3 + W_max (RFC 9438, 4.2), in bytes.
+ *
+ ****************************************************************************/
+
+static uint32_t cubic_window(FAR struct tcp_conn_s *conn, int64_t t)
+{
+  FAR struct tcp_cubic_s *cubic = &conn->cc_priv.cubic;
+  int64_t delta = t - cubic->k;
+  int64_t window;
+
+  delta  = MIN(MAX(delta, -CUBIC_MAX_DELTA), CUBIC_MAX_DELTA);
+  window = (int64_t)cubic->origin +
+           delta * delta * delta / 1000 * 4 * conn->mss / 10000000;
+
+  return window > 0 ? (uint32_t)MIN(window, UINT32_MAX) : 0;
+}
+
+/****************************************************************************
+ * Name: cubic_init
+ ****************************************************************************/
+
+static void cubic_init(FAR struct tcp_conn_s *conn)
+{
+  memset(&conn->cc_priv.cubic, 0, sizeof(struct tcp_cubic_s));
+}
+
+/****************************************************************************
+ * Name: cubic_ssthresh
+ *
+ * Description:
+ *   Remember the window at the loss as the plateau of the next epoch and
+ *   reduce it by beta_cubic (RFC 9438, 4.6 and 4.7).
+ *
+ ****************************************************************************/
+
+static uint32_t cubic_ssthresh(FAR struct tcp_conn_s *conn)
+{
+  FAR struct tcp_cubic_s *cubic = &conn->cc_priv.cubic;
+
+  /* Fast convergence: a flow that lost before reaching its previous
+   * plateau releases bandwidth for new flows.
+   */
+
+  if (conn->cwnd < cubic->wmax)
+    {
+      cubic->wmax = (uint64_t)conn->cwnd * CUBIC_FAST_BETA / 1024;
+    }
+  else
+    {
+      cubic->wmax = conn->cwnd;
+    }
+
+  cubic->epoch = 0;
+
+  return MAX((uint64_t)conn->cwnd * CUBIC_BETA / 1024, 2 * conn->mss);
+}
+
+/****************************************************************************
+ * Name: cubic_cong_avoid
+ ****************************************************************************/
+
+static void cubic_cong_avoid(FAR struct tcp_conn_s *conn, uint32_t acked)
+{
+  FAR struct tcp_cubic_s *cubic = &conn->cc_priv.cubic;
+  uint32_t target;
+  uint32_t now;
+  int64_t t;
+
+  if (conn->cwnd < conn->ssthresh)
+    {
+      tcp_cc_slow_start(conn, acked);
+      return;
+    }
+
+  now = tcp_cc_now();
+  if (cubic->epoch == 0)
+    {
+      /* Start a new epoch of congestion avoidance */
+
+      cubic->epoch = now | 1;
+      cubic->west  = conn->cwnd;
+
+      if (conn->cwnd < cubic->wmax)
+        {
+          cubic->k      = cubic_cbrt((uint64_t)(cubic->wmax - conn->cwnd) *
+                                     CUBIC_K_SCALE / conn->mss);
+          cubic->origin = cubic->wmax;
+        }
+      else
+        {
+          cubic->k      = 0;
+          cubic->origin = conn->cwnd;
+        }
+    }
+
+  /* Aim at the window of one RTT ahead, but grow by at most half of the
+   * window per RTT.
+   */
+
+  t      = (uint32_t)(now - cubic->epoch + cubic->minrtt) / USEC_PER_MSEC;
+  target = cubic_window(conn, t);
+  target = MIN(target, conn->cwnd + conn->cwnd / 2);
+
+  /* The window Reno would have reached since the epoch started, grown
+   * per ACK relative to the current window (RFC 9438 section 4.3).
+   */
+
+  cubic->west += (uint64_t)acked * conn->mss * CUBIC_ALPHA / 1024 /
+                 conn->cwnd;
+
+  if (target < cubic->west)
+    {
+      /* Reno-friendly region */
+
+      conn->cwnd = MAX(conn->cwnd, cubic->west);
+    }
+  else if (target > conn->cwnd)
+    {
+      /* Concave or convex region: (target - cwnd) / cwnd per acked MSS */
+
+      conn->cwnd += MAX((uint64_t)(target - conn->cwnd) * acked /
+                        conn->cwnd, 1);
+    }
+
+  conn->cwnd = MIN(conn->cwnd, conn->max_cwnd);
+  ninfo("update cubic cwnd to %" PRIu32 " target %" PRIu32 "\n",
+        conn->cwnd, target);
+}
+
+/****************************************************************************
+ * Name: cubic_acked
+ ****************************************************************************/
+
+static void cubic_acked(FAR struct tcp_conn_s *conn, uint32_t acked,
+                        uint32_t rtt)
+{
+  FAR struct tcp_cubic_s *cubic = &conn->cc_priv.cubic;
+
+  if (rtt > 0 && (cubic->minrtt == 0 || rtt < cubic->minrtt))
+    {
+      cubic->minrtt = rtt;
+    }
+}
@@ -66,6 +66,7 @@
 
 #include "devif/devif.h"
 #include "inet/inet.h"
+#include "socket/socket.h"
 #include "tcp/tcp.h"
 #include "arp/arp.h"
 #include "icmpv6/icmpv6.h"
@@ -81,6 +82,19 @@
 #  define CONFIG_NET_TCP_MAX_CONNS 0
 #endif
 
+#if defined(CONFIG_NET_TCP_HASH) && \
+    (CONFIG_NET_TCP_HASH_SIZE & (CONFIG_NET_TCP_HASH_SIZE - 1)) != 0
+#  error CONFIG_NET_TCP_HASH_SIZE must be a power of two
+#endif
+
+/* The socket options of a connection, none without socket option support */
+
+#ifdef CONFIG_NET_SOCKOPTS
+#  define TCP_SOCKOPTS(conn) ((conn)->sconn.s_options)
+#else
+#  define TCP_SOCKOPTS(conn) 0
+#endif
+
 /****************************************************************************
  * Private Data
  ****************************************************************************/
@@ -95,10 +109,158 @@ NET_BUFPOOL_DECLARE(g_tcp_connections, sizeof(struct tcp_conn_s),
 
 static dq_queue_t g_active_tcp_connections;
 
+#ifdef CONFIG_NET_TCP_HASH
+/* The active connections hashed by local port, remote port and remote
+ * address, and by local port only.
+ */
+
+static FAR struct tcp_conn_s *g_tcp_ehash[CONFIG_NET_TCP_HASH_SIZE];
+static FAR struct tcp_conn_s *g_tcp_phash[CONFIG_NET_TCP_HASH_SIZE];
+#endif
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
 
+#ifdef CONFIG_NET_TCP_HASH
+
+/****************************************************************************
+ * Name: tcp_hashfn
+ *
+ * Description:
+ *   Hash the ports and the remote address of a connection.  IPv6 addresses
+ *   are folded to 32 bits first.  The local address is not part of the key
+ *   because it may still be assigned after the connection became active.
+ *
+ ****************************************************************************/
+
+static inline unsigned int tcp_hashfn(uint16_t lport, uint16_t rport,
+                                      uint32_t raddr)
+{
+  uint32_t hash = (raddr ^ ((uint32_t)lport << 16 | rport)) * 0x9e3779b1u;
+
+  return (hash ^ (hash >> 16)) & TCP_HASH_MASK;
+}
+
+#ifdef CONFIG_NET_IPv6
+static inline uint32_t tcp_ipv6_fold(FAR const uint16_t *addr)
+{
+  return ((uint32_t)(addr[0] ^ addr[2] ^ addr[4] ^ addr[6]) << 16) ^
+         (addr[1] ^ addr[3] ^ addr[5] ^ addr[7]);
+}
+#endif
+
+/****************************************************************************
+ * Name: tcp_connhash
+ *
+ * Description:
+ *   Return the 4-tuple hash bucket of an active connection.
+ *
+ ****************************************************************************/
+
+static unsigned int tcp_connhash(FAR struct tcp_conn_s *conn)
+{
+#ifdef CONFIG_NET_IPv4
+#ifdef CONFIG_NET_IPv6
+  if (conn->domain == PF_INET)
+#endif
+    {
+      return tcp_hashfn(conn->lport, conn->rport, conn->u.ipv4.raddr);
+    }
+#endif /* CONFIG_NET_IPv4 */
+
+#ifdef CONFIG_NET_IPv6
+#ifdef CONFIG_NET_IPv4
+  else
+#endif
+    {
+      return tcp_hashfn(conn->lport, conn->rport,
+                        tcp_ipv6_fold(conn->u.ipv6.raddr));
+    }
+#endif /* CONFIG_NET_IPv6 */
+}
+
+/****************************************************************************
+ * Name: tcp_hash_insert
+ *
+ * Description:
+ *   Add a connection that is about to be put into the active list to the
+ *   4-tuple and the local port hash tables.
+ *
+ * Assumptions:
+ *   This function is called with the network locked.
+ *
+ ****************************************************************************/
+
+static void tcp_hash_insert(FAR struct tcp_conn_s *conn)
+{
+  FAR struct tcp_conn_s **bucket;
+
+  bucket      = &g_tcp_ehash[tcp_connhash(conn)];
+  conn->ehash = *bucket;
+  *bucket     = conn;
+
+  bucket      = &g_tcp_phash[tcp_porthash(conn->lport)];
+  conn->phash = *bucket;
+  *bucket     = conn;
+}
+
+/****************************************************************************
+ * Name: tcp_hash_remove
+ *
+ * Description:
+ *   Remove a connection that leaves the active list from the hash tables.
+ *
+ * Assumptions:
+ *   This function is called with the network locked.
+ *
+ ****************************************************************************/
+
+static void tcp_hash_remove(FAR struct tcp_conn_s *conn)
+{
+  FAR struct tcp_conn_s **curr;
+
+  for (curr = &g_tcp_ehash[tcp_connhash(conn)]; *curr != NULL;
+       curr = &(*curr)->ehash)
+    {
+      if (*curr == conn)
+        {
+          *curr = conn->ehash;
+          break;
+        }
+    }
+
+  for (curr = &g_tcp_phash[tcp_porthash(conn->lport)]; *curr != NULL;
+       curr = &(*curr)->phash)
+    {
+      if (*curr == conn)
+        {
+          *curr = conn->phash;
+          break;
+        }
+    }
+}
+
+/****************************************************************************
+ * Name: tcp_portconn
+ *
+ * Description:
+ *   Return the active connection after 'conn' (or the first one if 'conn'
+ *   is NULL) that may be bound to the local port 'portno'.
+ *
+ ****************************************************************************/
+
+static inline FAR struct tcp_conn_s *
+  tcp_portconn(FAR struct tcp_conn_s *conn, uint16_t portno)
+{
+  return conn == NULL ? g_tcp_phash[tcp_porthash(portno)] : conn->phash;
+}
+#else
+#  define tcp_hash_insert(conn)
+#  define tcp_hash_remove(conn)
+#  define tcp_portconn(conn, portno) tcp_nextconn(conn)
+#endif /* CONFIG_NET_TCP_HASH */
+
 /****************************************************************************
  * Name: tcp_listener
  *
@@ -108,18 +270,23 @@ static dq_queue_t g_active_tcp_connections;
  *
  *   Primary uses: (1) to determine if a port number is available, (2) to
  *   To identify the socket that will accept new connections on a local port.
+ *   'opt' holds the options of the connection asking; connections that
+ *   share SO_REUSEPORT with it are not reported.
  *
  ****************************************************************************/
 
 static FAR struct tcp_conn_s *
   tcp_listener(uint8_t domain, FAR const union ip_addr_u *ipaddr,
-               uint16_t portno)
+               uint16_t portno, sockopt_t opt)
 {
   FAR struct tcp_conn_s *conn = NULL;
+#ifdef CONFIG_NET_REUSEPORT
+  bool skip_reuseport = _SO_GETOPT(opt, SO_REUSEPORT);
+#endif
 
   /* Check if this port number is in use by any active UIP TCP connection */
 
-  while ((conn = tcp_nextconn(conn)) != NULL)
+  while ((conn = tcp_portconn(conn, portno)) != NULL)
     {
       /* Check if this connection is open and the local port assignment
        * matches the requested port number.
@@ -131,6 +298,16 @@ static FAR struct tcp_conn_s *
 #endif
          )
         {
+          /* Connections that all set SO_REUSEPORT may share the port */
+
+#ifdef CONFIG_NET_REUSEPORT
+          if (skip_reuseport &&
+              _SO_GETOPT(conn->sconn.s_options, SO_REUSEPORT))
+            {
+              continue;
+            }
+#endif
+
           /* If there are multiple interface devices, then the local IP
            * address of the connection must also match.  INADDR_ANY is a
            * special case:  There can only be instance of a port number
@@ -193,9 +370,14 @@ static inline FAR struct tcp_conn_s *
   in_addr_t srcipaddr;
   in_addr_t destipaddr;
 
-  conn       = (FAR struct tcp_conn_s *)g_active_tcp_connections.head;
   srcipaddr  = net_ip4addr_conv32(ip->srcipaddr);
   destipaddr = net_ip4addr_conv32(ip->destipaddr);
+#ifdef CONFIG_NET_TCP_HASH
+  conn       = g_tcp_ehash[tcp_hashfn(tcp->destport, tcp->srcport,
+                                      srcipaddr)];
+#else
+  conn       = (FAR struct tcp_conn_s *)g_active_tcp_connections.head;
+#endif
 
   while (conn)
     {
@@ -232,7 +414,11 @@ static inline FAR struct tcp_conn_s *
 
       /* Look at the next active connection */
 
+#ifdef CONFIG_NET_TCP_HASH
+      conn = conn->ehash;
+#else
       conn = (FAR struct tcp_conn_s *)conn->sconn.node.flink;
+#endif
     }
 
   return conn;
@@ -260,9 +446,14 @@ static inline FAR struct tcp_conn_s *
   net_ipv6addr_t *srcipaddr;
   net_ipv6addr_t *destipaddr;
 
-  conn       = (FAR struct tcp_conn_s *)g_active_tcp_connections.head;
   srcipaddr  = (net_ipv6addr_t *)ip->srcipaddr;
   destipaddr = (net_ipv6addr_t *)ip->destipaddr;
+#ifdef CONFIG_NET_TCP_HASH
+  conn       = g_tcp_ehash[tcp_hashfn(tcp->destport, tcp->srcport,
+                                      tcp_ipv6_fold(*srcipaddr))];
+#else
+  conn       = (FAR struct tcp_conn_s *)g_active_tcp_connections.head;
+#endif
 
   while (conn)
     {
@@ -299,7 +490,11 @@ static inline FAR struct tcp_conn_s *
 
       /* Look at the next active connection */
 
+#ifdef CONFIG_NET_TCP_HASH
+      conn = conn->ehash;
+#else
       conn = (FAR struct tcp_conn_s *)conn->sconn.node.flink;
+#endif
     }
 
   return conn;
@@ -366,7 +561,7 @@ static inline int tcp_ipv4_bind(FAR struct tcp_conn_s *conn,
 
   port = tcp_selectport(PF_INET,
                        (FAR const union ip_addr_u *)&addr->sin_addr.s_addr,
-                       addr->sin_port);
+                       addr->sin_port, TCP_SOCKOPTS(conn));
   if (port < 0)
     {
       nerr("ERROR: tcp_selectport failed: %d\n", port);
@@ -466,7 +661,7 @@ static inline int tcp_ipv6_bind(FAR struct tcp_conn_s *conn,
 
   port = tcp_selectport(PF_INET6,
                 (FAR const union ip_addr_u *)addr->sin6_addr.in6_u.u6_addr16,
-                addr->sin6_port);
+                addr->sin6_port, TCP_SOCKOPTS(conn));
   if (port < 0)
     {
       nerr("ERROR: tcp_selectport failed: %d\n", port);
@@ -516,6 +711,8 @@ static inline int tcp_ipv6_bind(FAR struct tcp_conn_s *conn,
  * Input Parameters:
  *   portno -- the selected port number in network order. Zero means no port
  *     selected.
+ *   opt -- the socket options of the connection being bound, SO_REUSEPORT
+ *     lets it share the port with other SO_REUSEPORT connections.
  *
  * Returned Value:
  *   Selected or verified port number in network order on success, a negated
@@ -533,7 +730,7 @@ static inline int tcp_ipv6_bind(FAR struct tcp_conn_s *conn,
 
 int tcp_selectport(uint8_t domain,
                    FAR const union ip_addr_u *ipaddr,
-                   uint16_t portno)
+                   uint16_t portno, sockopt_t opt)
 {
   static uint16_t g_last_tcp_port;
 
@@ -566,7 +763,7 @@ int tcp_selectport(uint8_t domain,
               return -EADDRINUSE;
             }
         }
-      while (tcp_listener(domain, ipaddr, portno)
+      while (tcp_listener(domain, ipaddr, portno, 0)
 #ifdef CONFIG_NET_NAT
              || nat_port_inuse(domain, IP_PROTO_TCP, ipaddr, portno)
 #endif
@@ -578,7 +775,7 @@ int tcp_selectport(uint8_t domain,
        * connection is using this local port.
        */
 
-      if (tcp_listener(domain, ipaddr, portno)
+      if (tcp_listener(domain, ipaddr, portno, opt)
 #ifdef CONFIG_NET_NAT
           || nat_port_inuse(domain, IP_PROTO_TCP, ipaddr, portno)
 #endif
@@ -727,6 +924,9 @@ FAR struct tcp_conn_s *tcp_alloc(uint8_t domain)
       conn->keepintvl     = 2 * DSEC_PER_SEC;
       conn->keepcnt       = 3;
 #endif
+#ifdef CONFIG_NET_TCP_CC_NEWRENO
+      conn->cc_ops        = TCP_CC_DEFAULT;
+#endif
 #if CONFIG_NET_RECV_BUFSIZE > 0
       conn->rcv_bufs      = CONFIG_NET_RECV_BUFSIZE;
 #endif
@@ -772,11 +972,29 @@ FAR struct tcp_conn_s *tcp_alloc(uint8_t domain)
 
 void tcp_free_rx_buffers(FAR struct tcp_conn_s *conn)
 {
+#ifdef CONFIG_NET_ZEROCOPY_RECV
+  FAR struct iob_s **loan;
+#endif
+
   /* Release any read-ahead buffers attached to the connection */
 
   iob_free_chain(conn->readahead);
   conn->readahead = NULL;
 
+#ifdef CONFIG_NET_ZEROCOPY_RECV
+  /* Buffers still lent to the user are gone with the connection */
+
+  for (loan = conn->zcloans;
+       loan < &conn->zcloans[CONFIG_NET_ZEROCOPY_RXLOANS]; loan++)
+    {
+      if (*loan != NULL)
+        {
+          iob_free(*loan);
+          *loan = NULL;
+        }
+    }
+#endif
+
 #ifdef CONFIG_NET_TCP_OUT_OF_ORDER
   /* Release any out-of-order buffers */
 
@@ -858,6 +1076,7 @@ void tcp_free(FAR struct tcp_conn_s *conn)
       /* Remove the connection from the active list */
 
       dq_rem(&conn->sconn.node, &g_active_tcp_connections);
+      tcp_hash_remove(conn);
     }
 
   tcp_free_rx_buffers(conn);
@@ -885,6 +1104,12 @@ void tcp_free(FAR struct tcp_conn_s *conn)
 
 #endif
 
+#ifdef CONFIG_NET_ZEROCOPY
+  /* Nobody is left to collect MSG_ZEROCOPY completions */
+
+  zerocopy_conn_release(&conn->sconn);
+#endif
+
 #ifdef CONFIG_NET_TCPBACKLOG
   /* Remove any backlog attached to this connection */
 
@@ -1090,6 +1315,9 @@ FAR struct tcp_conn_s *tcp_alloc_accept(FAR struct net_driver_s *dev,
 #ifdef CONFIG_NET_SOCKOPTS
       conn->sconn.s_rcvtimeo = listener->sconn.s_rcvtimeo;
       conn->sconn.s_sndtimeo = listener->sconn.s_sndtimeo;
+#  ifdef CONFIG_NET_REUSEPORT
+      conn->sconn.s_options |= listener->sconn.s_options & _SO_REUSEPORT;
+#  endif
 #  ifdef CONFIG_NET_BINDTODEVICE
       conn->sconn.s_boundto  = listener->sconn.s_boundto;
 #  endif
@@ -1104,6 +1332,12 @@ FAR struct tcp_conn_s *tcp_alloc_accept(FAR struct net_driver_s *dev,
       conn->snd_bufs         = listener->snd_bufs;
 #endif
       conn->mss              = listener->mss;
+#ifdef CONFIG_NET_REUSEPORT
+      conn->listener         = listener;
+#endif
+#ifdef CONFIG_NET_TCP_CC_NEWRENO
+      conn->cc_ops           = listener->cc_ops;
+#endif
 
       /* Fill in the necessary fields for the new connection. */
 
@@ -1155,6 +1389,7 @@ FAR struct tcp_conn_s *tcp_alloc_accept(FAR struct net_driver_s *dev,
        */
 
       dq_addlast(&conn->sconn.node, &g_active_tcp_connections);
+      tcp_hash_insert(conn);
       tcp_update_retrantimer(conn, TCP_RTO);
     }
 
@@ -1271,7 +1506,7 @@ int tcp_connect(FAR struct tcp_conn_s *conn, FAR const struct sockaddr *addr)
 
           port = tcp_selectport(PF_INET,
                                 (FAR const union ip_addr_u *)
-                                &conn->u.ipv4.laddr, 0);
+                                &conn->u.ipv4.laddr, 0, 0);
         }
 #endif /* CONFIG_NET_IPv4 */
 
@@ -1286,7 +1521,7 @@ int tcp_connect(FAR struct tcp_conn_s *conn, FAR const struct sockaddr *addr)
 
           port = tcp_selectport(PF_INET6,
                                 (FAR const union ip_addr_u *)
-                                conn->u.ipv6.laddr, 0);
+                                conn->u.ipv6.laddr, 0, 0);
         }
 #endif /* CONFIG_NET_IPv6 */
 
@@ -1466,6 +1701,7 @@ int tcp_connect(FAR struct tcp_conn_s *conn, FAR const struct sockaddr *addr)
   /* And, finally, put the connection structure into the active list. */
 
   dq_addlast(&conn->sconn.node, &g_active_tcp_connections);
+  tcp_hash_insert(conn);
   ret = OK;
 
 errout_with_lock:
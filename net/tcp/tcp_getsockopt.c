@@ -27,7 +27,9 @@
 #include <nuttx/config.h>
 
 #include <sys/time.h>
+#include <sys/param.h>
 #include <stdint.h>
+#include <string.h>
 #include <errno.h>
 #include <assert.h>
 #include <debug.h>
@@ -239,6 +241,37 @@ int tcp_getsockopt(FAR struct socket *psock, int option,
           }
         break;
 
+#ifdef CONFIG_NET_TCP_CC_NEWRENO
+      case TCP_CONGESTION: /* Congestion control algorithm */
+        if (*value_len == 0)
+          {
+            ret          = -EINVAL;
+          }
+        else
+          {
+            *value_len   = MIN(*value_len, TCP_CA_NAME_MAX);
+            strlcpy(value, conn->cc_ops->name, *value_len);
+            ret          = OK;
+          }
+        break;
+#endif
+
+#ifdef CONFIG_NET_TCP_INFO
+      case TCP_INFO: /* Statistics of the connection */
+        {
+          struct tcp_info info;
+
+          net_lock();
+          tcp_getinfo(conn, &info);
+          net_unlock();
+
+          *value_len = MIN(*value_len, sizeof(struct tcp_info));
+          memcpy(value, &info, *value_len);
+          ret = OK;
+        }
+        break;
+#endif
+
       default:
         nerr("ERROR: Unrecognized TCP option: %d\n", option);
         ret = -ENOPROTOOPT;
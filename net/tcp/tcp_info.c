@@ -0,0 +1,364 @@
+/****************************************************************************
+ * net/tcp/tcp_info.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/param.h>
+#include <netinet/tcp.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <nuttx/clock.h>
+#include <nuttx/net/net.h>
+#include <nuttx/net/tcp.h>
+
+#include "tcp/tcp.h"
+
+#ifdef CONFIG_NET_TCP_INFO
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/* The states of tcpstateflags in the Linux numbering of tcpi_state */
+
+static const uint8_t g_tcp_info_state[] =
+{
+  7,  /* TCP_CLOSED:      TCP_CLOSE */
+  7,  /* TCP_ALLOCATED:   TCP_CLOSE, TCP_LISTEN if listening */
+  3,  /* TCP_SYN_RCVD:    TCP_SYN_RECV */
+  2,  /* TCP_SYN_SENT:    TCP_SYN_SENT */
+  1,  /* TCP_ESTABLISHED: TCP_ESTABLISHED */
+  4,  /* TCP_FIN_WAIT_1:  TCP_FIN_WAIT1 */
+  5,  /* TCP_FIN_WAIT_2:  TCP_FIN_WAIT2 */
+  11, /* TCP_CLOSING:     TCP_CLOSING */
+  6,  /* TCP_TIME_WAIT:   TCP_TIME_WAIT */
+  9,  /* TCP_LAST_ACK:    TCP_LAST_ACK */
+};
+
+#define TCP_INFO_LISTEN 10
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: tcp_info_since
+ *
+ * Description:
+ *   Return the milliseconds elapsed since a time stamp, 0 if the event
+ *   never happened.
+ *
+ ****************************************************************************/
+
+static uint32_t tcp_info_since(clock_t stamp)
+{
+  if (stamp == 0)
+    {
+      return 0;
+    }
+
+  return TICK2MSEC(clock_systime_ticks() - stamp);
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: tcp_stats_rtt
+ *
+ * Description:
+ *   Feed an RTT sample into the smoothed RTT reported by TCP_INFO.  The
+ *   retransmission timer keeps its own, coarser estimate in conn->sa.
+ *
+ * Input Parameters:
+ *   conn   - The TCP connection of interest
+ *   rtt    - The RTT sample (units: microseconds)
+ *
+ * Returned Value:
+ *   None
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+void tcp_stats_rtt(FAR struct tcp_conn_s *conn, uint32_t rtt)
+{
+  FAR struct tcp_stats_s *stats = &conn->stats;
+  int32_t m;
+
+  /* Keep the scaled values clear of overflow */
+
+  rtt = MIN(MAX(rtt, 1), UINT32_MAX >> 4);
+
+  if (stats->min_rtt == 0 || rtt < stats->min_rtt)
+    {
+      stats->min_rtt = rtt;
+    }
+
+  /* The first sample initializes the estimate (RFC 6298, section 2.2) */
+
+  if (stats->srtt == 0)
+    {
+      stats->srtt   = rtt << 3;
+      stats->rttvar = rtt << 1;
+      return;
+    }
+
+  /* Same arithmetic as tcp_update_rtt(), in microseconds */
+
+  m = rtt - (stats->srtt >> 3);
+  stats->srtt += m;
+  if (m < 0)
+    {
+      m = -m;
+    }
+
+  m -= stats->rttvar >> 2;
+  stats->rttvar += m;
+}
+
+/****************************************************************************
+ * Name: tcp_stats_send
+ *
+ * Description:
+ *   Account an outgoing segment.  A segment whose payload ends at or below
+ *   the highest sequence number sent so far is counted as retransmitted.
+ *
+ * Input Parameters:
+ *   conn    - The TCP connection of interest
+ *   seq     - The sequence number of the segment
+ *   datalen - The length of the payload
+ *
+ * Returned Value:
+ *   None
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+void tcp_stats_send(FAR struct tcp_conn_s *conn, uint32_t seq,
+                    uint32_t datalen)
+{
+  FAR struct tcp_stats_s *stats = &conn->stats;
+  uint32_t end;
+
+  stats->segs_out++;
+  if (datalen == 0)
+    {
+      return;
+    }
+
+  end = TCP_SEQ_ADD(seq, datalen);
+  if (stats->data_segs_out > 0 && TCP_SEQ_LTE(end, stats->snd_max))
+    {
+      stats->total_retrans++;
+      stats->bytes_retrans += datalen;
+    }
+  else
+    {
+      stats->snd_max = end;
+    }
+
+  stats->data_segs_out++;
+  stats->bytes_sent    += datalen;
+  stats->last_data_sent = clock_systime_ticks();
+}
+
+/****************************************************************************
+ * Name: tcp_stats_lock
+ *
+ * Description:
+ *   Take the network lock on behalf of a socket call of the connection and
+ *   account the time spent waiting for it.
+ *
+ * Input Parameters:
+ *   conn   - The TCP connection of interest, may be NULL
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+void tcp_stats_lock(FAR struct tcp_conn_s *conn)
+{
+  clock_t start = perf_gettime();
+
+  net_lock();
+
+  /* The statistics are only touched with the lock held */
+
+  if (conn != NULL)
+    {
+      conn->stats.lock_wait += (clock_t)(perf_gettime() - start);
+      conn->stats.lock_waits++;
+    }
+}
+
+/****************************************************************************
+ * Name: tcp_getinfo
+ *
+ * Description:
+ *   Fill in the TCP_INFO statistics of a connection.
+ *
+ * Input Parameters:
+ *   conn   - The TCP connection of interest
+ *   info   - The location to return the statistics
+ *
+ * Returned Value:
+ *   None
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+void tcp_getinfo(FAR struct tcp_conn_s *conn, FAR struct tcp_info *info)
+{
+  FAR struct tcp_stats_s *stats = &conn->stats;
+  FAR struct tcp_conn_s *listener;
+  uint8_t state = conn->tcpstateflags & TCP_STATE_MASK;
+#ifdef CONFIG_NET_TCP_WRITE_BUFFERS
+  FAR sq_entry_t *entry;
+#endif
+  unsigned long freq;
+
+  memset(info, 0, sizeof(*info));
+
+  if (state < nitems(g_tcp_info_state))
+    {
+      info->tcpi_state = g_tcp_info_state[state];
+    }
+
+  if (state == TCP_ALLOCATED)
+    {
+#if defined(CONFIG_NET_IPv4) && defined(CONFIG_NET_IPv6)
+      listener = tcp_findlistener(&conn->u, conn->lport, conn->domain);
+#else
+      listener = tcp_findlistener(&conn->u, conn->lport);
+#endif
+      if (listener == conn)
+        {
+          info->tcpi_state = TCP_INFO_LISTEN;
+        }
+    }
+
+  info->tcpi_retransmits = conn->nrtx;
+
+  if ((conn->flags & TCP_TSTAMP) != 0)
+    {
+      info->tcpi_options |= TCPI_OPT_TIMESTAMPS;
+    }
+
+  if ((conn->flags & TCP_SACK) != 0)
+    {
+      info->tcpi_options |= TCPI_OPT_SACK;
+    }
+
+#ifdef CONFIG_NET_TCP_WINDOW_SCALE
+  if ((conn->flags & TCP_WSCALE) != 0)
+    {
+      info->tcpi_options   |= TCPI_OPT_WSCALE;
+      info->tcpi_snd_wscale = conn->snd_scale;
+      info->tcpi_rcv_wscale = conn->rcv_scale;
+    }
+#endif
+
+  info->tcpi_rto      = conn->rto * USEC_PER_HSEC;
+  info->tcpi_snd_mss  = conn->mss;
+  info->tcpi_unacked  = conn->tx_unacked;
+
+  info->tcpi_last_data_sent = tcp_info_since(stats->last_data_sent);
+  info->tcpi_last_data_recv = tcp_info_since(stats->last_data_recv);
+  info->tcpi_last_ack_recv  = tcp_info_since(stats->last_ack_recv);
+
+  /* Without a fine grained sample fall back to the estimate of the
+   * retransmission timer, which counts in half-seconds.
+   */
+
+  if (stats->srtt != 0)
+    {
+      info->tcpi_rtt    = stats->srtt >> 3;
+      info->tcpi_rttvar = stats->rttvar >> 2;
+    }
+  else
+    {
+      info->tcpi_rtt    = (conn->sa >> 3) * USEC_PER_HSEC;
+      info->tcpi_rttvar = (conn->sv >> 2) * USEC_PER_HSEC;
+    }
+
+#ifdef CONFIG_NET_TCP_CC_NEWRENO
+  if (conn->mss > 0)
+    {
+      info->tcpi_snd_ssthresh = conn->ssthresh / conn->mss;
+      info->tcpi_snd_cwnd     = conn->cwnd / conn->mss;
+    }
+#endif
+
+  info->tcpi_rcv_space = TCP_SEQ_SUB(conn->rcv_adv,
+                                     tcp_getsequence(conn->rcvseq));
+  info->tcpi_total_retrans = stats->total_retrans;
+
+#ifdef CONFIG_NET_TCP_PACING
+  info->tcpi_pacing_rate     = conn->pacing_rate;
+  info->tcpi_max_pacing_rate = UINT64_MAX;
+#endif
+
+  info->tcpi_bytes_acked    = stats->bytes_acked;
+  info->tcpi_bytes_received = stats->bytes_received;
+  info->tcpi_segs_out       = stats->segs_out;
+  info->tcpi_segs_in        = stats->segs_in;
+
+#ifdef CONFIG_NET_TCP_WRITE_BUFFERS
+  for (entry = sq_peek(&conn->write_q); entry != NULL;
+       entry = sq_next(entry))
+    {
+      FAR struct tcp_wrbuffer_s *wrb = (FAR struct tcp_wrbuffer_s *)entry;
+
+      info->tcpi_notsent_bytes += TCP_WBPKTLEN(wrb) - TCP_WBSENT(wrb);
+    }
+#endif
+
+  info->tcpi_min_rtt        = stats->min_rtt;
+  info->tcpi_data_segs_in   = stats->data_segs_in;
+  info->tcpi_data_segs_out  = stats->data_segs_out;
+  info->tcpi_bytes_sent     = stats->bytes_sent;
+  info->tcpi_bytes_retrans  = stats->bytes_retrans;
+  info->tcpi_snd_wnd        = conn->snd_wnd;
+
+  freq = perf_getfreq();
+  if (freq > 0)
+    {
+      info->tcpi_lock_wait  = stats->lock_wait * USEC_PER_SEC / freq;
+    }
+
+  info->tcpi_lock_waits     = stats->lock_waits;
+}
+
+#endif /* CONFIG_NET_TCP_INFO */
@@ -60,6 +60,7 @@
 #include <nuttx/net/netstats.h>
 #include <nuttx/net/ip.h>
 #include <nuttx/net/tcp.h>
+#include <nuttx/trace.h>
 
 #include "devif/devif.h"
 #include "utils/utils.h"
@@ -615,6 +616,15 @@ static void tcp_parse_option(FAR struct net_driver_s *dev,
         {
           conn->flags    |= TCP_SACK;
         }
+#endif
+#ifdef CONFIG_NET_TCP_TIMESTAMPS
+      else if (opt == TCP_OPT_TS &&
+               IPDATA(tcpiplen + 1 + i) == TCP_OPT_TS_LEN)
+        {
+          conn->ts_recent     = tcp_getsequence(IPBUF(tcpiplen + 2 + i));
+          conn->ts_recent_age = TCP_TS_NOW();
+          conn->flags        |= TCP_TSTAMP;
+        }
 #endif
       else
         {
@@ -634,6 +644,109 @@ static void tcp_parse_option(FAR struct net_driver_s *dev,
 
       i += IPDATA(tcpiplen + 1 + i);
     }
+
+#ifdef CONFIG_NET_TCP_TIMESTAMPS
+  /* The timestamps option takes room from the payload of every segment */
+
+  if ((conn->flags & TCP_TSTAMP) != 0)
+    {
+      conn->mss -= TCP_TSOPT_SIZE;
+    }
+#endif
+}
+
+/****************************************************************************
+ * Name: tcp_get_timestamp
+ *
+ * Description:
+ *   Find the timestamps option of an incoming segment.  The option is
+ *   expected first, aligned by two NOOP (RFC 7323, Appendix A), but any
+ *   position is accepted.
+ *
+ * Input Parameters:
+ *   tcp    - Header of TCP structure
+ *   tsval  - Location to return the timestamp of the peer
+ *   tsecr  - Location to return the timestamp echoed by the peer
+ *
+ * Returned Value:
+ *   True if the segment carries the timestamps option.
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_TCP_TIMESTAMPS
+static bool tcp_get_timestamp(FAR struct tcp_hdr_s *tcp,
+                              FAR uint32_t *tsval, FAR uint32_t *tsecr)
+{
+  int optlen = ((tcp->tcpoffset >> 4) - 5) << 2;
+  uint8_t opt;
+  int i;
+
+  for (i = 0; i < optlen; )
+    {
+      opt = tcp->optdata[i];
+      if (opt == TCP_OPT_END)
+        {
+          break;
+        }
+      else if (opt == TCP_OPT_NOOP)
+        {
+          ++i;
+          continue;
+        }
+      else if (i + 1 >= optlen || tcp->optdata[i + 1] == 0)
+        {
+          /* Malformed options */
+
+          break;
+        }
+      else if (opt == TCP_OPT_TS && tcp->optdata[i + 1] == TCP_OPT_TS_LEN &&
+               i + TCP_OPT_TS_LEN <= optlen)
+        {
+          *tsval = tcp_getsequence(&tcp->optdata[i + 2]);
+          *tsecr = tcp_getsequence(&tcp->optdata[i + 6]);
+          return true;
+        }
+
+      i += tcp->optdata[i + 1];
+    }
+
+  return false;
+}
+#endif
+
+/****************************************************************************
+ * Name: tcp_update_rtt
+ *
+ * Description:
+ *   Update the RTT estimation and the retransmission time-out with a new
+ *   RTT sample.
+ *
+ * Input Parameters:
+ *   conn   - The TCP connection of interest
+ *   m      - The RTT sample (units: half-seconds)
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+static void tcp_update_rtt(FAR struct tcp_conn_s *conn, signed char m)
+{
+  /* This is taken directly from VJs original code in his paper */
+
+  m = m - (conn->sa >> 3);
+  conn->sa += m;
+  if (m < 0)
+    {
+      m = -m;
+    }
+
+  m = m - (conn->sv >> 2);
+  conn->sv += m;
+  conn->rto = (conn->sa >> 3) + conn->sv;
 }
 
 /****************************************************************************
@@ -695,11 +808,15 @@ static void tcp_input(FAR struct net_driver_s *dev, uint8_t domain,
   FAR struct tcp_conn_s *conn = NULL;
   FAR struct tcp_hdr_s *tcp;
   union ip_binding_u uaddr;
-  unsigned int tcpiplen;
   uint16_t tmp16;
   uint16_t flags;
   uint16_t result;
   int      len;
+#ifdef CONFIG_NET_TCP_TIMESTAMPS
+  uint32_t tsval;
+  uint32_t tsecr;
+  bool     hasts = false;
+#endif
 
 #ifdef CONFIG_NET_STATISTICS
   /* Bump up the count of TCP packets received */
@@ -713,16 +830,6 @@ static void tcp_input(FAR struct net_driver_s *dev, uint8_t domain,
 
   tcp = IPBUF(iplen);
 
-  /* Get the size of the IP header and the TCP header.
-   *
-   * REVISIT:  TCP header is *not* a constant!  It can be larger if the
-   * TCP header includes options.  The constant TCP_HDRLEN should be
-   * replaced with the macro TCP_OPT_HDRLEN(n) which will calculate the
-   * correct header length in all cases.
-   */
-
-  tcpiplen = iplen + TCP_HDRLEN;
-
 #ifdef CONFIG_NET_TCP_CHECKSUMS
   /* Start of TCP input header processing code. */
 
@@ -739,6 +846,13 @@ static void tcp_input(FAR struct net_driver_s *dev, uint8_t domain,
     }
 #endif
 
+  net_trace_printf("tcp rx %u>%u seq=%" PRIu32 " ack=%" PRIu32
+                   " flags=%02x len=%u\n",
+                   NTOHS(tcp->srcport), NTOHS(tcp->destport),
+                   tcp_getsequence(tcp->seqno), tcp_getsequence(tcp->ackno),
+                   tcp->flags,
+                   dev->d_len - iplen - ((tcp->tcpoffset >> 4) << 2));
+
   /* Demultiplex this segment. First check any active connections. */
 
   conn = tcp_active(dev, tcp);
@@ -800,6 +914,17 @@ static void tcp_input(FAR struct net_driver_s *dev, uint8_t domain,
       if ((conn = tcp_findlistener(&uaddr, tmp16)) != NULL)
 #endif
         {
+#ifdef CONFIG_NET_REUSEPORT
+          /* Hand the flow to its owner within a SO_REUSEPORT group */
+
+          conn = tcp_reuseport_select(conn,
+                   net_flowhash(domain,
+                                net_ip_domain_select(domain,
+                                                     IPv4BUF->srcipaddr,
+                                                     IPv6BUF->srcipaddr),
+                                tcp->srcport, tcp->destport));
+#endif
+
           if (!tcp_backlogavailable(conn))
             {
               nerr("ERROR: no free containers for TCP BACKLOG!\n");
@@ -892,6 +1017,7 @@ reset:
 
 found:
   flags = 0;
+  TCP_STATS_INC(conn, segs_in);
 
   /* We do a very naive form of TCP reset processing; we just accept
    * any RST and kill our connection. We should in fact check if the
@@ -914,30 +1040,7 @@ found:
 
           /* Notify the listener for the connection of the reset event */
 
-#ifdef CONFIG_NET_IPv6
-#  ifdef CONFIG_NET_IPv4
-          if (domain == PF_INET6)
-#  endif
-            {
-              net_ipv6addr_copy(&uaddr.ipv6.laddr, IPv6BUF->destipaddr);
-            }
-#endif
-
-#ifdef CONFIG_NET_IPv4
-#  ifdef CONFIG_NET_IPv6
-          if (domain == PF_INET)
-#  endif
-            {
-              net_ipv4addr_copy(uaddr.ipv4.laddr,
-                                net_ip4addr_conv32(IPv4BUF->destipaddr));
-            }
-#endif
-
-#if defined(CONFIG_NET_IPv4) && defined(CONFIG_NET_IPv6)
-          listener = tcp_findlistener(&uaddr, conn->lport, domain);
-#else
-          listener = tcp_findlistener(&uaddr, conn->lport);
-#endif
+          listener = tcp_connlistener(conn);
 
           /* We must free this TCP connection structure; this connection
            * will never be established.  There should only be one reference
@@ -991,6 +1094,14 @@ found:
 
   dev->d_len -= (len + iplen);
 
+#ifdef CONFIG_NET_TCP_INFO
+  if (dev->d_len > 0)
+    {
+      conn->stats.data_segs_in++;
+      conn->stats.last_data_recv = clock_systime_ticks();
+    }
+#endif
+
 #if defined(CONFIG_NET_STATISTICS) && \
     defined(CONFIG_NET_TCP_DEBUG_DROP_RECV)
 
@@ -1022,6 +1133,51 @@ found:
     }
 #endif
 
+#ifdef CONFIG_NET_TCP_TIMESTAMPS
+  if ((conn->flags & TCP_TSTAMP) != 0)
+    {
+      hasts = tcp_get_timestamp(tcp, &tsval, &tsecr);
+    }
+
+  if (hasts)
+    {
+      uint32_t seq = tcp_getsequence(tcp->seqno);
+      uint32_t now = TCP_TS_NOW();
+
+      /* PAWS, RFC 7323 section 5.3: a segment with a timestamp older than
+       * the latest one of the peer is an old duplicate, e.g. from a
+       * previous wrap of the sequence numbers.  Answer it with an ACK and
+       * drop it.  RSTs are exempt, they are checked against the window.
+       */
+
+      if ((tcp->flags & TCP_SYN) == 0 && (tcp->flags & TCP_RST) == 0 &&
+          (int32_t)(tsval - conn->ts_recent) < 0 &&
+          now - conn->ts_recent_age < TCP_PAWS_IDLE)
+        {
+#ifdef CONFIG_NET_STATISTICS
+          g_netstats.tcp.drop++;
+#endif
+          ninfo("TCP PAWS: tsval=%" PRIu32 " ts_recent=%" PRIu32 "\n",
+                tsval, conn->ts_recent);
+
+          tcp_send(dev, conn, TCP_ACK, tcpip_hdrsize(conn));
+          return;
+        }
+
+      /* Echo the timestamp of the segment that our next ACK acknowledges,
+       * so that the peer measures the RTT including the delayed ACK.
+       */
+
+      if (TCP_SEQ_LTE(seq, tcp_getsequence(conn->rcvseq)))
+        {
+          conn->ts_recent     = tsval;
+          conn->ts_recent_age = now;
+        }
+
+      conn->ts_ecr = tsecr;
+    }
+#endif
+
   /* Check if the incoming segment acknowledges any outstanding data. If so,
    * we update the sequence number, reset the length of the outstanding
    * data, calculate RTT estimations, and reset the retransmission timer.
@@ -1068,6 +1224,15 @@ found:
 
       if (TCP_SEQ_LTE(ackseq, unackseq))
         {
+#ifdef CONFIG_NET_TCP_INFO
+          if (conn->tx_unacked > unackseq - ackseq)
+            {
+              conn->stats.bytes_acked += conn->tx_unacked -
+                                         (unackseq - ackseq);
+              conn->stats.last_ack_recv = clock_systime_ticks();
+            }
+#endif
+
           /* Calculate the new number of outstanding, unacknowledged bytes */
 
           conn->tx_unacked = unackseq - ackseq;
@@ -1116,25 +1281,33 @@ found:
         }
 #endif
 
-      /* Do RTT estimation, unless we have done retransmissions. */
+#ifdef CONFIG_NET_TCP_TIMESTAMPS
+      /* The echoed timestamp tells when the acknowledged segment was sent,
+       * also if it was retransmitted, so every ACK gives an exact RTT
+       * sample (RTTM, RFC 7323 section 4).  Round it up to half-seconds.
+       */
 
-      if (conn->nrtx == 0)
+      if (hasts && tsecr != 0)
         {
-          signed char m;
-          m = conn->rto - conn->timer;
-
-          /* This is taken directly from VJs original code in his paper */
+          uint32_t rtt = TCP_TS_NOW() - tsecr;
 
-          m = m - (conn->sa >> 3);
-          conn->sa += m;
-          if (m < 0)
+          if (rtt < INT8_MAX * MSEC_PER_HSEC)
             {
-              m = -m;
+              tcp_update_rtt(conn, (rtt + MSEC_PER_HSEC - 1) /
+                                   MSEC_PER_HSEC);
+#ifdef CONFIG_NET_TCP_INFO
+              tcp_stats_rtt(conn, rtt * USEC_PER_MSEC);
+#endif
             }
+        }
+      else
+#endif
 
-          m = m - (conn->sv >> 2);
-          conn->sv += m;
-          conn->rto = (conn->sa >> 3) + conn->sv;
+      /* Do RTT estimation, unless we have done retransmissions. */
+
+      if (conn->nrtx == 0)
+        {
+          tcp_update_rtt(conn, conn->rto - conn->timer);
         }
 
       /* Set the acknowledged flag. */
@@ -1210,7 +1383,7 @@ found:
                    * E.g. a keep-alive segment.
                    */
 
-                  tcp_send(dev, conn, TCP_ACK, tcpiplen);
+                  tcp_send(dev, conn, TCP_ACK, tcpip_hdrsize(conn));
                   return;
                 }
             }
@@ -1223,7 +1396,7 @@ found:
 #endif
               if ((conn->tcpstateflags & TCP_STATE_MASK) <= TCP_ESTABLISHED)
                 {
-                  tcp_send(dev, conn, TCP_ACK, tcpiplen);
+                  tcp_send(dev, conn, TCP_ACK, tcpip_hdrsize(conn));
                   return;
                 }
             }
@@ -1277,7 +1450,7 @@ found:
 
             /* Wake up any listener waiting for a connection on this port */
 
-            if (tcp_accept_connection(dev, conn, tcp->destport) != OK)
+            if (tcp_accept_connection(dev, conn) != OK)
               {
                 /* No more listener for current port.  We can free conn here
                  * because it has not been shared with upper layers yet as
@@ -1450,7 +1623,7 @@ found:
                 conn->sndseq_max    = tcp_getsequence(conn->sndseq) + 1;
 #endif
                 ninfo("TCP state: TCP_LAST_ACK\n");
-                tcp_send(dev, conn, TCP_FIN | TCP_ACK, tcpiplen);
+                tcp_send(dev, conn, TCP_FIN | TCP_ACK, tcpip_hdrsize(conn));
               }
             else
               {
@@ -1631,7 +1804,7 @@ found:
 
             net_incr32(conn->rcvseq, 1); /* ack FIN */
             tcp_callback(dev, conn, TCP_CLOSE);
-            tcp_send(dev, conn, TCP_ACK, tcpiplen);
+            tcp_send(dev, conn, TCP_ACK, tcpip_hdrsize(conn));
             return;
           }
         else if ((flags & TCP_ACKDATA) != 0 && conn->tx_unacked == 0)
@@ -1678,7 +1851,7 @@ found:
 
             net_incr32(conn->rcvseq, 1); /* ack FIN */
             tcp_callback(dev, conn, TCP_CLOSE);
-            tcp_send(dev, conn, TCP_ACK, tcpiplen);
+            tcp_send(dev, conn, TCP_ACK, tcpip_hdrsize(conn));
             return;
           }
 
@@ -1703,7 +1876,7 @@ found:
         goto drop;
 
       case TCP_TIME_WAIT:
-        tcp_send(dev, conn, TCP_ACK, tcpiplen);
+        tcp_send(dev, conn, TCP_ACK, tcpip_hdrsize(conn));
         return;
 
       case TCP_CLOSING:
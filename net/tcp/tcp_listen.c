@@ -55,7 +55,9 @@
 
 #include "devif/devif.h"
 #include "inet/inet.h"
+#include "socket/socket.h"
 #include "tcp/tcp.h"
+#include "utils/utils.h"
 
 /****************************************************************************
  * Private Data
@@ -65,6 +67,12 @@
 
 static FAR struct tcp_conn_s *tcp_listenports[CONFIG_NET_MAX_LISTENPORTS];
 
+#ifdef CONFIG_NET_TCP_HASH
+/* The listening connections hashed by local port */
+
+static FAR struct tcp_conn_s *g_tcp_lhash[CONFIG_NET_TCP_HASH_SIZE];
+#endif
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
@@ -89,17 +97,29 @@ FAR struct tcp_conn_s *tcp_findlistener(FAR union ip_binding_u *uaddr,
                                         uint16_t portno)
 #endif
 {
+#ifdef CONFIG_NET_TCP_HASH
+  FAR struct tcp_conn_s *conn;
+
+  /* Examine each listener hashed to the same bucket as the port */
+
+  for (conn = g_tcp_lhash[tcp_porthash(portno)]; conn != NULL;
+       conn = conn->lhash)
+#else
   int ndx;
 
   /* Examine each connection structure in each slot of the listener list */
 
   for (ndx = 0; ndx < CONFIG_NET_MAX_LISTENPORTS; ndx++)
+#endif
     {
+#ifndef CONFIG_NET_TCP_HASH
       /* Is this slot assigned?  If so, does the connection have the same
        * local port number?
        */
 
       FAR struct tcp_conn_s *conn = tcp_listenports[ndx];
+#endif
+
 #if defined(CONFIG_NET_IPv4) && defined(CONFIG_NET_IPv6)
       if (conn && conn->lport == portno && conn->domain == domain)
 #else
@@ -143,10 +163,165 @@ FAR struct tcp_conn_s *tcp_findlistener(FAR union ip_binding_u *uaddr,
   return NULL;
 }
 
+/****************************************************************************
+ * Name: tcp_reuseport_member
+ *
+ * Description:
+ *   Return true if 'conn' is a listener in the same SO_REUSEPORT group as
+ *   'listener': both set the option and are bound to the same address and
+ *   port.
+ *
+ * Assumptions:
+ *   This function is called from network logic with the network locked.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_REUSEPORT
+static bool tcp_reuseport_member(FAR struct tcp_conn_s *listener,
+                                 FAR struct tcp_conn_s *conn)
+{
+  if (conn == NULL || conn->lport != listener->lport ||
+      !_SO_GETOPT(conn->sconn.s_options, SO_REUSEPORT))
+    {
+      return false;
+    }
+
+#if defined(CONFIG_NET_IPv4) && defined(CONFIG_NET_IPv6)
+  if (conn->domain != listener->domain)
+    {
+      return false;
+    }
+#endif
+
+#ifdef CONFIG_NET_IPv6
+#  ifdef CONFIG_NET_IPv4
+  if (listener->domain == PF_INET6)
+#  endif
+    {
+      return net_ipv6addr_cmp(conn->u.ipv6.laddr, listener->u.ipv6.laddr);
+    }
+#endif
+
+#ifdef CONFIG_NET_IPv4
+  return net_ipv4addr_cmp(conn->u.ipv4.laddr, listener->u.ipv4.laddr);
+#endif
+}
+#endif
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
 
+/****************************************************************************
+ * Name: tcp_reuseport_select
+ *
+ * Description:
+ *   'listener' was returned by tcp_findlistener().  If it belongs to a
+ *   SO_REUSEPORT group, return the member of the group that owns the flow
+ *   with the given hash; otherwise return 'listener' itself.
+ *
+ * Assumptions:
+ *   This function is called from network logic with the network locked.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_REUSEPORT
+FAR struct tcp_conn_s *tcp_reuseport_select(FAR struct tcp_conn_s *listener,
+                                            uint32_t hash)
+{
+  unsigned int nmembers = 0;
+  unsigned int index;
+  int ndx;
+
+  if (!_SO_GETOPT(listener->sconn.s_options, SO_REUSEPORT))
+    {
+      return listener;
+    }
+
+  /* Every listener is in tcp_listenports[], hashed or not */
+
+  for (ndx = 0; ndx < CONFIG_NET_MAX_LISTENPORTS; ndx++)
+    {
+      if (tcp_reuseport_member(listener, tcp_listenports[ndx]))
+        {
+          nmembers++;
+        }
+    }
+
+  if (nmembers <= 1)
+    {
+      return listener;
+    }
+
+  index = net_flowhash_scale(hash, nmembers);
+  for (ndx = 0; ndx < CONFIG_NET_MAX_LISTENPORTS; ndx++)
+    {
+      if (tcp_reuseport_member(listener, tcp_listenports[ndx]) &&
+          index-- == 0)
+        {
+          return tcp_listenports[ndx];
+        }
+    }
+
+  return listener;
+}
+#endif
+
+/****************************************************************************
+ * Name: tcp_connlistener
+ *
+ * Description:
+ *   Return the listener that a connection in the TCP_SYN_RCVD state will
+ *   be accepted by, or NULL if there is none any longer.  A member of a
+ *   SO_REUSEPORT group chosen when the SYN arrived is kept, so that the
+ *   backlog checked then is the one the connection is added to; the flow
+ *   is only handed to another member if that one stopped listening.
+ *
+ * Assumptions:
+ *   This function is called from network logic with the network locked.
+ *
+ ****************************************************************************/
+
+FAR struct tcp_conn_s *tcp_connlistener(FAR struct tcp_conn_s *conn)
+{
+  FAR struct tcp_conn_s *listener;
+
+#ifdef CONFIG_NET_REUSEPORT
+  int ndx;
+
+  for (ndx = 0; ndx < CONFIG_NET_MAX_LISTENPORTS; ndx++)
+    {
+      listener = tcp_listenports[ndx];
+      if (listener != NULL && listener == conn->listener &&
+          listener->lport == conn->lport)
+        {
+          return listener;
+        }
+    }
+#endif
+
+#if defined(CONFIG_NET_IPv4) && defined(CONFIG_NET_IPv6)
+  listener = tcp_findlistener(&conn->u, conn->lport, conn->domain);
+#else
+  listener = tcp_findlistener(&conn->u, conn->lport);
+#endif
+
+#ifdef CONFIG_NET_REUSEPORT
+  if (listener != NULL)
+    {
+      uint8_t domain = net_ip_domain_select(conn->domain, PF_INET, PF_INET6);
+      uint32_t hash;
+
+      hash     = net_flowhash(domain,
+                              net_ip_binding_raddr(&conn->u, conn->domain),
+                              conn->rport, conn->lport);
+      listener = tcp_reuseport_select(listener, hash);
+    }
+#endif
+
+  return listener;
+}
+
 /****************************************************************************
  * Name: tcp_unlisten
  *
@@ -174,6 +349,23 @@ int tcp_unlisten(FAR struct tcp_conn_s *conn)
         }
     }
 
+#ifdef CONFIG_NET_TCP_HASH
+  if (ret == OK)
+    {
+      FAR struct tcp_conn_s **curr;
+
+      for (curr = &g_tcp_lhash[tcp_porthash(conn->lport)]; *curr != NULL;
+           curr = &(*curr)->lhash)
+        {
+          if (*curr == conn)
+            {
+              *curr = conn->lhash;
+              break;
+            }
+        }
+    }
+#endif
+
   net_unlock();
   return ret;
 }
@@ -191,6 +383,7 @@ int tcp_unlisten(FAR struct tcp_conn_s *conn)
 
 int tcp_listen(FAR struct tcp_conn_s *conn)
 {
+  FAR struct tcp_conn_s *listener;
   int ndx;
   int ret;
 
@@ -203,10 +396,23 @@ int tcp_listen(FAR struct tcp_conn_s *conn)
   /* First, check if there is already a socket listening on this port */
 
 #if defined(CONFIG_NET_IPv4) && defined(CONFIG_NET_IPv6)
-  if (tcp_islistener(&conn->u, conn->lport, conn->domain))
+  listener = tcp_findlistener(&conn->u, conn->lport, conn->domain);
 #else
-  if (tcp_islistener(&conn->u, conn->lport))
+  listener = tcp_findlistener(&conn->u, conn->lport);
+#endif
+
+#ifdef CONFIG_NET_REUSEPORT
+  /* Listeners that all set SO_REUSEPORT may share the port */
+
+  if (listener != NULL &&
+      _SO_GETOPT(listener->sconn.s_options, SO_REUSEPORT) &&
+      _SO_GETOPT(conn->sconn.s_options, SO_REUSEPORT))
+    {
+      listener = NULL;
+    }
 #endif
+
+  if (listener != NULL)
     {
       /* Yes, then we must refuse this request */
 
@@ -231,6 +437,10 @@ int tcp_listen(FAR struct tcp_conn_s *conn)
               /* Yes.. we found it */
 
               tcp_listenports[ndx] = conn;
+#ifdef CONFIG_NET_TCP_HASH
+              conn->lhash = g_tcp_lhash[tcp_porthash(conn->lport)];
+              g_tcp_lhash[tcp_porthash(conn->lport)] = conn;
+#endif
               ret = OK;
               break;
             }
@@ -277,7 +487,7 @@ bool tcp_islistener(FAR union ip_binding_u *uaddr, uint16_t portno)
  ****************************************************************************/
 
 int tcp_accept_connection(FAR struct net_driver_s *dev,
-                          FAR struct tcp_conn_s *conn, uint16_t portno)
+                          FAR struct tcp_conn_s *conn)
 {
   FAR struct tcp_conn_s *listener;
   int ret = -EINVAL;
@@ -287,11 +497,7 @@ int tcp_accept_connection(FAR struct net_driver_s *dev,
    * the connection.
    */
 
-#if defined(CONFIG_NET_IPv4) && defined(CONFIG_NET_IPv6)
-  listener = tcp_findlistener(&conn->u, portno, conn->domain);
-#else
-  listener = tcp_findlistener(&conn->u, portno);
-#endif
+  listener = tcp_connlistener(conn);
   if (listener != NULL)
     {
       /* Yes, there is a listener.  Is it accepting connections now? */
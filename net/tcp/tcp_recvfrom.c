@@ -631,6 +631,78 @@ static void tcp_notify_recvcpu(FAR struct tcp_conn_s *conn)
 #  define tcp_notify_recvcpu(c)
 #endif /* CONFIG_NETDEV_RSS */
 
+#ifdef CONFIG_NET_ZEROCOPY_RECV
+/****************************************************************************
+ * Name: tcp_recvfrom_zerocopy
+ *
+ * Description:
+ *   Lend the first read-ahead I/O buffer to the user instead of copying it
+ *   out.  msg_iov is pointed at the data, which stays valid until it is
+ *   handed back with TCP_ZEROCOPY_RELEASE.
+ *
+ * Input Parameters:
+ *   conn     The TCP connection of interest
+ *   msg      Receive info and buffer for receive data
+ *
+ * Returned Value:
+ *   The number of bytes lent; -ENOBUFS if the data must be copied instead.
+ *
+ * Assumptions:
+ *   The network is locked and there is read-ahead data.
+ *
+ ****************************************************************************/
+
+static ssize_t tcp_recvfrom_zerocopy(FAR struct tcp_conn_s *conn,
+                                     FAR struct msghdr *msg)
+{
+  FAR struct iob_s *iob = conn->readahead;
+  FAR struct iob_s *next;
+  int i;
+
+  DEBUGASSERT(iob != NULL && iob->io_len > 0);
+
+  /* An I/O buffer cannot be split, it must fit into the user request */
+
+  if (iob->io_len > msg->msg_iov->iov_len)
+    {
+      return -ENOBUFS;
+    }
+
+  for (i = 0; i < CONFIG_NET_ZEROCOPY_RXLOANS; i++)
+    {
+      if (conn->zcloans[i] == NULL)
+        {
+          break;
+        }
+    }
+
+  if (i >= CONFIG_NET_ZEROCOPY_RXLOANS)
+    {
+      return -ENOBUFS;
+    }
+
+  /* Detach the head of the read-ahead chain */
+
+  next = iob->io_flink;
+  if (next != NULL)
+    {
+      next->io_pktlen = iob->io_pktlen - iob->io_len;
+      iob->io_flink   = NULL;
+      iob->io_pktlen  = iob->io_len;
+    }
+
+  conn->readahead  = next;
+  conn->zcloans[i] = iob;
+
+  msg->msg_iov->iov_base = IOB_DATA(iob);
+  msg->msg_iov->iov_len  = iob->io_len;
+  msg->msg_flags        |= MSG_ZEROCOPY;
+
+  ninfo("Lent %u bytes in iob %p\n", iob->io_len, iob);
+  return iob->io_len;
+}
+#endif
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -666,9 +738,27 @@ ssize_t psock_tcp_recvfrom(FAR struct socket *psock, FAR struct msghdr *msg,
   struct tcp_callback_s  info;
   int                    ret;
 
-  net_lock();
-
   conn = psock->s_conn;
+  tcp_stats_lock(conn);
+
+#ifdef CONFIG_NET_ZEROCOPY_RECV
+  /* Hand out buffered data without copying it if asked to.  Otherwise, or
+   * if nothing is buffered yet, fall through to the normal copying path.
+   */
+
+  if ((flags & (MSG_ZEROCOPY | MSG_PEEK)) == MSG_ZEROCOPY &&
+      conn->readahead != NULL &&
+      _SO_GETOPT(conn->sconn.s_options, SO_ZEROCOPY))
+    {
+      ssize_t nlent = tcp_recvfrom_zerocopy(conn, msg);
+
+      if (nlent > 0)
+        {
+          net_unlock();
+          return nlent;
+        }
+    }
+#endif
 
   /* Initialize the state structure.  This is done with the network locked
    * because we don't want anything to happen until we are ready.
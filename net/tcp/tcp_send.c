@@ -47,7 +47,10 @@
 #include <nuttx/config.h>
 #if defined(CONFIG_NET) && defined(CONFIG_NET_TCP)
 
+#include <sys/param.h>
+
 #include <assert.h>
+#include <inttypes.h>
 #include <stdint.h>
 #include <string.h>
 #include <debug.h>
@@ -57,6 +60,7 @@
 #include <nuttx/net/netstats.h>
 #include <nuttx/net/ip.h>
 #include <nuttx/net/tcp.h>
+#include <nuttx/trace.h>
 #include <nuttx/wqueue.h>
 
 #include "netdev/netdev.h"
@@ -104,6 +108,38 @@ static inline FAR struct tcp_hdr_s *tcp_header(FAR struct net_driver_s *dev)
 #endif /* CONFIG_NET_IPv4 */
 }
 
+/****************************************************************************
+ * Name: tcp_timestamp
+ *
+ * Description:
+ *   Write the timestamps option, our clock and the latest timestamp of the
+ *   peer, preceded by two NOOP for alignment.
+ *
+ * Input Parameters:
+ *   conn    - The TCP connection structure holding connection information
+ *   optdata - Where to write the option
+ *
+ * Returned Value:
+ *   The size of the option.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_TCP_TIMESTAMPS
+static int tcp_timestamp(FAR struct tcp_conn_s *conn, FAR uint8_t *optdata)
+{
+  optdata[0] = TCP_OPT_NOOP;
+  optdata[1] = TCP_OPT_NOOP;
+  optdata[2] = TCP_OPT_TS;
+  optdata[3] = TCP_OPT_TS_LEN;
+
+  tcp_setsequence(&optdata[4], TCP_TS_NOW());
+  tcp_setsequence(&optdata[8], (conn->flags & TCP_TSTAMP) != 0 ?
+                               conn->ts_recent : 0);
+
+  return TCP_TSOPT_SIZE;
+}
+#endif
+
 /****************************************************************************
  * Name: tcp_sendcommon
  *
@@ -128,6 +164,10 @@ static void tcp_sendcommon(FAR struct net_driver_s *dev,
                            FAR struct tcp_conn_s *conn,
                            FAR struct tcp_hdr_s *tcp)
 {
+#if defined(CONFIG_NET_TCP_INFO) || defined(CONFIG_TRACE_NET)
+  unsigned int datalen;
+#endif
+
   /* Set TCP sequence numbers and port numbers */
 
   memcpy(tcp->ackno, conn->rcvseq, 4);
@@ -238,6 +278,23 @@ static void tcp_sendcommon(FAR struct net_driver_s *dev,
   g_netstats.tcp.sent++;
 #endif
 
+#if defined(CONFIG_NET_TCP_INFO) || defined(CONFIG_TRACE_NET)
+  /* The payload is what follows the IP and TCP headers */
+
+  datalen = dev->d_len - ((FAR uint8_t *)tcp - (FAR uint8_t *)IPBUF(0)) -
+            ((tcp->tcpoffset >> 4) << 2);
+
+  net_trace_printf("tcp tx %u>%u seq=%" PRIu32 " ack=%" PRIu32
+                   " flags=%02x len=%u\n",
+                   NTOHS(tcp->srcport), NTOHS(tcp->destport),
+                   tcp_getsequence(tcp->seqno), tcp_getsequence(tcp->ackno),
+                   tcp->flags, datalen);
+#endif
+
+#ifdef CONFIG_NET_TCP_INFO
+  tcp_stats_send(conn, tcp_getsequence(tcp->seqno), datalen);
+#endif
+
 #if !defined(CONFIG_NET_TCP_WRITE_BUFFERS)
   if ((tcp->flags & (TCP_SYN | TCP_FIN)) != 0)
     {
@@ -287,6 +344,7 @@ void tcp_send(FAR struct net_driver_s *dev, FAR struct tcp_conn_s *conn,
               uint16_t flags, uint16_t len)
 {
   FAR struct tcp_hdr_s *tcp;
+  int tsoptlen = 0;
 
   if (dev->d_iob == NULL)
     {
@@ -297,38 +355,59 @@ void tcp_send(FAR struct net_driver_s *dev, FAR struct tcp_conn_s *conn,
   tcp->flags = flags;
   dev->d_len = len;
 
+#ifdef CONFIG_NET_TCP_TIMESTAMPS
+  /* The room of the timestamps option is included in the header size of
+   * the connection, see tcpip_hdrsize(), and so in len.
+   */
+
+  if ((conn->flags & TCP_TSTAMP) != 0)
+    {
+      tsoptlen = tcp_timestamp(conn, tcp->optdata);
+    }
+#endif
+
 #ifdef CONFIG_NET_TCP_SELECTIVE_ACK
   if ((conn->flags & TCP_SACK) && (flags == TCP_ACK) && conn->nofosegs > 0)
     {
-      int optlen = conn->nofosegs * sizeof(struct tcp_sack_s);
+      FAR uint8_t *optdata = &tcp->optdata[tsoptlen];
+      int nsacks;
+      int optlen;
       int i;
 
-      tcp->optdata[0] = TCP_OPT_NOOP;
-      tcp->optdata[1] = TCP_OPT_NOOP;
-      tcp->optdata[2] = TCP_OPT_SACK;
-      tcp->optdata[3] = TCP_OPT_SACK_PERM_LEN + optlen;
+      /* Only three blocks fit into the options next to the timestamps */
+
+      nsacks = (TCP_MAX_HDRLEN - TCP_HDRLEN - tsoptlen - 4) /
+               sizeof(struct tcp_sack_s);
+      nsacks = MIN(conn->nofosegs, nsacks);
+
+      optlen = nsacks * sizeof(struct tcp_sack_s);
+
+      optdata[0] = TCP_OPT_NOOP;
+      optdata[1] = TCP_OPT_NOOP;
+      optdata[2] = TCP_OPT_SACK;
+      optdata[3] = TCP_OPT_SACK_PERM_LEN + optlen;
 
       optlen += 4;
 
-      for (i = 0; i < conn->nofosegs; i++)
+      for (i = 0; i < nsacks; i++)
         {
           ninfo("TCP SACK [%d]"
                 "[%" PRIu32 " : %" PRIu32 " : %" PRIu32 "]\n", i,
                 conn->ofosegs[i].left, conn->ofosegs[i].right,
                 TCP_SEQ_SUB(conn->ofosegs[i].right, conn->ofosegs[i].left));
-          tcp_setsequence(&tcp->optdata[4 + i * 2 * sizeof(uint32_t)],
+          tcp_setsequence(&optdata[4 + i * 2 * sizeof(uint32_t)],
                           conn->ofosegs[i].left);
-          tcp_setsequence(&tcp->optdata[4 + (i * 2 + 1) * sizeof(uint32_t)],
+          tcp_setsequence(&optdata[4 + (i * 2 + 1) * sizeof(uint32_t)],
                           conn->ofosegs[i].right);
         }
 
       dev->d_len += optlen;
-      tcp->tcpoffset = ((TCP_HDRLEN + optlen) / 4) << 4;
+      tcp->tcpoffset = ((TCP_HDRLEN + tsoptlen + optlen) / 4) << 4;
     }
   else
 #endif /* CONFIG_NET_TCP_SELECTIVE_ACK */
     {
-      tcp->tcpoffset = (TCP_HDRLEN / 4) << 4;
+      tcp->tcpoffset = ((TCP_HDRLEN + tsoptlen) / 4) << 4;
     }
 
   tcp_sendcommon(dev, conn, tcp);
@@ -611,6 +690,15 @@ void tcp_synack(FAR struct net_driver_s *dev, FAR struct tcp_conn_s *conn,
 
   dev->d_len = tcpip_hdrsize(conn);
 
+#ifdef CONFIG_NET_TCP_TIMESTAMPS
+  /* The timestamps option is counted with the other options below */
+
+  if ((conn->flags & TCP_TSTAMP) != 0)
+    {
+      dev->d_len -= TCP_TSOPT_SIZE;
+    }
+#endif
+
   /* Set the packet length for the TCP Maximum Segment Size */
 
 #ifdef CONFIG_NET_TCPPROTO_OPTIONS
@@ -662,6 +750,13 @@ void tcp_synack(FAR struct net_driver_s *dev, FAR struct tcp_conn_s *conn,
     }
 #endif
 
+#ifdef CONFIG_NET_TCP_TIMESTAMPS
+  if (tcp->flags == TCP_SYN || (conn->flags & TCP_TSTAMP) != 0)
+    {
+      optlen += tcp_timestamp(conn, &tcp->optdata[optlen]);
+    }
+#endif
+
   tcp->tcpoffset         = ((TCP_HDRLEN + optlen) / 4) << 4;
   dev->d_len            += optlen;
 
@@ -736,6 +831,16 @@ uint16_t tcpip_hdrsize(FAR struct tcp_conn_s *conn)
   uint16_t hdrsize = sizeof(struct tcp_hdr_s);
 
   UNUSED(conn);
+
+#ifdef CONFIG_NET_TCP_TIMESTAMPS
+  /* Every segment of the connection carries the timestamps */
+
+  if ((conn->flags & TCP_TSTAMP) != 0)
+    {
+      hdrsize += TCP_TSOPT_SIZE;
+    }
+#endif
+
   return net_ip_domain_select(conn->domain,
                               sizeof(struct ipv4_hdr_s) + hdrsize,
                               sizeof(struct ipv6_hdr_s) + hdrsize);
@@ -89,6 +89,14 @@
 #  define TCP_WBDUMP(msg,wrb,len,offset)
 #endif
 
+#ifdef CONFIG_NET_TCP_RACK
+/* The worst case delay of the ACK of a single segment, added to the probe
+ * timeout of a flight of one segment (RFC 8985, Section 7.2).
+ */
+
+#  define TCP_RACK_WCDELACKT 200
+#endif
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
@@ -214,6 +222,10 @@ static void retransmit_segment(FAR struct tcp_conn_s *conn,
             "conn tx_unacked=%" PRId32 " sent=%" PRId32 "\n",
             wrb, TCP_WBSENT(wrb), conn->tx_unacked, conn->sent);
 
+#ifdef CONFIG_NET_TCP_RACK
+      TCP_WBSACKED(wrb) = false;
+#endif
+
       /* Reset the number of bytes sent sent from the write buffer */
 
       if (conn->tx_unacked > sent)
@@ -412,6 +424,261 @@ static int parse_sack(FAR struct tcp_conn_s *conn, FAR struct tcp_hdr_s *tcp,
 }
 #endif /* CONFIG_NET_TCP_SELECTIVE_ACK */
 
+/****************************************************************************
+ * Name: tcp_rack_update
+ *
+ * Description:
+ *   A segment has been delivered, cumulatively ACKed or SACKed.  Take an
+ *   RTT sample from it and remember it if it is the most recently sent
+ *   segment delivered so far (RFC 8985, Section 6.2).
+ *
+ * Input Parameters:
+ *   conn   - The TCP connection of interest
+ *   wrb    - The delivered segment
+ *   now    - The current time (units: milliseconds)
+ *
+ * Returned Value:
+ *   None
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_TCP_RACK
+static void tcp_rack_update(FAR struct tcp_conn_s *conn,
+                            FAR struct tcp_wrbuffer_s *wrb, uint32_t now)
+{
+  uint32_t xmitts = TCP_WBXMITTS(wrb);
+  uint32_t endseq = TCP_WBSEQNO(wrb) + TCP_WBPKTLEN(wrb);
+  uint32_t rtt    = MAX(now - xmitts, 1);
+
+  /* The ACK of a retransmitted segment may be for the first transmission.
+   * Use it only if the echoed timestamp shows that the retransmission has
+   * been delivered.
+   */
+
+  if (TCP_WBNRTX(wrb) > 0)
+    {
+#ifdef CONFIG_NET_TCP_TIMESTAMPS
+      if ((conn->flags & TCP_TSTAMP) == 0 ||
+          (int32_t)(conn->ts_ecr - xmitts) < 0)
+#endif
+        {
+          return;
+        }
+    }
+
+  if (conn->rack_srtt == 0)
+    {
+      conn->rack_srtt = rtt << 3;
+    }
+  else
+    {
+      conn->rack_srtt += rtt - (conn->rack_srtt >> 3);
+    }
+
+  if ((int32_t)(xmitts - conn->rack_xmitts) > 0 ||
+      (xmitts == conn->rack_xmitts &&
+       TCP_SEQ_GT(endseq, conn->rack_endseq)))
+    {
+      conn->rack_xmitts = xmitts;
+      conn->rack_endseq = endseq;
+      conn->rack_rtt    = rtt;
+    }
+}
+
+/****************************************************************************
+ * Name: tcp_rack_sack
+ *
+ * Description:
+ *   Mark the unacked segments covered by the SACK blocks of an incoming
+ *   ACK as delivered.
+ *
+ * Input Parameters:
+ *   conn   - The TCP connection of interest
+ *   tcp    - Header of tcp structure
+ *   now    - The current time (units: milliseconds)
+ *
+ * Returned Value:
+ *   None
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+static void tcp_rack_sack(FAR struct tcp_conn_s *conn,
+                          FAR struct tcp_hdr_s *tcp, uint32_t now)
+{
+  struct tcp_ofoseg_s ofosegs[TCP_SACK_RANGES_MAX];
+  FAR struct tcp_wrbuffer_s *wrb;
+  FAR sq_entry_t *entry;
+  int nsacks;
+  int i;
+
+  nsacks = parse_sack(conn, tcp, ofosegs);
+  if (nsacks == 0)
+    {
+      return;
+    }
+
+  for (entry = sq_peek(&conn->unacked_q); entry; entry = sq_next(entry))
+    {
+      wrb = (FAR struct tcp_wrbuffer_s *)entry;
+      if (TCP_WBSACKED(wrb))
+        {
+          continue;
+        }
+
+      for (i = 0; i < nsacks; i++)
+        {
+          if (TCP_SEQ_GTE(TCP_WBSEQNO(wrb), ofosegs[i].left) &&
+              TCP_SEQ_LTE(TCP_WBSEQNO(wrb) + TCP_WBPKTLEN(wrb),
+                          ofosegs[i].right))
+            {
+              TCP_WBSACKED(wrb) = true;
+              tcp_rack_update(conn, wrb, now);
+              break;
+            }
+        }
+    }
+}
+
+/****************************************************************************
+ * Name: tcp_rack_detect_loss
+ *
+ * Description:
+ *   Deem an unacked segment lost if a segment sent after it has been
+ *   delivered and more than the RTT plus the reordering window has passed
+ *   since it was sent.  The lost segments are moved to the write queue to
+ *   be retransmitted (RFC 8985, Section 6.2).
+ *
+ * Input Parameters:
+ *   conn    - The TCP connection of interest
+ *   now     - The current time (units: milliseconds)
+ *   timeout - Location to return the time until the reordering window of
+ *             the next segment passes, zero if there is none
+ *
+ * Returned Value:
+ *   True if any segment was deemed lost.
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+static bool tcp_rack_detect_loss(FAR struct tcp_conn_s *conn, uint32_t now,
+                                 FAR uint32_t *timeout)
+{
+  FAR struct tcp_wrbuffer_s *wrb;
+  FAR sq_entry_t *entry;
+  FAR sq_entry_t *next;
+  uint32_t reo_wnd;
+  int32_t remaining;
+  bool lost = false;
+
+  *timeout = 0;
+
+  if (conn->rack_srtt == 0)
+    {
+      return false;
+    }
+
+  /* A quarter of the RTT, but no more than the smoothed RTT */
+
+  reo_wnd = MIN(conn->rack_rtt >> 2, conn->rack_srtt >> 3);
+
+  for (entry = sq_peek(&conn->unacked_q); entry; entry = next)
+    {
+      wrb  = (FAR struct tcp_wrbuffer_s *)entry;
+      next = sq_next(entry);
+
+      /* Only segments sent before the last delivered one can be lost */
+
+      if (TCP_WBSACKED(wrb) ||
+          (int32_t)(TCP_WBXMITTS(wrb) - conn->rack_xmitts) > 0 ||
+          (TCP_WBXMITTS(wrb) == conn->rack_xmitts &&
+           TCP_SEQ_GTE(TCP_WBSEQNO(wrb), conn->rack_endseq)))
+        {
+          continue;
+        }
+
+      remaining = TCP_WBXMITTS(wrb) + conn->rack_rtt + reo_wnd - now;
+      if (remaining <= 0)
+        {
+          ninfo("RACK: lost [%" PRIu32 " : %u]\n",
+                TCP_WBSEQNO(wrb), TCP_WBPKTLEN(wrb));
+
+          sq_rem(entry, &conn->unacked_q);
+          retransmit_segment(conn, wrb);
+          lost = true;
+        }
+      else if (*timeout == 0 || (uint32_t)remaining < *timeout)
+        {
+          *timeout = remaining;
+        }
+    }
+
+#ifdef CONFIG_NET_TCP_CC_NEWRENO
+  /* Enter fast recovery as after duplicate ACKs */
+
+  if (lost && (conn->flags & (TCP_INFR | TCP_INFT)) == 0)
+    {
+      conn->flags     |= TCP_INFT;
+      conn->fr_recover = conn->sndseq_max;
+      tcp_cc_update(conn, NULL);
+    }
+#endif
+
+  return lost;
+}
+
+/****************************************************************************
+ * Name: tcp_rack_arm
+ *
+ * Description:
+ *   Start the RACK timer for the reordering window of the next segment if
+ *   any, otherwise for a tail loss probe after two RTTs if data is in
+ *   flight (RFC 8985, Section 7.2).
+ *
+ * Input Parameters:
+ *   conn    - The TCP connection of interest
+ *   timeout - Time until the reordering window of the next segment passes
+ *
+ * Returned Value:
+ *   None
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+static void tcp_rack_arm(FAR struct tcp_conn_s *conn, uint32_t timeout)
+{
+  uint32_t pto;
+
+  if (timeout > 0)
+    {
+      tcp_rack_settimer(conn, timeout, false);
+    }
+  else if (conn->tx_unacked > 0 && conn->rack_srtt > 0)
+    {
+      pto = conn->rack_srtt >> 2;
+      if (conn->tx_unacked <= conn->mss)
+        {
+          pto += TCP_RACK_WCDELACKT;
+        }
+
+      tcp_rack_settimer(conn, MIN(pto, conn->rto * MSEC_PER_HSEC), true);
+    }
+  else
+    {
+      tcp_rack_settimer(conn, 0, false);
+    }
+}
+#endif /* CONFIG_NET_TCP_RACK */
+
 /****************************************************************************
  * Name: psock_send_eventhandler
  *
@@ -482,6 +749,10 @@ static uint16_t psock_send_eventhandler(FAR struct net_driver_s *dev,
       FAR sq_entry_t *entry;
       FAR sq_entry_t *next;
       uint32_t ackno;
+#ifdef CONFIG_NET_TCP_RACK
+      uint32_t now = TCP_TS_NOW();
+      uint32_t timeout;
+#endif
 
       /* Get the offset address of the TCP header */
 
@@ -547,6 +818,10 @@ static uint16_t psock_send_eventhandler(FAR struct net_driver_s *dev,
 
                   sq_rem(entry, &conn->unacked_q);
 
+#ifdef CONFIG_NET_TCP_RACK
+                  tcp_rack_update(conn, wrb, now);
+#endif
+
                   /* And return the write buffer to the pool of free
                    * buffers
                    */
@@ -608,7 +883,9 @@ static uint16_t psock_send_eventhandler(FAR struct net_driver_s *dev,
                        * driver to send the message and marked as rexmit
                        */
 
+#ifndef CONFIG_NET_TCP_CC_NEWRENO
                       TCP_WBNACK(wrb) = 0;
+#endif
                       conn->timeout = true;
                       netdev_txnotify_dev(conn->dev);
                       return flags;
@@ -681,6 +958,21 @@ static uint16_t psock_send_eventhandler(FAR struct net_driver_s *dev,
           ninfo("ACK: wrb=%p seqno=%" PRIu32 " pktlen=%u sent=%u\n",
                 wrb, TCP_WBSEQNO(wrb), TCP_WBPKTLEN(wrb), TCP_WBSENT(wrb));
         }
+
+#ifdef CONFIG_NET_TCP_RACK
+      /* Deem the segments lost that were sent well before the data that
+       * this ACK delivered, then wait for the reordering window of the
+       * others or for the tail of the flight.
+       */
+
+      if ((conn->flags & TCP_SACK) != 0)
+        {
+          tcp_rack_sack(conn, tcp, now);
+        }
+
+      tcp_rack_detect_loss(conn, now, &timeout);
+      tcp_rack_arm(conn, timeout);
+#endif
     }
 
   /* Check for a loss of connection */
@@ -778,6 +1070,10 @@ static uint16_t psock_send_eventhandler(FAR struct net_driver_s *dev,
               return flags;
             }
 
+#ifdef CONFIG_NET_TCP_RACK
+          TCP_WBXMITTS(wrb) = TCP_TS_NOW();
+#endif
+
 #ifdef CONFIG_NET_TCP_CC_NEWRENO
           /* After Fast retransmitted, set ssthresh to the maximum of
            * the unacked and the 2*SMSS, and enter to Fast Recovery.
@@ -967,6 +1263,48 @@ static uint16_t psock_send_eventhandler(FAR struct net_driver_s *dev,
         }
     }
 
+#ifdef CONFIG_NET_TCP_RACK
+  /* The RACK timer expired, either the reordering window of a segment has
+   * passed or the tail of the flight got no ACK.
+   */
+
+  if (conn->rack_timeout)
+    {
+      FAR struct tcp_wrbuffer_s *wrb;
+      uint32_t timeout;
+
+      conn->rack_timeout = false;
+
+      if (!tcp_rack_detect_loss(conn, TCP_TS_NOW(), &timeout) &&
+          conn->rack_probe)
+        {
+          /* Send the last segment again as a tail loss probe, its ACK
+           * reveals any loss of the tail to RACK.  New data would serve as
+           * well and is sent below if there is any.
+           */
+
+          wrb = (FAR struct tcp_wrbuffer_s *)sq_tail(&conn->unacked_q);
+          if (sq_empty(&conn->write_q) && wrb != NULL &&
+              !TCP_WBSACKED(wrb))
+            {
+              ninfo("RACK: probe [%" PRIu32 " : %u]\n",
+                    TCP_WBSEQNO(wrb), TCP_WBPKTLEN(wrb));
+
+              sq_remlast(&conn->unacked_q);
+              retransmit_segment(conn, wrb);
+            }
+
+          /* Only one probe until the next ACK */
+
+          tcp_rack_settimer(conn, 0, false);
+        }
+      else
+        {
+          tcp_rack_arm(conn, timeout);
+        }
+    }
+#endif
+
 #if CONFIG_NET_SEND_BUFSIZE > 0
   /* Notify the send buffer available if wrbbuffer drained */
 
@@ -1038,12 +1376,24 @@ static uint16_t psock_send_eventhandler(FAR struct net_driver_s *dev,
       if (TCP_SEQ_LT(seq, snd_wnd_edge))
         {
           uint32_t remaining_snd_wnd;
+          size_t maxlen = conn->mss;
           int ret;
 
+#ifdef CONFIG_NETDEV_GSO
+          /* Send whole segments up to d_gso_max bytes at once if the
+           * driver cuts them into segments of the MSS.
+           */
+
+          if (dev->d_gso_max > conn->mss)
+            {
+              maxlen = dev->d_gso_max / conn->mss * conn->mss;
+            }
+#endif
+
           sndlen = TCP_WBPKTLEN(wrb) - TCP_WBSENT(wrb);
-          if (sndlen > conn->mss)
+          if (sndlen > maxlen)
             {
-              sndlen = conn->mss;
+              sndlen = maxlen;
             }
 
           remaining_snd_wnd = TCP_SEQ_SUB(snd_wnd_edge, seq);
@@ -1068,6 +1418,17 @@ static uint16_t psock_send_eventhandler(FAR struct net_driver_s *dev,
               sndlen = CONFIG_IOB_BUFSIZE;
             }
 
+#ifdef CONFIG_NET_TCP_PACING
+          /* Hold the segment back until the pacer lets it go, the pacing
+           * timer will poll the connection again.
+           */
+
+          if (tcp_pacing_hold(conn))
+            {
+              return flags;
+            }
+#endif
+
           ninfo("SEND: wrb=%p seq=%" PRIu32 " pktlen=%u sent=%u sndlen=%zu "
                 "mss=%u snd_wnd=%" PRIu32 " seq=%" PRIu32
                 " remaining_snd_wnd=%" PRIu32 "\n",
@@ -1114,6 +1475,10 @@ static uint16_t psock_send_eventhandler(FAR struct net_driver_s *dev,
               return flags;
             }
 
+#ifdef CONFIG_NETDEV_GSO
+          dev->d_gso_size = sndlen > conn->mss ? conn->mss : 0;
+#endif
+
           /* Remember how much data we send out now so that we know
            * when everything has been acknowledged.  Just increment
            * the amount of data sent. This will be needed in sequence
@@ -1123,6 +1488,10 @@ static uint16_t psock_send_eventhandler(FAR struct net_driver_s *dev,
           conn->tx_unacked += sndlen;
           conn->sent       += sndlen;
 
+#ifdef CONFIG_NET_TCP_CC_NEWRENO
+          tcp_cc_sent(conn, seq, sndlen, TCP_WBNRTX(wrb) > 0);
+#endif
+
           /* Below prediction will become true,
            * unless retransmission occurrence
            */
@@ -1142,6 +1511,19 @@ static uint16_t psock_send_eventhandler(FAR struct net_driver_s *dev,
 
           TCP_WBSENT(wrb) += sndlen;
 
+#ifdef CONFIG_NET_TCP_RACK
+          /* Remember when the segment was sent, and restart the probe
+           * timeout on new data.
+           */
+
+          TCP_WBXMITTS(wrb) = TCP_TS_NOW();
+          if (TCP_WBNRTX(wrb) == 0 &&
+              (conn->rack_probe || work_available(&conn->rackwork)))
+            {
+              tcp_rack_arm(conn, 0);
+            }
+#endif
+
           ninfo("SEND: wrb=%p sent=%u pktlen=%u\n",
                 wrb, TCP_WBSENT(wrb), TCP_WBPKTLEN(wrb));
 
@@ -1250,6 +1632,42 @@ static unsigned int tcp_send_gettimeout(clock_t start, unsigned int timeout)
   return timeout;
 }
 
+#ifdef CONFIG_NET_ZEROCOPY
+/****************************************************************************
+ * Name: tcp_send_zerocopy
+ *
+ * Description:
+ *   Fill a new write buffer with a reference to the user data rather than
+ *   a copy of it.  Falls back to copying if no I/O buffer header can be
+ *   allocated.
+ *
+ * Returned Value:
+ *   The number of bytes added to the write buffer, or -ENOMEM.
+ *
+ ****************************************************************************/
+
+static int tcp_send_zerocopy(FAR struct tcp_wrbuffer_s *wrb,
+                             FAR struct zerocopy_s *zc,
+                             FAR const uint8_t *cp, uint16_t len)
+{
+  FAR struct iob_s *iob;
+
+  DEBUGASSERT(TCP_WBPKTLEN(wrb) == 0);
+
+  iob = zerocopy_iob(zc, cp, len);
+  if (iob == NULL)
+    {
+      return TCP_WBTRYCOPYIN(wrb, cp, len, 0);
+    }
+
+  /* Replace the empty head of the write buffer */
+
+  iob_free_chain(TCP_WBIOB(wrb));
+  TCP_WBIOB(wrb) = iob;
+  return len;
+}
+#endif
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -1321,6 +1739,9 @@ ssize_t psock_tcp_send(FAR struct socket *psock, FAR const void *buf,
   bool       nonblock;
   int        ret = OK;
   clock_t    start;
+#ifdef CONFIG_NET_ZEROCOPY
+  FAR struct zerocopy_s *zc = NULL;
+#endif
 
   if (psock == NULL || psock->s_type != SOCK_STREAM ||
       psock->s_conn == NULL)
@@ -1379,6 +1800,24 @@ ssize_t psock_tcp_send(FAR struct socket *psock, FAR const void *buf,
 
   BUF_DUMP("psock_tcp_send", buf, len);
 
+#ifdef CONFIG_NET_ZEROCOPY
+  /* With MSG_ZEROCOPY the write buffers refer to the user data instead of
+   * holding a copy.  The user must leave the buffer alone until the error
+   * queue reports that the data has been acknowledged.
+   */
+
+  if ((flags & MSG_ZEROCOPY) != 0 &&
+      _SO_GETOPT(conn->sconn.s_options, SO_ZEROCOPY))
+    {
+      zc = zerocopy_alloc(&conn->sconn, buf, len);
+      if (zc == NULL)
+        {
+          ret = -ENOBUFS;
+          goto errout;
+        }
+    }
+#endif
+
   cp = buf;
   while (len > 0)
     {
@@ -1387,7 +1826,7 @@ ssize_t psock_tcp_send(FAR struct socket *psock, FAR const void *buf,
       size_t chunk_len = len;
       ssize_t chunk_result;
 
-      net_lock();
+      tcp_stats_lock(conn);
 
       /* Now that we have the network locked, we need to check the connection
        * state again to ensure the connection is still valid.
@@ -1485,6 +1924,15 @@ ssize_t psock_tcp_send(FAR struct socket *psock, FAR const void *buf,
 
           max_wrb_size = tcp_max_wrb_size(conn);
           wrb = (FAR struct tcp_wrbuffer_s *)sq_tail(&conn->write_q);
+#ifdef CONFIG_NET_ZEROCOPY
+          if (zc != NULL)
+            {
+              /* User data always starts a write buffer of its own */
+
+              wrb = NULL;
+            }
+#endif
+
           if (wrb != NULL && TCP_WBSENT(wrb) == 0 && TCP_WBNRTX(wrb) == 0 &&
               TCP_WBPKTLEN(wrb) < max_wrb_size &&
               (TCP_WBPKTLEN(wrb) % conn->mss) != 0)
@@ -1528,6 +1976,9 @@ ssize_t psock_tcp_send(FAR struct socket *psock, FAR const void *buf,
 
           TCP_WBSEQNO(wrb) = (unsigned)-1;
           TCP_WBNRTX(wrb)  = 0;
+#ifdef CONFIG_NET_TCP_RACK
+          TCP_WBSACKED(wrb) = false;
+#endif
 
           off = TCP_WBPKTLEN(wrb);
           if (off + chunk_len > max_wrb_size)
@@ -1535,6 +1986,13 @@ ssize_t psock_tcp_send(FAR struct socket *psock, FAR const void *buf,
               chunk_len = max_wrb_size - off;
             }
 
+#ifdef CONFIG_NET_ZEROCOPY
+          if (zc != NULL && chunk_len > UINT16_MAX)
+            {
+              chunk_len = UINT16_MAX;
+            }
+#endif
+
           /* Copy the user data into the write buffer.  We cannot wait for
            * buffer space.
            */
@@ -1547,7 +2005,17 @@ ssize_t psock_tcp_send(FAR struct socket *psock, FAR const void *buf,
            * remaining data.
            */
 
-          chunk_result = TCP_WBTRYCOPYIN(wrb, cp, chunk_len, off);
+#ifdef CONFIG_NET_ZEROCOPY
+          if (zc != NULL)
+            {
+              chunk_result = tcp_send_zerocopy(wrb, zc, cp, chunk_len);
+            }
+          else
+#endif
+            {
+              chunk_result = TCP_WBTRYCOPYIN(wrb, cp, chunk_len, off);
+            }
+
           if (chunk_result == -ENOMEM)
             {
               if (TCP_WBPKTLEN(wrb) > 0)
@@ -1672,6 +2140,13 @@ ssize_t psock_tcp_send(FAR struct socket *psock, FAR const void *buf,
       goto errout;
     }
 
+#ifdef CONFIG_NET_ZEROCOPY
+  if (zc != NULL)
+    {
+      zerocopy_release(zc, result);
+    }
+#endif
+
   /* Return the number of bytes actually sent */
 
   return result;
@@ -1680,6 +2155,13 @@ errout_with_lock:
   net_unlock();
 
 errout:
+#ifdef CONFIG_NET_ZEROCOPY
+  if (zc != NULL)
+    {
+      zerocopy_release(zc, result);
+    }
+#endif
+
   if (result > 0)
     {
       return result;
@@ -548,7 +548,7 @@ ssize_t psock_tcp_send(FAR struct socket *psock,
    * ready.
    */
 
-  net_lock();
+  tcp_stats_lock(conn);
 
   /* Now that we have the network locked, we need to check the connection
    * state again to ensure the connection is still valid.
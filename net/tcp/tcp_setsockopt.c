@@ -27,16 +27,21 @@
 #include <nuttx/config.h>
 
 #include <sys/time.h>
+#include <sys/param.h>
+#include <sys/uio.h>
 #include <stdint.h>
+#include <string.h>
 #include <errno.h>
 #include <assert.h>
 #include <debug.h>
 
 #include <netinet/tcp.h>
 
+#include <nuttx/mm/iob.h>
 #include <nuttx/net/net.h>
 #include <nuttx/net/tcp.h>
 
+#include "netdev/netdev.h"
 #include "socket/socket.h"
 #include "utils/utils.h"
 #include "tcp/tcp.h"
@@ -260,6 +265,76 @@ int tcp_setsockopt(FAR struct socket *psock, int option,
           }
         break;
 
+#ifdef CONFIG_NET_TCP_CC_NEWRENO
+      case TCP_CONGESTION: /* Congestion control algorithm */
+        if (value == NULL || value_len == 0)
+          {
+            ret = -EINVAL;
+          }
+        else
+          {
+            FAR const struct tcp_cc_ops_s *ops;
+            char name[TCP_CA_NAME_MAX];
+
+            /* The name need not be NUL terminated */
+
+            value_len = MIN(value_len, TCP_CA_NAME_MAX - 1);
+            memcpy(name, value, value_len);
+            name[value_len] = '\0';
+
+            ops = tcp_cc_find(name);
+            if (ops == NULL)
+              {
+                nerr("ERROR: Unknown congestion control: %s\n", name);
+                return -ENOENT;
+              }
+
+            net_lock();
+            tcp_cc_select(conn, ops);
+            net_unlock();
+          }
+        break;
+#endif
+
+#ifdef CONFIG_NET_ZEROCOPY_RECV
+      case TCP_ZEROCOPY_RELEASE: /* Return a buffer lent by recvmsg() */
+        if (value == NULL || value_len != sizeof(struct iovec))
+          {
+            ret = -EINVAL;
+          }
+        else
+          {
+            FAR const struct iovec *iov = value;
+            int i;
+
+            ret = -EINVAL;
+
+            net_lock();
+            for (i = 0; i < CONFIG_NET_ZEROCOPY_RXLOANS; i++)
+              {
+                FAR struct iob_s *iob = conn->zcloans[i];
+
+                if (iob != NULL && IOB_DATA(iob) == iov->iov_base)
+                  {
+                    conn->zcloans[i] = NULL;
+                    iob_free(iob);
+                    ret = OK;
+                    break;
+                  }
+              }
+
+            /* The returned buffer may open up the receive window */
+
+            if (ret == OK && tcp_should_send_recvwindow(conn))
+              {
+                netdev_txnotify_dev(conn->dev);
+              }
+
+            net_unlock();
+          }
+        break;
+#endif
+
       default:
         nerr("ERROR: Unrecognized TCP option: %d\n", option);
         ret = -ENOPROTOOPT;
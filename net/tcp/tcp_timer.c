@@ -160,6 +160,94 @@ static void tcp_timer_expiry(FAR void *arg)
   net_unlock();
 }
 
+/****************************************************************************
+ * Name: tcp_pacing_expiry
+ *
+ * Description:
+ *   The next segment of a paced TCP connection is due, poll it.
+ *
+ * Input Parameters:
+ *   arg - The TCP "connection" to poll for TX data
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_TCP_PACING
+static void tcp_pacing_expiry(FAR void *arg)
+{
+  FAR struct tcp_conn_s *conn = NULL;
+
+  net_lock();
+
+  while ((conn = tcp_nextconn(conn)) != NULL)
+    {
+      if (conn == arg)
+        {
+          /* The work may have been dequeued just before tcp_free() tried
+           * to cancel it and the connection reused since.  Only act if the
+           * connection still owns an armed timer that was not queued again
+           * while we waited for the lock.
+           */
+
+          if (conn->pacing_armed && work_available(&conn->pacework))
+            {
+              conn->pacing_armed = false;
+              netdev_txnotify_dev(conn->dev);
+            }
+
+          break;
+        }
+    }
+
+  net_unlock();
+}
+#endif
+
+/****************************************************************************
+ * Name: tcp_rack_expiry
+ *
+ * Description:
+ *   The reordering window of a segment has passed or a tail loss probe is
+ *   due, poll the connection.
+ *
+ * Input Parameters:
+ *   arg - The TCP "connection" to poll for TX data
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_TCP_RACK
+static void tcp_rack_expiry(FAR void *arg)
+{
+  FAR struct tcp_conn_s *conn = NULL;
+
+  net_lock();
+
+  while ((conn = tcp_nextconn(conn)) != NULL)
+    {
+      if (conn == arg)
+        {
+          /* See tcp_pacing_expiry() */
+
+          if (conn->rack_armed && work_available(&conn->rackwork))
+            {
+              conn->rack_armed = false;
+              conn->rack_timeout = true;
+              netdev_txnotify_dev(conn->dev);
+            }
+
+          break;
+        }
+    }
+
+  net_unlock();
+}
+#endif
+
 /****************************************************************************
  * Name: tcp_xmit_probe
  *
@@ -339,7 +427,102 @@ void tcp_update_keeptimer(FAR struct tcp_conn_s *conn, int timeout)
 void tcp_stop_timer(FAR struct tcp_conn_s *conn)
 {
   work_cancel(LPWORK, &conn->work);
+#ifdef CONFIG_NET_TCP_PACING
+  conn->pacing_armed = false;
+  work_cancel(LPWORK, &conn->pacework);
+#endif
+#ifdef CONFIG_NET_TCP_RACK
+  conn->rack_armed = false;
+  work_cancel(LPWORK, &conn->rackwork);
+#endif
+}
+
+/****************************************************************************
+ * Name: tcp_pacing_hold
+ *
+ * Description:
+ *   Check whether the pacer lets the connection send a segment now.  If
+ *   not, the pacing timer is started to poll the connection again when the
+ *   next segment is due.
+ *
+ * Input Parameters:
+ *   conn - The TCP connection of interest
+ *
+ * Returned Value:
+ *   true if the segment must be held back.
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_TCP_PACING
+bool tcp_pacing_hold(FAR struct tcp_conn_s *conn)
+{
+  int32_t delay;
+
+  if (conn->pacing_rate == 0)
+    {
+      return false;
+    }
+
+  delay = (int32_t)(conn->pacing_next - tcp_cc_now());
+  if (delay <= 0)
+    {
+      return false;
+    }
+
+  if (work_available(&conn->pacework))
+    {
+      conn->pacing_armed = true;
+      work_queue(LPWORK, &conn->pacework, tcp_pacing_expiry,
+                 conn, USEC2TICK(delay));
+    }
+
+  return true;
 }
+#endif
+
+/****************************************************************************
+ * Name: tcp_rack_settimer
+ *
+ * Description:
+ *   Start the RACK timer of the connection, either to check the unacked
+ *   segments for loss again when their reordering window has passed, or
+ *   to send a tail loss probe.  A zero timeout stops the timer.
+ *
+ * Input Parameters:
+ *   conn    - The TCP connection of interest
+ *   timeout - Time for the next timeout (units: milliseconds)
+ *   probe   - True if a tail loss probe is due on expiry
+ *
+ * Returned Value:
+ *   None
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_TCP_RACK
+void tcp_rack_settimer(FAR struct tcp_conn_s *conn, uint32_t timeout,
+                       bool probe)
+{
+  conn->rack_probe = probe;
+
+  if (timeout > 0)
+    {
+      conn->rack_armed = true;
+      work_queue(LPWORK, &conn->rackwork, tcp_rack_expiry,
+                 conn, MSEC2TICK(timeout));
+    }
+  else
+    {
+      conn->rack_armed = false;
+      work_cancel(LPWORK, &conn->rackwork);
+    }
+}
+#endif
 
 /****************************************************************************
  * Name: tcp_set_zero_probe
@@ -534,12 +717,7 @@ void tcp_timer(FAR struct net_driver_s *dev, FAR struct tcp_conn_s *conn)
 
                   /* Find the listener for this connection. */
 
-#if defined(CONFIG_NET_IPv4) && defined(CONFIG_NET_IPv6)
-                  listener = tcp_findlistener(&conn->u, conn->lport,
-                                              conn->domain);
-#else
-                  listener = tcp_findlistener(&conn->u, conn->lport);
-#endif
+                  listener = tcp_connlistener(conn);
                   if (listener != NULL)
                     {
                       /* We call tcp_callback() for the connection with
@@ -652,22 +830,9 @@ void tcp_timer(FAR struct net_driver_s *dev, FAR struct tcp_conn_s *conn)
                     tcp_rexmit(dev, conn, result);
 
 #ifdef CONFIG_NET_TCP_CC_NEWRENO
-                    /* If conn is TCP_INFR, it should enter to slow start */
-
-                    if (conn->flags & TCP_INFR)
-                      {
-                        conn->flags &= ~TCP_INFR;
-                      }
-
-                    /* update the max_cwnd */
-
-                    conn->max_cwnd = (conn->max_cwnd + 7 * conn->cwnd) >> 3;
-
-                    /* reset cwnd and ssthresh, refers to RFC5861. */
+                    /* Collapse the congestion window, refers to RFC5861 */
 
-                    conn->ssthresh =
-                                    MAX(conn->tx_unacked / 2, 2 * conn->mss);
-                    conn->cwnd = conn->mss;
+                    tcp_cc_timeout(conn);
 #endif
                     goto done;
 
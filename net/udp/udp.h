@@ -60,6 +60,16 @@
 #  endif
 #endif
 
+/* With write buffering, the checksum of the payload is calculated while it
+ * is copied in from the user buffer, so that only the headers are summed
+ * when the datagram is sent.
+ */
+
+#if defined(CONFIG_NET_UDP_WRITE_BUFFERS) && \
+    defined(CONFIG_NET_UDP_CHECKSUMS) && !defined(CONFIG_NET_ARCH_CHKSUM)
+#  define UDP_COPYIN_CHKSUM 1
+#endif
+
 /* Allocate a new UDP data callback */
 
 #define udp_callback_alloc(dev,conn) \
@@ -111,6 +121,9 @@ struct udp_conn_s
   /* UDP-specific content follows */
 
   union ip_binding_u u;   /* IP address binding */
+#ifdef CONFIG_NET_UDP_HASH
+  FAR struct udp_conn_s *hash; /* Next in the local port hash chain */
+#endif
   uint16_t lport;         /* Bound local port number (network byte order) */
   uint16_t rport;         /* Remote port number (network byte order) */
   uint8_t  flags;         /* See _UDP_FLAG_* definitions */
@@ -127,6 +140,8 @@ struct udp_conn_s
 #ifdef CONFIG_NETDEV_RSS
   int      rcvcpu;        /* Last recvfrom cpuid */
 #endif
+  mutex_t  lock;          /* Protects readahead, see udp_conn_lock() */
+
   /* Read-ahead buffering.
    *
    *   readahead - An IOB chain where the UDP/IP read-ahead data is retained.
@@ -149,6 +164,11 @@ struct udp_conn_s
   FAR struct devif_callback_s *sndcb;
 #endif
 
+#ifdef UDP_COPYIN_CHKSUM
+  uint16_t sndchksum;             /* Payload checksum of the datagram in
+                                   * d_iob, or 0 to recalculate it */
+#endif
+
 #if defined(CONFIG_NET_IGMP) || defined(CONFIG_NET_MLD)
   struct ip_mreqn mreq;
 #endif
@@ -162,6 +182,10 @@ struct udp_conn_s
 #ifdef CONFIG_NET_TIMESTAMP
   int timestamp; /* Nonzero when SO_TIMESTAMP is enabled */
 #endif
+
+#ifdef CONFIG_NET_UDP_SEGMENT
+  uint16_t gso_size;              /* UDP_SEGMENT payload size, 0: disabled */
+#endif
 };
 
 /* This structure supports UDP write buffering.  It is simply a container
@@ -174,6 +198,9 @@ struct udp_wrbuffer_s
   sq_entry_t wb_node;              /* Supports a singly linked list */
   struct sockaddr_storage wb_dest; /* Destination address */
   FAR struct iob_s *wb_iob;        /* Head of the I/O buffer chain */
+#ifdef UDP_COPYIN_CHKSUM
+  uint16_t wb_chksum;              /* Checksum of the payload */
+#endif
 };
 #endif
 
@@ -234,6 +261,45 @@ FAR struct udp_conn_s *udp_alloc(uint8_t domain);
 
 void udp_free(FAR struct udp_conn_s *conn);
 
+/****************************************************************************
+ * Name: udp_conn_lock
+ *
+ * Description:
+ *   Take the per-connection lock.  The lock protects the read-ahead
+ *   buffers shared between the socket interface and the network input
+ *   path, so the socket interface can access them without taking the
+ *   global network lock.
+ *
+ *   The lock order is: net_lock() first, then udp_conn_lock().  The
+ *   connection lock is a leaf lock, it must not be held while waiting for
+ *   the network events or taking the network lock.
+ *
+ * Input Parameters:
+ *   conn - The UDP connection structure to lock
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+void udp_conn_lock(FAR struct udp_conn_s *conn);
+
+/****************************************************************************
+ * Name: udp_conn_unlock
+ *
+ * Description:
+ *   Release the per-connection lock.
+ *
+ * Input Parameters:
+ *   conn - The UDP connection structure to unlock
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+void udp_conn_unlock(FAR struct udp_conn_s *conn);
+
 /****************************************************************************
  * Name: udp_active
  *
@@ -250,6 +316,25 @@ FAR struct udp_conn_s *udp_active(FAR struct net_driver_s *dev,
                                   FAR struct udp_conn_s *conn,
                                   FAR struct udp_hdr_s *udp);
 
+/****************************************************************************
+ * Name: udp_reuseport_select
+ *
+ * Description:
+ *   'conn' is the first connection returned by udp_active() for a unicast
+ *   datagram.  If it belongs to a SO_REUSEPORT group, select the member of
+ *   the group that owns the flow of the datagram.
+ *
+ * Assumptions:
+ *   Called from network stack logic with the network stack locked
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_REUSEPORT
+FAR struct udp_conn_s *udp_reuseport_select(FAR struct net_driver_s *dev,
+                                            FAR struct udp_conn_s *conn,
+                                            FAR struct udp_hdr_s *udp);
+#endif
+
 /****************************************************************************
  * Name: udp_nextconn
  *
@@ -282,6 +367,23 @@ FAR struct udp_conn_s *udp_nextconn(FAR struct udp_conn_s *conn);
 
 uint16_t udp_select_port(uint8_t domain, FAR union ip_binding_u *u);
 
+/****************************************************************************
+ * Name: udp_setport
+ *
+ * Description:
+ *   Set the local port number (network byte order) of a UDP connection.
+ *   Zero unbinds the connection.  With CONFIG_NET_UDP_HASH, this also moves
+ *   the connection to the matching bucket of the port hash table, so the
+ *   lport field must not be assigned directly.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_UDP_HASH
+void udp_setport(FAR struct udp_conn_s *conn, uint16_t portno);
+#else
+#  define udp_setport(conn, portno) ((conn)->lport = (portno))
+#endif
+
 /****************************************************************************
  * Name: udp_bind
  *
@@ -480,6 +582,32 @@ int udp_setsockopt(FAR struct socket *psock, int option,
                    FAR const void *value, socklen_t value_len);
 #endif
 
+/****************************************************************************
+ * Name: udp_getsockopt
+ *
+ * Description:
+ *   udp_getsockopt() retrieves the value for the UDP-protocol option
+ *   specified by the 'option' argument for the socket specified by the
+ *   'psock' argument.
+ *
+ * Input Parameters:
+ *   psock     Socket structure of the socket to query
+ *   option    identifies the option to get
+ *   value     Points to the argument value
+ *   value_len The length of the argument value
+ *
+ * Returned Value:
+ *   Returns zero (OK) on success.  On failure, it returns a negated errno
+ *   value to indicate the nature of the error.  See psock_getsockopt() for
+ *   the complete list of appropriate return error codes.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_UDPPROTO_OPTIONS
+int udp_getsockopt(FAR struct socket *psock, int option,
+                   FAR void *value, FAR socklen_t *value_len);
+#endif
+
 /****************************************************************************
  * Name: udp_wrbuffer_alloc
  *
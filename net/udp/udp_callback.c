@@ -79,14 +79,18 @@ static uint16_t udp_datahandler(FAR struct net_driver_s *dev,
   int offset;
 
 #if CONFIG_NET_RECV_BUFSIZE > 0
+  udp_conn_lock(conn);
   if (conn->readahead && conn->readahead->io_pktlen > conn->rcvbufs)
     {
+      udp_conn_unlock(conn);
       netdev_iob_release(dev);
 #ifdef CONFIG_NET_STATISTICS
       g_netstats.udp.drop++;
 #endif
       return 0;
     }
+
+  udp_conn_unlock(conn);
 #endif
 
   iob = dev->d_iob;
@@ -214,9 +218,13 @@ static uint16_t udp_datahandler(FAR struct net_driver_s *dev,
   DEBUGASSERT(iob->io_offset + offset >= 0);
   iob_reserve(iob, iob->io_offset + offset);
 
-  /* Concat the iob to readahead */
+  /* Concat the iob to readahead, the receiver may consume the read-ahead
+   * buffers with only the connection locked.
+   */
 
+  udp_conn_lock(conn);
   net_iob_concat(&conn->readahead, &iob);
+  udp_conn_unlock(conn);
 
 #ifdef CONFIG_NET_UDP_NOTIFIER
   ninfo("Buffered %d bytes\n", buflen);
@@ -82,6 +82,15 @@
 #  define CONFIG_NET_UDP_MAX_CONNS 0
 #endif
 
+#ifdef CONFIG_NET_UDP_HASH
+#  if (CONFIG_NET_UDP_HASH_SIZE & (CONFIG_NET_UDP_HASH_SIZE - 1)) != 0
+#    error CONFIG_NET_UDP_HASH_SIZE must be a power of two
+#  endif
+#  define UDP_HASH_MASK       (CONFIG_NET_UDP_HASH_SIZE - 1)
+#  define udp_porthash(port) \
+     ((((uint32_t)(port) * 0x9e3779b1u) >> 16) & UDP_HASH_MASK)
+#endif
+
 /****************************************************************************
  * Private Data
  ****************************************************************************/
@@ -97,10 +106,40 @@ static mutex_t g_free_lock = NXMUTEX_INITIALIZER;
 
 static dq_queue_t g_active_udp_connections;
 
+#ifdef CONFIG_NET_UDP_HASH
+/* The bound UDP connections hashed by local port.  Each chain is kept in
+ * bind order.
+ */
+
+static FAR struct udp_conn_s *g_udp_hash[CONFIG_NET_UDP_HASH_SIZE];
+#endif
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
 
+/****************************************************************************
+ * Name: udp_portconn
+ *
+ * Description:
+ *   Return the connection after 'conn' (or the first one if 'conn' is NULL)
+ *   that may be bound to the local port 'portno'.
+ *
+ * Assumptions:
+ *   This function must be called with the network locked.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_UDP_HASH
+static inline FAR struct udp_conn_s *
+udp_portconn(FAR struct udp_conn_s *conn, uint16_t portno)
+{
+  return conn == NULL ? g_udp_hash[udp_porthash(portno)] : conn->hash;
+}
+#else
+#  define udp_portconn(conn, portno) udp_nextconn(conn)
+#endif
+
 /****************************************************************************
  * Name: udp_find_conn()
  *
@@ -113,6 +152,7 @@ static dq_queue_t g_active_udp_connections;
  *   portno - The port to use in the lookup
  *   opt    - The option from another conn to match the conflict conn
  *              SO_REUSEADDR: If both sockets have this, they never confilct.
+ *              SO_REUSEPORT: Likewise, the sockets share the port.
  *
  * Assumptions:
  *   This function must be called with the network locked.
@@ -127,10 +167,13 @@ static FAR struct udp_conn_s *udp_find_conn(uint8_t domain,
 #ifdef CONFIG_NET_SOCKOPTS
   bool skip_reusable = _SO_GETOPT(opt, SO_REUSEADDR);
 #endif
+#ifdef CONFIG_NET_REUSEPORT
+  bool skip_reuseport = _SO_GETOPT(opt, SO_REUSEPORT);
+#endif
 
   /* Now search each connection structure. */
 
-  while ((conn = udp_nextconn(conn)) != NULL)
+  while ((conn = udp_portconn(conn, portno)) != NULL)
     {
       /* With SO_REUSEADDR set for both sockets, we do not need to check its
        * address and port.
@@ -143,6 +186,15 @@ static FAR struct udp_conn_s *udp_find_conn(uint8_t domain,
         }
 #endif
 
+      /* Sockets that all set SO_REUSEPORT may share the port */
+
+#ifdef CONFIG_NET_REUSEPORT
+      if (skip_reuseport && _SO_GETOPT(conn->sconn.s_options, SO_REUSEPORT))
+        {
+          continue;
+        }
+#endif
+
       /* If the port local port number assigned to the connections matches
        * AND the IP address of the connection matches, then return a
        * reference to the connection structure.  INADDR_ANY is a special
@@ -203,7 +255,7 @@ udp_ipv4_active(FAR struct net_driver_s *dev, FAR struct udp_conn_s *conn,
 #endif
   FAR struct ipv4_hdr_s *ip = IPv4BUF;
 
-  conn = udp_nextconn(conn);
+  conn = udp_portconn(conn, udp->destport);
 
   while (conn)
     {
@@ -317,7 +369,7 @@ udp_ipv4_active(FAR struct net_driver_s *dev, FAR struct udp_conn_s *conn,
 
       /* Look at the next active connection */
 
-      conn = (FAR struct udp_conn_s *)conn->sconn.node.flink;
+      conn = udp_portconn(conn, udp->destport);
     }
 
   return conn;
@@ -343,7 +395,7 @@ udp_ipv6_active(FAR struct net_driver_s *dev, FAR struct udp_conn_s *conn,
 {
   FAR struct ipv6_hdr_s *ip = IPv6BUF;
 
-  conn = udp_nextconn(conn);
+  conn = udp_portconn(conn, udp->destport);
 
   while (conn != NULL)
     {
@@ -457,7 +509,7 @@ udp_ipv6_active(FAR struct net_driver_s *dev, FAR struct udp_conn_s *conn,
 
       /* Look at the next active connection */
 
-      conn = (FAR struct udp_conn_s *)conn->sconn.node.flink;
+      conn = udp_portconn(conn, udp->destport);
     }
 
   return conn;
@@ -538,6 +590,58 @@ errout:
   return portno;
 }
 
+/****************************************************************************
+ * Name: udp_setport
+ *
+ * Description:
+ *   Set the local port number (network byte order) of a UDP connection and
+ *   move the connection to the matching bucket of the port hash table.
+ *   Zero unbinds the connection.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_UDP_HASH
+void udp_setport(FAR struct udp_conn_s *conn, uint16_t portno)
+{
+  FAR struct udp_conn_s **curr;
+
+  net_lock();
+
+  if (conn->lport != 0)
+    {
+      for (curr = &g_udp_hash[udp_porthash(conn->lport)]; *curr != NULL;
+           curr = &(*curr)->hash)
+        {
+          if (*curr == conn)
+            {
+              *curr = conn->hash;
+              break;
+            }
+        }
+    }
+
+  conn->lport = portno;
+
+  if (portno != 0)
+    {
+      /* Append, so that datagrams are offered to the connections bound to
+       * the same port in the order in which they were bound.
+       */
+
+      curr = &g_udp_hash[udp_porthash(portno)];
+      while (*curr != NULL)
+        {
+          curr = &(*curr)->hash;
+        }
+
+      conn->hash = NULL;
+      *curr      = conn;
+    }
+
+  net_unlock();
+}
+#endif
+
 /****************************************************************************
  * Name: udp_initialize
  *
@@ -574,6 +678,7 @@ FAR struct udp_conn_s *udp_alloc(uint8_t domain)
     {
       /* Make sure that the connection is marked as uninitialized */
 
+      nxmutex_init(&conn->lock);
       conn->sconn.s_ttl = IP_TTL_DEFAULT;
       conn->flags       = 0;
 #if defined(CONFIG_NET_IPv4) || defined(CONFIG_NET_IPv6)
@@ -622,16 +727,21 @@ void udp_free(FAR struct udp_conn_s *conn)
 
   DEBUGASSERT(conn->crefs == 0);
 
+  udp_setport(conn, 0);
   nxmutex_lock(&g_free_lock);
-  conn->lport = 0;
 
   /* Remove the connection from the active list */
 
   dq_rem(&conn->sconn.node, &g_active_udp_connections);
 
-  /* Release any read-ahead buffers attached to the connection, NULL is ok */
+  /* Release any read-ahead buffers attached to the connection, NULL is ok.
+   * The read-ahead queue is only accessed with the connection locked.
+   */
 
+  udp_conn_lock(conn);
   iob_free_chain(conn->readahead);
+  conn->readahead = NULL;
+  udp_conn_unlock(conn);
 
 #ifdef CONFIG_NET_UDP_WRITE_BUFFERS
   /* Release any write buffers attached to the connection */
@@ -652,11 +762,40 @@ void udp_free(FAR struct udp_conn_s *conn)
 
   /* Free the connection. */
 
+  nxmutex_destroy(&conn->lock);
   NET_BUFPOOL_FREE(g_udp_connections, conn);
 
   nxmutex_unlock(&g_free_lock);
 }
 
+/****************************************************************************
+ * Name: udp_conn_lock
+ *
+ * Description:
+ *   Take the per-connection lock
+ *
+ ****************************************************************************/
+
+void udp_conn_lock(FAR struct udp_conn_s *conn)
+{
+  DEBUGASSERT(conn != NULL);
+  nxmutex_lock(&conn->lock);
+}
+
+/****************************************************************************
+ * Name: udp_conn_unlock
+ *
+ * Description:
+ *   Release the per-connection lock
+ *
+ ****************************************************************************/
+
+void udp_conn_unlock(FAR struct udp_conn_s *conn)
+{
+  DEBUGASSERT(conn != NULL);
+  nxmutex_unlock(&conn->lock);
+}
+
 /****************************************************************************
  * Name: udp_active
  *
@@ -692,6 +831,93 @@ FAR struct udp_conn_s *udp_active(FAR struct net_driver_s *dev,
 #endif /* CONFIG_NET_IPv4 */
 }
 
+/****************************************************************************
+ * Name: udp_reuseport_select
+ *
+ * Description:
+ *   'conn' is the first connection returned by udp_active() for a unicast
+ *   datagram.  If it belongs to a SO_REUSEPORT group, select the member of
+ *   the group that owns the flow of the datagram.  A flow always maps to
+ *   the same member as long as the group does not change.
+ *
+ * Assumptions:
+ *   This function must be called with the network locked.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_REUSEPORT
+FAR struct udp_conn_s *udp_reuseport_select(FAR struct net_driver_s *dev,
+                                            FAR struct udp_conn_s *conn,
+                                            FAR struct udp_hdr_s *udp)
+{
+  FAR struct udp_conn_s *member;
+  FAR const void *srcaddr;
+  unsigned int nmembers = 0;
+  unsigned int index;
+  uint32_t hash;
+  uint8_t domain;
+
+  /* A connected socket is an exact match for the flow, keep it */
+
+  if (_UDP_ISCONNECTMODE(conn->flags) ||
+      !_SO_GETOPT(conn->sconn.s_options, SO_REUSEPORT))
+    {
+      return conn;
+    }
+
+  /* Count the unconnected SO_REUSEPORT sockets that accept the datagram */
+
+  for (member = conn; member != NULL; member = udp_active(dev, member, udp))
+    {
+      if (!_UDP_ISCONNECTMODE(member->flags) &&
+          _SO_GETOPT(member->sconn.s_options, SO_REUSEPORT))
+        {
+          nmembers++;
+        }
+    }
+
+  if (nmembers <= 1)
+    {
+      return conn;
+    }
+
+#ifdef CONFIG_NET_IPv6
+#ifdef CONFIG_NET_IPv4
+  if (IFF_IS_IPv6(dev->d_flags))
+#endif
+    {
+      domain  = PF_INET6;
+      srcaddr = IPv6BUF->srcipaddr;
+    }
+#endif /* CONFIG_NET_IPv6 */
+
+#ifdef CONFIG_NET_IPv4
+#ifdef CONFIG_NET_IPv6
+  else
+#endif
+    {
+      domain  = PF_INET;
+      srcaddr = IPv4BUF->srcipaddr;
+    }
+#endif /* CONFIG_NET_IPv4 */
+
+  hash  = net_flowhash(domain, srcaddr, udp->srcport, udp->destport);
+  index = net_flowhash_scale(hash, nmembers);
+
+  for (member = conn; member != NULL; member = udp_active(dev, member, udp))
+    {
+      if (!_UDP_ISCONNECTMODE(member->flags) &&
+          _SO_GETOPT(member->sconn.s_options, SO_REUSEPORT) &&
+          index-- == 0)
+        {
+          return member;
+        }
+    }
+
+  return conn;
+}
+#endif /* CONFIG_NET_REUSEPORT */
+
 /****************************************************************************
  * Name: udp_nextconn
  *
@@ -852,7 +1078,7 @@ int udp_bind(FAR struct udp_conn_s *conn, FAR const struct sockaddr *addr)
         }
       else
         {
-          conn->lport = portno;
+          udp_setport(conn, portno);
           ret         = OK;
         }
     }
@@ -877,7 +1103,7 @@ int udp_bind(FAR struct udp_conn_s *conn, FAR const struct sockaddr *addr)
         {
           /* No.. then bind the socket to the port */
 
-          conn->lport = portno;
+          udp_setport(conn, portno);
           ret         = OK;
         }
       else
@@ -929,7 +1155,7 @@ int udp_connect(FAR struct udp_conn_s *conn, FAR const struct sockaddr *addr)
        * connection structure.
        */
 
-      conn->lport = HTONS(udp_select_port(conn->domain, &conn->u));
+      udp_setport(conn, HTONS(udp_select_port(conn->domain, &conn->u)));
       if (!conn->lport)
         {
           nerr("ERROR: Failed to get a local port!\n");
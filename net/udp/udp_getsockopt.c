@@ -0,0 +1,123 @@
+/****************************************************************************
+ * net/udp/udp_getsockopt.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <errno.h>
+#include <assert.h>
+#include <debug.h>
+
+#include <net/if.h>
+#include <netinet/udp.h>
+
+#include <nuttx/net/net.h>
+#include <nuttx/net/netdev.h>
+#include <nuttx/net/udp.h>
+
+#include "socket/socket.h"
+#include "utils/utils.h"
+#include "netdev/netdev.h"
+#include "udp/udp.h"
+
+#ifdef CONFIG_NET_UDPPROTO_OPTIONS
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: udp_getsockopt
+ *
+ * Description:
+ *   udp_getsockopt() retrieves the value for the UDP-protocol option
+ *   specified by the 'option' argument for the socket specified by the
+ *   'psock' argument.  If the size of the option value is greater than
+ *   'value_len', the value stored in the object pointed to by the 'value'
+ *   argument will be silently truncated. Otherwise, the length pointed to
+ *   by the 'value_len' argument will be modified to indicate the actual
+ *   length of the 'value'.
+ *
+ *   See <netinet/udp.h> for the a complete list of values of UDP protocol
+ *   options.
+ *
+ * Input Parameters:
+ *   psock     Socket structure of the socket to query
+ *   option    identifies the option to get
+ *   value     Points to the argument value
+ *   value_len The length of the argument value
+ *
+ * Returned Value:
+ *   Returns zero (OK) on success.  On failure, it returns a negated errno
+ *   value to indicate the nature of the error.  See psock_getsockopt() for
+ *   the complete list of appropriate return error codes.
+ *
+ ****************************************************************************/
+
+int udp_getsockopt(FAR struct socket *psock, int option,
+                   FAR void *value, FAR socklen_t *value_len)
+{
+  FAR struct udp_conn_s *conn = psock->s_conn;
+  int ret;
+
+  DEBUGASSERT(value != NULL && value_len != NULL);
+
+  if (psock->s_type != SOCK_DGRAM)
+    {
+      nerr("ERROR:  Not a UDP socket\n");
+      return -ENOTCONN;
+    }
+
+  switch (option)
+    {
+#ifdef CONFIG_NET_UDP_SEGMENT
+      case UDP_SEGMENT:
+        if (*value_len < sizeof(int))
+          {
+            ret = -EINVAL;
+          }
+        else
+          {
+            FAR int *segsize = (FAR int *)value;
+
+            *segsize   = conn->gso_size;
+            *value_len = sizeof(int);
+            ret        = OK;
+          }
+        break;
+#endif
+
+      default:
+        nerr("ERROR: Unrecognized UDP option: %d\n", option);
+        ret = -ENOPROTOOPT;
+        break;
+    }
+
+  UNUSED(conn);
+  return ret;
+}
+
+#endif /* CONFIG_NET_UDPPROTO_OPTIONS */
@@ -114,6 +114,7 @@ int udp_ioctl(FAR struct udp_conn_s *conn, int cmd, unsigned long arg)
   int ret = OK;
 
   net_lock();
+  udp_conn_lock(conn);
 
   switch (cmd)
     {
@@ -151,6 +152,7 @@ int udp_ioctl(FAR struct udp_conn_s *conn, int cmd, unsigned long arg)
         break;
     }
 
+  udp_conn_unlock(conn);
   net_unlock();
 
   return ret;
@@ -632,6 +632,7 @@ static void udp_notify_recvcpu(FAR struct udp_conn_s *conn)
   cpu = this_cpu();
   if (cpu != conn->rcvcpu)
     {
+      net_lock();
       if (conn->domain == PF_INET)
         {
           netdev_notify_recvcpu(conn->dev, cpu, conn->domain,
@@ -646,6 +647,7 @@ static void udp_notify_recvcpu(FAR struct udp_conn_s *conn)
         }
 
       conn->rcvcpu = cpu;
+      net_unlock();
     }
 
   return;
@@ -687,16 +689,16 @@ ssize_t psock_udp_recvfrom(FAR struct socket *psock, FAR struct msghdr *msg,
 
   /* Perform the UDP recvfrom() operation */
 
-  /* Initialize the state structure.  This is done with the network locked
-   * because we don't want anything to happen until we are ready.
-   */
-
-  net_lock();
   udp_recvfrom_initialize(conn, msg, &state, flags);
 
-  /* Copy the read-ahead data from the packet */
+  /* Copy the read-ahead data from the packet.  The read-ahead buffers are
+   * protected by the connection lock, so the datagram already buffered is
+   * received without taking the network lock.
+   */
 
+  udp_conn_lock(conn);
   udp_readahead(&state);
+  udp_conn_unlock(conn);
 
   /* The default return value is the number of bytes that we just copied
    * into the user buffer.  We will return this if the socket has become
@@ -732,61 +734,75 @@ ssize_t psock_udp_recvfrom(FAR struct socket *psock, FAR struct msghdr *msg,
 
   else if (state.ir_recvlen <= 0)
     {
-      /* Get the device that will handle the packet transfers.  This may be
-       * NULL if the UDP socket is bound to INADDR_ANY.  In that case, no
-       * NETDEV_DOWN notifications will be received.
+      /* Set up the wait with the network locked because we don't want
+       * anything to happen until we are ready.  A datagram may have been
+       * buffered before the network is locked, so check again.
        */
 
-      dev = udp_find_laddr_device(conn);
+      net_lock();
+      udp_conn_lock(conn);
+      udp_readahead(&state);
+      udp_conn_unlock(conn);
 
-      /* Set up the callback in the connection */
-
-      state.ir_cb = udp_callback_alloc(dev, conn);
-      if (state.ir_cb)
+      ret = state.ir_recvlen;
+      if (ret <= 0)
         {
-          /* Set up the callback in the connection */
-
-          state.ir_cb->flags = (UDP_NEWDATA | NETDEV_DOWN);
-          state.ir_cb->priv  = (FAR void *)&state;
-          state.ir_cb->event = udp_eventhandler;
-
-          /* Push a cancellation point onto the stack.  This will be
-           * called if the thread is canceled.
+          /* Get the device that will handle the packet transfers.  This may
+           * be NULL if the UDP socket is bound to INADDR_ANY.  In that case,
+           * no NETDEV_DOWN notifications will be received.
            */
 
-          info.dev  = dev;
-          info.conn = conn;
-          info.udp_cb = state.ir_cb;
-          info.sem = &state.ir_sem;
-          tls_cleanup_push(tls_get_info(), udp_callback_cleanup, &info);
+          dev = udp_find_laddr_device(conn);
 
-          /* Wait for either the receive to complete or for an error/timeout
-           * to occur.  net_sem_timedwait will also terminate if a signal is
-           * received.
-           */
+          /* Set up the callback in the connection */
 
-          ret = net_sem_timedwait(&state.ir_sem,
-                              _SO_TIMEOUT(conn->sconn.s_rcvtimeo));
-          tls_cleanup_pop(tls_get_info(), 0);
-          if (ret == -ETIMEDOUT)
+          state.ir_cb = udp_callback_alloc(dev, conn);
+          if (state.ir_cb)
             {
-              ret = -EAGAIN;
+              /* Set up the callback in the connection */
+
+              state.ir_cb->flags = (UDP_NEWDATA | NETDEV_DOWN);
+              state.ir_cb->priv  = (FAR void *)&state;
+              state.ir_cb->event = udp_eventhandler;
+
+              /* Push a cancellation point onto the stack.  This will be
+               * called if the thread is canceled.
+               */
+
+              info.dev  = dev;
+              info.conn = conn;
+              info.udp_cb = state.ir_cb;
+              info.sem = &state.ir_sem;
+              tls_cleanup_push(tls_get_info(), udp_callback_cleanup, &info);
+
+              /* Wait for either the receive to complete or for an
+               * error/timeout to occur.  net_sem_timedwait will also
+               * terminate if a signal is received.
+               */
+
+              ret = net_sem_timedwait(&state.ir_sem,
+                                  _SO_TIMEOUT(conn->sconn.s_rcvtimeo));
+              tls_cleanup_pop(tls_get_info(), 0);
+              if (ret == -ETIMEDOUT)
+                {
+                  ret = -EAGAIN;
+                }
+
+              /* Make sure that no further events are processed */
+
+              udp_callback_free(dev, conn, state.ir_cb);
+              ret = udp_recvfrom_result(ret, &state);
+            }
+          else
+            {
+              ret = -EBUSY;
             }
-
-          /* Make sure that no further events are processed */
-
-          udp_callback_free(dev, conn, state.ir_cb);
-          ret = udp_recvfrom_result(ret, &state);
-        }
-      else
-        {
-          ret = -EBUSY;
         }
+
+      net_unlock();
     }
 
   udp_notify_recvcpu(conn);
-
-  net_unlock();
   udp_recvfrom_uninitialize(&state);
   return ret;
 }
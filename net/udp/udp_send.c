@@ -121,6 +121,59 @@ static void udp_send_loopback(FAR struct net_driver_s *dev)
 }
 #endif
 
+/****************************************************************************
+ * Name: udp_copyin_chksum
+ *
+ * Description:
+ *   Calculate the UDP checksum from the pseudo and UDP headers and the
+ *   payload checksum that was calculated when the payload was copied into
+ *   the write buffer.
+ *
+ * Input Parameters:
+ *   dev     - The device driver structure to use in the send operation
+ *   udp     - The UDP header, with the checksum field cleared
+ *   payload - The checksum of the payload, in host byte order
+ *
+ * Returned Value:
+ *   The calculated checksum, as returned by udp_ipv4_chksum()
+ *
+ ****************************************************************************/
+
+#ifdef UDP_COPYIN_CHKSUM
+static uint16_t udp_copyin_chksum(FAR struct net_driver_s *dev,
+                                  FAR struct udp_hdr_s *udp,
+                                  uint16_t payload)
+{
+  uint32_t sum = 0;
+
+#ifdef CONFIG_NET_IPv4
+#ifdef CONFIG_NET_IPv6
+  if (IFF_IS_IPv4(dev->d_flags))
+#endif
+    {
+      sum = ipv4_upperlayer_header_chksum(dev, IP_PROTO_UDP);
+    }
+#endif /* CONFIG_NET_IPv4 */
+
+#ifdef CONFIG_NET_IPv6
+#ifdef CONFIG_NET_IPv4
+  else
+#endif
+    {
+      sum = ipv6_upperlayer_header_chksum(dev, IP_PROTO_UDP, IPv6_HDRLEN);
+    }
+#endif /* CONFIG_NET_IPv6 */
+
+  /* The UDP header is of even length, so the payload sum just adds on */
+
+  sum  = chksum(sum, (FAR uint8_t *)udp, UDP_HDRLEN);
+  sum += payload;
+  sum  = (sum & 0xffff) + (sum >> 16);
+
+  return (sum == 0) ? 0xffff : HTONS(sum);
+}
+#endif
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -250,6 +303,14 @@ void udp_send(FAR struct net_driver_s *dev, FAR struct udp_conn_s *conn)
 #ifdef CONFIG_NET_UDP_CHECKSUMS
       /* Calculate UDP checksum. */
 
+#ifdef UDP_COPYIN_CHKSUM
+      if (conn->sndchksum != 0)
+        {
+          udp->udpchksum  = ~udp_copyin_chksum(dev, udp, conn->sndchksum);
+          conn->sndchksum = 0;
+        }
+      else
+#endif
 #ifdef CONFIG_NET_IPv4
 #ifdef CONFIG_NET_IPv6
       if (IFF_IS_IPv4(dev->d_flags))
@@ -37,6 +37,7 @@
 #endif
 
 #include <sys/types.h>
+#include <sys/param.h>
 #include <sys/socket.h>
 
 #include <stdint.h>
@@ -85,6 +86,10 @@
 #  define UDP_WBDUMP(msg,wrb,len,offset)
 #endif
 
+/* Maximum number of datagrams a single UDP_SEGMENT send may produce */
+
+#define UDP_MAX_SEGMENTS 64
+
 /****************************************************************************
  * Private Function Prototypes
  ****************************************************************************/
@@ -258,7 +263,7 @@ static int sendto_next_transfer(FAR struct udp_conn_s *conn)
        * connection structure.
        */
 
-      conn->lport = HTONS(udp_select_port(conn->domain, &conn->u));
+      udp_setport(conn, HTONS(udp_select_port(conn->domain, &conn->u)));
       if (!conn->lport)
         {
           nerr("ERROR: Failed to get a local port!\n");
@@ -451,6 +456,10 @@ static uint16_t sendto_eventhandler(FAR struct net_driver_s *dev,
       dev->d_sndlen = wrb->wb_iob->io_pktlen - udpiplen;
       ninfo("wrb=%p sndlen=%d\n", wrb, dev->d_sndlen);
 
+#ifdef UDP_COPYIN_CHKSUM
+      conn->sndchksum = wrb->wb_chksum;
+#endif
+
       /* Do not need to release wb_iob, the life cycle of wb_iob is
        * handed over to the network device
        */
@@ -513,6 +522,363 @@ static unsigned int udp_send_gettimeout(clock_t start, unsigned int timeout)
   return timeout;
 }
 
+/****************************************************************************
+ * Name: udp_sendto_wait
+ *
+ * Description:
+ *   Wait until 'len' more bytes fit into the send buffer of the
+ *   connection.
+ *
+ * Assumptions:
+ *   Called with the network locked.
+ *
+ ****************************************************************************/
+
+static int udp_sendto_wait(FAR struct udp_conn_s *conn, size_t len,
+                           bool nonblock, clock_t start,
+                           unsigned int timeout)
+{
+#if CONFIG_NET_SEND_BUFSIZE > 0
+  int ret;
+
+  /* If the send buffer size exceeds the send limit,
+   * wait for the write buffer to be released
+   */
+
+  while (udp_wrbuffer_inqueue_size(conn) + len > conn->sndbufs)
+    {
+      if (nonblock)
+        {
+          return -EAGAIN;
+        }
+
+      ret = net_sem_timedwait_uninterruptible(&conn->sndsem,
+        udp_send_gettimeout(start, timeout));
+      if (ret < 0)
+        {
+          return ret == -ETIMEDOUT ? -EAGAIN : ret;
+        }
+    }
+#endif /* CONFIG_NET_SEND_BUFSIZE */
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: udp_sendto_prepare
+ *
+ * Description:
+ *   Allocate a write buffer for one datagram, address it and copy the
+ *   payload into it.  The buffer is not queued yet.
+ *
+ * Returned Value:
+ *   Zero with the buffer in *pwrb on success; a negated errno value with
+ *   nothing allocated on failure.
+ *
+ * Assumptions:
+ *   Called with the network locked.  Careful, the network will be
+ *   momentarily unlocked here.
+ *
+ ****************************************************************************/
+
+static int udp_sendto_prepare(FAR struct udp_conn_s *conn,
+                              FAR const void *buf, size_t len,
+                              FAR const struct sockaddr *to,
+                              socklen_t tolen, bool nonblock,
+                              clock_t start, unsigned int timeout,
+                              FAR struct udp_wrbuffer_s **pwrb)
+{
+  FAR struct udp_wrbuffer_s *wrb;
+  uint16_t udpiplen;
+  int ret;
+
+  /* Allocate a write buffer */
+
+#ifdef CONFIG_NET_JUMBO_FRAME
+
+  /* alloc iob of gso pkt for udp data */
+
+  wrb = udp_wrbuffer_tryalloc(len + udpip_hdrsize(conn) +
+                              CONFIG_NET_LL_GUARDSIZE);
+#else
+  if (nonblock)
+    {
+      wrb = udp_wrbuffer_tryalloc();
+    }
+  else
+    {
+      wrb = udp_wrbuffer_timedalloc(udp_send_gettimeout(start, timeout));
+    }
+#endif
+
+  if (wrb == NULL)
+    {
+      /* A buffer allocation error occurred */
+
+      nerr("ERROR: Failed to allocate write buffer\n");
+      return nonblock || timeout != UINT_MAX ? -EAGAIN : -ENOMEM;
+    }
+
+  /* Initialize the write buffer
+   *
+   * Check if the socket is connected
+   */
+
+  if (_SS_ISCONNECTED(conn->sconn.s_flags))
+    {
+      /* Yes.. get the connection address from the connection structure */
+
+#ifdef CONFIG_NET_IPv4
+#ifdef CONFIG_NET_IPv6
+      if (conn->domain == PF_INET)
+#endif
+        {
+          FAR struct sockaddr_in *addr4 =
+            (FAR struct sockaddr_in *)&wrb->wb_dest;
+
+          addr4->sin_family = AF_INET;
+          addr4->sin_port   = conn->rport;
+          net_ipv4addr_copy(addr4->sin_addr.s_addr, conn->u.ipv4.raddr);
+          memset(addr4->sin_zero, 0, sizeof(addr4->sin_zero));
+        }
+#endif /* CONFIG_NET_IPv4 */
+
+#ifdef CONFIG_NET_IPv6
+#ifdef CONFIG_NET_IPv4
+      else
+#endif
+        {
+          FAR struct sockaddr_in6 *addr6 =
+            (FAR struct sockaddr_in6 *)&wrb->wb_dest;
+
+          addr6->sin6_family = AF_INET6;
+          addr6->sin6_port   = conn->rport;
+          net_ipv6addr_copy(addr6->sin6_addr.s6_addr, conn->u.ipv6.raddr);
+        }
+#endif /* CONFIG_NET_IPv6 */
+    }
+
+  /* Not connected.  Use the provided destination address */
+
+  else
+    {
+      memcpy(&wrb->wb_dest, to, tolen);
+      udp_connect(conn, to);
+    }
+
+  /* Skip l2/l3/l4 offset before copy */
+
+  udpiplen = udpip_hdrsize(conn);
+
+  iob_reserve(wrb->wb_iob, CONFIG_NET_LL_GUARDSIZE);
+  iob_update_pktlen(wrb->wb_iob, udpiplen, false);
+
+  /* Copy the user data into the write buffer.  We cannot wait for
+   * buffer space if the socket was opened non-blocking.
+   */
+
+#ifdef UDP_COPYIN_CHKSUM
+  /* Sum the payload in the same pass.  udp_send() only has to add the
+   * headers then.
+   */
+
+  wrb->wb_chksum = 0;
+#endif
+
+  if (nonblock)
+    {
+#ifdef UDP_COPYIN_CHKSUM
+      ret = chksum_iob_copyin(wrb->wb_iob, (FAR uint8_t *)buf,
+                              len, false, &wrb->wb_chksum);
+#else
+      ret = iob_trycopyin(wrb->wb_iob, (FAR uint8_t *)buf,
+                          len, udpiplen, false);
+#endif
+    }
+  else
+    {
+      unsigned int count;
+      int blresult;
+
+      /* iob_copyin might wait for buffers to be freed, but if
+       * network is locked this might never happen, since network
+       * driver is also locked, therefore we need to break the lock
+       */
+
+      blresult = net_breaklock(&count);
+#ifdef UDP_COPYIN_CHKSUM
+      ret = chksum_iob_copyin(wrb->wb_iob, (FAR uint8_t *)buf,
+                              len, true, &wrb->wb_chksum);
+#else
+      ret = iob_copyin(wrb->wb_iob, (FAR uint8_t *)buf,
+                       len, udpiplen, false);
+#endif
+      if (blresult >= 0)
+        {
+          net_restorelock(count);
+        }
+    }
+
+  if (ret < 0)
+    {
+      udp_wrbuffer_release(wrb);
+      return ret;
+    }
+
+  /* Dump I/O buffer chain */
+
+  UDP_WBDUMP("I/O buffer chain", wrb, wrb->wb_iob->io_pktlen, 0);
+
+  *pwrb = wrb;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: udp_sendto_queue
+ *
+ * Description:
+ *   Append a train of prepared write buffers to the write queue of the
+ *   connection.
+ *
+ * Returned Value:
+ *   Zero on success.  On failure a negated errno value is returned and
+ *   the buffers are left in 'train' for the caller to release.
+ *
+ * Assumptions:
+ *   Called with the network locked.
+ *
+ ****************************************************************************/
+
+static int udp_sendto_queue(FAR struct udp_conn_s *conn,
+                            FAR sq_queue_t *train)
+{
+  bool empty;
+  int ret;
+
+  /* sendto_eventhandler() will send data in FIFO order from the
+   * conn->write_q.
+   *
+   * REVISIT:  Why FIFO order?  Because it is easy.  In a real world
+   * environment where there are multiple network devices this might
+   * be inefficient because we could be sending data to different
+   * device out-of-queued-order to optimize performance.  Sending
+   * data to different networks from a single UDP socket is probably
+   * not a very common use case, however.
+   */
+
+  empty = sq_empty(&conn->write_q);
+
+  sq_cat(train, &conn->write_q);
+  ninfo("Queued write_q(%p,%p)\n", conn->write_q.head, conn->write_q.tail);
+
+  if (empty)
+    {
+      /* The new write buffer lies at the head of the write queue.  Set
+       * up for the next packet transfer by setting the connection
+       * address to the address of the next packet now at the header of
+       * the write buffer queue.
+       */
+
+      ret = sendto_next_transfer(conn);
+      if (ret < 0)
+        {
+          sq_move(&conn->write_q, train);
+          return ret;
+        }
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: udp_sendto_release
+ *
+ * Description:
+ *   Release the write buffers of a train that was not queued.
+ *
+ ****************************************************************************/
+
+static void udp_sendto_release(FAR sq_queue_t *train)
+{
+  FAR struct udp_wrbuffer_s *wrb;
+
+  while ((wrb = (FAR struct udp_wrbuffer_s *)sq_remfirst(train)) != NULL)
+    {
+      udp_wrbuffer_release(wrb);
+    }
+}
+
+/****************************************************************************
+ * Name: udp_sendto_segment
+ *
+ * Description:
+ *   Split a send larger than the UDP_SEGMENT size into a train of
+ *   datagrams.  Datagrams are either sent or not, so a partial count would
+ *   not tell which of them went out: every datagram gets its write buffer
+ *   first and the train is only queued if all of them did.
+ *
+ * Returned Value:
+ *   The number of bytes queued, which is all of them, or a negated errno
+ *   value if nothing was queued.
+ *
+ * Assumptions:
+ *   Called with the network locked.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_UDP_SEGMENT
+static ssize_t udp_sendto_segment(FAR struct udp_conn_s *conn,
+                                  FAR const void *buf, size_t len,
+                                  FAR const struct sockaddr *to,
+                                  socklen_t tolen, bool nonblock,
+                                  clock_t start, unsigned int timeout)
+{
+  FAR struct udp_wrbuffer_s *wrb;
+  FAR const uint8_t *data = buf;
+  uint16_t segsize = conn->gso_size;
+  sq_queue_t train;
+  size_t off;
+  int ret;
+
+  if ((len + segsize - 1) / segsize > UDP_MAX_SEGMENTS)
+    {
+      return -EINVAL;
+    }
+
+  ret = udp_sendto_wait(conn, len, nonblock, start, timeout);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  sq_init(&train);
+
+  for (off = 0; off < len; off += segsize)
+    {
+      ret = udp_sendto_prepare(conn, data + off, MIN(len - off, segsize),
+                               to, tolen, nonblock, start, timeout, &wrb);
+      if (ret < 0)
+        {
+          goto errout;
+        }
+
+      sq_addlast(&wrb->wb_node, &train);
+    }
+
+  ret = udp_sendto_queue(conn, &train);
+  if (ret < 0)
+    {
+      goto errout;
+    }
+
+  return len;
+
+errout:
+  udp_sendto_release(&train);
+  return ret;
+}
+#endif
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -549,9 +915,8 @@ ssize_t psock_udp_sendto(FAR struct socket *psock, FAR const void *buf,
   FAR struct udp_wrbuffer_s *wrb;
   FAR struct udp_conn_s *conn;
   unsigned int timeout;
-  uint16_t udpiplen;
+  sq_queue_t train;
   bool nonblock;
-  bool empty;
   int ret = OK;
   clock_t start;
 
@@ -691,198 +1056,60 @@ ssize_t psock_udp_sendto(FAR struct socket *psock, FAR const void *buf,
     {
       net_lock();
 
-#if CONFIG_NET_SEND_BUFSIZE > 0
-      /* If the send buffer size exceeds the send limit,
-       * wait for the write buffer to be released
-       */
+#ifdef CONFIG_NET_UDP_SEGMENT
+      /* Let the stack split the buffer into UDP_SEGMENT sized datagrams */
 
-      while (udp_wrbuffer_inqueue_size(conn) + len > conn->sndbufs)
+      if (conn->gso_size > 0 && len > conn->gso_size)
         {
-          if (nonblock)
-            {
-              ret = -EAGAIN;
-              goto errout_with_lock;
-            }
-
-          ret = net_sem_timedwait_uninterruptible(&conn->sndsem,
-            udp_send_gettimeout(start, timeout));
+          ret = udp_sendto_segment(conn, buf, len, to, tolen, nonblock,
+                                   start, timeout);
           if (ret < 0)
             {
-              if (ret == -ETIMEDOUT)
-                {
-                  ret = -EAGAIN;
-                }
-
               goto errout_with_lock;
             }
-        }
-#endif /* CONFIG_NET_SEND_BUFSIZE */
-
-      /* Allocate a write buffer.  Careful, the network will be momentarily
-       * unlocked here.
-       */
-
-#ifdef CONFIG_NET_JUMBO_FRAME
-
-      /* alloc iob of gso pkt for udp data */
 
-      wrb = udp_wrbuffer_tryalloc(len + udpip_hdrsize(conn) +
-                                  CONFIG_NET_LL_GUARDSIZE);
-#else
-      if (nonblock)
-        {
-          wrb = udp_wrbuffer_tryalloc();
-        }
-      else
-        {
-          wrb = udp_wrbuffer_timedalloc(udp_send_gettimeout(start,
-                                                            timeout));
+          goto out;
         }
 #endif
 
-      if (wrb == NULL)
+      ret = udp_sendto_wait(conn, len, nonblock, start, timeout);
+      if (ret < 0)
         {
-          /* A buffer allocation error occurred */
-
-          nerr("ERROR: Failed to allocate write buffer\n");
-
-          if (nonblock || timeout != UINT_MAX)
-            {
-              ret = -EAGAIN;
-            }
-          else
-            {
-              ret = -ENOMEM;
-            }
-
           goto errout_with_lock;
         }
 
-      /* Initialize the write buffer
-       *
-       * Check if the socket is connected
-       */
-
-      if (_SS_ISCONNECTED(conn->sconn.s_flags))
-        {
-          /* Yes.. get the connection address from the connection structure */
-
-#ifdef CONFIG_NET_IPv4
-#ifdef CONFIG_NET_IPv6
-          if (conn->domain == PF_INET)
-#endif
-            {
-              FAR struct sockaddr_in *addr4 =
-                (FAR struct sockaddr_in *)&wrb->wb_dest;
-
-              addr4->sin_family = AF_INET;
-              addr4->sin_port   = conn->rport;
-              net_ipv4addr_copy(addr4->sin_addr.s_addr, conn->u.ipv4.raddr);
-              memset(addr4->sin_zero, 0, sizeof(addr4->sin_zero));
-            }
-#endif /* CONFIG_NET_IPv4 */
-
-#ifdef CONFIG_NET_IPv6
-#ifdef CONFIG_NET_IPv4
-          else
-#endif
-            {
-              FAR struct sockaddr_in6 *addr6 =
-                (FAR struct sockaddr_in6 *)&wrb->wb_dest;
-
-              addr6->sin6_family = AF_INET6;
-              addr6->sin6_port   = conn->rport;
-              net_ipv6addr_copy(addr6->sin6_addr.s6_addr,
-                                conn->u.ipv6.raddr);
-            }
-#endif /* CONFIG_NET_IPv6 */
-        }
-
-      /* Not connected.  Use the provided destination address */
-
-      else
-        {
-          memcpy(&wrb->wb_dest, to, tolen);
-          udp_connect(conn, to);
-        }
-
-      /* Skip l2/l3/l4 offset before copy */
-
-      udpiplen = udpip_hdrsize(conn);
-
-      iob_reserve(wrb->wb_iob, CONFIG_NET_LL_GUARDSIZE);
-      iob_update_pktlen(wrb->wb_iob, udpiplen, false);
-
-      /* Copy the user data into the write buffer.  We cannot wait for
-       * buffer space if the socket was opened non-blocking.
-       */
-
-      if (nonblock)
+      ret = udp_sendto_prepare(conn, buf, len, to, tolen, nonblock, start,
+                               timeout, &wrb);
+      if (ret < 0)
         {
-          ret = iob_trycopyin(wrb->wb_iob, (FAR uint8_t *)buf,
-                              len, udpiplen, false);
+          goto errout_with_lock;
         }
-      else
-        {
-          unsigned int count;
-          int blresult;
-
-          /* iob_copyin might wait for buffers to be freed, but if
-           * network is locked this might never happen, since network
-           * driver is also locked, therefore we need to break the lock
-           */
 
-          blresult = net_breaklock(&count);
-          ret = iob_copyin(wrb->wb_iob, (FAR uint8_t *)buf,
-                           len, udpiplen, false);
-          if (blresult >= 0)
-            {
-              net_restorelock(count);
-            }
-        }
+      sq_init(&train);
+      sq_addlast(&wrb->wb_node, &train);
 
+      ret = udp_sendto_queue(conn, &train);
       if (ret < 0)
         {
-          goto errout_with_wrb;
+          udp_sendto_release(&train);
+          goto errout_with_lock;
         }
 
-      /* Dump I/O buffer chain */
-
-      UDP_WBDUMP("I/O buffer chain", wrb, wrb->wb_iob->io_pktlen, 0);
-
-      /* sendto_eventhandler() will send data in FIFO order from the
-       * conn->write_q.
-       *
-       * REVISIT:  Why FIFO order?  Because it is easy.  In a real world
-       * environment where there are multiple network devices this might
-       * be inefficient because we could be sending data to different
-       * device out-of-queued-order to optimize performance.  Sending
-       * data to different networks from a single UDP socket is probably
-       * not a very common use case, however.
+#ifdef CONFIG_NET_UDP_SEGMENT
+out:
+#endif
+#ifdef CONFIG_NET_ZEROCOPY
+      /* The write buffer goes to the driver as it is (see
+       * sendto_eventhandler()), where loopback and receive packing may
+       * rewrite it, so UDP always copies.  The user buffer is free again.
        */
 
-      empty = sq_empty(&conn->write_q);
-
-      sq_addlast(&wrb->wb_node, &conn->write_q);
-      ninfo("Queued WRB=%p pktlen=%u write_q(%p,%p)\n",
-            wrb, wrb->wb_iob->io_pktlen,
-            conn->write_q.head, conn->write_q.tail);
-
-      if (empty)
+      if ((flags & MSG_ZEROCOPY) != 0 &&
+          _SO_GETOPT(conn->sconn.s_options, SO_ZEROCOPY))
         {
-          /* The new write buffer lies at the head of the write queue.  Set
-           * up for the next packet transfer by setting the connection
-           * address to the address of the next packet now at the header of
-           * the write buffer queue.
-           */
-
-          ret = sendto_next_transfer(conn);
-          if (ret < 0)
-            {
-              sq_remlast(&conn->write_q);
-              goto errout_with_wrb;
-            }
+          zerocopy_copied(&conn->sconn);
         }
+#endif
 
       net_unlock();
     }
@@ -891,9 +1118,6 @@ ssize_t psock_udp_sendto(FAR struct socket *psock, FAR const void *buf,
 
   return len;
 
-errout_with_wrb:
-  udp_wrbuffer_release(wrb);
-
 errout_with_lock:
   net_unlock();
   return ret;
@@ -76,7 +76,51 @@
 int udp_setsockopt(FAR struct socket *psock, int option,
                    FAR const void *value, socklen_t value_len)
 {
-  return -ENOPROTOOPT;
+  FAR struct udp_conn_s *conn = psock->s_conn;
+  int ret;
+
+  DEBUGASSERT(value_len == 0 || value != NULL);
+
+  if (psock->s_type != SOCK_DGRAM)
+    {
+      nerr("ERROR:  Not a UDP socket\n");
+      return -ENOTCONN;
+    }
+
+  switch (option)
+    {
+#ifdef CONFIG_NET_UDP_SEGMENT
+      case UDP_SEGMENT:  /* Payload size of the datagrams a send is split
+                          * into, zero disables segmentation */
+        if (value_len != sizeof(int))
+          {
+            ret = -EINVAL;
+          }
+        else
+          {
+            int segsize = *(FAR const int *)value;
+
+            if (segsize < 0 || segsize > UINT16_MAX)
+              {
+                ret = -EINVAL;
+              }
+            else
+              {
+                conn->gso_size = (uint16_t)segsize;
+                ret            = OK;
+              }
+          }
+        break;
+#endif
+
+      default:
+        nerr("ERROR: Unrecognized UDP option: %d\n", option);
+        ret = -ENOPROTOOPT;
+        break;
+    }
+
+  UNUSED(conn);
+  return ret;
 }
 
 #endif /* CONFIG_NET_UDPPROTO_OPTIONS */
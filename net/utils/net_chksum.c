@@ -27,86 +27,372 @@
 #include <nuttx/config.h>
 #ifdef CONFIG_NET
 
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+#include <errno.h>
+
 #include "utils/utils.h"
 
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Sum 16 bytes per step with the vector extension of GCC/clang where the
+ * target has 128-bit SIMD: SSE2 on x86_64 (e.g. the simulator) and NEON on
+ * arm64.
+ */
+
+#if !defined(CONFIG_NET_ARCH_CHKSUM_PARTIAL) && defined(__GNUC__) && \
+    (defined(__SSE2__) || defined(__ARM_NEON))
+#  define CHKSUM_VECTOR 1
+#endif
+
+/* Fold a 64-bit sum of 16-bit words into 16 bits */
+
+#define CHKSUM_FOLD64(s) \
+  do \
+    { \
+      (s) = ((s) & 0xffffffff) + ((s) >> 32); \
+      (s) = ((s) & 0xffffffff) + ((s) >> 32); \
+      (s) = ((s) & 0xffff) + ((s) >> 16); \
+      (s) = ((s) & 0xffff) + ((s) >> 16); \
+      (s) = ((s) & 0xffff) + ((s) >> 16); \
+    } \
+  while (0)
+
+#define CHKSUM_SWAP16(s) ((uint16_t)(((s) << 8) | ((s) >> 8)))
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+#ifdef CHKSUM_VECTOR
+typedef uint32_t chksum_vec_t
+  __attribute__((vector_size(16), aligned(4), may_alias));
+#endif
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
 
+#ifndef CONFIG_NET_ARCH_CHKSUM
+
 /****************************************************************************
- * Name: checksum
+ * Name: chksum_partial
  *
  * Description:
- *   Calculate the raw change sum over the memory region described by
- *   data and len.
+ *   Return the one's complement sum of the 16-bit words at 'data', loaded
+ *   in native byte order, as in RFC 1071.  A trailing odd byte is summed
+ *   as if it were followed by a zero byte.
  *
- * Input Parameters:
- *   sum  - Partial calculations carried over from a previous call to
- *          chksum().  This should be zero on the first time that check
- *          sum is called.
- *   data - Beginning of the data to include in the checksum.
- *   len  - Length of the data to include in the checksum.
- *   odd  - the flag of the Calculated data sum
- *
- * Returned Value:
- *   The updated checksum value.
+ *   The words are summed four (or sixteen with SIMD) bytes at a time into a
+ *   wide accumulator and folded once at the end, instead of folding the
+ *   carry after every word.  If CONFIG_NET_ARCH_CHKSUM_PARTIAL is defined,
+ *   then up_chksum_partial() is used instead.
  *
  ****************************************************************************/
 
-#ifndef CONFIG_NET_ARCH_CHKSUM
-uint16_t checksum(uint16_t sum, FAR const uint8_t *data,
-                    uint16_t len, bool *odd)
+#ifdef CONFIG_NET_ARCH_CHKSUM_PARTIAL
+#  define chksum_partial(d, l) up_chksum_partial(d, l)
+#else
+static uint16_t chksum_partial(FAR const uint8_t *data, size_t len)
 {
-  FAR const uint8_t *dataptr;
-  FAR const uint8_t *last_byte;
-  uint16_t t;
+  bool odd = ((uintptr_t)data & 1) != 0;
+  uint64_t sum = 0;
 
-  dataptr = data;
-  last_byte = data + len - 1;
+  if (len == 0)
+    {
+      return 0;
+    }
 
-  if (*odd == true)
+  /* Make the address even.  The sum is byte swapped at the end, so that
+   * the byte taken here becomes the first byte of a word again.
+   */
+
+  if (odd)
     {
-      t = dataptr[0];
-      sum += t;
-      if (sum < t)
-        {
-          sum++; /* carry */
-        }
+#ifdef CONFIG_ENDIAN_BIG
+      sum = *data++;
+#else
+      sum = (uint32_t)*data++ << 8;
+#endif
+      len--;
+    }
+
+  /* Make the address a multiple of four */
 
-      dataptr += 1;
+  if (len >= 2 && ((uintptr_t)data & 2) != 0)
+    {
+      sum  += *(FAR const uint16_t *)data;
+      data += 2;
+      len  -= 2;
     }
 
-  while (dataptr < last_byte)
+#ifdef CHKSUM_VECTOR
+  while (len >= 16)
     {
-      /* At least two more bytes */
+      const chksum_vec_t mask =
+        {
+          0xffff, 0xffff, 0xffff, 0xffff
+        };
+
+      const chksum_vec_t shift =
+        {
+          16, 16, 16, 16
+        };
+
+      chksum_vec_t lo =
+        {
+          0
+        };
+
+      chksum_vec_t hi =
+        {
+          0
+        };
+
+      size_t n = len / 16;
+
+      /* Each lane gains at most 0xffff per step, so flush the lanes into
+       * the scalar sum before they can overflow.
+       */
+
+      if (n > 4096)
+        {
+          n = 4096;
+        }
 
-      t = ((uint16_t)dataptr[0] << 8) + dataptr[1];
-      sum += t;
-      if (sum < t)
+      len -= n * 16;
+      while (n-- > 0)
         {
-          sum++; /* carry */
+          chksum_vec_t v = *(FAR const chksum_vec_t *)data;
+
+          lo   += v & mask;
+          hi   += v >> shift;
+          data += 16;
         }
 
-      dataptr += 2;
+      sum += (uint64_t)lo[0] + lo[1] + lo[2] + lo[3] +
+                       hi[0] + hi[1] + hi[2] + hi[3];
     }
+#endif
 
-  *odd = false;
+  while (len >= 16)
+    {
+      FAR const uint32_t *word = (FAR const uint32_t *)data;
 
-  if (dataptr == last_byte)
+      sum  += (uint64_t)word[0] + word[1] + word[2] + word[3];
+      data += 16;
+      len  -= 16;
+    }
+
+  while (len >= 4)
     {
-      t = (dataptr[0] << 8) + 0;
-      sum += t;
-      if (sum < t)
-        {
-          sum++; /* carry */
-        }
+      sum  += *(FAR const uint32_t *)data;
+      data += 4;
+      len  -= 4;
+    }
+
+  if (len >= 2)
+    {
+      sum  += *(FAR const uint16_t *)data;
+      data += 2;
+      len  -= 2;
+    }
 
-      *odd = true;
+  if (len > 0)
+    {
+#ifdef CONFIG_ENDIAN_BIG
+      sum += (uint32_t)*data << 8;
+#else
+      sum += *data;
+#endif
     }
 
-  /* Return sum in host byte order. */
+  CHKSUM_FOLD64(sum);
 
-  return sum;
+  return odd ? CHKSUM_SWAP16(sum) : (uint16_t)sum;
+}
+#endif /* CONFIG_NET_ARCH_CHKSUM_PARTIAL */
+
+/****************************************************************************
+ * Name: chksum_copy_partial
+ *
+ * Description:
+ *   Copy 'len' bytes from 'src' to 'dest' and return the chksum_partial()
+ *   of them, reading the source only once.  Buffers that cannot be both
+ *   word aligned are copied first and summed from the destination.
+ *
+ ****************************************************************************/
+
+static uint16_t chksum_copy_partial(FAR uint8_t *dest,
+                                    FAR const uint8_t *src, size_t len)
+{
+  bool odd = ((uintptr_t)src & 1) != 0;
+  uint64_t sum = 0;
+
+  if ((((uintptr_t)dest ^ (uintptr_t)src) & 3) != 0)
+    {
+      memcpy(dest, src, len);
+      return chksum_partial(dest, len);
+    }
+
+  if (len == 0)
+    {
+      return 0;
+    }
+
+  if (odd)
+    {
+#ifdef CONFIG_ENDIAN_BIG
+      sum = *src;
+#else
+      sum = (uint32_t)*src << 8;
+#endif
+      *dest++ = *src++;
+      len--;
+    }
+
+  if (len >= 2 && ((uintptr_t)src & 2) != 0)
+    {
+      uint16_t half = *(FAR const uint16_t *)src;
+
+      *(FAR uint16_t *)dest = half;
+      sum  += half;
+      src  += 2;
+      dest += 2;
+      len  -= 2;
+    }
+
+  while (len >= 16)
+    {
+      FAR const uint32_t *from = (FAR const uint32_t *)src;
+      FAR uint32_t *to = (FAR uint32_t *)dest;
+      uint32_t w0 = from[0];
+      uint32_t w1 = from[1];
+      uint32_t w2 = from[2];
+      uint32_t w3 = from[3];
+
+      to[0] = w0;
+      to[1] = w1;
+      to[2] = w2;
+      to[3] = w3;
+      sum  += (uint64_t)w0 + w1 + w2 + w3;
+      src  += 16;
+      dest += 16;
+      len  -= 16;
+    }
+
+  while (len >= 4)
+    {
+      uint32_t word = *(FAR const uint32_t *)src;
+
+      *(FAR uint32_t *)dest = word;
+      sum  += word;
+      src  += 4;
+      dest += 4;
+      len  -= 4;
+    }
+
+  if (len >= 2)
+    {
+      uint16_t half = *(FAR const uint16_t *)src;
+
+      *(FAR uint16_t *)dest = half;
+      sum  += half;
+      src  += 2;
+      dest += 2;
+      len  -= 2;
+    }
+
+  if (len > 0)
+    {
+#ifdef CONFIG_ENDIAN_BIG
+      sum += (uint32_t)*src << 8;
+#else
+      sum += *src;
+#endif
+      *dest = *src;
+    }
+
+  CHKSUM_FOLD64(sum);
+
+  return odd ? CHKSUM_SWAP16(sum) : (uint16_t)sum;
+}
+
+/****************************************************************************
+ * Name: chksum_add
+ *
+ * Description:
+ *   Add the native byte order chksum_partial() of a buffer of length 'len'
+ *   to the running checksum 'sum' (host byte order).  'odd' tells whether
+ *   the buffer starts in the middle of a 16-bit word and is updated for the
+ *   following buffer.
+ *
+ ****************************************************************************/
+
+static uint16_t chksum_add(uint16_t sum, uint16_t partial, size_t len,
+                           FAR bool *odd)
+{
+  uint32_t total;
+
+  /* The native sum of a buffer that starts in the middle of a word is the
+   * byte swapped sum of the same bytes in word order (RFC 1071).
+   */
+
+  partial = NTOHS(partial);
+  if (*odd)
+    {
+      partial = CHKSUM_SWAP16(partial);
+    }
+
+  *odd ^= (len & 1) != 0;
+
+  total = (uint32_t)sum + partial;
+  total = (total & 0xffff) + (total >> 16);
+  return (uint16_t)total;
+}
+
+/****************************************************************************
+ * Name: checksum
+ *
+ * Description:
+ *   Calculate the raw change sum over the memory region described by
+ *   data and len.
+ *
+ * Input Parameters:
+ *   sum  - Partial calculations carried over from a previous call to
+ *          chksum().  This should be zero on the first time that check
+ *          sum is called.
+ *   data - Beginning of the data to include in the checksum.
+ *   len  - Length of the data to include in the checksum.
+ *   odd  - the flag of the Calculated data sum
+ *
+ * Returned Value:
+ *   The updated checksum value.
+ *
+ ****************************************************************************/
+
+uint16_t checksum(uint16_t sum, FAR const uint8_t *data,
+                    uint16_t len, bool *odd)
+{
+  return chksum_add(sum, chksum_partial(data, len), len, odd);
+}
+
+/****************************************************************************
+ * Name: checksum_copy
+ *
+ * Description:
+ *   Like checksum(), but also copy the data to 'dest'.
+ *
+ ****************************************************************************/
+
+static uint16_t checksum_copy(uint16_t sum, FAR uint8_t *dest,
+                              FAR const uint8_t *src, size_t len,
+                              FAR bool *odd)
+{
+  return chksum_add(sum, chksum_copy_partial(dest, src, len), len, odd);
 }
 
 /****************************************************************************
@@ -139,6 +425,34 @@ uint16_t chksum(uint16_t sum, FAR const uint8_t *data, uint16_t len)
   return checksum(sum, data, len, &odd);
 }
 
+/****************************************************************************
+ * Name: chksum_copy
+ *
+ * Description:
+ *   Copy a buffer and calculate the raw change sum over the copied data in
+ *   the same pass.
+ *
+ * Input Parameters:
+ *   sum  - Partial calculations carried over from a previous call to
+ *          chksum().  This should be zero on the first time that check
+ *          sum is called.
+ *   dest - Destination of the copy.
+ *   src  - Beginning of the data to copy and include in the checksum.
+ *   len  - Length of the data to copy and include in the checksum.
+ *
+ * Returned Value:
+ *   The updated checksum value.
+ *
+ ****************************************************************************/
+
+uint16_t chksum_copy(uint16_t sum, FAR uint8_t *dest,
+                     FAR const uint8_t *src, uint16_t len)
+{
+  bool odd = false;
+
+  return checksum_copy(sum, dest, src, len, &odd);
+}
+
 #endif /* CONFIG_NET_ARCH_CHKSUM */
 
 /****************************************************************************
@@ -188,6 +502,81 @@ uint16_t chksum_iob(uint16_t sum, FAR struct iob_s *iob, uint16_t offset)
 }
 #endif /* CONFIG_MM_IOB */
 
+/****************************************************************************
+ * Name: chksum_iob_copyin
+ *
+ * Description:
+ *   Append data to the end of an iob chain, extending the chain as
+ *   necessary, and calculate the raw change sum over the appended data
+ *   while it is copied.
+ *
+ * Input Parameters:
+ *   iob       - The head of the iob chain to append to.
+ *   src       - Beginning of the data to copy.
+ *   len       - Length of the data to copy.
+ *   can_block - True if the allocation of further iobs may wait.
+ *   sum       - The location of the running checksum.  This should be
+ *               zero before the first call.  It is updated on return.
+ *
+ * Returned Value:
+ *   The number of bytes copied, or -ENOMEM if the chain could not be
+ *   extended.
+ *
+ ****************************************************************************/
+
+#if defined(CONFIG_MM_IOB) && !defined(CONFIG_NET_ARCH_CHKSUM)
+int chksum_iob_copyin(FAR struct iob_s *iob, FAR const uint8_t *src,
+                      unsigned int len, bool can_block, FAR uint16_t *sum)
+{
+  FAR struct iob_s *head = iob;
+  FAR uint8_t *dest;
+  unsigned int total = len;
+  bool odd = false;
+
+  DEBUGASSERT(iob != NULL && src != NULL && sum != NULL);
+
+  while (iob->io_flink != NULL)
+    {
+      iob = iob->io_flink;
+    }
+
+  while (len > 0)
+    {
+      unsigned int ncopy = IOB_BUFSIZE(iob) - iob->io_offset - iob->io_len;
+
+      if (ncopy == 0)
+        {
+          FAR struct iob_s *next;
+
+          next = can_block ? iob_alloc(false) : iob_tryalloc(false);
+          if (next == NULL)
+            {
+              return -ENOMEM;
+            }
+
+          iob->io_flink = next;
+          iob = next;
+          continue;
+        }
+
+      if (ncopy > len)
+        {
+          ncopy = len;
+        }
+
+      dest = &iob->io_data[iob->io_offset + iob->io_len];
+      *sum = checksum_copy(*sum, dest, src, ncopy, &odd);
+
+      iob->io_len     += ncopy;
+      head->io_pktlen += ncopy;
+      src             += ncopy;
+      len             -= ncopy;
+    }
+
+  return total;
+}
+#endif
+
 /****************************************************************************
  * Name: net_chksum
  *
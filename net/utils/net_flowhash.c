@@ -0,0 +1,116 @@
+/****************************************************************************
+ * net/utils/net_flowhash.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <netinet/in.h>
+
+#include "utils/utils.h"
+
+#ifdef CONFIG_NET_REUSEPORT
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/* Random secret so that remote peers cannot choose flows that all land on
+ * the same member of a SO_REUSEPORT group.
+ */
+
+static uint32_t g_flowhash_key;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: net_flowhash_mix
+ *
+ * Description:
+ *   Fold one 32-bit word into the running hash.
+ *
+ ****************************************************************************/
+
+static inline uint32_t net_flowhash_mix(uint32_t hash, uint32_t word)
+{
+  hash ^= word;
+  hash *= 0x9e3779b1;
+  return hash ^ (hash >> 15);
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: net_flowhash
+ *
+ * Description:
+ *   Calculate a hash of the remote end point and the local port of a flow.
+ *   The same flow always yields the same value until the next reboot.
+ *
+ * Input Parameters:
+ *   domain - PF_INET or PF_INET6
+ *   raddr  - The remote address, in_addr_t or net_ipv6addr_t layout
+ *   rport  - The remote port (network order)
+ *   lport  - The local port (network order)
+ *
+ * Returned Value:
+ *   A 32-bit hash of the flow.
+ *
+ ****************************************************************************/
+
+uint32_t net_flowhash(uint8_t domain, FAR const void *raddr,
+                      uint16_t rport, uint16_t lport)
+{
+  FAR const uint8_t *addr = raddr;
+  size_t addrlen = domain == PF_INET6 ? 16 : 4;
+  uint32_t hash;
+  uint32_t word;
+  size_t i;
+
+  if (g_flowhash_key == 0)
+    {
+      arc4random_buf(&g_flowhash_key, sizeof(g_flowhash_key));
+      g_flowhash_key |= 1;
+    }
+
+  hash = g_flowhash_key;
+  for (i = 0; i < addrlen; i += sizeof(word))
+    {
+      memcpy(&word, addr + i, sizeof(word));
+      hash = net_flowhash_mix(hash, word);
+    }
+
+  hash = net_flowhash_mix(hash, ((uint32_t)rport << 16) | lport);
+  return net_flowhash_mix(hash, hash >> 16);
+}
+
+#endif /* CONFIG_NET_REUSEPORT */
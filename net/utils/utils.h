@@ -367,6 +367,40 @@ FAR void *net_ipv6_payload(FAR struct ipv6_hdr_s *ipv6, FAR uint8_t *proto);
 uint16_t net_iob_concat(FAR struct iob_s **iob1, FAR struct iob_s **iob2);
 #endif
 
+/****************************************************************************
+ * Name: net_flowhash
+ *
+ * Description:
+ *   Calculate a keyed hash of the remote address, remote port and local
+ *   port of a flow.  Used to spread flows over a SO_REUSEPORT group.
+ *
+ * Input Parameters:
+ *   domain - PF_INET or PF_INET6
+ *   raddr  - The remote address, in_addr_t or net_ipv6addr_t layout
+ *   rport  - The remote port (network order)
+ *   lport  - The local port (network order)
+ *
+ * Returned Value:
+ *   A 32-bit hash of the flow.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_REUSEPORT
+uint32_t net_flowhash(uint8_t domain, FAR const void *raddr,
+                      uint16_t rport, uint16_t lport);
+#endif
+
+/****************************************************************************
+ * Name: net_flowhash_scale
+ *
+ * Description:
+ *   Map a flow hash onto the range [0, n).
+ *
+ ****************************************************************************/
+
+#define net_flowhash_scale(hash, n) \
+  ((unsigned int)(((uint64_t)(hash) * (n)) >> 32))
+
 /****************************************************************************
  * Name: net_bufpool_timedalloc
  *
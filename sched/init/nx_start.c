@@ -62,6 +62,7 @@
 #include "init/init.h"
 #include "instrument/instrument.h"
 #include "tls/tls.h"
+#include "wdog/wdog.h"
 
 /****************************************************************************
  * Pre-processor Definitions
@@ -541,6 +542,10 @@ void nx_start(void)
 
   /* Initialize RTOS Data ***************************************************/
 
+  /* Initialize the watchdog queues before anything may start a watchdog */
+
+  wd_initialize();
+
   drivers_early_initialize();
 
   sched_trace_begin();
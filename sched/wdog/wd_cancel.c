@@ -37,11 +37,117 @@
 
 #include "sched/sched.h"
 #include "wdog/wdog.h"
-
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
 
+/****************************************************************************
+ * Name: wd_dequeue
+ *
+ * Description:
+ *   Remove an active watchdog from the queue it is armed in and mark it
+ *   inactive.  With CONFIG_WDOG_PERCPU that queue may belong to another
+ *   CPU and is locked here; otherwise the caller must be in a critical
+ *   section.
+ *
+ * Input Parameters:
+ *   wdog - The watchdog to remove
+ *   note - Emit NOTE_WDOG_CANCEL for the removed watchdog
+ *
+ * Returned Value:
+ *   -EINVAL if the watchdog is not active, 1 if the next expiration of
+ *   its queue changed and the timer has to be reassessed, 0 otherwise.
+ *
+ ****************************************************************************/
+
+int wd_dequeue(FAR struct wdog_s *wdog, bool note)
+{
+  irqstate_t flags;
+  bool head;
+  int cpu;
+
+  for (; ; )
+    {
+      /* A watchdog that was never started may hold any cpu value, reject
+       * it before that value selects a queue lock.
+       */
+
+      cpu = WDOG_CPU(wdog);
+      if (cpu < 0 || cpu >= WDOG_NQUEUES)
+        {
+          return -EINVAL;
+        }
+
+      flags = wd_queue_lock(cpu);
+
+      if (!WDOG_ISACTIVE(wdog))
+        {
+          wd_queue_unlock(cpu, flags);
+          return -EINVAL;
+        }
+
+      /* The watchdog may have been restarted on another CPU meanwhile */
+
+      if (WDOG_CPU(wdog) == cpu)
+        {
+          break;
+        }
+
+      wd_queue_unlock(cpu, flags);
+    }
+
+  if (note)
+    {
+      sched_note_wdog(NOTE_WDOG_CANCEL, (FAR void *)wdog->func,
+                      (FAR void *)(uintptr_t)wdog->expired);
+    }
+
+  /* Now, remove the watchdog from the timer queue */
+
+  head = wd_queue_remove(cpu, wdog);
+
+  /* Mark the watchdog inactive */
+
+  wdog->func = NULL;
+
+  wd_queue_unlock(cpu, flags);
+  return head;
+}
+
+/****************************************************************************
+ * Name: wd_wait_running
+ *
+ * Description:
+ *   Wait until the callback of the watchdog is no longer running on any
+ *   other CPU, so the caller may free or reuse the watchdog.  A callback
+ *   running on this CPU is the caller itself (or interrupted by it) and
+ *   can not be waited for.
+ *
+ *   Callbacks run inside the critical section, so a caller that holds it
+ *   never waits here.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_WDOG_PERCPU
+void wd_wait_running(FAR struct wdog_s *wdog)
+{
+  int cpu;
+
+  for (cpu = 0; cpu < WDOG_NQUEUES; cpu++)
+    {
+      if (cpu == this_cpu())
+        {
+          continue;
+        }
+
+      while (g_wdrunning[cpu] == wdog)
+        {
+          SP_DSB();
+        }
+    }
+}
+#endif
+
 /****************************************************************************
  * Name: wd_cancel
  *
@@ -63,6 +169,31 @@ int wd_cancel(FAR struct wdog_s *wdog)
   irqstate_t flags;
   int ret;
 
+#ifdef CONFIG_WDOG_PERCPU
+  /* Only the queue of the watchdog is locked, the critical section is
+   * needed only to reassess the timer.
+   */
+
+  if (wdog == NULL)
+    {
+      return -EINVAL;
+    }
+
+  ret = wd_dequeue(wdog, true);
+  if (ret > 0)
+    {
+      flags = enter_critical_section();
+      nxsched_reassess_timer();
+      leave_critical_section(flags);
+    }
+
+  /* The callback may just have been started on another CPU, don't let
+   * the caller free the watchdog under it.
+   */
+
+  wd_wait_running(wdog);
+  return ret < 0 ? ret : OK;
+#else
   flags = enter_critical_section();
 
   ret = wd_cancel_irq(wdog);
@@ -70,6 +201,7 @@ int wd_cancel(FAR struct wdog_s *wdog)
   leave_critical_section(flags);
 
   return ret;
+#endif
 }
 
 /****************************************************************************
@@ -91,37 +223,31 @@ int wd_cancel(FAR struct wdog_s *wdog)
 
 int wd_cancel_irq(FAR struct wdog_s *wdog)
 {
-  bool head;
+  int ret;
 
-  /* Make sure that the watchdog is valid and still active. */
+  /* Make sure that the watchdog is valid */
 
-  if (wdog == NULL || !WDOG_ISACTIVE(wdog))
+  if (wdog == NULL)
     {
       return -EINVAL;
     }
 
-  sched_note_wdog(NOTE_WDOG_CANCEL, (FAR void *)wdog->func,
-                  (FAR void *)(uintptr_t)wdog->expired);
-
   /* Prohibit timer interactions with the timer queue until the
    * cancellation is complete
    */
 
-  head = list_is_head(&g_wdactivelist, &wdog->node);
-
-  /* Now, remove the watchdog from the timer queue */
-
-  list_delete(&wdog->node);
-
-  /* Mark the watchdog inactive */
-
-  wdog->func = NULL;
+  ret = wd_dequeue(wdog, true);
+  wd_wait_running(wdog);
+  if (ret < 0)
+    {
+      return ret;
+    }
 
-  if (head)
+  if (ret > 0)
     {
-      /* If the watchdog is at the head of the timer queue, then
-       * we will need to re-adjust the interval timer that will
-       * generate the next interval event.
+      /* If the next expiration of the timer queue changed, then we will
+       * need to re-adjust the interval timer that will generate the next
+       * interval event.
        */
 
       nxsched_reassess_timer();
@@ -34,13 +34,63 @@
  * Public Data
  ****************************************************************************/
 
+#ifdef CONFIG_WDOG_TIMER_WHEEL
+/* The g_wdwheel holds all active watchdogs hashed by expiration time. The
+ * slot lists are initialized on demand, so it can live in .bss.
+ */
+
+struct wdog_wheel_s g_wdwheel[WDOG_NQUEUES];
+#elif defined(CONFIG_WDOG_PERCPU)
+/* The per-CPU lists are initialized by wd_initialize() */
+
+struct list_node g_wdactivelist[WDOG_NQUEUES];
+#else
 /* The g_wdactivelist data structure is a singly linked list ordered by
  * watchdog expiration time. When watchdog timers expire,the functions on
  * this linked list are removed and the function is called.
  */
 
-struct list_node g_wdactivelist = LIST_INITIAL_VALUE(g_wdactivelist);
+struct list_node g_wdactivelist[WDOG_NQUEUES] =
+{
+  LIST_INITIAL_VALUE(g_wdactivelist[0])
+};
+#endif
+
+#ifdef CONFIG_WDOG_PERCPU
+spinlock_t g_wdlock[WDOG_NQUEUES];
+FAR struct wdog_s *volatile g_wdrunning[WDOG_NQUEUES];
+#endif
 
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
+
+/****************************************************************************
+ * Name: wd_initialize
+ *
+ * Description:
+ *   Initialize the per-CPU watchdog queues.  This must be called before
+ *   any watchdog is started.
+ *
+ * Input Parameters:
+ *   None
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_WDOG_PERCPU
+void wd_initialize(void)
+{
+  int cpu;
+
+  for (cpu = 0; cpu < WDOG_NQUEUES; cpu++)
+    {
+#ifndef CONFIG_WDOG_TIMER_WHEEL
+      list_initialize(&g_wdactivelist[cpu]);
+#endif
+      spin_lock_init(&g_wdlock[cpu]);
+    }
+}
+#endif
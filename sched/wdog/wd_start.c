@@ -87,7 +87,11 @@
  ****************************************************************************/
 
 #ifdef CONFIG_SCHED_TICKLESS
-static unsigned int g_wdtimernested;
+static unsigned int g_wdtimernested[WDOG_NQUEUES];
+#endif
+
+#ifdef CONFIG_WDOG_PERCPU
+static struct smp_call_data_s g_wdsmpcall[WDOG_NQUEUES];
 #endif
 
 /****************************************************************************
@@ -95,13 +99,15 @@ static unsigned int g_wdtimernested;
  ****************************************************************************/
 
 /****************************************************************************
- * Name: wd_expiration
+ * Name: wd_queue_expiration
  *
  * Description:
- *   Check if the timer for the watchdog at the head of list is ready to
- *   run. If so, remove the watchdog from the list and execute it.
+ *   Check if the timer for the watchdog at the head of the queue of 'cpu'
+ *   is ready to run. If so, remove the watchdog from the queue and execute
+ *   it.
  *
  * Input Parameters:
+ *   cpu   - The watchdog queue to process
  *   ticks - current time in ticks
  *
  * Returned Value:
@@ -109,11 +115,13 @@ static unsigned int g_wdtimernested;
  *
  ****************************************************************************/
 
-static inline_function void wd_expiration(clock_t ticks)
+static void wd_queue_expiration(int cpu, clock_t ticks)
 {
   FAR struct wdog_s *wdog;
+  irqstate_t qflags;
   irqstate_t flags;
   wdentry_t func;
+  wdparm_t arg;
 
   flags = enter_critical_section();
 
@@ -122,56 +130,148 @@ static inline_function void wd_expiration(clock_t ticks)
    * is called in the watchdog callback functions.
    */
 
-  g_wdtimernested++;
+  g_wdtimernested[cpu]++;
 #endif
 
-  /* Process the watchdog at the head of the list as well as any
+  /* Process the watchdog at the head of the queue as well as any
    * other watchdogs that became ready to run at this time
    */
 
-  while (!list_is_empty(&g_wdactivelist))
+  for (; ; )
     {
-      wdog = list_first_entry(&g_wdactivelist, struct wdog_s, node);
-
-      /* Check if expected time is expired */
-
-      if (!clock_compare(wdog->expired, ticks))
+      qflags = wd_queue_lock(cpu);
+      wdog = wd_queue_expire(cpu, ticks);
+      if (wdog == NULL)
         {
+          wd_queue_unlock(cpu, qflags);
           break;
         }
 
-      /* Remove the watchdog from the head of the list */
-
-      list_delete(&wdog->node);
-
-      /* Indicate that the watchdog is no longer active. */
+      /* Indicate that the watchdog is no longer active, but is running
+       * until the callback returns.
+       */
 
       func = wdog->func;
+      arg = wdog->arg;
       wdog->func = NULL;
+#ifdef CONFIG_WDOG_PERCPU
+      g_wdrunning[cpu] = wdog;
+#endif
+      wd_queue_unlock(cpu, qflags);
 
       /* Execute the watchdog function */
 
       up_setpicbase(wdog->picbase);
-      CALL_FUNC(func, wdog->arg);
+      CALL_FUNC(func, arg);
+
+#ifdef CONFIG_WDOG_PERCPU
+      qflags = wd_queue_lock(cpu);
+      g_wdrunning[cpu] = NULL;
+      wd_queue_unlock(cpu, qflags);
+#endif
     }
 
 #ifdef CONFIG_SCHED_TICKLESS
   /* Decrement the nested watchdog timer count */
 
-  g_wdtimernested--;
+  g_wdtimernested[cpu]--;
 #endif
 
   leave_critical_section(flags);
 }
 
+/****************************************************************************
+ * Name: wd_smp_expiration
+ *
+ * Description:
+ *   SMP call handler processing the expired watchdogs of this CPU.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_WDOG_PERCPU
+static int wd_smp_expiration(FAR void *arg)
+{
+#ifdef CONFIG_SCHED_TICKLESS
+  irqstate_t flags;
+#endif
+
+  wd_queue_expiration(this_cpu(), clock_systime_ticks());
+
+#ifdef CONFIG_SCHED_TICKLESS
+  /* Watchdogs re-armed by the callbacks skipped the reassessment while
+   * nested, and unlike on the CPU servicing the timer no wd_timer() call
+   * follows, so reassess here.
+   */
+
+  flags = enter_critical_section();
+  nxsched_reassess_timer();
+  leave_critical_section(flags);
+#endif
+
+  return OK;
+}
+#endif
+
+/****************************************************************************
+ * Name: wd_expiration
+ *
+ * Description:
+ *   Process the expired watchdogs.  With CONFIG_WDOG_PERCPU the watchdogs
+ *   of other CPUs are handed over to their owner by an SMP call, so they
+ *   run on the CPU that armed them.
+ *
+ * Input Parameters:
+ *   ticks - current time in ticks
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+static inline_function void wd_expiration(clock_t ticks)
+{
+#ifdef CONFIG_WDOG_PERCPU
+  irqstate_t flags;
+  clock_t next;
+  bool expired;
+  int cpu;
+
+  for (cpu = 0; cpu < WDOG_NQUEUES; cpu++)
+    {
+      if (cpu == this_cpu())
+        {
+          continue;
+        }
+
+      flags = wd_queue_lock(cpu);
+      expired = wd_queue_next(cpu, &next) && clock_compare(next, ticks);
+      wd_queue_unlock(cpu, flags);
+
+      if (expired)
+        {
+          if (g_wdsmpcall[cpu].func == NULL)
+            {
+              nxsched_smp_call_init(&g_wdsmpcall[cpu],
+                                    wd_smp_expiration, NULL);
+            }
+
+          nxsched_smp_call_single_async(cpu, &g_wdsmpcall[cpu]);
+        }
+    }
+#endif
+
+  wd_queue_expiration(WDOG_THIS_CPU, ticks);
+}
+
 /****************************************************************************
  * Name: wd_insert
  *
  * Description:
- *   Insert the timer into the global list to ensure that
- *   the list is sorted in increasing order of expiration absolute time.
+ *   Insert the timer into the queue of 'cpu' to ensure that the queue is
+ *   sorted in increasing order of expiration absolute time.
  *
  * Input Parameters:
+ *   cpu      - The watchdog queue
  *   wdog     - Watchdog ID
  *   expired  - expired absolute time in clock ticks
  *   wdentry  - Function to call on timeout
@@ -181,88 +281,72 @@ static inline_function void wd_expiration(clock_t ticks)
  *   wdog and wdentry is not NULL.
  *
  * Returned Value:
- *   None.
+ *   True if the next expiration of the queue changed.
  *
  ****************************************************************************/
 
 static inline_function
-void wd_insert(FAR struct wdog_s *wdog, clock_t expired,
+bool wd_insert(int cpu, FAR struct wdog_s *wdog, clock_t expired,
                wdentry_t wdentry, wdparm_t arg)
 {
-  FAR struct wdog_s *curr;
-
-  /* Traverse the watchdog list */
-
-  list_for_every_entry(&g_wdactivelist, curr, struct wdog_s, node)
-    {
-      /* Until curr->expired has not timed out relative to expired */
-
-      if (!clock_compare(curr->expired, expired))
-        {
-          break;
-        }
-    }
-
-  /* There are two cases:
-   * - Traverse to the end, where curr == &g_wdactivelist.
-   * - Find a curr such that curr->expected has not timed out
-   * relative to expired.
-   * In either case 1 or 2, we just insert the wdog before curr.
-   */
-
-  list_add_before(&curr->node, &wdog->node);
-
   wdog->func = wdentry;
   up_getpicbase(&wdog->picbase);
   wdog->arg = arg;
   wdog->expired = expired;
+
+  return wd_queue_insert(cpu, wdog);
 }
 
 /****************************************************************************
- * Public Functions
+ * Name: wd_queue_lock2
+ *
+ * Description:
+ *   Lock the queues of 'cpu1' and 'cpu2' in increasing CPU order, so two
+ *   CPUs moving watchdogs between the same queues can not deadlock.
+ *
  ****************************************************************************/
 
+#ifdef CONFIG_WDOG_PERCPU
+static irqstate_t wd_queue_lock2(int cpu1, int cpu2)
+{
+  irqstate_t flags;
+
+  flags = wd_queue_lock(MIN(cpu1, cpu2));
+  if (cpu1 != cpu2)
+    {
+      spin_lock(&g_wdlock[MAX(cpu1, cpu2)]);
+    }
+
+  return flags;
+}
+
+static void wd_queue_unlock2(int cpu1, int cpu2, irqstate_t flags)
+{
+  if (cpu1 != cpu2)
+    {
+      spin_unlock(&g_wdlock[MAX(cpu1, cpu2)]);
+    }
+
+  wd_queue_unlock(MIN(cpu1, cpu2), flags);
+}
+#endif
+
 /****************************************************************************
- * Name: wd_start_abstick
+ * Name: wd_start_queue
  *
  * Description:
- *   This function adds a watchdog timer to the active timer queue.  The
- *   specified watchdog function at 'wdentry' will be called from the
- *   interrupt level after the specified number of ticks has reached.
- *   Watchdog timers may be started from the interrupt level.
- *
- *   Watchdog timers execute in the address environment that was in effect
- *   when wd_start() is called.
- *
- *   Watchdog timers execute only once.
- *
- *   To replace either the timeout delay or the function to be executed,
- *   call wd_start again with the same wdog; only the most recent wdStart()
- *   on a given watchdog ID has any effect.
- *
- * Input Parameters:
- *   wdog     - Watchdog ID
- *   ticks    - Absoulute time in clock ticks
- *   wdentry  - Function to call on timeout
- *   arg      - Parameter to pass to wdentry.
- *
- *   NOTE:  The parameter must be of type wdparm_t.
- *
- * Returned Value:
- *   Zero (OK) is returned on success; a negated errno value is return to
- *   indicate the nature of any failure.
- *
- * Assumptions:
- *   The watchdog routine runs in the context of the timer interrupt handler
- *   and is subject to all ISR restrictions.
+ *   Add the watchdog timer to the queue of 'cpu'.  See wd_start_abstick().
  *
  ****************************************************************************/
 
-int wd_start_abstick(FAR struct wdog_s *wdog, clock_t ticks,
-                     wdentry_t wdentry, wdparm_t arg)
+static int wd_start_queue(FAR struct wdog_s *wdog, int cpu, clock_t ticks,
+                          wdentry_t wdentry, wdparm_t arg)
 {
   irqstate_t flags;
   bool reassess = false;
+#ifdef CONFIG_WDOG_PERCPU
+  int old;
+#endif
 
   /* Verify the wdog and setup parameters */
 
@@ -293,21 +377,67 @@ int wd_start_abstick(FAR struct wdog_s *wdog, clock_t ticks,
    * the critical section is established.
    */
 
-  flags = enter_critical_section();
-#ifdef CONFIG_SCHED_TICKLESS
-  /* We need to reassess timer if the watchdog list head has changed. */
+#ifdef CONFIG_WDOG_PERCPU
+  /* The watchdog may still be active in the queue of another CPU.  Lock
+   * that queue and the queue of 'cpu' together, so the removal and the
+   * insertion are one step and a concurrent wd_start() can not insert
+   * the watchdog twice.  The critical section is needed only to reassess
+   * the timer.
+   */
+
+  for (; ; )
+    {
+      old = WDOG_ISACTIVE(wdog) ? WDOG_CPU(wdog) : cpu;
+      flags = wd_queue_lock2(old, cpu);
+
+      /* Retry if the watchdog was moved before the locks were taken */
+
+      if (!WDOG_ISACTIVE(wdog) || WDOG_CPU(wdog) == old)
+        {
+          break;
+        }
+
+      wd_queue_unlock2(old, cpu, flags);
+    }
 
   if (WDOG_ISACTIVE(wdog))
     {
-      reassess |= list_is_head(&g_wdactivelist, &wdog->node);
-      list_delete(&wdog->node);
+      reassess = wd_queue_remove(old, wdog);
       wdog->func = NULL;
     }
+#else
+  flags = enter_critical_section();
 
-  wd_insert(wdog, ticks, wdentry, arg);
+  /* Check if the watchdog has been started. If so, delete it. */
 
-  if (!g_wdtimernested &&
-      (reassess || list_is_head(&g_wdactivelist, &wdog->node)))
+  if (WDOG_ISACTIVE(wdog))
+    {
+      reassess = wd_dequeue(wdog, false) > 0;
+    }
+#endif
+
+  /* We need to reassess timer if the next expiration has changed. */
+
+  reassess |= wd_insert(cpu, wdog, ticks, wdentry, arg);
+
+#ifdef CONFIG_SCHED_TICKLESS
+  /* The timer is reassessed after the watchdog callbacks anyway */
+
+  reassess &= !g_wdtimernested[WDOG_THIS_CPU];
+#else
+  reassess = false;
+#endif
+
+#ifdef CONFIG_WDOG_PERCPU
+  wd_queue_unlock2(old, cpu, flags);
+  if (reassess)
+    {
+      flags = enter_critical_section();
+      nxsched_reassess_timer();
+      leave_critical_section(flags);
+    }
+#else
+  if (reassess)
     {
       /* Resume the interval timer that will generate the next
        * interval event. If the timer at the head of the list changed,
@@ -316,25 +446,60 @@ int wd_start_abstick(FAR struct wdog_s *wdog, clock_t ticks,
 
       nxsched_reassess_timer();
     }
-#else
-  UNUSED(reassess);
 
-  /* Check if the watchdog has been started. If so, delete it. */
-
-  if (WDOG_ISACTIVE(wdog))
-    {
-      list_delete(&wdog->node);
-      wdog->func = NULL;
-    }
-
-  wd_insert(wdog, ticks, wdentry, arg);
-#endif
   leave_critical_section(flags);
+#endif
 
   sched_note_wdog(NOTE_WDOG_START, wdentry, (FAR void *)(uintptr_t)ticks);
   return OK;
 }
 
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: wd_start_abstick
+ *
+ * Description:
+ *   This function adds a watchdog timer to the active timer queue.  The
+ *   specified watchdog function at 'wdentry' will be called from the
+ *   interrupt level after the specified number of ticks has reached.
+ *   Watchdog timers may be started from the interrupt level.
+ *
+ *   Watchdog timers execute in the address environment that was in effect
+ *   when wd_start() is called.
+ *
+ *   Watchdog timers execute only once.
+ *
+ *   To replace either the timeout delay or the function to be executed,
+ *   call wd_start again with the same wdog; only the most recent wdStart()
+ *   on a given watchdog ID has any effect.
+ *
+ * Input Parameters:
+ *   wdog     - Watchdog ID
+ *   ticks    - Absoulute time in clock ticks
+ *   wdentry  - Function to call on timeout
+ *   arg      - Parameter to pass to wdentry.
+ *
+ *   NOTE:  The parameter must be of type wdparm_t.
+ *
+ * Returned Value:
+ *   Zero (OK) is returned on success; a negated errno value is return to
+ *   indicate the nature of any failure.
+ *
+ * Assumptions:
+ *   The watchdog routine runs in the context of the timer interrupt handler
+ *   and is subject to all ISR restrictions.
+ *
+ ****************************************************************************/
+
+int wd_start_abstick(FAR struct wdog_s *wdog, clock_t ticks,
+                     wdentry_t wdentry, wdparm_t arg)
+{
+  return wd_start_queue(wdog, WDOG_THIS_CPU, ticks, wdentry, arg);
+}
+
 /****************************************************************************
  * Name: wd_start
  *
@@ -385,6 +550,43 @@ int wd_start(FAR struct wdog_s *wdog, sclock_t delay,
                           wdentry, arg);
 }
 
+/****************************************************************************
+ * Name: wd_start_cpu
+ *
+ * Description:
+ *   This function is the same as wd_start() except that the watchdog
+ *   function is executed on the specified CPU instead of the CPU calling
+ *   wd_start_cpu().
+ *
+ * Input Parameters:
+ *   wdog     - Watchdog ID
+ *   cpu      - The CPU to execute the watchdog function on
+ *   delay    - Delay count in clock ticks
+ *   wdentry  - Function to call on timeout
+ *   arg      - Parameter to pass to wdentry
+ *
+ * Returned Value:
+ *   Zero (OK) is returned on success; a negated errno value is return to
+ *   indicate the nature of any failure.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_WDOG_PERCPU
+int wd_start_cpu(FAR struct wdog_s *wdog, int cpu, sclock_t delay,
+                 wdentry_t wdentry, wdparm_t arg)
+{
+  /* Verify the wdog and setup parameters */
+
+  if (delay < 0 || cpu < 0 || cpu >= CONFIG_SMP_NCPUS)
+    {
+      return -EINVAL;
+    }
+
+  return wd_start_queue(wdog, cpu, clock_systime_ticks() + delay,
+                        wdentry, arg);
+}
+#endif
+
 /****************************************************************************
  * Name: wd_timer
  *
@@ -414,9 +616,15 @@ int wd_start(FAR struct wdog_s *wdog, sclock_t delay,
 #ifdef CONFIG_SCHED_TICKLESS
 clock_t wd_timer(clock_t ticks, bool noswitches)
 {
-  FAR struct wdog_s *wdog;
+  irqstate_t qflags;
+#ifndef CONFIG_WDOG_PERCPU
   irqstate_t flags;
+#endif
+  bool found = false;
+  clock_t first = 0;
+  clock_t next;
   sclock_t ret;
+  int cpu;
 
   /* Check if the watchdog at the head of the list is ready to run */
 
@@ -425,24 +633,41 @@ clock_t wd_timer(clock_t ticks, bool noswitches)
       wd_expiration(ticks);
     }
 
+#ifndef CONFIG_WDOG_PERCPU
   flags = enter_critical_section();
+#endif
 
-  /* Return the delay for the next watchdog to expire */
+  /* Find the next watchdog to expire in all queues */
 
-  if (list_is_empty(&g_wdactivelist))
+  for (cpu = 0; cpu < WDOG_NQUEUES; cpu++)
+    {
+      qflags = wd_queue_lock(cpu);
+      if (wd_queue_next(cpu, &next) &&
+          (!found || clock_compare(next, first)))
+        {
+          first = next;
+          found = true;
+        }
+
+      wd_queue_unlock(cpu, qflags);
+    }
+
+#ifndef CONFIG_WDOG_PERCPU
+  leave_critical_section(flags);
+#endif
+
+  if (!found)
     {
-      leave_critical_section(flags);
       return 0;
     }
 
   /* Notice that if noswitches, expired - g_wdtickbase
-   * may get negative value.
+   * may get negative value.  With the timer wheel, the next tick may
+   * also be a cascade point of a higher level, the timer is then
+   * reassessed again after the cascade.
    */
 
-  wdog = list_first_entry(&g_wdactivelist, struct wdog_s, node);
-  ret = wdog->expired - ticks;
-
-  leave_critical_section(flags);
+  ret = first - ticks;
 
   /* Return the delay for the next watchdog to expire */
 
@@ -0,0 +1,372 @@
+/****************************************************************************
+ * sched/wdog/wd_wheel.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <strings.h>
+
+#include <nuttx/clock.h>
+#include <nuttx/list.h>
+#include <nuttx/wdog.h>
+
+#include "wdog/wdog.h"
+
+#ifdef CONFIG_WDOG_TIMER_WHEEL
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* All slot bits of one level */
+
+#define WDOG_WHEEL_ALLBITS  (UINT64_MAX >> (64 - WDOG_WHEEL_SLOTS))
+
+/* The number of ticks covered by the whole wheel */
+
+#define WDOG_WHEEL_RANGE    ((clock_t)1 << (WDOG_WHEEL_LEVELS * \
+                                            WDOG_WHEEL_SHIFT))
+
+#define WDOG_WHEEL_BIT(i)   ((uint64_t)1 << (i))
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: wd_wheel_add
+ *
+ * Description:
+ *   Hash the watchdog into the slot matching its distance from the wheel
+ *   base.  Watchdogs that have already expired go to the current level 0
+ *   slot, watchdogs beyond the range of the wheel are parked in the top
+ *   level and re-hashed when that slot is cascaded.
+ *
+ ****************************************************************************/
+
+static void wd_wheel_add(FAR struct wdog_wheel_s *wheel,
+                         FAR struct wdog_s *wdog)
+{
+  FAR struct list_node *list;
+  clock_t expired = wdog->expired;
+  sclock_t delta = expired - wheel->base;
+  int level = 0;
+  int index;
+
+  if (delta <= 0)
+    {
+      index = wheel->base & WDOG_WHEEL_MASK;
+    }
+  else
+    {
+      while (level < WDOG_WHEEL_LEVELS - 1 &&
+             (clock_t)delta >= ((clock_t)1 << ((level + 1) *
+                                               WDOG_WHEEL_SHIFT)))
+        {
+          level++;
+        }
+
+      if ((clock_t)delta >= WDOG_WHEEL_RANGE)
+        {
+          expired = wheel->base + WDOG_WHEEL_RANGE - 1;
+        }
+
+      index = (expired >> (level * WDOG_WHEEL_SHIFT)) & WDOG_WHEEL_MASK;
+    }
+
+  /* The slot list is only valid while its bit is set in the bitmap */
+
+  list = &wheel->slot[level][index];
+  if ((wheel->bitmap[level] & WDOG_WHEEL_BIT(index)) == 0)
+    {
+      list_initialize(list);
+      wheel->bitmap[level] |= WDOG_WHEEL_BIT(index);
+    }
+
+  list_add_tail(list, &wdog->node);
+}
+
+/****************************************************************************
+ * Name: wd_wheel_cascade
+ *
+ * Description:
+ *   Re-hash the watchdogs of all higher level slots starting at 'ticks'.
+ *   The wheel base must already be set to 'ticks'.
+ *
+ ****************************************************************************/
+
+static void wd_wheel_cascade(FAR struct wdog_wheel_s *wheel, clock_t ticks)
+{
+  FAR struct list_node *list;
+  FAR struct wdog_s *wdog;
+  struct list_node pending;
+  int level;
+  int index;
+
+  /* Cascade from the top so that watchdogs may drop several levels */
+
+  for (level = WDOG_WHEEL_LEVELS - 1; level > 0; level--)
+    {
+      if ((ticks & (((clock_t)1 << (level * WDOG_WHEEL_SHIFT)) - 1)) != 0)
+        {
+          continue;
+        }
+
+      index = (ticks >> (level * WDOG_WHEEL_SHIFT)) & WDOG_WHEEL_MASK;
+      if ((wheel->bitmap[level] & WDOG_WHEEL_BIT(index)) == 0)
+        {
+          continue;
+        }
+
+      /* Detach the slot first, the watchdogs may hash back into it */
+
+      list = &wheel->slot[level][index];
+      pending.next       = list->next;
+      pending.prev       = list->prev;
+      pending.next->prev = &pending;
+      pending.prev->next = &pending;
+      wheel->bitmap[level] &= ~WDOG_WHEEL_BIT(index);
+
+      while (!list_is_empty(&pending))
+        {
+          wdog = list_first_entry(&pending, struct wdog_s, node);
+          list_delete(&wdog->node);
+          wd_wheel_add(wheel, wdog);
+        }
+    }
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: wd_wheel_insert
+ *
+ * Description:
+ *   Insert the watchdog into the timer wheel slot matching its expiration
+ *   time.  This is O(1) regardless of the number of active watchdogs.
+ *
+ * Input Parameters:
+ *   wheel - The timer wheel
+ *   wdog  - The watchdog with the expired field already set up
+ *
+ * Returned Value:
+ *   None
+ *
+ * Assumptions:
+ *   Called within a critical section.
+ *
+ ****************************************************************************/
+
+void wd_wheel_insert(FAR struct wdog_wheel_s *wheel,
+                     FAR struct wdog_s *wdog)
+{
+  clock_t next;
+
+  /* Catch up with the current time if the wheel has been idle, so that a
+   * long idle period does not push new watchdogs into the top level.
+   */
+
+  if (!wd_wheel_next(wheel, &next))
+    {
+      wheel->base = clock_systime_ticks();
+    }
+
+  wd_wheel_add(wheel, wdog);
+}
+
+/****************************************************************************
+ * Name: wd_wheel_remove
+ *
+ * Description:
+ *   Remove the watchdog from the timer wheel.
+ *
+ * Input Parameters:
+ *   wheel - The timer wheel
+ *   wdog  - The active watchdog to remove
+ *
+ * Returned Value:
+ *   None
+ *
+ * Assumptions:
+ *   Called within a critical section.
+ *
+ ****************************************************************************/
+
+void wd_wheel_remove(FAR struct wdog_wheel_s *wheel,
+                     FAR struct wdog_s *wdog)
+{
+  FAR struct list_node *list = wdog->node.next;
+  int index;
+
+  /* If the watchdog is the only entry, its neighbour is the slot head and
+   * the slot becomes empty.
+   */
+
+  if (list == wdog->node.prev)
+    {
+      index = list - &wheel->slot[0][0];
+      wheel->bitmap[index >> WDOG_WHEEL_SHIFT] &=
+        ~WDOG_WHEEL_BIT(index & WDOG_WHEEL_MASK);
+    }
+
+  list_delete(&wdog->node);
+}
+
+/****************************************************************************
+ * Name: wd_wheel_next
+ *
+ * Description:
+ *   Return the next tick at which the wheel needs to be serviced, either
+ *   because a watchdog expires or because a higher level slot has to be
+ *   cascaded.  The cost is bounded by the number of levels.
+ *
+ * Input Parameters:
+ *   wheel - The timer wheel
+ *   next  - The location to return the next tick
+ *
+ * Returned Value:
+ *   True if there is any active watchdog in the wheel, false otherwise.
+ *
+ * Assumptions:
+ *   Called within a critical section.
+ *
+ ****************************************************************************/
+
+bool wd_wheel_next(FAR struct wdog_wheel_s *wheel, FAR clock_t *next)
+{
+  clock_t delay = 0;
+  bool found = false;
+  uint64_t bitmap;
+  clock_t ticks;
+  int level;
+  int shift;
+  int index;
+
+  /* Watchdogs in the current level 0 slot have already expired */
+
+  if (wheel->bitmap[0] & WDOG_WHEEL_BIT(wheel->base & WDOG_WHEEL_MASK))
+    {
+      *next = wheel->base;
+      return true;
+    }
+
+  for (level = 0; level < WDOG_WHEEL_LEVELS; level++)
+    {
+      bitmap = wheel->bitmap[level];
+      if (bitmap == 0)
+        {
+          continue;
+        }
+
+      /* Rotate the bitmap so that bit 0 is the slot after the current
+       * one, then the first set bit is the distance to the next slot.
+       * The current slot itself of a higher level means one full turn.
+       */
+
+      shift = level * WDOG_WHEEL_SHIFT;
+      index = ((wheel->base >> shift) + 1) & WDOG_WHEEL_MASK;
+      if (index != 0)
+        {
+          bitmap = ((bitmap >> index) |
+                    (bitmap << (WDOG_WHEEL_SLOTS - index))) &
+                   WDOG_WHEEL_ALLBITS;
+        }
+
+      ticks = ((wheel->base >> shift) + ffsll(bitmap)) << shift;
+      if (!found || ticks - wheel->base < delay)
+        {
+          delay = ticks - wheel->base;
+          found = true;
+        }
+    }
+
+  *next = wheel->base + delay;
+  return found;
+}
+
+/****************************************************************************
+ * Name: wd_wheel_expire
+ *
+ * Description:
+ *   Advance the timer wheel up to 'ticks' and remove the next expired
+ *   watchdog from it.
+ *
+ * Input Parameters:
+ *   wheel - The timer wheel
+ *   ticks - The current time in ticks
+ *
+ * Returned Value:
+ *   The expired watchdog or NULL if no more watchdogs expired.
+ *
+ * Assumptions:
+ *   Called within a critical section.
+ *
+ ****************************************************************************/
+
+FAR struct wdog_s *wd_wheel_expire(FAR struct wdog_wheel_s *wheel,
+                                   clock_t ticks)
+{
+  FAR struct wdog_s *wdog;
+  clock_t next;
+  int index;
+
+  for (; ; )
+    {
+      index = wheel->base & WDOG_WHEEL_MASK;
+      if (wheel->bitmap[0] & WDOG_WHEEL_BIT(index))
+        {
+          wdog = list_first_entry(&wheel->slot[0][index],
+                                  struct wdog_s, node);
+          if (!clock_compare(wdog->expired, ticks))
+            {
+              return NULL;
+            }
+
+          wd_wheel_remove(wheel, wdog);
+          return wdog;
+        }
+
+      if (!wd_wheel_next(wheel, &next) || !clock_compare(next, ticks))
+        {
+          /* Nothing more to do before 'ticks', skip the idle slots */
+
+          if (clock_compare(wheel->base, ticks))
+            {
+              wheel->base = ticks;
+            }
+
+          return NULL;
+        }
+
+      wheel->base = next;
+      wd_wheel_cascade(wheel, next);
+    }
+}
+
+#endif /* CONFIG_WDOG_TIMER_WHEEL */
@@ -37,6 +37,8 @@
 #include <nuttx/queue.h>
 #include <nuttx/wdog.h>
 #include <nuttx/list.h>
+#include <nuttx/sched.h>
+#include <nuttx/spinlock.h>
 
 /****************************************************************************
  * Pre-processor Definitions
@@ -46,6 +48,52 @@
 
 #define list_node wdlist_node
 
+#ifdef CONFIG_WDOG_TIMER_WHEEL
+#  define WDOG_WHEEL_SHIFT  CONFIG_WDOG_TIMER_WHEEL_SHIFT
+#  define WDOG_WHEEL_SLOTS  (1 << WDOG_WHEEL_SHIFT)
+#  define WDOG_WHEEL_MASK   (WDOG_WHEEL_SLOTS - 1)
+#  define WDOG_WHEEL_LEVELS CONFIG_WDOG_TIMER_WHEEL_LEVELS
+#endif
+
+/* With CONFIG_WDOG_PERCPU each CPU owns one watchdog queue protected by its
+ * own spinlock.  Otherwise there is one queue protected by the critical
+ * section and the queue lock is a no-op.
+ */
+
+#ifdef CONFIG_WDOG_PERCPU
+#  define WDOG_NQUEUES                CONFIG_SMP_NCPUS
+#  define WDOG_CPU(w)                 ((w)->cpu)
+#  define WDOG_THIS_CPU               this_cpu()
+#  define wd_queue_lock(cpu)          spin_lock_irqsave(&g_wdlock[cpu])
+#  define wd_queue_unlock(cpu, flags) \
+     spin_unlock_irqrestore(&g_wdlock[cpu], flags)
+#else
+#  define WDOG_NQUEUES                1
+#  define WDOG_CPU(w)                 0
+#  define WDOG_THIS_CPU               0
+#  define wd_queue_lock(cpu)          0
+#  define wd_queue_unlock(cpu, flags) UNUSED(flags)
+#endif
+
+/****************************************************************************
+ * Public Type Definitions
+ ****************************************************************************/
+
+#ifdef CONFIG_WDOG_TIMER_WHEEL
+/* This is the hierarchical timer wheel.  Level 0 has a granularity of one
+ * tick, each higher level is WDOG_WHEEL_SLOTS times coarser.  Watchdogs
+ * in the higher levels are cascaded down when the wheel base reaches the
+ * start of their slot, so every watchdog still expires on its exact tick.
+ */
+
+struct wdog_wheel_s
+{
+  clock_t          base;                       /* Tick being processed */
+  uint64_t         bitmap[WDOG_WHEEL_LEVELS];  /* Non-empty slots */
+  struct list_node slot[WDOG_WHEEL_LEVELS][WDOG_WHEEL_SLOTS];
+};
+#endif
+
 /****************************************************************************
  * Public Data
  ****************************************************************************/
@@ -58,12 +106,30 @@ extern "C"
 #define EXTERN extern
 #endif
 
+#ifdef CONFIG_WDOG_TIMER_WHEEL
+/* The g_wdwheel holds all active watchdogs hashed by expiration time. */
+
+extern struct wdog_wheel_s g_wdwheel[WDOG_NQUEUES];
+#else
 /* The g_wdactivelist data structure is a singly linked list ordered by
  * watchdog expiration time. When watchdog timers expire,the functions on
  * this linked list are removed and the function is called.
  */
 
-extern struct list_node g_wdactivelist;
+extern struct list_node g_wdactivelist[WDOG_NQUEUES];
+#endif
+
+#ifdef CONFIG_WDOG_PERCPU
+/* The g_wdlock protects the watchdog queue of each CPU */
+
+extern spinlock_t g_wdlock[WDOG_NQUEUES];
+
+/* The watchdog whose callback each CPU is running, set and cleared under
+ * g_wdlock so wd_cancel() can wait for it.
+ */
+
+extern FAR struct wdog_s *volatile g_wdrunning[WDOG_NQUEUES];
+#endif
 
 /****************************************************************************
  * Public Function Prototypes
@@ -123,6 +189,323 @@ void wd_timer(clock_t ticks);
 struct tcb_s;
 void wd_recover(FAR struct tcb_s *tcb);
 
+/****************************************************************************
+ * Name: wd_initialize
+ *
+ * Description:
+ *   Initialize the per-CPU watchdog queues.  This must be called before
+ *   any watchdog is started.
+ *
+ * Input Parameters:
+ *   None
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_WDOG_PERCPU
+void wd_initialize(void);
+#else
+#  define wd_initialize()
+#endif
+
+/****************************************************************************
+ * Name: wd_dequeue
+ *
+ * Description:
+ *   Remove an active watchdog from the queue it is armed in and mark it
+ *   inactive.  With CONFIG_WDOG_PERCPU that queue may belong to another
+ *   CPU and is locked here; otherwise the caller must be in a critical
+ *   section.
+ *
+ * Input Parameters:
+ *   wdog - The watchdog to remove
+ *   note - Emit NOTE_WDOG_CANCEL for the removed watchdog
+ *
+ * Returned Value:
+ *   -EINVAL if the watchdog is not active, 1 if the next expiration of
+ *   its queue changed and the timer has to be reassessed, 0 otherwise.
+ *
+ ****************************************************************************/
+
+int wd_dequeue(FAR struct wdog_s *wdog, bool note);
+
+/****************************************************************************
+ * Name: wd_wait_running
+ *
+ * Description:
+ *   Wait until the callback of the watchdog is no longer running on any
+ *   other CPU.
+ *
+ * Input Parameters:
+ *   wdog - The watchdog that was just cancelled
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_WDOG_PERCPU
+void wd_wait_running(FAR struct wdog_s *wdog);
+#else
+#  define wd_wait_running(wdog)
+#endif
+
+#ifdef CONFIG_WDOG_TIMER_WHEEL
+
+/****************************************************************************
+ * Name: wd_wheel_insert
+ *
+ * Description:
+ *   Insert the watchdog into the timer wheel slot matching its expiration
+ *   time.  This is O(1) regardless of the number of active watchdogs.
+ *
+ * Input Parameters:
+ *   wheel - The timer wheel
+ *   wdog  - The watchdog with the expired field already set up
+ *
+ * Returned Value:
+ *   None
+ *
+ * Assumptions:
+ *   Called within a critical section.
+ *
+ ****************************************************************************/
+
+void wd_wheel_insert(FAR struct wdog_wheel_s *wheel,
+                     FAR struct wdog_s *wdog);
+
+/****************************************************************************
+ * Name: wd_wheel_remove
+ *
+ * Description:
+ *   Remove the watchdog from the timer wheel.
+ *
+ * Input Parameters:
+ *   wheel - The timer wheel
+ *   wdog  - The active watchdog to remove
+ *
+ * Returned Value:
+ *   None
+ *
+ * Assumptions:
+ *   Called within a critical section.
+ *
+ ****************************************************************************/
+
+void wd_wheel_remove(FAR struct wdog_wheel_s *wheel,
+                     FAR struct wdog_s *wdog);
+
+/****************************************************************************
+ * Name: wd_wheel_next
+ *
+ * Description:
+ *   Return the next tick at which the wheel needs to be serviced, either
+ *   because a watchdog expires or because a higher level slot has to be
+ *   cascaded.  The cost is bounded by the number of levels.
+ *
+ * Input Parameters:
+ *   wheel - The timer wheel
+ *   next  - The location to return the next tick
+ *
+ * Returned Value:
+ *   True if there is any active watchdog in the wheel, false otherwise.
+ *
+ * Assumptions:
+ *   Called within a critical section.
+ *
+ ****************************************************************************/
+
+bool wd_wheel_next(FAR struct wdog_wheel_s *wheel, FAR clock_t *next);
+
+/****************************************************************************
+ * Name: wd_wheel_expire
+ *
+ * Description:
+ *   Advance the timer wheel up to 'ticks' and remove the next expired
+ *   watchdog from it.
+ *
+ * Input Parameters:
+ *   wheel - The timer wheel
+ *   ticks - The current time in ticks
+ *
+ * Returned Value:
+ *   The expired watchdog or NULL if no more watchdogs expired.
+ *
+ * Assumptions:
+ *   Called within a critical section.
+ *
+ ****************************************************************************/
+
+FAR struct wdog_s *wd_wheel_expire(FAR struct wdog_wheel_s *wheel,
+                                   clock_t ticks);
+#endif /* CONFIG_WDOG_TIMER_WHEEL */
+
+/****************************************************************************
+ * Inline Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: wd_queue_next
+ *
+ * Description:
+ *   Return the next tick at which the watchdog queue of 'cpu' needs to be
+ *   serviced.  The caller must hold the queue lock.
+ *
+ ****************************************************************************/
+
+static inline_function bool wd_queue_next(int cpu, FAR clock_t *next)
+{
+#ifdef CONFIG_WDOG_TIMER_WHEEL
+  return wd_wheel_next(&g_wdwheel[cpu], next);
+#else
+  if (list_is_empty(&g_wdactivelist[cpu]))
+    {
+      return false;
+    }
+
+  *next = list_first_entry(&g_wdactivelist[cpu],
+                           struct wdog_s, node)->expired;
+  return true;
+#endif
+}
+
+/****************************************************************************
+ * Name: wd_queue_insert
+ *
+ * Description:
+ *   Insert the watchdog into the queue of 'cpu' by its expired field.
+ *   The caller must hold the queue lock.
+ *
+ * Returned Value:
+ *   True if the next expiration of the queue changed.
+ *
+ ****************************************************************************/
+
+static inline_function bool wd_queue_insert(int cpu,
+                                            FAR struct wdog_s *wdog)
+{
+#ifdef CONFIG_WDOG_TIMER_WHEEL
+  FAR struct wdog_wheel_s *wheel = &g_wdwheel[cpu];
+  clock_t prev;
+  clock_t next;
+  bool empty;
+
+  empty = !wd_wheel_next(wheel, &prev);
+  wd_wheel_insert(wheel, wdog);
+  wd_wheel_next(wheel, &next);
+#else
+  FAR struct list_node *list = &g_wdactivelist[cpu];
+  FAR struct wdog_s *curr;
+
+  /* Traverse the watchdog list */
+
+  list_for_every_entry(list, curr, struct wdog_s, node)
+    {
+      /* Until curr->expired has not timed out relative to expired */
+
+      if (!clock_compare(curr->expired, wdog->expired))
+        {
+          break;
+        }
+    }
+
+  /* There are two cases:
+   * - Traverse to the end, where curr == list.
+   * - Find a curr such that curr->expected has not timed out
+   * relative to expired.
+   * In either case 1 or 2, we just insert the wdog before curr.
+   */
+
+  list_add_before(&curr->node, &wdog->node);
+#endif
+
+#ifdef CONFIG_WDOG_PERCPU
+  wdog->cpu = cpu;
+#endif
+
+#ifdef CONFIG_WDOG_TIMER_WHEEL
+  return empty || next != prev;
+#else
+  return list_is_head(list, &wdog->node);
+#endif
+}
+
+/****************************************************************************
+ * Name: wd_queue_remove
+ *
+ * Description:
+ *   Remove the watchdog from the queue of 'cpu'.  The caller must hold the
+ *   queue lock.
+ *
+ * Returned Value:
+ *   True if the next expiration of the queue changed.
+ *
+ ****************************************************************************/
+
+static inline_function bool wd_queue_remove(int cpu,
+                                            FAR struct wdog_s *wdog)
+{
+#ifdef CONFIG_WDOG_TIMER_WHEEL
+  FAR struct wdog_wheel_s *wheel = &g_wdwheel[cpu];
+  clock_t prev;
+  clock_t next;
+
+  /* The wheel has no head, check whether the next expiration moved */
+
+  wd_wheel_next(wheel, &prev);
+  wd_wheel_remove(wheel, wdog);
+  return !wd_wheel_next(wheel, &next) || next != prev;
+#else
+  bool head = list_is_head(&g_wdactivelist[cpu], &wdog->node);
+
+  list_delete(&wdog->node);
+  return head;
+#endif
+}
+
+/****************************************************************************
+ * Name: wd_queue_expire
+ *
+ * Description:
+ *   Remove the next watchdog of the queue of 'cpu' that is ready to run.
+ *   The caller must hold the queue lock.
+ *
+ * Returned Value:
+ *   The expired watchdog, or NULL if there is no more expired watchdog.
+ *
+ ****************************************************************************/
+
+static inline_function FAR struct wdog_s *wd_queue_expire(int cpu,
+                                                          clock_t ticks)
+{
+#ifdef CONFIG_WDOG_TIMER_WHEEL
+  return wd_wheel_expire(&g_wdwheel[cpu], ticks);
+#else
+  FAR struct wdog_s *wdog;
+
+  if (list_is_empty(&g_wdactivelist[cpu]))
+    {
+      return NULL;
+    }
+
+  wdog = list_first_entry(&g_wdactivelist[cpu], struct wdog_s, node);
+
+  /* Check if expected time is expired */
+
+  if (!clock_compare(wdog->expired, ticks))
+    {
+      return NULL;
+    }
+
+  /* Remove the watchdog from the head of the list */
+
+  list_delete(&wdog->node);
+  return wdog;
+#endif
+}
+
 #undef EXTERN
 #ifdef __cplusplus
 }
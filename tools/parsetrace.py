@@ -148,6 +148,31 @@ class SymbolTables(object):
                         return size
         raise ValueError("not found type")
 
+    def has_member(self, struct_name, member_name):
+        if not self.elffile.has_dwarf_info():
+            raise ValueError("not found dwarf info!")
+
+        dwarfinfo = self.elffile.get_dwarf_info()
+        for CU in dwarfinfo.iter_CUs():
+            for DIE in CU.iter_DIEs():
+                if DIE.tag != "DW_TAG_structure_type":
+                    continue
+                if "DW_AT_name" not in DIE.attributes:
+                    continue
+                name = DIE.attributes["DW_AT_name"].value.decode("utf-8")
+                if name != struct_name:
+                    continue
+                for child in DIE.iter_children():
+                    if (
+                        child.tag == "DW_TAG_member"
+                        and "DW_AT_name" in child.attributes
+                        and child.attributes["DW_AT_name"].value.decode("utf-8")
+                        == member_name
+                    ):
+                        return True
+                return False
+        raise ValueError("not found struct")
+
     def readstring(self, addr):
         data = b""
         while True:
@@ -272,6 +297,8 @@ class ParseBinaryLogTool:
         elf_nuttx_path,
         out_path=None,
         size_long=4,
+        size_clock=8,
+        perf_freq=1000000000,
         config_endian_big=False,
     ):
         self.binary_log_path = binary_log_path
@@ -284,7 +311,9 @@ class ParseBinaryLogTool:
         self.parsed = list()
         self.task_name_dict = dict()
         self.size_long = size_long
-        self.size_note_common = 3 + size_long * 3
+        self.size_clock = size_clock
+        self.perf_freq = perf_freq
+        self.size_note_common = 4 + size_long + size_clock
         self.config_endian_big = config_endian_big
 
     def parse_by_endian(self, lis):
@@ -304,8 +333,7 @@ class ParseBinaryLogTool:
         one.add("uint8", "nc_priority")
         one.add("uint8", "nc_cpu")
         one.add("uint8", "nc_pid", self.size_long)
-        one.add("uint8", "nc_systime_sec", self.size_long)
-        one.add("uint8", "nc_systime_nsec", self.size_long)
+        one.add("uint8", "nc_systime", self.size_clock)  # perf_gettime()
         res = one.deserialize(self.in_bytes, st)
 
         # case type
@@ -324,8 +352,7 @@ class ParseBinaryLogTool:
         res = one.deserialize(self.in_bytes, st)
         # parse pid, systime ...
         res["nc_pid"] = self.parse_by_endian(res["nc_pid"])[0]
-        res["nc_systime_sec"] = self.parse_by_endian(res["nc_systime_sec"])[0]
-        res["nc_systime_nsec"] = self.parse_by_endian(res["nc_systime_nsec"])[0]
+        res["nc_systime"] = self.parse_by_endian(res["nc_systime"])[0]
         if "nst_ip" in res:
             res["nst_ip"] = self.parse_by_endian(res["nst_ip"])[1]
 
@@ -344,9 +371,7 @@ class ParseBinaryLogTool:
         nc_pid = one["nc_pid"]
         nc_cpu = one["nc_cpu"]
         nsa_name = self.task_name_dict.get(nc_pid, "noname")
-        float_time = float(
-            str(one["nc_systime_sec"]) + "." + str(one["nc_systime_nsec"])
-        )
+        float_time = one["nc_systime"] / self.perf_freq
 
         # case nc_type
         a_model, other_model = None, None
@@ -399,10 +424,20 @@ class ParseBinaryLogTool:
 
 
 class TraceDecoder(SymbolTables):
-    def __init__(self, elffile):
+    def __init__(self, elffile, perf_freq=1000000000):
         super().__init__(elffile)
         self.data = b""
-        self.typeinfo["time_t"] = "int%d" % (self.get_typesize("time_t") * 8)
+        self.perf_freq = perf_freq
+        self.typeinfo["clock_t"] = "uint%d" % (self.get_typesize("clock_t") * 8)
+
+        # CONFIG_DRIVERS_NOTE_PRINTF_COMPACT drops npt_ip and npt_type,
+        # the record only holds the format string address and the packed
+        # arguments, whose layout is described by the format string.
+
+        try:
+            self.compact = not self.has_member("note_printf_s", "npt_type")
+        except ValueError:
+            self.compact = False
 
     def note_common_define(self):
         note_common = pycstruct.StructDef(alignment=4)
@@ -411,16 +446,17 @@ class TraceDecoder(SymbolTables):
         note_common.add("uint8", "nc_priority")
         note_common.add("uint8", "nc_cpu")
         note_common.add(self.typeinfo["pid_t"], "nc_pid")
-        note_common.add(self.typeinfo["time_t"], "nc_systime_sec")
-        note_common.add(self.typeinfo["long"], "nc_systime_nsec")
+        note_common.add(self.typeinfo["clock_t"], "nc_systime")
         return note_common
 
     def note_printf_define(self, length):
         struct_def = pycstruct.StructDef(alignment=4)
         struct_def.add(self.note_common_define(), "npt_cmn")
-        struct_def.add(self.typeinfo["size_t"], "npt_ip")
+        if not self.compact:
+            struct_def.add(self.typeinfo["size_t"], "npt_ip")
         struct_def.add(self.typeinfo["size_t"], "npt_fmt")
-        struct_def.add("uint32", "npt_type")
+        if not self.compact:
+            struct_def.add("uint32", "npt_type")
         if length > 0:
             struct_def.add("uint8", "npt_data", length=length)
         return struct_def
@@ -431,14 +467,12 @@ class TraceDecoder(SymbolTables):
         ).groups()
         format = "%" if pattern[0] is None else "%" + pattern[0]
 
+        # char and short arguments are promoted to int and packed as such
+
         if pattern[4] == "l" or pattern[4] == "z" or pattern[4] == "t":
-            length = 4 if self.typeinfo["size_t"] == "int32" else 8
-        elif pattern[4] == "ll":
+            length = 4 if self.typeinfo["size_t"] == "uint32" else 8
+        elif pattern[4] == "ll" or pattern[4] == "j":
             length = 8
-        elif pattern[4] == "h":
-            length = 2
-        elif pattern[4] == "hh":
-            length = 1
         else:
             length = 4
 
@@ -514,7 +548,7 @@ class TraceDecoder(SymbolTables):
         return "%s", lenght, string
 
     def extract_point(self, fmt, data):
-        length = 4 if self.typeinfo["size_t"] == "int32" else 8
+        length = 4 if self.typeinfo["size_t"] == "uint32" else 8
         value = int.from_bytes(
             data[:length], byteorder=self.elfinfo["byteorder"], signed=False
         )
@@ -538,7 +572,8 @@ class TraceDecoder(SymbolTables):
             parts = [
                 part
                 for part in re.split(
-                    r"(%[-+#0\s]*[\d|\*]*(?:\.[\d|\*])?[lhjztL]?[diufFeEgGxXoscpn%])",
+                    r"(%[-+#0\s]*[\d|\*]*(?:\.[\d|\*])?(?:ll|hh|[lhjztL])?"
+                    r"[diufFeEgGxXoscpn%])",
                     format,
                 )
             ]
@@ -563,10 +598,7 @@ class TraceDecoder(SymbolTables):
 
     def print_format(self, note):
         payload = dict()
-        payload["time"] = (
-            note["npt_cmn"]["nc_systime_sec"]
-            + note["npt_cmn"]["nc_systime_nsec"] / 1000000000
-        )
+        payload["time"] = note["npt_cmn"]["nc_systime"] / self.perf_freq
         payload["pid"] = note["npt_cmn"]["nc_pid"]
         payload["cpu"] = (
             0 if "nc_cpu" not in note["npt_cmn"] else note["npt_cmn"]["nc_cpu"]
@@ -623,6 +655,13 @@ def parse_arguments():
     parser.add_argument(
         "-b", "--baudrate", help="Physical serial device baud rate", default=115200
     )
+    parser.add_argument(
+        "-f",
+        "--perf-freq",
+        help="perf_getfreq() of the target, to convert note time stamps",
+        type=int,
+        default=1000000000,
+    )
     parser.add_argument("-v", "--verbose", help="verbose output", action="store_true")
     parser.add_argument(
         "-o",
@@ -641,7 +680,7 @@ if __name__ == "__main__":
     if args.trace is None and args.device is None:
         print("error, please add trace file path or device name")
         print(
-            "usage: parsetrace.py [-h] [-t TRACE] [-e ELF] [-d DEVICE] [-b BAUDRATE] [-v] [-o OUTPUT]"
+            "usage: parsetrace.py [-h] [-t TRACE] [-e ELF] [-d DEVICE] [-b BAUDRATE] [-f PERF_FREQ] [-v] [-o OUTPUT]"
         )
         exit(1)
 
@@ -672,10 +711,10 @@ if __name__ == "__main__":
             print("trace log type is binary")
             if args.elf:
                 print(
-                    "parse_binary_log, default config, size_long=4, config_endian_big=False, config_smp=0"
+                    "parse_binary_log, default config, size_long=4, size_clock=8, config_endian_big=False"
                 )
                 parse_binary_log_tool = ParseBinaryLogTool(
-                    args.trace, args.elf, out_path
+                    args.trace, args.elf, out_path, perf_freq=args.perf_freq
                 )
                 parse_binary_log_tool.symbol_tables.parse_symbol()
                 parse_binary_log_tool.parse_binary_log()
@@ -687,7 +726,7 @@ if __name__ == "__main__":
             print("error, please add elf file path")
             exit(1)
 
-        decode = TraceDecoder(args.elf)
+        decode = TraceDecoder(args.elf, args.perf_freq)
         with serial.Serial(args.device, baudrate=args.baudrate) as ser:
             ser.timeout = 0
             decode.tty_received()